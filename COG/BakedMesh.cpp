@@ -0,0 +1,180 @@
+#include <cstring>
+#include <algorithm>
+
+#include "BakedMesh.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+BakedMesh::BakedMesh()
+	:	m_header(nullptr)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+BakedMesh::~BakedMesh()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Maps a baked mesh and checks that it is valid and up to date with the source model it was baked from
+*******************************************************************************************************************/
+bool BakedMesh::Open(const std::string& fileLocation, const std::string& sourceLocation)
+{
+	Close();
+
+	//--- A missing baked file isn't an error, the model just hasn't been baked yet
+	if (!VirtualFile::Exists(fileLocation)) { return false; }
+
+	if (!m_file.Open(fileLocation)) { return false; }
+
+	const Header* header = (const Header*)m_file.GetData();
+
+	if (m_file.GetSize() < sizeof(Header) || memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 ||
+		header->version != s_version || header->vertexSize != sizeof(VertexBuffer::PackedVertex)) {
+		FL_LOG("[MODEL] Baked mesh is not a valid .cogmesh (or is an old version): ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	//--- Make sure the file actually contains all of the data the header says it does
+	unsigned long long vertexBytes	= (unsigned long long)header->vertexCount * sizeof(VertexBuffer::PackedVertex);
+	unsigned long long indexBytes	= (unsigned long long)header->indexCount * sizeof(unsigned int);
+	unsigned long long lodBytes		= (unsigned long long)header->lodCount * sizeof(mesh_simplifier::Lod);
+
+	if (header->vertexCount == 0 || header->indexCount == 0 || header->lodCount == 0 ||
+		header->vertexOffset + vertexBytes > m_file.GetSize() || header->indexOffset + indexBytes > m_file.GetSize() ||
+		header->lodOffset + lodBytes > m_file.GetSize()) {
+		FL_LOG("[MODEL] Baked mesh is truncated: ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	//--- Every LOD has to be a range inside the index array, or we'd draw garbage
+	const mesh_simplifier::Lod* lods = (const mesh_simplifier::Lod*)(m_file.GetData() + header->lodOffset);
+
+	for (unsigned int lod = 0; lod < header->lodCount; lod++) {
+		if ((unsigned long long)lods[lod].indexOffset + lods[lod].indexCount > header->indexCount) {
+			FL_LOG("[MODEL] Baked mesh has an invalid LOD: ", fileLocation.c_str(), LOG_WARN);
+			Close();
+			return false;
+		}
+	}
+
+	//--- Indices are read on the CPU as well as drawn (compressing, occluders), so each one must name a real vertex
+	const unsigned int* indices	= (const unsigned int*)(m_file.GetData() + header->indexOffset);
+	unsigned int largestIndex	= 0;
+
+	for (unsigned int index = 0; index < header->indexCount; index++) { largestIndex = std::max(largestIndex, indices[index]); }
+
+	if (largestIndex >= header->vertexCount) {
+		FL_LOG("[MODEL] Baked mesh has an invalid index: ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	//--- If the source model has been changed since we baked it, the baked data is out of date.
+	//--- If there's no source model at all, the baked file is all we have, so use it
+	unsigned long long sourceHash = 0;
+
+	if (VirtualFile::GenerateHash(sourceLocation, sourceHash) && sourceHash != header->sourceHash) {
+		FL_LOG("[MODEL] Baked mesh is out of date: ", fileLocation.c_str(), LOG_MESSAGE);
+		Close();
+		return false;
+	}
+
+	m_header = header;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps the baked mesh
+*******************************************************************************************************************/
+void BakedMesh::Close()
+{
+	m_header = nullptr;
+	m_file.Close();
+}
+
+
+/*******************************************************************************************************************
+	Writes the vertex and index data to a baked mesh file.
+	The data is written to a temporary file first and then moved in to place, so a crash or a full disk
+	can never leave a half written .cogmesh behind
+*******************************************************************************************************************/
+bool BakedMesh::Write(const std::string& fileLocation, unsigned long long sourceHash, const std::vector<VertexBuffer::PackedVertex>& vertices,
+					  const std::vector<unsigned int>& indices, const std::vector<mesh_simplifier::Lod>& lods, const glm::vec3& dimension)
+{
+	if (vertices.empty() || indices.empty() || lods.empty()) { return false; }
+
+	//--- The header is written as raw bytes, so make sure there's no padding hiding in it
+	static_assert(sizeof(Header) == 56, "BakedMesh::Header must be tightly packed");
+
+	Header header = {};
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+
+	header.version		= s_version;
+	header.vertexSize	= sizeof(VertexBuffer::PackedVertex);
+	header.vertexCount	= (unsigned int)vertices.size();
+	header.indexCount	= (unsigned int)indices.size();
+	header.vertexOffset	= sizeof(Header);
+	header.indexOffset	= header.vertexOffset + header.vertexCount * sizeof(VertexBuffer::PackedVertex);
+	header.lodCount		= (unsigned int)lods.size();
+	header.lodOffset	= header.indexOffset + header.indexCount * sizeof(unsigned int);
+	header.dimension	= dimension;
+
+	header.sourceHash	= sourceHash;
+
+	std::string temporaryLocation = fileLocation + ".tmp";
+
+	HANDLE file = CreateFile(temporaryLocation.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) { FL_LOG("[MODEL] Could not create baked mesh: ", fileLocation.c_str(), LOG_WARN); return false; }
+
+	DWORD written = 0;
+
+	bool success =	WriteFile(file, &header, sizeof(Header), &written, nullptr) &&
+					WriteFile(file, &vertices.front(), (DWORD)(vertices.size() * sizeof(VertexBuffer::PackedVertex)), &written, nullptr) &&
+					WriteFile(file, &indices.front(), (DWORD)(indices.size() * sizeof(unsigned int)), &written, nullptr) &&
+					WriteFile(file, &lods.front(), (DWORD)(lods.size() * sizeof(mesh_simplifier::Lod)), &written, nullptr);
+
+	CloseHandle(file);
+
+	if (!success || !MoveFileEx(temporaryLocation.c_str(), fileLocation.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		FL_LOG("[MODEL] Could not write baked mesh: ", fileLocation.c_str(), LOG_WARN);
+		DeleteFile(temporaryLocation.c_str());
+		return false;
+	}
+
+	FL_LOG("[MODEL] Baked mesh written: ", fileLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const VertexBuffer::PackedVertex* BakedMesh::GetVertices() const	{ return (const VertexBuffer::PackedVertex*)(m_file.GetData() + m_header->vertexOffset); }
+const unsigned int* BakedMesh::GetIndices() const					{ return (const unsigned int*)(m_file.GetData() + m_header->indexOffset); }
+unsigned int BakedMesh::GetVertexCount() const						{ return m_header->vertexCount; }
+unsigned int BakedMesh::GetIndexCount() const						{ return m_header->indexCount; }
+const mesh_simplifier::Lod* BakedMesh::GetLods() const				{ return (const mesh_simplifier::Lod*)(m_file.GetData() + m_header->lodOffset); }
+unsigned int BakedMesh::GetLodCount() const							{ return m_header->lodCount; }
+const glm::vec3& BakedMesh::GetDimension() const					{ return m_header->dimension; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const char BakedMesh::s_magic[4]		= { 'C', 'O', 'G', 'M' };
+const unsigned int BakedMesh::s_version	= 4;
\ No newline at end of file
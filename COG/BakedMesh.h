@@ -0,0 +1,80 @@
+#pragma once
+
+/*******************************************************************************************************************
+	BakedMesh.h, BakedMesh.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Reads and writes .cogmesh files - a binary copy of a model, exactly as it is pushed to the graphics card.
+
+	[Features]
+	A .cogmesh holds a small header, the PackedVertex array, the index array, the LOD table and the model's
+	dimensions. Every LOD shares the same vertices - each one is a range of the index array (see MeshSimplifier.h).
+	Files are memory mapped (or read from a pack, see VirtualFile.h), so the vertex and index data can be handed straight to the buffers with no parsing
+	and no copies. The header stores a hash of the source model's bytes (read the same way, from a pack or from
+	disk), so if the source model changes the baked file is ignored and can be re-baked.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	The data is stored in the native layout of this machine (little endian, sizeof(PackedVertex) per vertex).
+	Bump s_version whenever PackedVertex or the header changes, so that older files are re-baked.
+
+*******************************************************************************************************************/
+#include <vector>
+#include <string>
+#include "VirtualFile.h"
+#include "VertexBuffer.h"
+#include "MeshSimplifier.h"
+
+class BakedMesh {
+
+private:
+	struct Header {
+		char				magic[4];
+		unsigned int		version;
+		unsigned long long	sourceHash;
+		unsigned int		vertexSize;
+		unsigned int		vertexCount;
+		unsigned int		indexCount;
+		unsigned int		vertexOffset;
+		unsigned int		indexOffset;
+		unsigned int		lodCount;
+		unsigned int		lodOffset;
+		glm::vec3			dimension;
+	};
+
+public:
+	BakedMesh();
+	~BakedMesh();
+
+public:
+	bool Open(const std::string& fileLocation, const std::string& sourceLocation);
+	void Close();
+
+public:
+	static bool Write(const std::string& fileLocation, unsigned long long sourceHash, const std::vector<VertexBuffer::PackedVertex>& vertices,
+					  const std::vector<unsigned int>& indices, const std::vector<mesh_simplifier::Lod>& lods, const glm::vec3& dimension);
+
+public:
+	const VertexBuffer::PackedVertex*	GetVertices() const;
+	const unsigned int*					GetIndices() const;
+	unsigned int						GetVertexCount() const;
+	unsigned int						GetIndexCount() const;
+	const mesh_simplifier::Lod*			GetLods() const;
+	unsigned int						GetLodCount() const;
+	const glm::vec3&					GetDimension() const;
+
+private:
+	BakedMesh(const BakedMesh&)				= delete;
+	BakedMesh& operator=(const BakedMesh&)	= delete;
+
+private:
+	VirtualFile		m_file;
+	const Header*	m_header;
+
+private:
+	static const char			s_magic[4];
+	static const unsigned int	s_version;
+};
\ No newline at end of file
@@ -0,0 +1,577 @@
+#include <cstdio>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <GLM.hpp>
+#include <gtc\matrix_transform.hpp>
+
+#include "Benchmark.h"
+#include "ObjLoader.h"
+#include "VertexIndexer.h"
+#include "MeshOptimizer.h"
+#include "TerrainGenerator.h"
+#include "TerrainQuadtree.h"
+#include "TerrainNoise.h"
+#include "BoundingVolumeTree.h"
+#include "Frustum.h"
+#include "OcclusionBuffer.h"
+#include "PerformanceTimer.h"
+#include "Tools.h"
+
+namespace benchmark {
+
+	/*******************************************************************************************************************
+		Runs every benchmark in turn
+	*******************************************************************************************************************/
+	void Run()
+	{
+		//--- A 1000 x 1000 grid gives us 2 million faces
+		ObjLoading(1000);
+		VertexIndexing(1000);
+		MeshOptimization(300);
+
+		//--- 1K, 2K and 4K heightmaps
+		TerrainGeneration(1024);
+		TerrainGeneration(2048);
+		TerrainGeneration(4096);
+
+		//--- 2K and 4K procedural terrains
+		NoiseGeneration(2048);
+		NoiseGeneration(4096);
+
+		//--- 10K and 100K entities spread over a 4K world
+		EntityQueries(10000);
+		EntityQueries(100000);
+
+		//--- 10K and 100K entities behind rows of walls
+		OcclusionCulling(10000);
+		OcclusionCulling(100000);
+	}
+
+
+	/*******************************************************************************************************************
+		Writes a flat grid of gridSize x gridSize quads (2 triangles each) to an OBJ file
+	*******************************************************************************************************************/
+	static bool WriteGridObj(const std::string& fileLocation, unsigned int gridSize)
+	{
+		FILE* file = nullptr;
+
+		if (fopen_s(&file, fileLocation.c_str(), "wb") != 0 || !file) { return false; }
+
+		unsigned int points = gridSize + 1;
+
+		for (unsigned int z = 0; z < points; z++) {
+			for (unsigned int x = 0; x < points; x++) {
+				fprintf(file, "v %f %f %f\n", (float)x, (float)((x * 7 + z * 13) % 17) * 0.125f, -(float)z);
+				fprintf(file, "vt %f %f\n", (float)x / gridSize, (float)z / gridSize);
+				fprintf(file, "vn 0.000000 1.000000 0.000000\n");
+			}
+		}
+
+		for (unsigned int z = 0; z < gridSize; z++) {
+			for (unsigned int x = 0; x < gridSize; x++) {
+
+				unsigned int bottomLeft		= z * points + x + 1;
+				unsigned int bottomRight	= bottomLeft + 1;
+				unsigned int topLeft		= bottomLeft + points;
+				unsigned int topRight		= topLeft + 1;
+
+				fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", bottomLeft, bottomLeft, bottomLeft, bottomRight, bottomRight, bottomRight, topRight, topRight, topRight);
+				fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", bottomLeft, bottomLeft, bottomLeft, topRight, topRight, topRight, topLeft, topLeft, topLeft);
+			}
+		}
+
+		fclose(file);
+
+		return true;
+	}
+
+
+	/*******************************************************************************************************************
+		Compares the memory mapped OBJ parser against the original stream based parser
+	*******************************************************************************************************************/
+	void ObjLoading(unsigned int gridSize)
+	{
+		const std::string fileLocation = "benchmark.obj";
+
+		if (!WriteGridObj(fileLocation, gridSize)) { Debug("[BENCHMARK] Could not write " + fileLocation); return; }
+
+		Debug("[BENCHMARK] OBJ loading, faces: " + NumberToString(gridSize * gridSize * 2));
+
+		for (int indexed = 0; indexed < 2; indexed++) {
+
+			std::vector<glm::vec3> vertices, normals;
+			std::vector<glm::vec2> textureCoords;
+			std::vector<unsigned int> indices;
+
+			long long streamed = 0, mapped = 0;
+
+			{
+				ObjLoader loader;
+				PerformanceTimer<> timer;
+				loader.LoadObjFileStreamed(fileLocation, vertices, textureCoords, normals, (indexed) ? &indices : nullptr);
+				streamed = timer.Elapsed();
+			}
+
+			size_t streamedCount = vertices.size();
+			vertices.clear(); textureCoords.clear(); normals.clear(); indices.clear();
+
+			{
+				ObjLoader loader;
+				PerformanceTimer<> timer;
+				loader.LoadObjFile(fileLocation, vertices, textureCoords, normals, (indexed) ? &indices : nullptr);
+				mapped = timer.Elapsed();
+			}
+
+			Debug(std::string((indexed) ? "  indexed" : "  plain") +
+				  "  streamed: " + NumberToString(streamed) + "ms" +
+				  "  mapped: " + NumberToString(mapped) + "ms" +
+				  "  vertices: " + NumberToString(streamedCount) + " / " + NumberToString(vertices.size()));
+		}
+
+		remove(fileLocation.c_str());
+	}
+
+
+	/*******************************************************************************************************************
+		Compares the original std::map vertex de-duplication against the hash table, single and multi threaded
+	*******************************************************************************************************************/
+	void VertexIndexing(unsigned int gridSize)
+	{
+		//--- Build the same unindexed triangle list that ObjLoader hands to the indexer for a grid OBJ
+		std::vector<VertexBuffer::PackedVertex> vertices;
+		vertices.reserve(gridSize * gridSize * 6);
+
+		const unsigned int corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+
+		for (unsigned int z = 0; z < gridSize; z++) {
+			for (unsigned int x = 0; x < gridSize; x++) {
+				for (const auto& corner : corners) {
+					float cornerX = (float)(x + corner[0]), cornerZ = (float)(z + corner[1]);
+					vertices.push_back({ glm::vec3(cornerX, 0.0f, -cornerZ), glm::vec2(cornerX / gridSize, cornerZ / gridSize),
+										 glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f) });
+				}
+			}
+		}
+
+		Debug("[BENCHMARK] Vertex indexing, vertices: " + NumberToString(vertices.size()));
+
+		std::vector<unsigned int> mapIndices;
+		long long mapped = 0;
+
+		{
+			PerformanceTimer<> timer;
+			std::map<VertexBuffer::PackedVertex, unsigned int> vertexToIndex;
+			unsigned int uniqueCount = 0;
+
+			for (const VertexBuffer::PackedVertex& vertex : vertices) {
+				auto it = vertexToIndex.find(vertex);
+				if (it != vertexToIndex.end()) { mapIndices.emplace_back(it->second); continue; }
+				vertexToIndex[vertex] = uniqueCount;
+				mapIndices.emplace_back(uniqueCount++);
+			}
+
+			mapped = timer.Elapsed();
+		}
+
+		for (int parallel = 0; parallel < 2; parallel++) {
+
+			std::vector<unsigned int> unique, indices;
+			long long hashed = 0;
+
+			{
+				PerformanceTimer<> timer;
+				VertexIndexer(parallel != 0).Generate(vertices, unique, indices);
+				hashed = timer.Elapsed();
+			}
+
+			Debug(std::string((parallel) ? "  parallel" : "  serial") +
+				  "  map: " + NumberToString(mapped) + "ms" +
+				  "  hashed: " + NumberToString(hashed) + "ms" +
+				  "  unique: " + NumberToString(unique.size()) +
+				  "  matches map: " + ((indices == mapIndices) ? "yes" : "no"));
+		}
+	}
+
+
+	/*******************************************************************************************************************
+		Measures the vertex cache gain of the mesh optimizer on a grid whose triangles have been shuffled
+	*******************************************************************************************************************/
+	void MeshOptimization(unsigned int gridSize)
+	{
+		unsigned int points = gridSize + 1;
+
+		std::vector<glm::vec3> positions;
+		positions.reserve(points * points);
+
+		for (unsigned int z = 0; z < points; z++) {
+			for (unsigned int x = 0; x < points; x++) {
+				positions.push_back(glm::vec3((float)x, (float)((x * 7 + z * 13) % 17) * 0.125f, -(float)z));
+			}
+		}
+
+		std::vector<unsigned int> indices;
+		indices.reserve(gridSize * gridSize * 6);
+
+		for (unsigned int z = 0; z < gridSize; z++) {
+			for (unsigned int x = 0; x < gridSize; x++) {
+				unsigned int bottomLeft = z * points + x, bottomRight = bottomLeft + 1, topLeft = bottomLeft + points, topRight = topLeft + 1;
+				unsigned int quad[6] = { bottomLeft, bottomRight, topRight, bottomLeft, topRight, topLeft };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+
+		//--- Shuffle the triangles (with a fixed seed, so every run is the same) to mimic a badly ordered export
+		unsigned int seed = 12345;
+		size_t triangleCount = indices.size() / 3;
+
+		for (size_t triangle = triangleCount - 1; triangle > 0; triangle--) {
+			seed = seed * 1664525 + 1013904223;
+			size_t other = seed % (triangle + 1);
+			for (unsigned int corner = 0; corner < 3; corner++) { std::swap(indices[triangle * 3 + corner], indices[other * 3 + corner]); }
+		}
+
+		Debug("[BENCHMARK] Mesh optimization, triangles: " + NumberToString(triangleCount));
+
+		mesh_optimizer::CacheStatistics before = mesh_optimizer::AnalyzeVertexCache(indices, positions.size());
+
+		long long cache = 0, overdraw = 0, fetch = 0;
+
+		{ PerformanceTimer<> timer; mesh_optimizer::OptimizeVertexCache(indices, positions.size()); cache = timer.Elapsed(); }
+		mesh_optimizer::CacheStatistics afterCache = mesh_optimizer::AnalyzeVertexCache(indices, positions.size());
+
+		{ PerformanceTimer<> timer; mesh_optimizer::OptimizeOverdraw(indices, positions); overdraw = timer.Elapsed(); }
+		mesh_optimizer::CacheStatistics afterOverdraw = mesh_optimizer::AnalyzeVertexCache(indices, positions.size());
+
+		{ PerformanceTimer<> timer; mesh_optimizer::Reorder(positions, mesh_optimizer::OptimizeVertexFetch(indices, positions.size())); fetch = timer.Elapsed(); }
+
+		Debug("  ACMR: " + NumberToString(before.acmr) + " -> " + NumberToString(afterCache.acmr) + " (cache, " + NumberToString(cache) + "ms)" +
+			  " -> " + NumberToString(afterOverdraw.acmr) + " (overdraw, " + NumberToString(overdraw) + "ms)");
+		Debug("  ATVR: " + NumberToString(before.atvr) + " -> " + NumberToString(afterOverdraw.atvr) + "  fetch: " + NumberToString(fetch) + "ms");
+	}
+
+
+	/*******************************************************************************************************************
+		Compares the original single threaded terrain generation (levelling, normals and per-triangle tangents, one pass
+		at a time) against terrain_generator, on a size x size heightmap of RGB pixels
+	*******************************************************************************************************************/
+	void TerrainGeneration(unsigned int size)
+	{
+		const int width = (int)size, height = (int)size, channels = 3;
+		const float level = 15.0f;
+
+		//--- Rolling hills, the same in every channel like a grayscale heightmap
+		std::vector<unsigned char> pixels((size_t)width * height * channels);
+
+		for (int row = 0; row < height; row++) {
+			for (int column = 0; column < width; column++) {
+				unsigned char value = (unsigned char)(127.5f + 127.5f * std::sin(column * 0.05f) * std::cos(row * 0.03f));
+				for (int channel = 0; channel < channels; channel++) { pixels[((size_t)row * width + column) * channels + channel] = value; }
+			}
+		}
+
+		Debug("[BENCHMARK] Terrain generation, heightmap: " + NumberToString(width) + "x" + NumberToString(height));
+
+		std::vector<VertexBuffer::PackedVertex> original, generated;
+		std::vector<unsigned int> indices;
+		long long serial = 0, simd = 0;
+
+		{
+			PerformanceTimer<> timer;
+
+			std::vector<float> heights((size_t)width * height);
+
+			for (int row = 0; row < height; row++) {
+				for (int column = 0; column < width; column++) { heights[(size_t)row * width + column] = (float)pixels[((size_t)row * width + column) * channels]; }
+			}
+
+			for (float& value : heights) { value /= level; }
+
+			auto findHeight = [&](int column, int row) {
+				column = std::min(std::max(column, 0), width - 1); row = std::min(std::max(row, 0), height - 1);
+				return heights[(size_t)row * width + column];
+			};
+
+			original.resize(heights.size());
+
+			for (int row = 0; row < height; row++) {
+				for (int column = 0; column < width; column++) {
+					VertexBuffer::PackedVertex& vertex = original[(size_t)row * width + column];
+					vertex.position		= glm::vec3((float)column, heights[(size_t)row * width + column], (float)row);
+					vertex.textureCoord	= glm::vec2((float)column, (float)row);
+					vertex.normal		= glm::normalize(glm::vec3(findHeight(column - 1, row) - findHeight(column + 1, row), 2.0f,
+															   findHeight(column, row - 1) - findHeight(column, row + 1)));
+					vertex.tangent		= glm::vec3(0.0f);
+					vertex.bitangent	= glm::vec3(0.0f);
+				}
+			}
+
+			TerrainQuadtree quadtree;
+			quadtree.Build(original, width, height, indices);
+
+			for (size_t index = 0; index < indices.size(); index += 3) {
+
+				VertexBuffer::PackedVertex* corners[3] = { &original[indices[index]], &original[indices[index + 1]], &original[indices[index + 2]] };
+
+				glm::vec3 deltaPosition[2]	= { corners[1]->position - corners[0]->position, corners[2]->position - corners[0]->position };
+				glm::vec2 deltaTexCoord[2]	= { corners[1]->textureCoord - corners[0]->textureCoord, corners[2]->textureCoord - corners[0]->textureCoord };
+
+				float denominator	= 1.0f / (deltaTexCoord[0].x * deltaTexCoord[1].y - deltaTexCoord[1].x * deltaTexCoord[0].y);
+				glm::vec3 tangent	= denominator * (deltaTexCoord[1].y * deltaPosition[0] - deltaTexCoord[0].y * deltaPosition[1]);
+				glm::vec3 bitangent	= denominator * (-deltaTexCoord[1].x * deltaPosition[0] + deltaTexCoord[0].x * deltaPosition[1]);
+
+				for (VertexBuffer::PackedVertex* corner : corners) { corner->tangent += tangent; corner->bitangent += bitangent; }
+			}
+
+			for (VertexBuffer::PackedVertex& vertex : original) {
+				vertex.tangent		= glm::normalize(vertex.tangent - vertex.normal * glm::dot(vertex.normal, vertex.tangent));
+				vertex.bitangent	= glm::normalize(vertex.bitangent);
+			}
+
+			serial = timer.Elapsed();
+		}
+
+		{
+			PerformanceTimer<> timer;
+
+			std::vector<float> heights;
+			terrain_generator::ConvertHeights(&pixels.front(), channels, width, height, level, heights);
+			terrain_generator::GenerateVertices(&heights.front(), width, height, generated);
+
+			TerrainQuadtree quadtree;
+			quadtree.Build(generated, width, height, indices);
+
+			simd = timer.Elapsed();
+		}
+
+		//--- The sums are added up in a different order, so allow for rounding
+		float largestError = 0.0f;
+
+		for (size_t vertex = 0; vertex < original.size(); vertex++) {
+			largestError = std::max(largestError, std::abs(original[vertex].position.y - generated[vertex].position.y));
+			largestError = std::max(largestError, glm::length(original[vertex].normal - generated[vertex].normal));
+			largestError = std::max(largestError, glm::length(original[vertex].tangent - generated[vertex].tangent));
+			largestError = std::max(largestError, glm::length(original[vertex].bitangent - generated[vertex].bitangent));
+		}
+
+		Debug("  original: " + NumberToString(serial) + "ms" +
+			  "  simd + threads: " + NumberToString(simd) + "ms" +
+			  "  matches original: " + ((largestError < 1e-4f) ? "yes" : "no"));
+	}
+
+
+	/*******************************************************************************************************************
+		Measures procedural heights in millions of samples per second, for each kind of noise, and checks that a
+		tile generated on its own matches the same part of the whole terrain
+	*******************************************************************************************************************/
+	void NoiseGeneration(unsigned int size)
+	{
+		const int octaves = 8, tileSize = 257;
+		const float level = 15.0f;
+
+		Debug("[BENCHMARK] Procedural terrain, size: " + NumberToString(size) + "x" + NumberToString(size) + ", octaves: " + NumberToString(octaves));
+
+		const char* names[3] = { "fractal", "ridged", "warped" };
+
+		for (int kind = 0; kind < 3; kind++) {
+
+			TerrainNoise noise({ 1234, (kind == 1) ? TerrainNoise::NOISE_RIDGED : TerrainNoise::NOISE_FRACTAL, (int)size, octaves,
+								 0.0f, 0.0f, 0.0f, (kind == 2) ? 40.0f : 0.0f });
+
+			std::vector<float> heights, tile;
+			long long elapsed = 0;
+
+			{
+				PerformanceTimer<std::chrono::microseconds> timer;
+				noise.Generate(0, 0, (int)size, (int)size, level, heights);
+				elapsed = std::max(timer.Elapsed(), 1ll);
+			}
+
+			//--- A tile from the middle of the terrain, which should be identical to the same part of the whole
+			int origin = (int)size / 2 - tileSize / 2;
+			noise.Generate(origin, origin, tileSize, tileSize, level, tile);
+
+			bool isMatching = true;
+
+			for (int row = 0; row < tileSize && isMatching; row++) {
+				for (int column = 0; column < tileSize; column++) {
+					if (tile[(size_t)row * tileSize + column] != heights[(size_t)(origin + row) * size + origin + column]) { isMatching = false; break; }
+				}
+			}
+
+			Debug("  " + std::string(names[kind]) + ": " + NumberToString(elapsed / 1000) + "ms" +
+				  "  million samples/s: " + NumberToString((long long)((double)heights.size() / elapsed)) +
+				  "  tiles match: " + (isMatching ? "yes" : "no"));
+		}
+	}
+
+
+	/*******************************************************************************************************************
+		Indexes count boxes in a bounding volume tree, moves a tenth of them, and times frustum and box queries against
+		testing every box in turn
+	*******************************************************************************************************************/
+	void EntityQueries(unsigned int count)
+	{
+		const float worldSize = 4096.0f;
+		const int queries = 100;
+
+		Debug("[BENCHMARK] Entity queries, entities: " + NumberToString(count));
+
+		//--- Boxes from 1 to 10 units across, scattered with a simple LCG so every run is the same
+		unsigned int seed = 1234;
+		auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return (float)(seed >> 8) / 16777216.0f; };
+
+		std::vector<glm::vec3> minimums(count), maximums(count);
+
+		for (unsigned int i = 0; i < count; i++) {
+			glm::vec3 size(1.0f + random() * 9.0f, 1.0f + random() * 9.0f, 1.0f + random() * 9.0f);
+			minimums[i] = glm::vec3(random() * worldSize, 0.0f, random() * worldSize);
+			maximums[i] = minimums[i] + size;
+		}
+
+		BoundingVolumeTree tree;
+		std::vector<int> proxies(count);
+		long long insertTime = 0, moveTime = 0;
+
+		{
+			PerformanceTimer<std::chrono::microseconds> timer;
+			for (unsigned int i = 0; i < count; i++) { proxies[i] = tree.Insert(minimums[i], maximums[i], i); }
+			insertTime = timer.Elapsed();
+		}
+
+		{
+			PerformanceTimer<std::chrono::microseconds> timer;
+			for (unsigned int i = 0; i < count; i += 10) {
+				glm::vec3 offset(random() * 4.0f - 2.0f, 0.0f, random() * 4.0f - 2.0f);
+				minimums[i] += offset;
+				maximums[i] += offset;
+				tree.Move(proxies[i], minimums[i], maximums[i]);
+			}
+			moveTime = timer.Elapsed();
+		}
+
+		//--- Cameras looking across the world from somewhere on it, and a box around a player standing at each
+		std::vector<Frustum> frustums;
+		std::vector<glm::vec3> eyes;
+
+		for (int query = 0; query < queries; query++) {
+
+			glm::vec3 eye(random() * worldSize, 10.0f, random() * worldSize);
+			float angle = random() * 6.2831853f;
+
+			frustums.emplace_back(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f),
+								  glm::lookAt(eye, eye + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f)));
+			eyes.push_back(eye);
+		}
+
+		std::vector<unsigned int> objects, crossing;
+		long long treeTime = 0, linearTime = 0;
+		size_t found = 0, expected = 0;
+
+		{
+			PerformanceTimer<std::chrono::microseconds> timer;
+
+			for (int query = 0; query < queries; query++) {
+				tree.QueryFrustum(frustums[query], objects, crossing);
+				found += objects.size() + crossing.size();
+				tree.QueryBox(eyes[query] - glm::vec3(8.0f), eyes[query] + glm::vec3(8.0f), objects);
+				found += objects.size();
+			}
+			treeTime = timer.Elapsed();
+		}
+
+		{
+			PerformanceTimer<std::chrono::microseconds> timer;
+
+			for (int query = 0; query < queries; query++) {
+
+				glm::vec3 minimum = eyes[query] - glm::vec3(8.0f), maximum = eyes[query] + glm::vec3(8.0f);
+
+				for (unsigned int i = 0; i < count; i++) {
+					if (frustums[query].IsRectangleInside((minimums[i] + maximums[i]) * 0.5f, (maximums[i] - minimums[i]) * 0.5f)) { expected++; }
+					if (minimums[i].x <= maximum.x && minimum.x <= maximums[i].x &&
+						minimums[i].y <= maximum.y && minimum.y <= maximums[i].y &&
+						minimums[i].z <= maximum.z && minimum.z <= maximums[i].z) { expected++; }
+				}
+			}
+			linearTime = timer.Elapsed();
+		}
+
+		//--- The tree's leaves are a little bigger than the boxes, so it finds every box and maybe a few more
+		Debug("  insert: " + NumberToString(insertTime / 1000) + "ms  move 10%: " + NumberToString(moveTime / 1000) + "ms" +
+			  "  height: " + NumberToString(tree.GetHeight()));
+		Debug("  tree: " + NumberToString(treeTime / queries) + "us  linear: " + NumberToString(linearTime / queries) + "us per frame" +
+			  "  found: " + NumberToString(found) + "  expected: " + NumberToString(expected));
+	}
+
+
+	/*******************************************************************************************************************
+		Draws rows of walls in to an occlusion buffer, and culls count boxes scattered behind and between them - timing
+		both, and counting how many boxes the walls hide. Runs entirely on the CPU
+	*******************************************************************************************************************/
+	void OcclusionCulling(unsigned int count)
+	{
+		const int walls = 64;
+		const int frames = 100;
+
+		Debug("[BENCHMARK] Occlusion culling, entities: " + NumberToString(count));
+
+		unsigned int seed = 1234;
+		auto random = [&seed]() { seed = seed * 1664525u + 1013904223u; return (float)(seed >> 8) / 16777216.0f; };
+
+		//--- A cube from -1 to 1 (counter clockwise faces), stretched in to each wall
+		std::vector<glm::vec3> positions = { { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+											 { -1, -1,  1 }, { 1, -1,  1 }, { 1, 1,  1 }, { -1, 1,  1 } };
+		std::vector<unsigned int> indices = { 4, 5, 6, 4, 6, 7,  1, 0, 3, 1, 3, 2,  5, 1, 2, 5, 2, 6,
+											  0, 4, 7, 0, 7, 3,  7, 6, 2, 7, 2, 3,  0, 1, 5, 0, 5, 4 };
+
+		std::vector<glm::mat4> models;
+
+		for (int wall = 0; wall < walls; wall++) {
+			glm::vec3 size(4.0f + random() * 12.0f, 4.0f + random() * 8.0f, 1.0f);
+			glm::vec3 center(random() * 400.0f - 200.0f, size.y, -20.0f - random() * 300.0f);
+			models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), center), size));
+		}
+
+		std::vector<glm::vec3> minimums(count), maximums(count);
+
+		for (unsigned int i = 0; i < count; i++) {
+			glm::vec3 size(0.5f + random() * 2.0f, 0.5f + random() * 2.0f, 0.5f + random() * 2.0f);
+			minimums[i] = glm::vec3(random() * 400.0f - 200.0f, 0.0f, -10.0f - random() * 400.0f);
+			maximums[i] = minimums[i] + size;
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+		OcclusionBuffer buffer;
+		std::vector<unsigned char> isOccluded;
+		long long rasterTime = 0, cullTime = 0;
+		size_t occluded = 0;
+
+		for (int frame = 0; frame < frames; frame++) {
+
+			glm::vec3 eye(random() * 40.0f - 20.0f, 2.0f, 0.0f);
+			float angle = (random() - 0.5f) * 0.5f;
+			glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(std::sin(angle), 0.0f, -std::cos(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			{
+				PerformanceTimer<std::chrono::microseconds> timer;
+				buffer.Begin(projection * view);
+				for (auto& model : models) { buffer.AddOccluder(positions.data(), positions.size(), indices.data(), indices.size(), model); }
+				buffer.Rasterize();
+				rasterTime += timer.Elapsed();
+			}
+
+			{
+				PerformanceTimer<std::chrono::microseconds> timer;
+				occluded += buffer.CullBoxes(minimums.data(), maximums.data(), count, isOccluded);
+				cullTime += timer.Elapsed();
+			}
+		}
+
+		Debug("  rasterize: " + NumberToString(rasterTime / frames) + "us  cull: " + NumberToString(cullTime / frames) + "us per frame" +
+			  "  triangles: " + NumberToString(buffer.GetTriangleCount()));
+		Debug("  occluded: " + NumberToString(occluded / frames) + " / " + NumberToString(count) + " per frame");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+/*******************************************************************************************************************
+	Benchmark.h, Benchmark.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A handful of benchmarks used to measure the loading code paths of the engine, without needing a window.
+
+	[Features]
+	Run the game with the -benchmark argument to run every benchmark and print the timings to the console.
+	All test data is generated on the fly, so no extra assets need to be shipped.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Run these in Release mode - timings taken in Debug mode are meaningless.
+
+*******************************************************************************************************************/
+#include <string>
+
+namespace benchmark {
+
+	void Run();
+	void ObjLoading(unsigned int gridSize);
+	void VertexIndexing(unsigned int gridSize);
+	void MeshOptimization(unsigned int gridSize);
+	void TerrainGeneration(unsigned int size);
+	void NoiseGeneration(unsigned int size);
+	void EntityQueries(unsigned int count);
+	void OcclusionCulling(unsigned int count);
+}
\ No newline at end of file
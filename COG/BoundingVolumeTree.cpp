@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "BoundingVolumeTree.h"
+#include "Frustum.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+BoundingVolumeTree::BoundingVolumeTree(float margin)
+	:	m_root(s_none),
+		m_freeNodes(s_none),
+		m_count(0),
+		m_margin(margin)
+{
+	if (m_margin <= 0.0f) { m_margin = s_defaultMargin; }
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+BoundingVolumeTree::~BoundingVolumeTree()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that adds an object's box to the tree, and returns the proxy used to move or remove it later
+*******************************************************************************************************************/
+int BoundingVolumeTree::Insert(const glm::vec3& minimum, const glm::vec3& maximum, unsigned int object)
+{
+	int leaf = AllocateNode();
+
+	m_nodes[leaf].minimum	= minimum - glm::vec3(m_margin);
+	m_nodes[leaf].maximum	= maximum + glm::vec3(m_margin);
+	m_nodes[leaf].height	= 0;
+	m_nodes[leaf].object	= object;
+
+	InsertLeaf(leaf);
+	m_count++;
+
+	return leaf;
+}
+
+
+/*******************************************************************************************************************
+	Function that updates an object's box. Nothing changes while the box is still inside its leaf, otherwise the leaf
+	is taken out and inserted again around the new box. Returns true if the tree changed
+*******************************************************************************************************************/
+bool BoundingVolumeTree::Move(int proxy, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+	Node& leaf = m_nodes[proxy];
+
+	if ((minimum.x >= leaf.minimum.x && maximum.x <= leaf.maximum.x) &&
+		(minimum.y >= leaf.minimum.y && maximum.y <= leaf.maximum.y) &&
+		(minimum.z >= leaf.minimum.z && maximum.z <= leaf.maximum.z)) { return false; }
+
+	RemoveLeaf(proxy);
+
+	m_nodes[proxy].minimum = minimum - glm::vec3(m_margin);
+	m_nodes[proxy].maximum = maximum + glm::vec3(m_margin);
+
+	InsertLeaf(proxy);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that takes an object out of the tree. The proxy can't be used again afterwards
+*******************************************************************************************************************/
+void BoundingVolumeTree::Remove(int proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	m_count--;
+}
+
+
+/*******************************************************************************************************************
+	Function that takes every object out of the tree
+*******************************************************************************************************************/
+void BoundingVolumeTree::Clear()
+{
+	m_nodes.clear();
+	m_root		= s_none;
+	m_freeNodes	= s_none;
+	m_count		= 0;
+}
+
+
+/*******************************************************************************************************************
+	Function that finds every object whose leaf is inside the frustum - those entirely inside it in outInside, and those
+	crossing its sides (which might still be outside it) in outCrossing
+*******************************************************************************************************************/
+void BoundingVolumeTree::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& outInside, std::vector<unsigned int>& outCrossing)
+{
+	struct Branch {
+		int				node;
+		unsigned int	sides;
+	};
+
+	outInside.clear();
+	outCrossing.clear();
+
+	if (m_root == s_none) { return; }
+
+	std::vector<Branch> branches;
+	branches.reserve(64);
+	branches.push_back(Branch{ m_root, ~0u });
+
+	while (!branches.empty()) {
+
+		Branch branch = branches.back();
+		branches.pop_back();
+
+		Node& node = m_nodes[branch.node];
+
+		//--- Only the sides the parent crossed are tested, and whatever this node crosses is passed on to its children.
+		//--- Once there are no sides left the branch is entirely inside, and nothing below it is tested at all
+		if (branch.sides) {
+			Frustum::ContainmentType containment = frustum.ClassifyRectangle((node.minimum + node.maximum) * 0.5f, (node.maximum - node.minimum) * 0.5f,
+																			 branch.sides, node.lastSide);
+
+			if (containment == Frustum::CONTAINMENT_OUTSIDE) { continue; }
+		}
+
+		if (node.height == 0) { ((branch.sides) ? outCrossing : outInside).push_back(node.object); }
+		else {
+			branches.push_back(Branch{ node.left, branch.sides });
+			branches.push_back(Branch{ node.right, branch.sides });
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds every object whose leaf overlaps a box
+*******************************************************************************************************************/
+void BoundingVolumeTree::QueryBox(const glm::vec3& minimum, const glm::vec3& maximum, std::vector<unsigned int>& outObjects) const
+{
+	Query([&](const Node& node) {
+		return ((node.minimum.x <= maximum.x && minimum.x <= node.maximum.x) &&
+				(node.minimum.y <= maximum.y && minimum.y <= node.maximum.y) &&
+				(node.minimum.z <= maximum.z && minimum.z <= node.maximum.z));
+	}, outObjects);
+}
+
+
+/*******************************************************************************************************************
+	Function that finds every object whose leaf overlaps a sphere
+*******************************************************************************************************************/
+void BoundingVolumeTree::QuerySphere(const glm::vec3& centerPosition, float radius, std::vector<unsigned int>& outObjects) const
+{
+	Query([&](const Node& node) {
+		glm::vec3 offset = glm::clamp(centerPosition, node.minimum, node.maximum) - centerPosition;
+		return glm::dot(offset, offset) <= radius * radius;
+	}, outObjects);
+}
+
+
+/*******************************************************************************************************************
+	Function that finds every object whose leaf a ray passes through, within maxDistance lengths of its direction.
+	Objects are found in no particular order
+*******************************************************************************************************************/
+void BoundingVolumeTree::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<unsigned int>& outObjects) const
+{
+	//--- Keep the direction away from zero, so the inverse never divides by it
+	glm::vec3 inverse;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float component	= (std::fabs(direction[axis]) < 1e-12f) ? std::copysign(1e-12f, direction[axis]) : direction[axis];
+		inverse[axis]	= 1.0f / component;
+	}
+
+	//--- The slab method - the ray is inside the box between where it has entered all 3 slabs and left any of them
+	Query([&](const Node& node) {
+
+		glm::vec3 nearest	= (node.minimum - origin) * inverse;
+		glm::vec3 furthest	= (node.maximum - origin) * inverse;
+
+		glm::vec3 entry	= glm::min(nearest, furthest);
+		glm::vec3 exit	= glm::max(nearest, furthest);
+
+		float start	= std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+		float end	= std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+
+		return start <= end;
+	}, outObjects);
+}
+
+
+/*******************************************************************************************************************
+	Function that walks down the tree, skipping every branch whose box fails the test, and adds the object of every
+	leaf that passes it
+*******************************************************************************************************************/
+template <typename Test> void BoundingVolumeTree::Query(Test&& isTouching, std::vector<unsigned int>& outObjects) const
+{
+	outObjects.clear();
+
+	if (m_root == s_none) { return; }
+
+	//--- The tree is balanced, so the stack never gets much deeper than the tree's height
+	std::vector<int> nodes;
+	nodes.reserve(64);
+	nodes.push_back(m_root);
+
+	while (!nodes.empty()) {
+
+		const Node& node = m_nodes[nodes.back()];
+		nodes.pop_back();
+
+		if (!isTouching(node)) { continue; }
+
+		if (node.height == 0) { outObjects.push_back(node.object); }
+		else {
+			nodes.push_back(node.left);
+			nodes.push_back(node.right);
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds a place to put a leaf, and builds a branch there to hold the leaf and whatever was there before.
+	The leaf goes wherever the tree's surface area grows the least - each step down costs the growth of the box
+	stepped in to, and we stop when it's cheaper to pair the leaf with the whole branch than to go any further
+*******************************************************************************************************************/
+void BoundingVolumeTree::InsertLeaf(int leaf)
+{
+	if (m_root == s_none) {
+		m_root					= leaf;
+		m_nodes[leaf].parent	= s_none;
+		return;
+	}
+
+	glm::vec3 minimum = m_nodes[leaf].minimum;
+	glm::vec3 maximum = m_nodes[leaf].maximum;
+
+	int sibling = m_root;
+
+	while (m_nodes[sibling].height > 0) {
+
+		const Node& node = m_nodes[sibling];
+
+		float area			= GetSurfaceArea(node.minimum, node.maximum);
+		float combinedArea	= GetSurfaceArea(glm::min(node.minimum, minimum), glm::max(node.maximum, maximum));
+
+		//--- Pairing with this branch makes a new branch above it, and anything further down grows this one too
+		float cost			= 2.0f * combinedArea;
+		float inheritedCost	= 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.left, node.right };
+
+		for (int child = 0; child < 2; child++) {
+
+			const Node& current = m_nodes[children[child]];
+			float grownArea		= GetSurfaceArea(glm::min(current.minimum, minimum), glm::max(current.maximum, maximum));
+
+			childCosts[child] = inheritedCost + ((current.height == 0) ? grownArea : grownArea - GetSurfaceArea(current.minimum, current.maximum));
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1]) { break; }
+
+		sibling = (childCosts[0] < childCosts[1]) ? children[0] : children[1];
+	}
+
+	//--- The new branch takes the sibling's place, with the sibling and the leaf below it
+	int oldParent = m_nodes[sibling].parent;
+	int newParent = AllocateNode();
+
+	Node& branch	= m_nodes[newParent];
+	branch.parent	= oldParent;
+	branch.left		= sibling;
+	branch.right	= leaf;
+	branch.minimum	= glm::min(m_nodes[sibling].minimum, minimum);
+	branch.maximum	= glm::max(m_nodes[sibling].maximum, maximum);
+	branch.height	= m_nodes[sibling].height + 1;
+
+	if (oldParent == s_none)						{ m_root = newParent; }
+	else if (m_nodes[oldParent].left == sibling)	{ m_nodes[oldParent].left = newParent; }
+	else											{ m_nodes[oldParent].right = newParent; }
+
+	m_nodes[sibling].parent	= newParent;
+	m_nodes[leaf].parent	= newParent;
+
+	//--- Then rebalance and grow every branch above it
+	for (int node = newParent; node != s_none; node = m_nodes[node].parent) {
+		node = Balance(node);
+		Refit(node);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that takes a leaf out of the tree. Its parent branch goes too, and the leaf's sibling takes its place
+*******************************************************************************************************************/
+void BoundingVolumeTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_root) {
+		m_root = s_none;
+		return;
+	}
+
+	int parent		= m_nodes[leaf].parent;
+	int grandParent	= m_nodes[parent].parent;
+	int sibling		= (m_nodes[parent].left == leaf) ? m_nodes[parent].right : m_nodes[parent].left;
+
+	FreeNode(parent);
+
+	if (grandParent == s_none) {
+		m_root					= sibling;
+		m_nodes[sibling].parent	= s_none;
+		return;
+	}
+
+	if (m_nodes[grandParent].left == parent)	{ m_nodes[grandParent].left = sibling; }
+	else										{ m_nodes[grandParent].right = sibling; }
+
+	m_nodes[sibling].parent = grandParent;
+
+	//--- Then rebalance and shrink every branch above it
+	for (int node = grandParent; node != s_none; node = m_nodes[node].parent) {
+		node = Balance(node);
+		Refit(node);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that rotates a branch if one side of it is more than 1 level taller than the other (an AVL rotation).
+	The taller child takes the branch's place, and the branch takes the shorter of that child's own children.
+	Returns the node that is now in the branch's place
+*******************************************************************************************************************/
+int BoundingVolumeTree::Balance(int node)
+{
+	if (m_nodes[node].height < 2) { return node; }
+
+	int left	= m_nodes[node].left;
+	int right	= m_nodes[node].right;
+	int balance	= m_nodes[right].height - m_nodes[left].height;
+
+	if (balance >= -1 && balance <= 1) { return node; }
+
+	//--- The taller side is lifted up, and its shorter child is handed down to the branch
+	int lifted	= (balance > 1) ? right : left;
+	int first	= m_nodes[lifted].left;
+	int second	= m_nodes[lifted].right;
+	int kept	= (m_nodes[first].height > m_nodes[second].height) ? first : second;
+	int given	= (kept == first) ? second : first;
+
+	int parent = m_nodes[node].parent;
+
+	m_nodes[lifted].parent	= parent;
+	m_nodes[lifted].left	= node;
+	m_nodes[lifted].right	= kept;
+	m_nodes[node].parent	= lifted;
+	m_nodes[given].parent	= node;
+
+	if (balance > 1)	{ m_nodes[node].right = given; }
+	else				{ m_nodes[node].left = given; }
+
+	if (parent == s_none)					{ m_root = lifted; }
+	else if (m_nodes[parent].left == node)	{ m_nodes[parent].left = lifted; }
+	else									{ m_nodes[parent].right = lifted; }
+
+	Refit(node);
+	Refit(lifted);
+
+	return lifted;
+}
+
+
+/*******************************************************************************************************************
+	Function that works out a branch's box and height from its two children
+*******************************************************************************************************************/
+void BoundingVolumeTree::Refit(int node)
+{
+	Node& branch		= m_nodes[node];
+	const Node& left	= m_nodes[branch.left];
+	const Node& right	= m_nodes[branch.right];
+
+	branch.minimum	= glm::min(left.minimum, right.minimum);
+	branch.maximum	= glm::max(left.maximum, right.maximum);
+	branch.height	= std::max(left.height, right.height) + 1;
+}
+
+
+/*******************************************************************************************************************
+	Function that takes a node from the free list, or adds a new one if there are none
+*******************************************************************************************************************/
+int BoundingVolumeTree::AllocateNode()
+{
+	if (m_freeNodes == s_none) {
+		m_nodes.push_back(Node());
+		m_freeNodes					= (int)m_nodes.size() - 1;
+		m_nodes[m_freeNodes].parent	= s_none;
+	}
+
+	int node	= m_freeNodes;
+	m_freeNodes	= m_nodes[node].parent;
+
+	m_nodes[node].parent	= s_none;
+	m_nodes[node].left		= s_none;
+	m_nodes[node].right		= s_none;
+	m_nodes[node].height	= 0;
+	m_nodes[node].lastSide	= 0;
+	m_nodes[node].object	= 0;
+
+	return node;
+}
+
+
+/*******************************************************************************************************************
+	Function that puts a node back on the free list (the free list is linked through the parents)
+*******************************************************************************************************************/
+void BoundingVolumeTree::FreeNode(int node)
+{
+	m_nodes[node].parent	= m_freeNodes;
+	m_nodes[node].height	= -1;
+	m_freeNodes				= node;
+}
+
+
+/*******************************************************************************************************************
+	Function that returns half of a box's surface area (which is all that's needed to compare them)
+*******************************************************************************************************************/
+float BoundingVolumeTree::GetSurfaceArea(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+	glm::vec3 size = maximum - minimum;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+size_t BoundingVolumeTree::GetCount() const	{ return m_count; }
+int BoundingVolumeTree::GetHeight() const	{ return (m_root == s_none) ? 0 : m_nodes[m_root].height; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const int BoundingVolumeTree::s_none				= -1;
+const float BoundingVolumeTree::s_defaultMargin		= 0.5f;
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+/*******************************************************************************************************************
+	BoundingVolumeTree.h, BoundingVolumeTree.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A dynamic bounding volume hierarchy (a binary tree of boxes), for finding the objects in a scene that are in view,
+	touching a box or sphere, or along a ray, without checking every one of them.
+
+	[Features]
+	Objects can be added, moved and removed at any time - each one is a leaf of the tree, found again by the proxy
+	returned when it was inserted.
+	Leaves are a little bigger than the objects in them (the margin), so an object can move about a bit before the
+	tree needs to change. Only when an object leaves its box is it taken out and inserted again.
+	New leaves go wherever they add the least surface area to the tree, and the tree is rebalanced with rotations on
+	the way back up, so it stays shallow however objects are added (in a row, on a grid, etc.)
+	Queries walk down from the root and skip any branch that misses, so the cost follows how many objects are found
+	rather than how many are in the scene.
+	Frustum queries carry down which sides of the frustum each branch crosses, so a branch entirely inside it adds
+	everything below it without another test, and its children are only tested against the sides it crosses. Each
+	node remembers the side that last culled it, and tests that one first next time.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Objects are identified by an unsigned int passed in when they're inserted (an index in to a container, etc.)
+	Results come from the leaves' boxes, which are bigger than the objects - so query results are candidates that
+	might still need testing against the objects' own bounds (except for objects entirely inside a frustum).
+	A frustum query isn't const, as it updates the side each node remembers.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+
+class Frustum;
+
+class BoundingVolumeTree {
+
+private:
+	struct Node {
+		glm::vec3		minimum, maximum;
+		int				parent;
+		int				left, right;
+		int				height;
+		int				lastSide;
+		unsigned int	object;
+	};
+
+public:
+	BoundingVolumeTree(float margin = 0.0f);
+	~BoundingVolumeTree();
+
+public:
+	int Insert(const glm::vec3& minimum, const glm::vec3& maximum, unsigned int object);
+	bool Move(int proxy, const glm::vec3& minimum, const glm::vec3& maximum);
+	void Remove(int proxy);
+	void Clear();
+
+public:
+	void QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& outInside, std::vector<unsigned int>& outCrossing);
+	void QueryBox(const glm::vec3& minimum, const glm::vec3& maximum, std::vector<unsigned int>& outObjects) const;
+	void QuerySphere(const glm::vec3& centerPosition, float radius, std::vector<unsigned int>& outObjects) const;
+	void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<unsigned int>& outObjects) const;
+
+public:
+	size_t GetCount() const;
+	int GetHeight() const;
+
+private:
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void Refit(int node);
+
+private:
+	template <typename Test> void Query(Test&& isTouching, std::vector<unsigned int>& outObjects) const;
+
+private:
+	static float GetSurfaceArea(const glm::vec3& minimum, const glm::vec3& maximum);
+
+private:
+	std::vector<Node>	m_nodes;
+	int					m_root;
+	int					m_freeNodes;
+	size_t				m_count;
+	float				m_margin;
+
+private:
+	static const int	s_none;
+	static const float	s_defaultMargin;
+};
\ No newline at end of file
@@ -192,6 +192,21 @@ bool BufferCache::AddPackedBuffers(const std::string& tag, bool isIndexed)
 }
 
 
+/*******************************************************************************************************************
+	A function that removes a VAO, packed VBO and EBO from our buffer cache, deleting them from the GPU.
+	For buffers that only live for part of the game (streamed terrain tiles, for example)
+*******************************************************************************************************************/
+void BufferCache::RemovePackedBuffers(const std::string& tag)
+{
+	if (s_vaoBuffers.erase(tag) == 0) { return; }
+
+	s_vboPackedBuffers.erase(tag);
+	s_eboBuffers.erase(tag);
+
+	FL_LOG("[BUFFER CACHE] Buffers removed from buffer cache: ", tag.c_str(), LOG_RESOURCE);
+}
+
+
 /*******************************************************************************************************************
 	A function that returns a packed VBO already in memory or returns nullptr if not found
 *******************************************************************************************************************/
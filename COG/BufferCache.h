@@ -11,6 +11,7 @@
 	Adds all VAO, VBO and EBO's to a cache upon creation, allowing re-use of ID's.
 	Seperate cache for each buffer type - allowing generic use of buffers (vertex/index drawing).
 	Multiple VBO support (for standard layout types - position, uv's, normals, etc.)
+	Packed buffers can be removed again, for objects that come and go while the game is running.
 
 	[Upcoming]
 	Better error checking features.
@@ -45,6 +46,7 @@ public:
 	bool AddBuffers(const std::string& tag, bool isIndexed,
 					bool hasTextureCoords = false, bool hasNormals = false, bool hasTangentsAndBitangents = false);
 	bool AddPackedBuffers(const std::string& tag, bool isIndexed);
+	void RemovePackedBuffers(const std::string& tag);
 	bool AddUBO(GLsizeiptr byteSize, GLuint binding, bool dynamic);
 	bool AddFBO(const std::string& tag);
 	bool AddRBO(const std::string& tag);
@@ -0,0 +1,271 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+#include "CollisionGrid.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+CollisionGrid::CollisionGrid(float cellSize)
+	:	m_cells(s_minCellCount),
+		m_cellSize(cellSize)
+{
+	if (m_cellSize <= 0.0f) { m_cellSize = s_defaultCellSize; }
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+CollisionGrid::~CollisionGrid()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that adds a body to the grid, and returns the handle used to move or remove it later.
+	Its pairs are found on the next update
+*******************************************************************************************************************/
+int CollisionGrid::Insert(const glm::vec3& minimum, const glm::vec3& maximum, unsigned int object, bool isDynamic)
+{
+	int body;
+
+	if (m_freeBodies.empty()) {
+
+		//--- Keep at least 2 cells in the table for every body, so few cells ever hash to the same place
+		if ((m_bodies.size() + 1) * 2 > m_cells.size()) { Rehash(m_cells.size() * 2); }
+
+		body = (int)m_bodies.size();
+		m_bodies.push_back(Body());
+	}
+	else {
+		body = m_freeBodies.back();
+		m_freeBodies.pop_back();
+	}
+
+	m_bodies[body].object		= object;
+	m_bodies[body].isDynamic	= isDynamic;
+	m_bodies[body].isMoved		= true;
+
+	SetBox(m_bodies[body], minimum, maximum);
+	AddToCells(body);
+
+	m_movedBodies.push_back(body);
+
+	return body;
+}
+
+
+/*******************************************************************************************************************
+	Function that updates a body's box. Nothing happens if the box hasn't changed, otherwise its pairs are tested
+	again on the next update (and it changes cells, if it now covers different ones)
+*******************************************************************************************************************/
+void CollisionGrid::Move(int body, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+	Body& current = m_bodies[body];
+
+	if (current.minimum[0] == minimum.x && current.minimum[1] == minimum.y && current.minimum[2] == minimum.z &&
+		current.maximum[0] == maximum.x && current.maximum[1] == maximum.y && current.maximum[2] == maximum.z) { return; }
+
+	Body moved = current;
+	SetBox(moved, minimum, maximum);
+
+	if (moved.firstX != current.firstX || moved.firstZ != current.firstZ || moved.lastX != current.lastX || moved.lastZ != current.lastZ) {
+		RemoveFromCells(body);
+		m_bodies[body] = moved;
+		AddToCells(body);
+	}
+	else { m_bodies[body] = moved; }
+
+	if (!m_bodies[body].isMoved) {
+		m_bodies[body].isMoved = true;
+		m_movedBodies.push_back(body);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that takes a body out of the grid, along with all of its pairs. The handle can't be used again afterwards
+*******************************************************************************************************************/
+void CollisionGrid::Remove(int body)
+{
+	RemoveFromCells(body);
+
+	m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(), [body](const Pair& pair) { return pair.first == body || pair.second == body; }), m_pairs.end());
+
+	if (m_bodies[body].isMoved) {
+		m_movedBodies.erase(std::find(m_movedBodies.begin(), m_movedBodies.end(), body));
+		m_bodies[body].isMoved = false;
+	}
+
+	m_freeBodies.push_back(body);
+}
+
+
+/*******************************************************************************************************************
+	Function that brings the pairs up to date with the bodies that have moved (or been inserted) since the last update.
+	Their old pairs are dropped, the bodies sharing a cell with them become candidates, and the candidates' boxes are
+	tested in one batch - with every one that overlaps added to the pairs
+*******************************************************************************************************************/
+void CollisionGrid::Update()
+{
+	if (m_movedBodies.empty()) { return; }
+
+	m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(), [this](const Pair& pair) {
+		return m_bodies[pair.first].isMoved || m_bodies[pair.second].isMoved;
+	}), m_pairs.end());
+
+	m_candidates.clear();
+
+	for (int body : m_movedBodies) { FindCandidates(body); }
+
+	//--- Room for every candidate, then trimmed down to the ones that overlap
+	size_t pairCount = m_pairs.size();
+	m_pairs.resize(pairCount + m_candidates.size());
+
+	for (const Pair& candidate : m_candidates) {
+
+		const Body& first	= m_bodies[candidate.first];
+		const Body& second	= m_bodies[candidate.second];
+
+		//--- Each box's 4th lane is 0, so it always passes and only x, y and z decide
+		__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(first.minimum), _mm_loadu_ps(second.maximum)),
+									_mm_cmple_ps(_mm_loadu_ps(second.minimum), _mm_loadu_ps(first.maximum)));
+
+		m_pairs[pairCount] = candidate;
+		pairCount += (_mm_movemask_ps(overlap) == 0xF);
+	}
+
+	m_pairs.resize(pairCount);
+
+	for (int body : m_movedBodies) { m_bodies[body].isMoved = false; }
+	m_movedBodies.clear();
+}
+
+
+/*******************************************************************************************************************
+	Function that adds every body sharing a cell with a moved body to the candidates
+*******************************************************************************************************************/
+void CollisionGrid::FindCandidates(int body)
+{
+	const Body& moved = m_bodies[body];
+
+	for (int z = moved.firstZ; z <= moved.lastZ; z++) {
+		for (int x = moved.firstX; x <= moved.lastX; x++) {
+
+			for (int other : m_cells[GetCell(x, z)]) {
+
+				const Body& current = m_bodies[other];
+
+				//--- Skip itself, and two moved bodies are only paired once (by the first of them)
+				if (other == body || (current.isMoved && other < body)) { continue; }
+
+				if (!moved.isDynamic && !current.isDynamic) { continue; }
+
+				//--- Other cells can hash to the same place, so make sure it really is in this one - and only pair them
+				//--- in the first cell they share
+				if (x < current.firstX || x > current.lastX || z < current.firstZ || z > current.lastZ) { continue; }
+				if (x != std::max(moved.firstX, current.firstX) || z != std::max(moved.firstZ, current.firstZ)) { continue; }
+
+				m_candidates.push_back(Pair{ body, other });
+			}
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that sets a body's box, and the range of cells it covers
+*******************************************************************************************************************/
+void CollisionGrid::SetBox(Body& body, const glm::vec3& minimum, const glm::vec3& maximum) const
+{
+	body.minimum[0] = minimum.x; body.minimum[1] = minimum.y; body.minimum[2] = minimum.z; body.minimum[3] = 0.0f;
+	body.maximum[0] = maximum.x; body.maximum[1] = maximum.y; body.maximum[2] = maximum.z; body.maximum[3] = 0.0f;
+
+	body.firstX	= (int)std::floor(minimum.x / m_cellSize);
+	body.firstZ	= (int)std::floor(minimum.z / m_cellSize);
+	body.lastX	= (int)std::floor(maximum.x / m_cellSize);
+	body.lastZ	= (int)std::floor(maximum.z / m_cellSize);
+}
+
+
+/*******************************************************************************************************************
+	Function that lists a body in every cell its box covers
+*******************************************************************************************************************/
+void CollisionGrid::AddToCells(int body)
+{
+	const Body& current = m_bodies[body];
+
+	for (int z = current.firstZ; z <= current.lastZ; z++) {
+		for (int x = current.firstX; x <= current.lastX; x++) {
+
+			std::vector<int>& cell = m_cells[GetCell(x, z)];
+
+			//--- Two of its cells can hash to the same place, but it's only listed there once (so only paired once)
+			if (std::find(cell.begin(), cell.end(), body) == cell.end()) { cell.push_back(body); }
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that takes a body out of every cell its box covers
+*******************************************************************************************************************/
+void CollisionGrid::RemoveFromCells(int body)
+{
+	const Body& current = m_bodies[body];
+
+	for (int z = current.firstZ; z <= current.lastZ; z++) {
+		for (int x = current.firstX; x <= current.lastX; x++) {
+
+			std::vector<int>& cell = m_cells[GetCell(x, z)];
+
+			//--- Order doesn't matter within a cell, so swap it with the last body rather than shifting the rest down
+			auto found = std::find(cell.begin(), cell.end(), body);
+			if (found != cell.end()) { *found = cell.back(); cell.pop_back(); }
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that resizes the table of cells (always a power of 2), and lists every body again
+*******************************************************************************************************************/
+void CollisionGrid::Rehash(size_t cellCount)
+{
+	for (auto& cell : m_cells) { cell.clear(); }
+	m_cells.resize(cellCount);
+
+	//--- Free bodies aren't in any cells, so they're found first and skipped
+	std::vector<char> isFree(m_bodies.size(), 0);
+	for (int body : m_freeBodies) { isFree[body] = 1; }
+
+	for (int body = 0; body < (int)m_bodies.size(); body++) {
+		if (!isFree[body]) { AddToCells(body); }
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that hashes a cell's position in to the table of cells
+*******************************************************************************************************************/
+unsigned int CollisionGrid::GetCell(int x, int z) const
+{
+	return ((unsigned int)x * 73856093u ^ (unsigned int)z * 19349663u) & (unsigned int)(m_cells.size() - 1);
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const std::vector<CollisionGrid::Pair>& CollisionGrid::GetPairs() const	{ return m_pairs; }
+unsigned int CollisionGrid::GetBodyObject(int body) const				{ return m_bodies[body].object; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const size_t CollisionGrid::s_minCellCount		= 4096;
+const float CollisionGrid::s_defaultCellSize		= 8.0f;
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+/*******************************************************************************************************************
+	CollisionGrid.h, CollisionGrid.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A uniform grid broad phase, for finding which bodies' bounding boxes are touching without testing every body
+	against every other.
+
+	[Features]
+	The ground is split in to square cells (in x and z), and each body is listed in every cell its box covers. Only
+	bodies sharing a cell are ever tested against each other.
+	Cells are hashed in to a table, so the grid has no edges and needs no memory for empty ground. The table grows
+	with the number of bodies, so each place in it is shared by very few.
+	Pairs are kept from one update to the next - only the pairs of bodies that have moved since are tested again, so
+	a scene that is mostly still costs almost nothing.
+	A body only changes cells when its box covers different ones, and a pair sharing more than one cell is only found
+	in the first of them, so no pair is ever tested twice.
+	Static bodies are never paired with each other, only with dynamic ones.
+	The boxes of every candidate pair are tested in one batch, with all 3 axes of a pair compared at once (SSE2).
+
+	[Upcoming]
+	Pairs that have just started or stopped touching, for collision events.
+
+	[Side Notes]
+	Bodies are identified by the handle returned when they're inserted, and carry an unsigned int of their own (an
+	index in to a container, etc.) which can be found from the handle with GetBodyObject.
+	The cell size should be a bit bigger than most of the bodies - too small and every body is in lots of cells, too
+	big and lots of bodies share each one.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+
+class CollisionGrid {
+
+public:
+	struct Pair {
+		int first, second;
+	};
+
+private:
+	struct Body {
+		float			minimum[4];
+		float			maximum[4];
+		int				firstX, firstZ;
+		int				lastX, lastZ;
+		unsigned int	object;
+		bool			isDynamic;
+		bool			isMoved;
+	};
+
+public:
+	CollisionGrid(float cellSize = 0.0f);
+	~CollisionGrid();
+
+public:
+	int Insert(const glm::vec3& minimum, const glm::vec3& maximum, unsigned int object, bool isDynamic);
+	void Move(int body, const glm::vec3& minimum, const glm::vec3& maximum);
+	void Remove(int body);
+	void Update();
+
+public:
+	const std::vector<Pair>& GetPairs() const;
+	unsigned int GetBodyObject(int body) const;
+
+private:
+	void SetBox(Body& body, const glm::vec3& minimum, const glm::vec3& maximum) const;
+	void AddToCells(int body);
+	void RemoveFromCells(int body);
+	void FindCandidates(int body);
+	void Rehash(size_t cellCount);
+	unsigned int GetCell(int x, int z) const;
+
+private:
+	std::vector<Body>				m_bodies;
+	std::vector<int>				m_freeBodies;
+	std::vector<int>				m_movedBodies;
+	std::vector<std::vector<int>>	m_cells;
+	std::vector<Pair>				m_candidates;
+	std::vector<Pair>				m_pairs;
+	float							m_cellSize;
+
+private:
+	static const size_t				s_minCellCount;
+	static const float				s_defaultCellSize;
+};
\ No newline at end of file
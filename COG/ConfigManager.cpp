@@ -0,0 +1,500 @@
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "ConfigManager.h"
+#include "FileManager.h"
+#include "Tools.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+ConfigFile::ConfigFile()
+	:	m_header(nullptr),
+		m_objects(nullptr),
+		m_properties(nullptr),
+		m_objectSlots(nullptr),
+		m_keySlots(nullptr),
+		m_strings(nullptr)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+ConfigFile::~ConfigFile()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Maps the compiled copy of a config file, compiling it first if it is missing or out of date
+*******************************************************************************************************************/
+bool ConfigFile::Load(const std::string& fileLocation)
+{
+	std::string compiledLocation = fileLocation + ".cogcfg";
+
+	if (Open(compiledLocation, fileLocation)) { return true; }
+
+	std::vector<char> image;
+
+	if (!Compile(fileLocation, image)) { return false; }
+
+	if (Write(compiledLocation, image) && Open(compiledLocation, fileLocation)) { return true; }
+
+	//--- We couldn't write the compiled file, so use the compiled data straight from memory
+	m_image.swap(image);
+
+	return Attach(m_image.data(), m_image.size());
+}
+
+
+/*******************************************************************************************************************
+	Maps a compiled config file and checks that it is valid and up to date with the text file it was compiled from
+*******************************************************************************************************************/
+bool ConfigFile::Open(const std::string& fileLocation, const std::string& sourceLocation)
+{
+	//--- A missing compiled file isn't an error, the config file just hasn't been compiled yet
+	if (!VirtualFile::Exists(fileLocation)) { return false; }
+
+	if (!m_file.Open(fileLocation)) { return false; }
+
+	if (!Attach(m_file.GetData(), m_file.GetSize())) {
+		FL_LOG("[CONFIG] Compiled config is not a valid .cogcfg (or is an old version): ", fileLocation.c_str(), LOG_WARN);
+		m_file.Close();
+		return false;
+	}
+
+	//--- If the text file has been changed since we compiled it, the compiled data is out of date.
+	//--- If there's no text file at all, the compiled file is all we have, so use it
+	unsigned long long sourceHash = 0;
+
+	if (VirtualFile::GenerateHash(sourceLocation, sourceHash) && sourceHash != m_header->sourceHash) {
+		FL_LOG("[CONFIG] Compiled config is out of date: ", fileLocation.c_str(), LOG_MESSAGE);
+		m_header = nullptr;
+		m_file.Close();
+		return false;
+	}
+
+	FL_LOG("[CONFIG] Compiled config mapped, objects found: ", m_header->objectCount, LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Checks that a compiled image is valid and points the tables at it. Nothing is copied
+*******************************************************************************************************************/
+bool ConfigFile::Attach(const char* data, size_t size)
+{
+	m_header = nullptr;
+
+	const Header* header = (const Header*)data;
+
+	if (size < sizeof(Header) || memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 || header->version != s_version) { return false; }
+
+	//--- Make sure the image actually contains all of the data the header says it does
+	auto fits = [size](unsigned int offset, unsigned long long bytes) { return offset + bytes <= size; };
+
+	if (!fits(header->objectOffset, (unsigned long long)header->objectCount * sizeof(Object)) ||
+		!fits(header->propertyOffset, (unsigned long long)header->propertyCount * sizeof(Property)) ||
+		!fits(header->objectSlotOffset, (unsigned long long)header->objectSlotCount * sizeof(unsigned int)) ||
+		!fits(header->keySlotOffset, (unsigned long long)header->keySlotCount * sizeof(unsigned int)) ||
+		!fits(header->stringOffset, header->stringSize)) { return false; }
+
+	//--- The hash tables are looked up with a mask, and every string has to end inside the string block
+	if (header->objectSlotCount == 0 || (header->objectSlotCount & (header->objectSlotCount - 1)) != 0 ||
+		header->keySlotCount == 0 || (header->keySlotCount & (header->keySlotCount - 1)) != 0 ||
+		header->stringSize == 0 || data[header->stringOffset + header->stringSize - 1] != '\0') { return false; }
+
+	const Object* objects			= (const Object*)(data + header->objectOffset);
+	const Property* properties		= (const Property*)(data + header->propertyOffset);
+	const unsigned int* objectSlots	= (const unsigned int*)(data + header->objectSlotOffset);
+	const unsigned int* keySlots	= (const unsigned int*)(data + header->keySlotOffset);
+
+	for (unsigned int object = 0; object < header->objectCount; object++) {
+		if (objects[object].tag >= header->stringSize ||
+			(unsigned long long)objects[object].first + objects[object].count > header->propertyCount) { return false; }
+	}
+
+	for (unsigned int property = 0; property < header->propertyCount; property++) {
+		if (properties[property].key >= header->stringSize || properties[property].value >= header->stringSize) { return false; }
+	}
+
+	//--- Slots hold an index (or a string offset) plus one, so that zero can mean an empty slot
+	for (unsigned int slot = 0; slot < header->objectSlotCount; slot++) {
+		if (objectSlots[slot] > header->objectCount) { return false; }
+	}
+
+	for (unsigned int slot = 0; slot < header->keySlotCount; slot++) {
+		if (keySlots[slot] > header->stringSize) { return false; }
+	}
+
+	m_header		= header;
+	m_objects		= objects;
+	m_properties	= properties;
+	m_objectSlots	= objectSlots;
+	m_keySlots		= keySlots;
+	m_strings		= data + header->stringOffset;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Parses every object in a text config file in one pass and lays them out as a compiled image
+*******************************************************************************************************************/
+bool ConfigFile::Compile(const std::string& sourceLocation, std::vector<char>& outImage)
+{
+	using namespace file_constants;
+
+	Header header = {};
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.version = s_version;
+
+	VirtualFile file;
+
+	if (!file.Open(sourceLocation)) { return false; }
+
+	//--- Stamp the compiled file with the exact bytes it's compiled from, wherever they were read from
+	header.sourceHash = file.GenerateHash();
+
+	const char* cursor	= file.GetData();
+	const char* end		= cursor + file.GetSize();
+
+	std::string strings(1, '\0');
+	std::unordered_map<std::string, unsigned int> stringOffsets = { { std::string(), 0 } };
+	std::unordered_map<std::string, unsigned int> tags;
+	std::vector<Object> objects;
+	std::vector<Property> properties;
+
+	//--- Every string is stored once, with a null terminator, and referred to by its offset in the string block
+	auto intern = [&](const std::string& text) {
+		auto string = stringOffsets.try_emplace(text, (unsigned int)strings.size());
+		if (string.second) { strings.append(text.c_str(), text.size() + 1); }
+		return string.first->second;
+	};
+
+	std::string tag, line;
+	bool isInObject	= false;
+	Object object	= { 0, 0, 0 };
+
+	//--- Objects are only added once their END line has been found (or the file has ended)
+	auto finishObject = [&]() {
+		if (isInObject) { tags.emplace(tag, (unsigned int)objects.size()); objects.push_back(object); }
+		isInObject = false;
+	};
+
+	while (cursor < end) {
+
+		const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+		if (!lineEnd) { lineEnd = end; }
+
+		line.assign(cursor, lineEnd);
+		cursor = lineEnd + 1;
+
+		if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+
+		if (line.compare(0, TYPE_BEGIN.size(), TYPE_BEGIN) == 0) {
+
+			finishObject();
+
+			tag = (line.size() > TYPE_BEGIN_OFFSET) ? line.substr(TYPE_BEGIN_OFFSET) : std::string();
+
+			//--- Only the first object with this tag is used, so don't store the properties of any others
+			isInObject	= (tags.find(tag) == tags.end());
+			object		= { intern(tag), (unsigned int)properties.size(), 0 };
+		}
+		else if (line.compare(0, TYPE_END.size(), TYPE_END) == 0) { finishObject(); }
+		else if (isInObject) {
+
+			if (line.compare(0, LINE_BREAK.size(), LINE_BREAK) == 0) { continue; }
+
+			size_t divider = line.find(DIVIDER);
+			if (divider == std::string::npos) { continue; }
+
+			std::string key		= line.substr(0, divider);
+			std::string value	= line.substr(divider + DIVIDER_OFFSET);
+
+			key.erase(std::remove(key.begin(), key.end(), '\t'), key.end());
+			value.erase(std::remove(value.begin(), value.end(), '\t'), value.end());
+
+			Property property = { intern(key), intern(value), StringToFloat(value), StringToInteger(value) };
+
+			//--- The first value of a repeated key wins
+			auto first	= properties.begin() + object.first;
+			auto last	= properties.end();
+
+			if (std::none_of(first, last, [&property](const Property& other) { return other.key == property.key; })) {
+				properties.push_back(property);
+				object.count++;
+			}
+		}
+	}
+
+	finishObject();
+
+	//--- Open addressing hash tables, at most half full so that probes stay short
+	auto slotCount = [](size_t count) { unsigned int slots = 1; while (slots < count * 2) { slots <<= 1; } return slots; };
+
+	std::vector<unsigned int> objectSlots(slotCount(objects.size()), 0);
+	std::vector<unsigned int> keySlots(slotCount(properties.size()), 0);
+
+	auto insert = [&strings](std::vector<unsigned int>& slots, unsigned int stringOffset, unsigned int value) {
+		const char* text	= strings.c_str() + stringOffset;
+		unsigned int mask	= (unsigned int)slots.size() - 1;
+		unsigned int slot	= Hash(text, strlen(text)) & mask;
+		while (slots[slot]) { slot = (slot + 1) & mask; }
+		slots[slot] = value;
+	};
+
+	for (unsigned int index = 0; index < objects.size(); index++) { insert(objectSlots, objects[index].tag, index + 1); }
+
+	//--- Only key names go in the key table, not every value string
+	std::vector<unsigned int> keys;
+	for (const Property& property : properties) { keys.push_back(property.key); }
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	for (unsigned int key : keys) { insert(keySlots, key, key + 1); }
+
+	//--- Every table holds 4 byte values, so laying them out back to back keeps them all aligned
+	static_assert(sizeof(Header) == 56, "ConfigFile::Header must be tightly packed");
+	static_assert(sizeof(Object) == 12 && sizeof(Property) == 16, "ConfigFile records must be tightly packed");
+
+	header.objectCount		= (unsigned int)objects.size();
+	header.objectOffset		= sizeof(Header);
+	header.propertyCount	= (unsigned int)properties.size();
+	header.propertyOffset	= header.objectOffset + header.objectCount * sizeof(Object);
+	header.objectSlotCount	= (unsigned int)objectSlots.size();
+	header.objectSlotOffset	= header.propertyOffset + header.propertyCount * sizeof(Property);
+	header.keySlotCount		= (unsigned int)keySlots.size();
+	header.keySlotOffset	= header.objectSlotOffset + header.objectSlotCount * sizeof(unsigned int);
+	header.stringSize		= (unsigned int)strings.size();
+	header.stringOffset		= header.keySlotOffset + header.keySlotCount * sizeof(unsigned int);
+
+	outImage.resize(header.stringOffset + header.stringSize);
+
+	auto copy = [&outImage](unsigned int offset, const void* data, size_t bytes) { if (bytes) { memcpy(&outImage[offset], data, bytes); } };
+
+	copy(0, &header, sizeof(Header));
+	copy(header.objectOffset, objects.data(), objects.size() * sizeof(Object));
+	copy(header.propertyOffset, properties.data(), properties.size() * sizeof(Property));
+	copy(header.objectSlotOffset, objectSlots.data(), objectSlots.size() * sizeof(unsigned int));
+	copy(header.keySlotOffset, keySlots.data(), keySlots.size() * sizeof(unsigned int));
+	copy(header.stringOffset, strings.data(), strings.size());
+
+	FL_LOG("[CONFIG] Config file compiled, objects found: ", objects.size(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Writes a compiled image to a .cogcfg file.
+	The image is written to a temporary file first and then moved in to place, so a crash or a full disk
+	can never leave a half written .cogcfg behind
+*******************************************************************************************************************/
+bool ConfigFile::Write(const std::string& fileLocation, const std::vector<char>& image)
+{
+	std::string temporaryLocation = fileLocation + ".tmp";
+
+	HANDLE file = CreateFile(temporaryLocation.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) { FL_LOG("[CONFIG] Could not create compiled config: ", fileLocation.c_str(), LOG_WARN); return false; }
+
+	DWORD written = 0;
+
+	bool success = WriteFile(file, image.data(), (DWORD)image.size(), &written, nullptr) && written == image.size();
+
+	CloseHandle(file);
+
+	if (!success || !MoveFileEx(temporaryLocation.c_str(), fileLocation.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		FL_LOG("[CONFIG] Could not write compiled config: ", fileLocation.c_str(), LOG_WARN);
+		DeleteFile(temporaryLocation.c_str());
+		return false;
+	}
+
+	FL_LOG("[CONFIG] Compiled config written: ", fileLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that finds an object by its tag, returning nullptr if there's no such object
+*******************************************************************************************************************/
+const ConfigFile::Object* ConfigFile::FindObject(const std::string& tag) const
+{
+	if (!m_header) { return nullptr; }
+
+	unsigned int mask = m_header->objectSlotCount - 1;
+
+	for (unsigned int slot = Hash(tag.c_str(), tag.size()) & mask, probe = 0; probe <= mask; slot = (slot + 1) & mask, probe++) {
+
+		if (!m_objectSlots[slot]) { return nullptr; }
+
+		const Object& object = m_objects[m_objectSlots[slot] - 1];
+		if (tag == m_strings + object.tag) { return &object; }
+	}
+
+	return nullptr;
+}
+
+
+/*******************************************************************************************************************
+	Function that finds a property of an object, returning nullptr if the object doesn't have it
+*******************************************************************************************************************/
+const ConfigFile::Property* ConfigFile::FindProperty(const Object& object, const std::string& key) const
+{
+	if (!m_header) { return nullptr; }
+
+	//--- A key that isn't stored anywhere in the file can't belong to this object
+	unsigned int mask	= m_header->keySlotCount - 1;
+	unsigned int id		= 0;
+
+	for (unsigned int slot = Hash(key.c_str(), key.size()) & mask, probe = 0; probe <= mask; slot = (slot + 1) & mask, probe++) {
+
+		if (!m_keySlots[slot]) { return nullptr; }
+		if (key == m_strings + m_keySlots[slot] - 1) { id = m_keySlots[slot]; break; }
+	}
+
+	if (!id) { return nullptr; }
+
+	for (unsigned int property = object.first; property < object.first + object.count; property++) {
+		if (m_properties[property].key == id - 1) { return &m_properties[property]; }
+	}
+
+	return nullptr;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const char* ConfigFile::GetString(unsigned int offset) const { return m_strings + offset; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const char ConfigFile::s_magic[4]			= { 'C', 'O', 'G', 'C' };
+const unsigned int ConfigFile::s_version	= 2;
+
+unsigned int ConfigFile::Hash(const char* text, size_t length)
+{
+	//--- FNV-1a, which is plenty for a few hundred short tags and key names
+	unsigned int hash = 2166136261u;
+
+	for (size_t character = 0; character < length; character++) { hash = (hash ^ (unsigned char)text[character]) * 16777619u; }
+
+	return hash;
+}
+
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+ConfigObject::ConfigObject()
+	:	m_file(nullptr),
+		m_object(nullptr)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+ConfigObject::ConfigObject(const ConfigFile* file, const ConfigFile::Object* object)
+	:	m_file(file),
+		m_object(object)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+bool ConfigObject::IsValid() const { return m_file && m_object; }
+
+const char* ConfigObject::GetString(const std::string& key) const
+{
+	const ConfigFile::Property* property = (IsValid()) ? m_file->FindProperty(*m_object, key) : nullptr;
+	return (property) ? m_file->GetString(property->value) : "";
+}
+
+float ConfigObject::GetFloat(const std::string& key) const
+{
+	const ConfigFile::Property* property = (IsValid()) ? m_file->FindProperty(*m_object, key) : nullptr;
+	return (property) ? property->number : 0.0f;
+}
+
+int ConfigObject::GetInteger(const std::string& key) const
+{
+	const ConfigFile::Property* property = (IsValid()) ? m_file->FindProperty(*m_object, key) : nullptr;
+	return (property) ? property->integer : 0;
+}
+
+bool ConfigObject::GetBool(const std::string& key) const { return GetInteger(key) != 0; }
+
+glm::vec2 ConfigObject::GetVector2(const std::string& key, const char* components) const
+{
+	return glm::vec2(GetFloat(key + '.' + components[0]), GetFloat(key + '.' + components[1]));
+}
+
+glm::vec3 ConfigObject::GetVector3(const std::string& key, const char* components) const
+{
+	return glm::vec3(GetFloat(key + '.' + components[0]), GetFloat(key + '.' + components[1]), GetFloat(key + '.' + components[2]));
+}
+
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+ConfigManager::ConfigManager()
+{
+	FL_LOG("[CONFIG MANAGER CONSTRUCT]", FL_LOG_EMPTY, LOG_BREAK);
+}
+
+
+/*******************************************************************************************************************
+	Finds an object in a config file, loading the file first if this is the first time it has been used
+*******************************************************************************************************************/
+ConfigObject ConfigManager::Find(const std::string& fileLocation, const std::string& tag)
+{
+	auto file = m_files.find(fileLocation);
+
+	if (file == m_files.end()) {
+
+		std::unique_ptr<ConfigFile> config = std::make_unique<ConfigFile>();
+
+		//--- Remember files that failed to load too, so we don't keep trying to open them
+		if (!config->Load(fileLocation)) { FL_LOG("[CONFIG] Could not load config file: ", fileLocation.c_str(), LOG_ERROR); }
+
+		file = m_files.emplace(fileLocation, std::move(config)).first;
+	}
+
+	const ConfigFile::Object* object = file->second->FindObject(tag);
+
+	if (!object) { FL_LOG("[CONFIG] Object not found in file: ", tag.c_str(), LOG_ERROR); }
+
+	return ConfigObject(file->second.get(), object);
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps every config file, so they will be loaded again the next time they are used
+*******************************************************************************************************************/
+void ConfigManager::Shutdown()
+{
+	m_files.clear();
+
+	FL_LOG("[CONFIG] Config files released", FL_LOG_EMPTY, LOG_MEMORY);
+}
\ No newline at end of file
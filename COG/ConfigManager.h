@@ -0,0 +1,163 @@
+#pragma once
+
+/*******************************************************************************************************************
+	ConfigManager.h, ConfigManager.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Singleton class that compiles .config files in to a binary format the first time they are used, and memory maps
+	the compiled file every time after that, so that any number of objects can be created from a file without
+	reading or parsing it again.
+
+	[Features]
+	The text file is compiled to a .cogcfg file next to it (gameObjects.config becomes gameObjects.config.cogcfg).
+	A .cogcfg holds a small header, a fixed-size record for every object and every property, two hash tables
+	(object tags and key names) and one block of null-terminated strings. Every key and value string is stored once,
+	however many objects use it, and each object's properties sit next to each other, so looking up an object by its
+	tag is a single hash lookup and looking up one of its properties is a short scan over string offsets.
+	Numbers are converted when the file is compiled, so the typed accessors (GetFloat, GetInteger, GetBool,
+	GetVector2, GetVector3) read them straight out of the mapped file with no string conversions.
+	The header stores a hash of the text file's bytes (read the same way, from a pack or from disk), so the text stays
+	the one source of truth - edit it and it is recompiled the next time it is used. If there's no text file at all, the compiled file is used on its own.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	The config file format is the same one FileManager::GetObjectData reads:
+
+	TYPE >> tag
+	key:	value
+	----------END----------
+
+	Only the first object with a given tag is kept, and only the first value of a repeated key, as before.
+	Missing objects and keys give empty strings and zeros, as before.
+	If the compiled file can't be written (a read only folder, for example) the compiled data is kept in memory instead.
+	Bump s_version whenever the compiled layout changes, so that older files are recompiled.
+
+*******************************************************************************************************************/
+#include <GLM.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+
+#include "VirtualFile.h"
+#include "Singleton.h"
+
+class ConfigFile {
+
+public:
+	struct Object {
+		unsigned int	tag;
+		unsigned int	first;
+		unsigned int	count;
+	};
+
+	struct Property {
+		unsigned int	key;
+		unsigned int	value;
+		float			number;
+		int				integer;
+	};
+
+private:
+	struct Header {
+		char				magic[4];
+		unsigned int		version;
+		unsigned long long	sourceHash;
+		unsigned int		objectCount;
+		unsigned int		objectOffset;
+		unsigned int		propertyCount;
+		unsigned int		propertyOffset;
+		unsigned int		objectSlotCount;
+		unsigned int		objectSlotOffset;
+		unsigned int		keySlotCount;
+		unsigned int		keySlotOffset;
+		unsigned int		stringSize;
+		unsigned int		stringOffset;
+	};
+
+public:
+	ConfigFile();
+	~ConfigFile();
+
+public:
+	bool Load(const std::string& fileLocation);
+
+public:
+	const Object*	FindObject(const std::string& tag) const;
+	const Property*	FindProperty(const Object& object, const std::string& key) const;
+	const char*		GetString(unsigned int offset) const;
+
+private:
+	ConfigFile(const ConfigFile&)				= delete;
+	ConfigFile& operator=(const ConfigFile&)	= delete;
+
+private:
+	bool Open(const std::string& fileLocation, const std::string& sourceLocation);
+	bool Attach(const char* data, size_t size);
+
+private:
+	static bool Compile(const std::string& sourceLocation, std::vector<char>& outImage);
+	static bool Write(const std::string& fileLocation, const std::vector<char>& image);
+	static unsigned int Hash(const char* text, size_t length);
+
+private:
+	VirtualFile			m_file;
+	std::vector<char>	m_image;
+	const Header*		m_header;
+	const Object*		m_objects;
+	const Property*		m_properties;
+	const unsigned int*	m_objectSlots;
+	const unsigned int*	m_keySlots;
+	const char*			m_strings;
+
+private:
+	static const char			s_magic[4];
+	static const unsigned int	s_version;
+};
+
+
+class ConfigObject {
+
+public:
+	ConfigObject();
+	ConfigObject(const ConfigFile* file, const ConfigFile::Object* object);
+
+public:
+	bool IsValid() const;
+
+public:
+	const char*			GetString(const std::string& key) const;
+	float				GetFloat(const std::string& key) const;
+	int					GetInteger(const std::string& key) const;
+	bool				GetBool(const std::string& key) const;
+	glm::vec2			GetVector2(const std::string& key, const char* components = "xy") const;
+	glm::vec3			GetVector3(const std::string& key, const char* components = "xyz") const;
+
+private:
+	const ConfigFile*			m_file;
+	const ConfigFile::Object*	m_object;
+};
+
+
+class ConfigManager {
+
+public:
+	friend class Singleton<ConfigManager>;
+
+public:
+	ConfigObject Find(const std::string& fileLocation, const std::string& tag);
+	void Shutdown();
+
+private:
+	ConfigManager();
+	ConfigManager(const ConfigManager&)				= delete;
+	ConfigManager& operator=(const ConfigManager&)	= delete;
+
+private:
+	std::map<std::string, std::unique_ptr<ConfigFile>> m_files;
+};
+
+typedef Singleton<ConfigManager> Config;
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "Entity.h"
 #include "EntityShader.h"
 #include "Tools.h"
-#include "FileManager.h"
+#include "ConfigManager.h"
+#include "Camera.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
@@ -49,7 +50,13 @@ void Entity::Render(Shader* shader)
 
 		if (EntityShader* entityShader = Downcast<EntityShader>(shader)) {
 
-			entityShader->SetInstanceData(&m_transform, &m_material);
+			entityShader->SetInstanceData(&m_transform, &m_material, m_model.GetDecodeMatrix());
+
+			//--- Pick the model's LOD based on how far it is from the camera
+			if (Camera* camera = shader->GetCamera()) {
+				const glm::vec3& scale = m_transform.GetScale();
+				m_model.SelectLod(glm::distance(camera->GetPosition(), m_transform.GetPosition()), std::max(scale.x, std::max(scale.y, scale.z)));
+			}
 
 			m_material.Bind();
 			m_model.Render();
@@ -64,27 +71,20 @@ void Entity::Render(Shader* shader)
 *******************************************************************************************************************/
 Entity* Entity::Create(const std::string& tag)
 {
-	File::Instance()->OpenForReading("Assets\\Files\\gameObjects.config");
-
-	std::map<std::string, std::map<std::string, std::string>> data;
-
-	File::Instance()->GetObjectData(tag, data);
-
-	glm::vec3 position	= glm::vec3(StringToFloat(data[tag]["transform.x"]), StringToFloat(data[tag]["transform.y"]), StringToFloat(data[tag]["transform.z"]));
-	glm::vec3 rotation	= glm::vec3(StringToFloat(data[tag]["rotation.x"]), StringToFloat(data[tag]["rotation.y"]), StringToFloat(data[tag]["rotation.z"]));
-	glm::vec3 scale		= glm::vec3(StringToFloat(data[tag]["scale.x"]), StringToFloat(data[tag]["scale.y"]), StringToFloat(data[tag]["scale.z"]));
+	ConfigObject data = Config::Instance()->Find("Assets\\Files\\gameObjects.config", tag);
 
-	bool hasCollisionResponse = StringToInteger(data[tag]["collision.response"]);
+	glm::vec3 position	= data.GetVector3("transform");
+	glm::vec3 rotation	= data.GetVector3("rotation");
+	glm::vec3 scale		= data.GetVector3("scale");
 
-	//--- NOTE
-	// This function was made for ease of use/quickness and is not optimized at all, so please ignore (I know it's ugly!)
-	// Later I plan on tidying up file handling and building a proper file parsing system (I never got round to this!)
-	//---
+	bool hasCollisionResponse	= data.GetBool("collision.response");
+	bool isCompact				= data.GetBool("model.compact");
+	bool isOccluder				= data.GetBool("model.occluder");
 
 	return new Entity(
-		data[tag]["tag"], Transform(position, rotation, scale),
-		Material(data[tag]["material.diffuse"], data[tag]["material.normal"], data[tag]["material.specular"], data[tag]["material.emissive"]),
-		Model(data[tag]["model"]), hasCollisionResponse);
+		data.GetString("tag"), Transform(position, rotation, scale),
+		Material(data.GetString("material.diffuse"), data.GetString("material.normal"), data.GetString("material.specular"), data.GetString("material.emissive")),
+		Model(data.GetString("model"), isCompact, isOccluder), hasCollisionResponse);
 }
 
 
@@ -84,12 +84,13 @@ void EntityShader::SetPermanentAttributes()
 
 
 /*******************************************************************************************************************
-	A function that set's all the per instance entity data within the shader (specific to this game)
+	A function that set's all the per instance entity data within the shader (specific to this game).
+	The decode matrix is only passed in for models with quantised positions (see VertexCompressor.h)
 *******************************************************************************************************************/
-void EntityShader::SetInstanceData(Transform* transform, Material* material)
+void EntityShader::SetInstanceData(Transform* transform, Material* material, const glm::mat4* decode)
 {
 	if (m_shaderCount != NULL) {
-		SetMatrixData(transform);
+		SetMatrixData(transform, decode);
 		SetMaterialData(material);
 	}
 }
@@ -98,7 +99,7 @@ void EntityShader::SetInstanceData(Transform* transform, Material* material)
 /*******************************************************************************************************************
 	A function that set's the matrix data within the shader (should only be done when a change happens)
 *******************************************************************************************************************/
-bool EntityShader::SetMatrixData(Transform* transform)
+bool EntityShader::SetMatrixData(Transform* transform, const glm::mat4* decode)
 {
 	if (!m_camera || !transform) { return false; }
 
@@ -109,6 +110,10 @@ bool EntityShader::SetMatrixData(Transform* transform)
 	glm::mat4 world			= transform->GetTransformationMatrix();
 	glm::mat4 intraWorld	= glm::transpose(glm::inverse(world));
 
+	//--- Quantised positions are scaled back in to model space by the world matrix. The decode matrix has the same
+	//--- scale on every axis, so the normal matrix is left as it is
+	if (decode) { world = world * (*decode); }
+
 	//--- Check if any data has changed and only update the old data if so
 	if (m_matrixData.projection != projection)	{ m_matrixData.projection = projection; hasChanged = true; }
 	if (m_matrixData.view != view)				{ m_matrixData.view = view; hasChanged = true; }
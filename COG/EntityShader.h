@@ -33,7 +33,7 @@ public:
 	virtual ~EntityShader();
 	
 public:
-	void SetInstanceData(Transform* transform, Material* material);
+	void SetInstanceData(Transform* transform, Material* material, const glm::mat4* decode = nullptr);
 	virtual bool SetLights(const std::vector<Light*>& lights) override;
 	virtual void DebugMode(bool enableDebugSettings) override;
 
@@ -42,7 +42,7 @@ private:
 	virtual void SetPermanentAttributes()	override;
 
 private:
-	bool SetMatrixData(Transform* transform);
+	bool SetMatrixData(Transform* transform, const glm::mat4* decode);
 	void SetFogData(int type, bool rangeBased, float density, const glm::vec4& color);
 	bool SetTextureData(Texture* texture);
 	bool SetMaterialData(Material* material);
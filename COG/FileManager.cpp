@@ -1,4 +1,5 @@
 #include "FileManager.h"
+#include "VirtualFile.h"
 #include "Log.h"
 #include <algorithm>
 #include <vector>
@@ -7,16 +8,87 @@
 	Constructor with initializer list to set default values of data members
 *******************************************************************************************************************/
 FileManager::FileManager()
+	:	m_stream(&m_file)
 {
 	FL_LOG("[FILE MANAGER CONSTRUCT]", FL_LOG_EMPTY, LOG_BREAK);
 }
 
 
+/*******************************************************************************************************************
+	Maps a pack file and adds it to the packs that files are read from. Packs mounted later take priority
+*******************************************************************************************************************/
+bool FileManager::Mount(const std::string& packLocation)
+{
+	std::unique_ptr<PackFile> pack = std::make_unique<PackFile>();
+
+	if (!pack->Open(packLocation)) { return false; }
+
+	m_packs.push_back(std::move(pack));
+
+	FL_LOG("[FILE] Pack mounted successfully: ", packLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps every pack, so files are only read from disk
+*******************************************************************************************************************/
+void FileManager::Unmount()
+{
+	m_packs.clear();
+
+	FL_LOG("[FILE] Packs unmounted", FL_LOG_EMPTY, LOG_MEMORY);
+}
+
+
+/*******************************************************************************************************************
+	Function that finds a file in the mounted packs, returning nullptr if it isn't in any of them
+*******************************************************************************************************************/
+const PackFile::Entry* FileManager::FindPacked(const std::string& fileLocation, const PackFile*& outPack) const
+{
+	for (auto pack = m_packs.rbegin(); pack != m_packs.rend(); pack++) {
+
+		const PackFile::Entry* entry = (*pack)->Find(fileLocation);
+
+		if (entry) { outPack = pack->get(); return entry; }
+	}
+
+	return nullptr;
+}
+
+
+/*******************************************************************************************************************
+	Reads a file from the mounted packs in to a string stream, so it can be read just like a file on disk
+*******************************************************************************************************************/
+bool FileManager::OpenPacked(const std::string& fileLocation)
+{
+	const PackFile* pack = nullptr;
+
+	if (!FindPacked(fileLocation, pack)) { return false; }
+
+	VirtualFile file;
+
+	if (!file.Open(fileLocation)) { return false; }
+
+	m_packedFile.clear();
+	m_packedFile.str(std::string(file.GetData(), file.GetSize()));
+	m_stream = &m_packedFile;
+
+	FL_LOG("[FILE] Packed file opened successfully: ", fileLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
 /*******************************************************************************************************************
 	Opens a text file for reading data only
 *******************************************************************************************************************/
 bool FileManager::OpenForReading(const std::string& fileLocation)
 {
+	if (OpenPacked(fileLocation)) { return true; }
+
+	m_stream = &m_file;
 	m_file.open(fileLocation.c_str(), std::ifstream::in);
 
 	if (!m_file.is_open())	{ FL_LOG("[FILE] File doesn't exist: ", fileLocation.c_str(), LOG_ERROR); return false; }
@@ -33,6 +105,9 @@ bool FileManager::OpenForReading(const std::string& fileLocation)
 *******************************************************************************************************************/
 bool FileManager::BinaryOpenForReading(const std::string& fileLocation)
 {
+	if (OpenPacked(fileLocation)) { return true; }
+
+	m_stream = &m_file;
 	m_file.open(fileLocation.c_str(), std::ifstream::in | std::ios::binary);
 
 	if (!m_file.is_open()) { FL_LOG("[FILE] File doesn't exist: ", fileLocation.c_str(), LOG_ERROR); return false; }
@@ -49,6 +124,7 @@ bool FileManager::BinaryOpenForReading(const std::string& fileLocation)
 *******************************************************************************************************************/
 bool FileManager::BinaryOpenForWriting(const std::string& fileLocation)
 {
+	m_stream = &m_file;
 	m_file.open(fileLocation.c_str(), std::ifstream::out | std::ios::binary);
 
 	if (!m_file.is_open()) { FL_LOG("[FILE] File doesn't exist: ", fileLocation.c_str(), LOG_ERROR); return false; }
@@ -66,6 +142,7 @@ bool FileManager::BinaryOpenForWriting(const std::string& fileLocation)
 void FileManager::Close(const std::string& fileLocation) {
 
 	m_file.close();
+	m_packedFile.str(std::string());
 
 	FL_LOG("[FILE] File closed successfully: ", fileLocation.c_str(), LOG_SUCCESS);
 }
@@ -74,7 +151,7 @@ void FileManager::Close(const std::string& fileLocation) {
 /*******************************************************************************************************************
 	Function that gets all the data from a file and stores it in to a string
 *******************************************************************************************************************/
-std::istream& FileManager::ExtractFileData() { return std::getline(m_file, m_fileData); }
+std::istream& FileManager::ExtractFileData() { return std::getline(*m_stream, m_fileData); }
 
 
 /*******************************************************************************************************************
@@ -95,7 +172,7 @@ std::string FileManager::CutFileData(int startPosition, int endPosition) {
 /*******************************************************************************************************************
 	Function that moves the file pointer from a starting position to an end position
 *******************************************************************************************************************/
-const std::istream& FileManager::Seek(int startPosition, int endPosition) { return m_file.seekg(startPosition, endPosition); }
+const std::istream& FileManager::Seek(int startPosition, int endPosition) { return m_stream->seekg(startPosition, endPosition); }
 
 
 /*******************************************************************************************************************
@@ -110,7 +187,7 @@ size_t FileManager::Find(const std::string &data) { return m_fileData.find(data)
 int FileManager::GetFileSize()
 {
 	Seek(0, std::ios_base::end);
-	int fileSize = (int)m_file.tellg();
+	int fileSize = (int)m_stream->tellg();
 	Seek(0, std::ios_base::beg);
 
 	return fileSize;
@@ -134,7 +211,7 @@ bool FileManager::GetObjectData(const std::string &objectName, std::map<std::str
 
 			if (objectName == fileObjectName) { objectFound = true; }
 		} 
-		else if (FileDataContains(TYPE_END) && objectFound) { m_file.close(); }
+		else if (FileDataContains(TYPE_END) && objectFound) { m_file.close(); m_packedFile.str(std::string()); }
 		else if (objectFound) { 
 			
 			if (FileDataContains(LINE_BREAK)) { continue; }
@@ -150,6 +227,7 @@ bool FileManager::GetObjectData(const std::string &objectName, std::map<std::str
 		else if (FileDataContains(END_OF_FILE) && !objectFound) {
 			FL_LOG("[FILE] Object not found in file: ", objectName.c_str(), LOG_ERROR);
 			m_file.close();
+			m_packedFile.str(std::string());
 			return false;
 		}
 	}
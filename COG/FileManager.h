@@ -3,16 +3,22 @@
 /*******************************************************************************************************************
 	FileManager.h, FileManager.cpp
 	Created by Kim Kane
-	Last updated: 04/01/2018
+	Last updated: 17/10/2026
 
 	*This class is still under construction.
 	Singleton class that creates an fstream object and reads in data from files.
+	It also holds the pack files (see PackFile.h) that are mounted, which every file that is read goes through first
+	(see VirtualFile.h). Files that aren't in a mounted pack are read from disk, as before.
 
 *******************************************************************************************************************/
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <memory>
 #include <map>
 
+#include "PackFile.h"
 #include "Singleton.h"
 
 namespace file_constants {
@@ -36,6 +42,11 @@ class FileManager {
 public:
 	friend class Singleton<FileManager>;
 
+public:
+	bool Mount(const std::string& packLocation);
+	void Unmount();
+	const PackFile::Entry* FindPacked(const std::string& fileLocation, const PackFile*& outPack) const;
+
 public:
 	bool OpenForReading(const std::string& fileLocation);
 	bool BinaryOpenForReading(const std::string& fileLocation);
@@ -60,8 +71,16 @@ private:
 	FileManager& operator=(const FileManager&)	= delete;
 
 private:
-	std::fstream	m_file;
-	std::string		m_fileData;
+	bool OpenPacked(const std::string& fileLocation);
+
+private:
+	std::fstream		m_file;
+	std::stringstream	m_packedFile;
+	std::iostream*		m_stream;
+	std::string			m_fileData;
+
+private:
+	std::vector<std::unique_ptr<PackFile>> m_packs;
 
 private:
 	std::map<std::string, std::map<std::string, std::string>> m_objectData;
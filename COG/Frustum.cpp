@@ -1,14 +1,68 @@
+#include <emmintrin.h>
+#include <cmath>
+#include <algorithm>
+
 #include "Frustum.h"
 
+/*******************************************************************************************************************
+	Function that reads 4 vec3s in a row (12 floats) and splits them in to their x, y and z components
+*******************************************************************************************************************/
+static inline void LoadVectors(const glm::vec3* vectors, __m128& outX, __m128& outY, __m128& outZ)
+{
+	const float* values = &vectors[0].x;
+
+	//--- x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+	__m128 first	= _mm_loadu_ps(values);
+	__m128 second	= _mm_loadu_ps(values + 4);
+	__m128 third	= _mm_loadu_ps(values + 8);
+
+	outX = _mm_shuffle_ps(_mm_shuffle_ps(first, first, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(second, third, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+	outY = _mm_shuffle_ps(_mm_shuffle_ps(first, second, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(second, third, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	outZ = _mm_shuffle_ps(_mm_shuffle_ps(first, second, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(third, third, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+
+/*******************************************************************************************************************
+	Function that works out how far a position is in front of 4 of the planes, starting at side
+*******************************************************************************************************************/
+static inline __m128 GetDistances(const float planes[4][8], int side, const glm::vec3& position)
+{
+	__m128 x = _mm_mul_ps(_mm_loadu_ps(&planes[0][side]), _mm_set1_ps(position.x));
+	__m128 y = _mm_mul_ps(_mm_loadu_ps(&planes[1][side]), _mm_set1_ps(position.y));
+	__m128 z = _mm_mul_ps(_mm_loadu_ps(&planes[2][side]), _mm_set1_ps(position.z));
+
+	return _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, _mm_loadu_ps(&planes[3][side])));
+}
+
+
+/*******************************************************************************************************************
+	Function that works out how far a box reaches towards 4 of the planes from its centre, starting at side
+*******************************************************************************************************************/
+static inline __m128 GetExtents(const float planes[4][8], int side, const glm::vec3& halfDimension)
+{
+	const __m128 SIGN = _mm_set1_ps(-0.0f);
+
+	__m128 x = _mm_mul_ps(_mm_andnot_ps(SIGN, _mm_loadu_ps(&planes[0][side])), _mm_set1_ps(halfDimension.x));
+	__m128 y = _mm_mul_ps(_mm_andnot_ps(SIGN, _mm_loadu_ps(&planes[1][side])), _mm_set1_ps(halfDimension.y));
+	__m128 z = _mm_mul_ps(_mm_andnot_ps(SIGN, _mm_loadu_ps(&planes[2][side])), _mm_set1_ps(halfDimension.z));
+
+	return _mm_add_ps(_mm_add_ps(x, y), z);
+}
+
+
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
 *******************************************************************************************************************/
 Frustum::Frustum(const glm::mat4& projection, const glm::mat4& view)
+	:	m_clip(0.0f),
+		m_planeTests(0)
 {
-	//--- Prepare our frustum and reserve memory when an instance is first created
-	m_frustum.resize(s_maxSides);
-	for (unsigned int side = 0; side < s_maxSides; side++) {
-		m_frustum[side].resize(s_maxPlaneContents);
+	//--- The spare sides face every way at once (a normal of zero) and sit in front of everything
+	for (int side = FRONT + 1; side < 8; side++) {
+		m_planes[A][side] = 0.0f;
+		m_planes[B][side] = 0.0f;
+		m_planes[C][side] = 0.0f;
+		m_planes[D][side] = 1.0f;
 	}
 
 	//--- Update frustum when an instance is first created, to set the startup clipping planes
@@ -26,25 +80,21 @@ Frustum::~Frustum()
 
 
 /*******************************************************************************************************************
-	A function which calculates a magnitude of a normal to a plane and then normalizes it
+	A function which calculates a magnitude of a normal to a plane and then normalizes it, before storing it
 *******************************************************************************************************************/
-void Frustum::NormalizePlane(std::vector <std::vector<float>>& frustum, SideType side) {
-	
+void Frustum::SetPlane(SideType side, float a, float b, float c, float d) {
+
 	//--- Here we calculate the magnitude of the normal to the plane (point A B C)
 	//--- Remember that (A, B, C) is that same thing as the normal's (X, Y, Z).
 	//--- To calculate magnitude you use the equation:  magnitude = sqrt( x^2 + y^2 + z^2)
-	float magnitude = (float)sqrt(
-		frustum[side][A] * frustum[side][A] +
-		frustum[side][B] * frustum[side][B] +
-		frustum[side][C] * frustum[side][C]
-	);
-	
+	float magnitude = (float)sqrt(a * a + b * b + c * c);
+
 	//--- Then we divide the plane's values by it's magnitude.
 	//--- This makes it easier to work with.
-	frustum[side][A] /= magnitude;
-	frustum[side][B] /= magnitude;
-	frustum[side][C] /= magnitude;
-	frustum[side][D] /= magnitude;
+	m_planes[A][side] = a / magnitude;
+	m_planes[B][side] = b / magnitude;
+	m_planes[C][side] = c / magnitude;
+	m_planes[D][side] = d / magnitude;
 }
 
 
@@ -56,235 +106,264 @@ void Frustum::Update(const glm::mat4& projection, const glm::mat4& view) {
 	//--- This will hold the clipping planes (sides of the frustum)
 	glm::mat4 clip = projection * view;
 
+	//--- A new frame, so start counting again - and if the camera hasn't moved, the planes haven't either
+	m_planeTests = 0;
+
+	if (clip == m_clip) { return; }
+
+	m_clip = clip;
+
 	//--- Now we actually want to get the sides of the frustum. To do this we take
 	//--- the clipping planes we received above and extract the sides from them.
+	//--- Each one is a normal (A, B, C) and a distance (D) to the plane, which we then normalize.
+	SetPlane(RIGHT,		clip[0][3] - clip[0][0], clip[1][3] - clip[1][0], clip[2][3] - clip[2][0], clip[3][3] - clip[3][0]);
+	SetPlane(LEFT,		clip[0][3] + clip[0][0], clip[1][3] + clip[1][0], clip[2][3] + clip[2][0], clip[3][3] + clip[3][0]);
+	SetPlane(BOTTOM,	clip[0][3] + clip[0][1], clip[1][3] + clip[1][1], clip[2][3] + clip[2][1], clip[3][3] + clip[3][1]);
+	SetPlane(TOP,		clip[0][3] - clip[0][1], clip[1][3] - clip[1][1], clip[2][3] - clip[2][1], clip[3][3] - clip[3][1]);
+	SetPlane(BACK,		clip[0][3] - clip[0][2], clip[1][3] - clip[1][2], clip[2][3] - clip[2][2], clip[3][3] - clip[3][2]);
+	SetPlane(FRONT,		clip[0][3] + clip[0][2], clip[1][3] + clip[1][2], clip[2][3] + clip[2][2], clip[3][3] + clip[3][2]);
+}
 
-	//--- This will extract the RIGHT side of the frustum
-	m_frustum[RIGHT][A] = clip[0][3] - clip[0][0];
-	m_frustum[RIGHT][B] = clip[1][3] - clip[1][0];
-	m_frustum[RIGHT][C] = clip[2][3] - clip[2][0];
-	m_frustum[RIGHT][D] = clip[3][3] - clip[3][0];
 
-	//--- Now that we have a normal (A, B, C) and a distance (D) to the plane,
-	//--- we want to normalize that normal and distance.
-	NormalizePlane(m_frustum, RIGHT);
+/*******************************************************************************************************************
+	A function which checks if a single point is inside the frustum
+*******************************************************************************************************************/
+bool Frustum::IsPointInside(const glm::vec3& position) const {
 
-	m_frustum[LEFT][A] = clip[0][3] + clip[0][0];
-	m_frustum[LEFT][B] = clip[1][3] + clip[1][0];
-	m_frustum[LEFT][C] = clip[2][3] + clip[2][0];
-	m_frustum[LEFT][D] = clip[3][3] + clip[3][0];
+	m_planeTests += FRONT + 1;
 
-	NormalizePlane(m_frustum, LEFT);
+	//--- Check all the sides, 4 at a time - if the point is behind any side, it ISN'T in the frustum
+	for (int side = 0; side < 8; side += 4) {
+		if (_mm_movemask_ps(_mm_cmple_ps(GetDistances(m_planes, side, position), _mm_setzero_ps()))) { return false; }
+	}
 
-	m_frustum[BOTTOM][A] = clip[0][3] + clip[0][1];
-	m_frustum[BOTTOM][B] = clip[1][3] + clip[1][1];
-	m_frustum[BOTTOM][C] = clip[2][3] + clip[2][1];
-	m_frustum[BOTTOM][D] = clip[3][3] + clip[3][1];
+	//--- The point was inside of the frustum (In front of ALL the sides of the frustum)
+	return true;
+}
 
-	NormalizePlane(m_frustum, BOTTOM);
 
-	m_frustum[TOP][A] = clip[0][3] - clip[0][1];
-	m_frustum[TOP][B] = clip[1][3] - clip[1][1];
-	m_frustum[TOP][C] = clip[2][3] - clip[2][1];
-	m_frustum[TOP][D] = clip[3][3] - clip[3][1];
+/*******************************************************************************************************************
+	A function which checks if a sphere is inside the frustum, giving its center position and radius
+*******************************************************************************************************************/
+bool Frustum::IsSphereInside(const glm::vec3& centerPosition, float radius) const {
 
-	NormalizePlane(m_frustum, TOP);
+	m_planeTests += FRONT + 1;
+
+	//--- If the center of the sphere is farther behind any side than the radius, the sphere is outside of the frustum
+	for (int side = 0; side < 8; side += 4) {
+		if (_mm_movemask_ps(_mm_cmple_ps(GetDistances(m_planes, side, centerPosition), _mm_set1_ps(-radius)))) { return false; }
+	}
 
-	m_frustum[BACK][A] = clip[0][3] - clip[0][2];
-	m_frustum[BACK][B] = clip[1][3] - clip[1][2];
-	m_frustum[BACK][C] = clip[2][3] - clip[2][2];
-	m_frustum[BACK][D] = clip[3][3] - clip[3][2];
+	//--- The sphere was inside of the frustum!
+	return true;
+}
 
-	NormalizePlane(m_frustum, BACK);
 
-	m_frustum[FRONT][A] = clip[0][3] + clip[0][2];
-	m_frustum[FRONT][B] = clip[1][3] + clip[1][2];
-	m_frustum[FRONT][C] = clip[2][3] + clip[2][2];
-	m_frustum[FRONT][D] = clip[3][3] + clip[3][2];
+/*******************************************************************************************************************
+	A function which checks if a cube is inside the frustum given its center position and length / 2.0
+*******************************************************************************************************************/
+bool Frustum::IsCubeInside(const glm::vec3& centerPosition, float halfDepth) const {
 
-	NormalizePlane(m_frustum, FRONT);
+	return IsRectangleInside(centerPosition, glm::vec3(halfDepth));
 }
 
 
 /*******************************************************************************************************************
-	A function which checks if a single point is inside the frustum
+	A function which checks if a rectangle is inside the frustum given its center position half dimension
 *******************************************************************************************************************/
-bool Frustum::IsPointInside(const glm::vec3& position) {
-
-	//--- Go through all the sides of the frustum
-	for (unsigned int side = 0; side < s_maxSides; side++) {
-		//--- Calculate the plane equation and check if the point is behind a side of the frustum
-		if (m_frustum[side][A] * position.x +
-			m_frustum[side][B] * position.y +
-			m_frustum[side][C] * position.z +
-			m_frustum[side][D] <= 0.0f) {
-			//--- The point was behind a side, so it ISN'T in the frustum
-			return false;
-		}
+bool Frustum::IsRectangleInside(const glm::vec3& centerPosition, const glm::vec3& halfDimension) const {
+
+	m_planeTests += FRONT + 1;
+
+	//--- Rectangles are the same as cubes only we take into acount the full dimension
+	//--- Due to the sides being un-equal; so equivelant to width, height and depth of a models
+	//--- bounding box / 2.0
+	//--- If even the corner furthest in front of a side is behind it, it isn't in the frustum
+	for (int side = 0; side < 8; side += 4) {
+
+		__m128 distance = _mm_add_ps(GetDistances(m_planes, side, centerPosition), GetExtents(m_planes, side, halfDimension));
+
+		if (_mm_movemask_ps(_mm_cmplt_ps(distance, _mm_setzero_ps()))) { return false; }
 	}
 
-	//--- The point was inside of the frustum (In front of ALL the sides of the frustum)
 	return true;
 }
 
 
 /*******************************************************************************************************************
-	A function which checks if a sphere is inside the frustum, giving its center position and radius
+	A function which culls count spheres at once, 4 at a time. The index of every sphere inside the frustum is written
+	to outInside (which needs room for count indices), in order, and the number of them is returned
 *******************************************************************************************************************/
-bool Frustum::IsSphereInside(const glm::vec3& centerPosition, float radius) {
-
-	//--- Go through all the sides of the frustum
-	for (unsigned int side = 0; side < s_maxSides; side++) {
-		//--- If the center of the sphere is farther away from the plane than the radius
-		if (m_frustum[side][A] * centerPosition.x +
-			m_frustum[side][B] * centerPosition.y +
-			m_frustum[side][C] * centerPosition.z +
-			m_frustum[side][D] <= -radius) {
-			//--- The distance was greater than the radius so the sphere is outside of the frustum
-			return false;
+size_t Frustum::CullSpheres(const glm::vec3* centerPositions, const float* radii, size_t count, unsigned int* outInside) const
+{
+	m_planeTests += count * (FRONT + 1);
+
+	//--- Every plane spread across all 4 lanes, ready for the loop
+	__m128 planes[FRONT + 1][D + 1];
+
+	for (int side = RIGHT; side <= FRONT; side++) {
+		for (int content = A; content <= D; content++) { planes[side][content] = _mm_set1_ps(m_planes[content][side]); }
+	}
+
+	size_t insideCount = 0;
+
+	for (size_t first = 0; first < count; first += 4) {
+
+		size_t remaining = std::min(count - first, (size_t)4);
+
+		//--- The last few are copied out so that nothing past the end of the arrays is read
+		glm::vec3 copiedCenters[4] = {};
+		float copiedRadii[4] = {};
+
+		const glm::vec3* center	= &centerPositions[first];
+		const float* radius		= &radii[first];
+
+		if (remaining < 4) {
+			std::copy(center, center + remaining, copiedCenters);
+			std::copy(radius, radius + remaining, copiedRadii);
+			center = copiedCenters;
+			radius = copiedRadii;
+		}
+
+		__m128 x, y, z;
+		LoadVectors(center, x, y, z);
+
+		__m128 negative	= _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius));
+		__m128 outside	= _mm_setzero_ps();
+
+		for (int side = RIGHT; side <= FRONT; side++) {
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[side][A], x), _mm_mul_ps(planes[side][B], y)),
+										 _mm_add_ps(_mm_mul_ps(planes[side][C], z), planes[side][D]));
+
+			outside = _mm_or_ps(outside, _mm_cmple_ps(distance, negative));
+		}
+
+		int inside = ~_mm_movemask_ps(outside);
+
+		//--- Every index is written, but the count only moves past the ones inside (no branches to mispredict)
+		for (unsigned int sphere = 0; sphere < remaining; sphere++) {
+			outInside[insideCount]	= (unsigned int)(first + sphere);
+			insideCount				+= (inside >> sphere) & 1;
 		}
 	}
 
-	//--- The sphere was inside of the frustum!
-	return true;
+	return insideCount;
 }
 
 
 /*******************************************************************************************************************
-	A function which checks if a cube is inside the frustum given its center position and length / 2.0
+	A function which culls count rectangles at once, 4 at a time. The index of every rectangle inside the frustum is
+	written to outInside (which needs room for count indices), in order, and the number of them is returned
 *******************************************************************************************************************/
-bool Frustum::IsCubeInside(const glm::vec3& centerPosition, float halfDepth) {
-	
-	//--- Extract the center position of the cube and half the length (depth(z axis) / 2.0)
-	//--- Then we check each point in the cube and seeing if it is inside the frustum.
-	//--- If a point is found in front of a side, then we skip to the next side.
-	//--- If we get to a plane that does NOT have a point in front of it, then it will return false.
-
-	for (unsigned int side = 0; side < s_maxSides; side++) {
-		if (m_frustum[side][A] * (centerPosition.x - halfDepth) +
-			m_frustum[side][B] * (centerPosition.y - halfDepth) +
-			m_frustum[side][C] * (centerPosition.z - halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDepth) +
-			m_frustum[side][B] * (centerPosition.y - halfDepth) +
-			m_frustum[side][C] * (centerPosition.z - halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDepth) +
-			m_frustum[side][B] * (centerPosition.y + halfDepth) +
-			m_frustum[side][C] * (centerPosition.z - halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDepth) +
-			m_frustum[side][B] * (centerPosition.y + halfDepth) +
-			m_frustum[side][C] * (centerPosition.z - halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDepth) +
-			m_frustum[side][B] * (centerPosition.y - halfDepth) +
-			m_frustum[side][C] * (centerPosition.z + halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDepth) +
-			m_frustum[side][B] * (centerPosition.y - halfDepth) +
-			m_frustum[side][C] * (centerPosition.z + halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDepth) +
-			m_frustum[side][B] * (centerPosition.y + halfDepth) +
-			m_frustum[side][C] * (centerPosition.z + halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDepth) +
-			m_frustum[side][B] * (centerPosition.y + halfDepth) +
-			m_frustum[side][C] * (centerPosition.z + halfDepth) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		//--- If we get here, it isn't in the frustum
-		return false;
+size_t Frustum::CullRectangles(const glm::vec3* centerPositions, const glm::vec3* halfDimensions, size_t count, unsigned int* outInside) const
+{
+	m_planeTests += count * (FRONT + 1);
+
+	enum { ABSOLUTE_A = D + 1, ABSOLUTE_B, ABSOLUTE_C, PLANE_CONTENTS };
+
+	const __m128 SIGN = _mm_set1_ps(-0.0f);
+
+	//--- Every plane spread across all 4 lanes, along with the size of its normal on each axis (for the extents)
+	__m128 planes[FRONT + 1][PLANE_CONTENTS];
+
+	for (int side = RIGHT; side <= FRONT; side++) {
+		for (int content = A; content <= D; content++) { planes[side][content] = _mm_set1_ps(m_planes[content][side]); }
+		for (int content = A; content <= C; content++) { planes[side][ABSOLUTE_A + content] = _mm_andnot_ps(SIGN, planes[side][content]); }
 	}
 
-	return true;
+	size_t insideCount = 0;
+
+	for (size_t first = 0; first < count; first += 4) {
+
+		size_t remaining = std::min(count - first, (size_t)4);
+
+		//--- The last few are copied out so that nothing past the end of the arrays is read
+		glm::vec3 copiedCenters[4] = {}, copiedHalves[4] = {};
+
+		const glm::vec3* center	= &centerPositions[first];
+		const glm::vec3* half	= &halfDimensions[first];
+
+		if (remaining < 4) {
+			std::copy(center, center + remaining, copiedCenters);
+			std::copy(half, half + remaining, copiedHalves);
+			center	= copiedCenters;
+			half	= copiedHalves;
+		}
+
+		__m128 x, y, z, halfX, halfY, halfZ;
+		LoadVectors(center, x, y, z);
+		LoadVectors(half, halfX, halfY, halfZ);
+
+		__m128 outside = _mm_setzero_ps();
+
+		for (int side = RIGHT; side <= FRONT; side++) {
+
+			const __m128* plane = planes[side];
+
+			//--- The centre's distance in front of the side, plus how far the box reaches towards it
+			__m128 distance	= _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[A], x), _mm_mul_ps(plane[B], y)),
+										 _mm_add_ps(_mm_mul_ps(plane[C], z), plane[D]));
+			__m128 extent	= _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[ABSOLUTE_A], halfX), _mm_mul_ps(plane[ABSOLUTE_B], halfY)),
+										 _mm_mul_ps(plane[ABSOLUTE_C], halfZ));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+		}
+
+		int inside = ~_mm_movemask_ps(outside);
+
+		//--- Every index is written, but the count only moves past the ones inside (no branches to mispredict)
+		for (unsigned int rectangle = 0; rectangle < remaining; rectangle++) {
+			outInside[insideCount]	= (unsigned int)(first + rectangle);
+			insideCount				+= (inside >> rectangle) & 1;
+		}
+	}
+
+	return insideCount;
 }
 
 
 /*******************************************************************************************************************
-	A function which checks if a rectangle is inside the frustum given its center position half dimension
+	A function which finds whether a rectangle is outside, inside or crossing the sides of the frustum, testing one
+	side at a time. inOutSides holds a bit for each side still to be tested (pass ~0u to test them all), and the sides
+	the rectangle is entirely in front of are cleared from it - so anything inside this rectangle only needs testing
+	against the sides that are left. inOutLastSide is the side to test first, and is set to the side that culls it
 *******************************************************************************************************************/
-bool Frustum::IsRectangleInside(const glm::vec3& centerPosition, const glm::vec3& halfDimension) {
+Frustum::ContainmentType Frustum::ClassifyRectangle(const glm::vec3& centerPosition, const glm::vec3& halfDimension,
+													unsigned int& inOutSides, int& inOutLastSide) const
+{
+	unsigned int sides = inOutSides & ((1u << (FRONT + 1)) - 1);
 
-	//--- Rectangles are the same as cubes only we take into acount the full dimension
-	//--- Due to the sides being un-equal; so equivelant to width, height and depth of a models
-	//--- bounding box / 2.0
+	//--- Whichever side culled it last time will most likely cull it again, so that one goes first and the rest follow
+	//--- in order
+	for (int test = 0; test <= FRONT; test++) {
+
+		int side = (test == 0) ? inOutLastSide : ((test <= inOutLastSide) ? test - 1 : test);
 
-	for (unsigned int side = 0; side < s_maxSides; side++) {
-		if (m_frustum[side][A] * (centerPosition.x - halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y - halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z - halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y - halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z - halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y + halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z - halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y + halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z - halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y - halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z + halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y - halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z + halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x - halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y + halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z + halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		if (m_frustum[side][A] * (centerPosition.x + halfDimension.x) +
-			m_frustum[side][B] * (centerPosition.y + halfDimension.y) +
-			m_frustum[side][C] * (centerPosition.z + halfDimension.z) +
-			m_frustum[side][D] >= 0.0f)
-			continue;
-
-		//--- If we get here, it isn't in the frustum
-		return false;
+		if (!(sides & (1u << side))) { continue; }
+
+		m_planeTests++;
+
+		float distance	= m_planes[A][side] * centerPosition.x + m_planes[B][side] * centerPosition.y + m_planes[C][side] * centerPosition.z + m_planes[D][side];
+		float extent	= std::fabs(m_planes[A][side]) * halfDimension.x + std::fabs(m_planes[B][side]) * halfDimension.y + std::fabs(m_planes[C][side]) * halfDimension.z;
+
+		//--- Even the corner furthest in front is behind it, so it's outside - or even the corner furthest behind is in
+		//--- front of it, so nothing inside the rectangle needs testing against this side again
+		if (distance + extent < 0.0f) {
+			inOutLastSide = side;
+			return CONTAINMENT_OUTSIDE;
+		}
+
+		if (distance - extent >= 0.0f) { sides &= ~(1u << side); }
 	}
 
-	return true;
+	inOutSides = sides;
+
+	return (sides) ? CONTAINMENT_CROSSING : CONTAINMENT_INSIDE;
 }
 
 
 /*******************************************************************************************************************
-	Static variables and functions
+	Accessor methods
 *******************************************************************************************************************/
-const unsigned int Frustum::s_maxPlaneContents	= 4;
-const unsigned int Frustum::s_maxSides			= 6;
\ No newline at end of file
+size_t Frustum::GetPlaneTestCount() const { return m_planeTests; }
\ No newline at end of file
@@ -3,16 +3,24 @@
 /*******************************************************************************************************************
 	Frustum.h, Frustum.cpp
 	Created by Kim Kane
-	Last updated: 19/05/2018
+	Last updated: 17/10/2026
 
 	Generates a culling frustum to cull objects not visible by the projection.
 
 	[Features]
 	Optimizes rendering of many objects.
 	Support for points, spheres, boxes and rectangles.
+	The planes are stored as structure of arrays (all the A's together, then all the B's, etc.), padded to 8 planes,
+	so one object is tested against every plane at once with SSE2.
+	Batches of spheres or rectangles are culled 4 objects at a time with SSE2 (CullSpheres / CullRectangles),
+	writing out a list of the ones inside, for scenes with thousands of objects.
+	Rectangles can also be classified as outside, inside or crossing the sides (ClassifyRectangle), one side at a
+	time - skipping the sides a parent was already inside of, and testing the side that culled it last frame first.
+	The planes are only worked out again when the projection or view has changed.
+	Counts the planes tested each frame, for measuring how much the above saves.
 
 	[Upcoming]
-	Nothing at present.
+	8 objects at a time with AVX, once the project can rely on (or check for) a CPU that has it.
 
 	[Side Notes]
 	References and Credits:
@@ -22,9 +30,11 @@
 	o-Web Host of www.GameTutorials.com
 	https://gist.github.com/jimmikaelkael/2e4ffa5712d61816c7ca
 
+	A rectangle is tested with only the corner furthest along each plane's normal, which is inside whenever any of its
+	8 corners are, so the results are the same as testing every corner.
+
 *******************************************************************************************************************/
 #include <glm.hpp>
-#include <vector>
 
 class Frustum {
 
@@ -35,6 +45,9 @@ private:
 	//--- Sides of the viewing frustum
 	enum SideType { RIGHT, LEFT, BOTTOM, TOP, BACK, FRONT };
 
+public:
+	enum ContainmentType { CONTAINMENT_OUTSIDE, CONTAINMENT_CROSSING, CONTAINMENT_INSIDE };
+
 public:
 	Frustum(const glm::mat4& projection, const glm::mat4& view);
 	~Frustum();
@@ -43,18 +56,29 @@ public:
 	void Update(const glm::mat4& projection, const glm::mat4& view);
 	
 public:
-	bool IsPointInside(const glm::vec3& position);
-	bool IsSphereInside(const glm::vec3& centerPosition, float radius);
-	bool IsCubeInside(const glm::vec3& centerPosition, float halfDepth);
-	bool IsRectangleInside(const glm::vec3& centerPosition, const glm::vec3& halfDimension);
+	bool IsPointInside(const glm::vec3& position) const;
+	bool IsSphereInside(const glm::vec3& centerPosition, float radius) const;
+	bool IsCubeInside(const glm::vec3& centerPosition, float halfDepth) const;
+	bool IsRectangleInside(const glm::vec3& centerPosition, const glm::vec3& halfDimension) const;
 
-private:
-	void NormalizePlane(std::vector <std::vector<float>>& frustum, SideType side);
+public:
+	size_t CullSpheres(const glm::vec3* centerPositions, const float* radii, size_t count, unsigned int* outInside) const;
+	size_t CullRectangles(const glm::vec3* centerPositions, const glm::vec3* halfDimensions, size_t count, unsigned int* outInside) const;
+	ContainmentType ClassifyRectangle(const glm::vec3& centerPosition, const glm::vec3& halfDimension, unsigned int& inOutSides, int& inOutLastSide) const;
+
+public:
+	size_t GetPlaneTestCount() const;
 
 private:
-	std::vector<std::vector<float>> m_frustum;
+	void SetPlane(SideType side, float a, float b, float c, float d);
 
 private:
-	static const unsigned int s_maxPlaneContents;
-	static const unsigned int s_maxSides;
+	//--- One row per plane contents (A, B, C, D), with a column for each side and 2 spare sides that nothing is ever outside
+	float m_planes[4][8];
+
+	//--- The projection * view the planes were last worked out from
+	glm::mat4 m_clip;
+
+	//--- Only counted, so can be changed by the tests (which don't change the frustum itself)
+	mutable size_t m_planeTests;
 };
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "GameManager.h"
 #include "ResourceManager.h"
+#include "ThreadPool.h"
+#include "ConfigManager.h"
+#include "FileManager.h"
 #include "Log.h"
 
 /*******************************************************************************************************************
@@ -22,6 +25,9 @@ void GameManager::Initialize(const std::string& title, bool fullScreen, bool cor
 {
 	using namespace screen_constants;
 
+	//--- Read the assets from the pack if there is one, otherwise they're read from the Assets folder
+	File::Instance()->Mount("Assets.cogpak");
+
 	//--- Initialize the game window
 	Screen::Instance()->Initialize(title, WIDTH, HEIGHT, OPENGL_VERSION, OPENGL_SUBVERSION, fullScreen, coreMode, vSync);
 
@@ -44,7 +50,11 @@ void GameManager::Initialize(const std::string& title, bool fullScreen, bool cor
 *******************************************************************************************************************/
 void GameManager::Shutdown()
 {
+	//--- Let the workers finish what they're doing before the resources they're loading are destroyed
+	Workers::Instance()->Shutdown();
 	Resource::Instance()->Shutdown();
+	Config::Instance()->Shutdown();
+	File::Instance()->Unmount();
 	Audio::Instance()->Shutdown();
 	Input::Instance()->ShutDown();
 	Screen::Instance()->ShutDown();
@@ -177,6 +187,9 @@ void GameManager::Update()
 	//--- Update the in-game audio
 	Audio::Instance()->Update();
 
+	//--- Upload any resources that have finished loading in the background
+	Resource::Instance()->ProcessUploads();
+
 	//--- Default frame time = (MS per second / Default FPS) = (1000.0f / 60.0f) = (approx)16.6ms
 	const float defaultFrameTime = Timer::GetDefaultFrameTime();
 
@@ -6,7 +6,8 @@
 *******************************************************************************************************************/
 IndexBuffer::IndexBuffer()
 	:	m_indexBufferObject(0),
-		m_indexCount(0)
+		m_indexCount(0),
+		m_indexType(GL_UNSIGNED_INT)
 {
 	GenerateBufferObject();
 }
@@ -46,7 +47,33 @@ void IndexBuffer::Unbind() const
 *******************************************************************************************************************/
 void IndexBuffer::Render(GLenum mode) const
 {
-	FL_GLCALL(glDrawElements(mode, m_indexCount, GL_UNSIGNED_INT, nullptr));
+	FL_GLCALL(glDrawElements(mode, m_indexCount, m_indexType, nullptr));
+}
+
+
+/*******************************************************************************************************************
+	A function that renders part of the indexed buffer data - count indices, starting from the offset index
+*******************************************************************************************************************/
+void IndexBuffer::Render(GLenum mode, unsigned int count, unsigned int offset) const
+{
+	if (offset + count > m_indexCount) { FL_LOG("[INDEX BUFFER] Render range is outside of the buffer", FL_LOG_EMPTY, LOG_ERROR); return; }
+
+	size_t indexSize = (m_indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+	FL_GLCALL(glDrawElements(mode, count, m_indexType, (const void*)(offset * indexSize)));
+}
+
+
+/*******************************************************************************************************************
+	A function that renders part of the indexed buffer data, adding the base vertex to every index read
+*******************************************************************************************************************/
+void IndexBuffer::Render(GLenum mode, unsigned int count, unsigned int offset, int baseVertex) const
+{
+	if (offset + count > m_indexCount) { FL_LOG("[INDEX BUFFER] Render range is outside of the buffer", FL_LOG_EMPTY, LOG_ERROR); return; }
+
+	size_t indexSize = (m_indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+
+	FL_GLCALL(glDrawElementsBaseVertex(mode, count, m_indexType, (const void*)(offset * indexSize), baseVertex));
 }
 
 
@@ -54,21 +81,60 @@ void IndexBuffer::Render(GLenum mode) const
 	A function that pushes all the passed in indexed data to the GPU for rendering
 *******************************************************************************************************************/
 bool IndexBuffer::Push(const std::vector<GLuint>& data, bool dynamic)
+{
+	return Push((data.empty()) ? nullptr : &data.front(), (unsigned int)data.size(), dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes indexed data to the GPU straight from memory (e.g. a memory mapped file)
+*******************************************************************************************************************/
+bool IndexBuffer::Push(const GLuint* data, unsigned int count, bool dynamic)
+{
+	return PushData(data, count, GL_UNSIGNED_INT, dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes 16-bit indexed data to the GPU
+*******************************************************************************************************************/
+bool IndexBuffer::Push(const std::vector<GLushort>& data, bool dynamic)
+{
+	return Push((data.empty()) ? nullptr : &data.front(), (unsigned int)data.size(), dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes 16-bit indexed data to the GPU straight from memory
+*******************************************************************************************************************/
+bool IndexBuffer::Push(const GLushort* data, unsigned int count, bool dynamic)
+{
+	return PushData(data, count, GL_UNSIGNED_SHORT, dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes indices of the given type (GL_UNSIGNED_INT or GL_UNSIGNED_SHORT) to the GPU
+*******************************************************************************************************************/
+bool IndexBuffer::PushData(const void* data, unsigned int count, GLenum indexType, bool dynamic)
 {
 	//--- Make sure we have data before doing anything
-	if (data.empty()) {
+	if (!data || count == 0) {
 		FL_LOG("[INDEX BUFFER] Model index data vector container is empty", FL_LOG_EMPTY, LOG_ERROR); return false;
 	}
 
 	//--- Bind the index buffer object
 	Bind();
 
-	//--- Store the number of indices
-	m_indexCount = data.size();
+	//--- Store the number and type of indices
+	m_indexCount	= count;
+	m_indexType		= indexType;
+
+	size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
 	
 	//--- Push the data to the GPU
-	FL_GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLuint), &data.front(), (dynamic)	? GL_DYNAMIC_DRAW
-																											: GL_STATIC_DRAW));
+	FL_GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * indexSize, data, (dynamic)	? GL_DYNAMIC_DRAW
+																										: GL_STATIC_DRAW));
 	FL_LOG("[INDEX BUFFER] Pushed index data to the graphics card", FL_LOG_EMPTY, LOG_MESSAGE);
 
 	return true;
@@ -10,6 +10,9 @@
 
 	[Features]
 	Supports an std::vector container of unsigned integer data to send to the GPU.
+	Supports rendering a range of the indices, so several index lists (e.g. model LODs) can share one buffer.
+	Supports a base vertex, so one set of indices can draw many copies of a mesh from the same vertex buffer.
+	Supports 16-bit indices, which halve the size of the buffer for meshes with no more than 65536 vertices.
 	Ability to switch between render modes at run time and push dynamic/static data to the GPU.
 
 	[Upcoming]
@@ -52,7 +55,12 @@ public:
 
 public:
 	void Render(GLenum mode = GL_TRIANGLES) const;
+	void Render(GLenum mode, unsigned int count, unsigned int offset) const;
+	void Render(GLenum mode, unsigned int count, unsigned int offset, int baseVertex) const;
 	bool Push(const std::vector<GLuint>& data, bool dynamic = false);
+	bool Push(const GLuint* data, unsigned int count, bool dynamic = false);
+	bool Push(const std::vector<GLushort>& data, bool dynamic = false);
+	bool Push(const GLushort* data, unsigned int count, bool dynamic = false);
 
 private:
 	IndexBuffer(IndexBuffer const&)		= delete;
@@ -60,8 +68,10 @@ private:
 
 private:
 	void GenerateBufferObject();
+	bool PushData(const void* data, unsigned int count, GLenum indexType, bool dynamic);
 
 private:
 	GLuint			m_indexBufferObject;
 	unsigned int	m_indexCount;
+	GLenum			m_indexType;
 };
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include "Light.h"
-#include "FileManager.h"
+#include "ConfigManager.h"
 #include "Tools.h"
 
 /*******************************************************************************************************************
@@ -112,57 +112,48 @@ Light::~Light()
 *******************************************************************************************************************/
 Light* Light::Create(const std::string& tag)
 {
-	File::Instance()->OpenForReading("Assets\\Files\\lights.config");
-
-	std::map<std::string, std::map<std::string, std::string>> data;
-
-	File::Instance()->GetObjectData(tag, data);
+	ConfigObject data = Config::Instance()->Find("Assets\\Files\\lights.config", tag);
 	
 	Light* light = nullptr;
 
-	LightType type = (LightType)StringToInteger(data[tag]["type"]);
+	LightType type = (LightType)data.GetInteger("type");
 	
 	switch (type) {
 
 		case LIGHT_DIRECTION: {
 			light = new Light(
-				Direction(StringToFloat(data[tag]["direction.x"]), StringToFloat(data[tag]["direction.y"]), StringToFloat(data[tag]["direction.z"])),
-				Ambient(StringToFloat(data[tag]["ambient.r"]), StringToFloat(data[tag]["ambient.g"]), StringToFloat(data[tag]["ambient.b"])),
-				Diffuse(StringToFloat(data[tag]["diffuse.r"]), StringToFloat(data[tag]["diffuse.g"]), StringToFloat(data[tag]["diffuse.b"])),
-				Specular(StringToFloat(data[tag]["specular.r"]), StringToFloat(data[tag]["specular.g"]), StringToFloat(data[tag]["specular.b"]))); 
+				Direction(data.GetVector3("direction")),
+				Ambient(data.GetFloat("ambient.r"), data.GetFloat("ambient.g"), data.GetFloat("ambient.b")),
+				Diffuse(data.GetFloat("diffuse.r"), data.GetFloat("diffuse.g"), data.GetFloat("diffuse.b")),
+				Specular(data.GetFloat("specular.r"), data.GetFloat("specular.g"), data.GetFloat("specular.b"))); 
 			break;
 		}
 
 		case LIGHT_POINT: {
 			light = new Light(
-				Position(StringToFloat(data[tag]["position.x"]), StringToFloat(data[tag]["position.y"]), StringToFloat(data[tag]["position.z"])),
-				Ambient(StringToFloat(data[tag]["ambient.r"]), StringToFloat(data[tag]["ambient.g"]), StringToFloat(data[tag]["ambient.b"])),
-				Diffuse(StringToFloat(data[tag]["diffuse.r"]), StringToFloat(data[tag]["diffuse.g"]), StringToFloat(data[tag]["diffuse.b"])),
-				Specular(StringToFloat(data[tag]["specular.r"]), StringToFloat(data[tag]["specular.g"]), StringToFloat(data[tag]["specular.b"])),
-				Attenuation(StringToFloat(data[tag]["attenuation.c"]), StringToFloat(data[tag]["attenuation.l"]), StringToFloat(data[tag]["attenuation.q"])),
-				StringToFloat(data[tag]["margin"]));
+				Position(data.GetVector3("position")),
+				Ambient(data.GetFloat("ambient.r"), data.GetFloat("ambient.g"), data.GetFloat("ambient.b")),
+				Diffuse(data.GetFloat("diffuse.r"), data.GetFloat("diffuse.g"), data.GetFloat("diffuse.b")),
+				Specular(data.GetFloat("specular.r"), data.GetFloat("specular.g"), data.GetFloat("specular.b")),
+				Attenuation(data.GetFloat("attenuation.c"), data.GetFloat("attenuation.l"), data.GetFloat("attenuation.q")),
+				data.GetFloat("margin"));
 			break;
 		}
 
 		case LIGHT_SPOT: {
 			light = new Light(
-				Position(StringToFloat(data[tag]["position.x"]), StringToFloat(data[tag]["position.y"]), StringToFloat(data[tag]["position.z"])),
-				Direction(StringToFloat(data[tag]["direction.x"]), StringToFloat(data[tag]["direction.y"]), StringToFloat(data[tag]["direction.z"])),
-				Ambient(StringToFloat(data[tag]["ambient.r"]), StringToFloat(data[tag]["ambient.g"]), StringToFloat(data[tag]["ambient.b"])),
-				Diffuse(StringToFloat(data[tag]["diffuse.r"]), StringToFloat(data[tag]["diffuse.g"]), StringToFloat(data[tag]["diffuse.b"])),
-				Specular(StringToFloat(data[tag]["specular.r"]), StringToFloat(data[tag]["specular.g"]), StringToFloat(data[tag]["specular.b"])),
-				Attenuation(StringToFloat(data[tag]["attenuation.c"]), StringToFloat(data[tag]["attenuation.l"]), StringToFloat(data[tag]["attenuation.q"])),
-				Angle(StringToFloat(data[tag]["angle.inner"]), StringToFloat(data[tag]["angle.outer"])),
-				StringToFloat(data[tag]["margin"]));
+				Position(data.GetVector3("position")),
+				Direction(data.GetVector3("direction")),
+				Ambient(data.GetFloat("ambient.r"), data.GetFloat("ambient.g"), data.GetFloat("ambient.b")),
+				Diffuse(data.GetFloat("diffuse.r"), data.GetFloat("diffuse.g"), data.GetFloat("diffuse.b")),
+				Specular(data.GetFloat("specular.r"), data.GetFloat("specular.g"), data.GetFloat("specular.b")),
+				Attenuation(data.GetFloat("attenuation.c"), data.GetFloat("attenuation.l"), data.GetFloat("attenuation.q")),
+				Angle(data.GetFloat("angle.inner"), data.GetFloat("angle.outer")),
+				data.GetFloat("margin"));
 			break;
 		}
 	}
 
-	//--- NOTE
-	// This function was made for ease of use/quickness and is not optimized at all, so please ignore (I know it's ugly!)
-	// Later I plan on tidying up file handling and building a proper file parsing system (I never got round to this!)
-	//---
-
 	return light;
 }
 
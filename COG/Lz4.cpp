@@ -0,0 +1,199 @@
+#include <cstring>
+#include <vector>
+
+#include "Lz4.h"
+
+namespace lz4 {
+
+	//--- The shortest match the format can store
+	static const size_t MINIMUM_MATCH = 4;
+
+	//--- The format requires the last 5 bytes to be literals, and the last match to start at least 12 bytes from the end
+	static const size_t LAST_LITERALS	= 5;
+	static const size_t MATCH_LIMIT		= 12;
+
+	//--- Matches can only reach back as far as a 16-bit offset allows
+	static const size_t MAXIMUM_OFFSET = 65535;
+
+	static const unsigned int HASH_BITS = 12;
+
+
+	/*******************************************************************************************************************
+		Reads 4 bytes from a position that may not be aligned
+	*******************************************************************************************************************/
+	static unsigned int Read32(const unsigned char* position)
+	{
+		unsigned int value;
+		memcpy(&value, position, sizeof(value));
+		return value;
+	}
+
+
+	/*******************************************************************************************************************
+		Writes a length that didn't fit in its 4 bits of the token, as a run of 255s and a final byte
+	*******************************************************************************************************************/
+	static bool WriteLength(size_t length, unsigned char*& output, const unsigned char* outputEnd)
+	{
+		for (; length >= 255; length -= 255) {
+			if (output >= outputEnd) { return false; }
+			*output++ = 255;
+		}
+
+		if (output >= outputEnd) { return false; }
+		*output++ = (unsigned char)length;
+
+		return true;
+	}
+
+
+	/*******************************************************************************************************************
+		Writes one sequence - a run of literals followed by a match. A matchLength of 0 writes the final literals only
+	*******************************************************************************************************************/
+	static bool WriteSequence(const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength,
+							  unsigned char*& output, const unsigned char* outputEnd)
+	{
+		if (output >= outputEnd) { return false; }
+
+		unsigned char* token	= output++;
+		size_t matchCode		= (matchLength) ? matchLength - MINIMUM_MATCH : 0;
+
+		*token = (unsigned char)(((literalLength < 15) ? literalLength : 15) << 4 | ((matchCode < 15) ? matchCode : 15));
+
+		if (literalLength >= 15 && !WriteLength(literalLength - 15, output, outputEnd)) { return false; }
+
+		if ((size_t)(outputEnd - output) < literalLength) { return false; }
+		if (literalLength) { memcpy(output, literals, literalLength); }
+		output += literalLength;
+
+		if (!matchLength) { return true; }
+
+		if (outputEnd - output < 2) { return false; }
+		*output++ = (unsigned char)(offset & 0xff);
+		*output++ = (unsigned char)(offset >> 8);
+
+		return (matchCode < 15) || WriteLength(matchCode - 15, output, outputEnd);
+	}
+
+
+	/*******************************************************************************************************************
+		Returns the most space that compressing size bytes could take, for data that doesn't compress at all
+	*******************************************************************************************************************/
+	size_t GetMaximumCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+
+	/*******************************************************************************************************************
+		Compresses a block of data, returning the compressed size, or 0 if it doesn't fit in the capacity given
+	*******************************************************************************************************************/
+	size_t Compress(const char* source, size_t size, char* destination, size_t capacity)
+	{
+		const unsigned char* input		= (const unsigned char*)source;
+		const unsigned char* inputEnd	= input + size;
+		const unsigned char* anchor		= input;
+		const unsigned char* position	= input;
+
+		unsigned char* output			= (unsigned char*)destination;
+		const unsigned char* outputEnd	= output + capacity;
+
+		if (size > MATCH_LIMIT) {
+
+			const unsigned char* matchStartLimit	= inputEnd - MATCH_LIMIT;
+			const unsigned char* matchEndLimit		= inputEnd - LAST_LITERALS;
+
+			//--- The last position each 4 byte sequence was seen at, relative to the start of the input
+			std::vector<unsigned int> table((size_t)1 << HASH_BITS, 0);
+
+			while (position < matchStartLimit) {
+
+				unsigned int sequence	= Read32(position);
+				unsigned int hash		= (sequence * 2654435761u) >> (32 - HASH_BITS);
+
+				const unsigned char* reference = input + table[hash];
+				table[hash] = (unsigned int)(position - input);
+
+				if (reference >= position || (size_t)(position - reference) > MAXIMUM_OFFSET || Read32(reference) != sequence) {
+					position++;
+					continue;
+				}
+
+				const unsigned char* matchEnd = position + MINIMUM_MATCH;
+				reference += MINIMUM_MATCH;
+
+				while (matchEnd < matchEndLimit && *matchEnd == *reference) { matchEnd++; reference++; }
+
+				if (!WriteSequence(anchor, position - anchor, matchEnd - reference, matchEnd - position, output, outputEnd)) { return 0; }
+
+				position	= matchEnd;
+				anchor		= position;
+			}
+		}
+
+		if (!WriteSequence(anchor, inputEnd - anchor, 0, 0, output, outputEnd)) { return 0; }
+
+		return output - (unsigned char*)destination;
+	}
+
+
+	/*******************************************************************************************************************
+		Decompresses a block of data, returning false if the data is corrupt or doesn't decompress to exactly the size given
+	*******************************************************************************************************************/
+	bool Decompress(const char* source, size_t size, char* destination, size_t decompressedSize)
+	{
+		const unsigned char* input		= (const unsigned char*)source;
+		const unsigned char* inputEnd	= input + size;
+
+		unsigned char* output			= (unsigned char*)destination;
+		unsigned char* outputStart		= output;
+		const unsigned char* outputEnd	= output + decompressedSize;
+
+		//--- Reads a length that carries on past its 4 bits of the token
+		auto readLength = [&input, inputEnd](size_t& length) {
+			unsigned char byte = 255;
+			while (byte == 255) {
+				if (input >= inputEnd) { return false; }
+				byte = *input++;
+				length += byte;
+			}
+			return true;
+		};
+
+		while (input < inputEnd) {
+
+			unsigned int token		= *input++;
+			size_t literalLength	= token >> 4;
+
+			if (literalLength == 15 && !readLength(literalLength)) { return false; }
+
+			if ((size_t)(inputEnd - input) < literalLength || (size_t)(outputEnd - output) < literalLength) { return false; }
+
+			if (literalLength) { memcpy(output, input, literalLength); }
+			input	+= literalLength;
+			output	+= literalLength;
+
+			//--- The last sequence has no match
+			if (input == inputEnd) { break; }
+
+			if (inputEnd - input < 2) { return false; }
+
+			size_t offset = input[0] | (input[1] << 8);
+			input += 2;
+
+			if (offset == 0 || offset > (size_t)(output - outputStart)) { return false; }
+
+			size_t matchLength = token & 15;
+
+			if (matchLength == 15 && !readLength(matchLength)) { return false; }
+
+			matchLength += MINIMUM_MATCH;
+
+			if ((size_t)(outputEnd - output) < matchLength) { return false; }
+
+			//--- Matches can overlap the bytes they're writing (e.g. a run of one byte), so copy one byte at a time
+			const unsigned char* reference = output - offset;
+			for (size_t byte = 0; byte < matchLength; byte++) { output[byte] = reference[byte]; }
+
+			output += matchLength;
+		}
+
+		return output == outputEnd;
+	}
+}
\ No newline at end of file
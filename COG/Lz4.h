@@ -0,0 +1,30 @@
+#pragma once
+
+/*******************************************************************************************************************
+	Lz4.h, Lz4.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A small compressor and decompressor for the LZ4 block format, used for the entries of .cogpak files (see PackFile.h).
+
+	[Features]
+	Decompression is a straight copy loop with no tables, so it runs at close to memory speed.
+	The compressor is a simple greedy one (one hash table of 4 byte sequences), which is fast enough to pack every asset
+	in a few seconds. Its output is standard LZ4 block data, so any LZ4 decompressor can read it.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Blocks don't store their own sizes - the caller has to keep both the compressed and the decompressed size.
+	Decompress checks every read and write, so corrupt data fails rather than overrunning a buffer.
+
+*******************************************************************************************************************/
+#include <cstddef>
+
+namespace lz4 {
+
+	size_t GetMaximumCompressedSize(size_t size);
+	size_t Compress(const char* source, size_t size, char* destination, size_t capacity);
+	bool Decompress(const char* source, size_t size, char* destination, size_t decompressedSize);
+}
\ No newline at end of file
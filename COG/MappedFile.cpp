@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+MappedFile::MappedFile()
+	:	m_file(INVALID_HANDLE_VALUE),
+		m_mapping(nullptr),
+		m_data(nullptr),
+		m_size(0)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor - releases the mapping if it is still open
+*******************************************************************************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+
+/*******************************************************************************************************************
+	Opens a file for reading and maps the whole of its contents into memory
+*******************************************************************************************************************/
+bool MappedFile::Open(const std::string& fileLocation)
+{
+	//--- Make sure we don't leak a previous mapping if this object is re-used
+	Close();
+
+	m_file = CreateFile(fileLocation.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+						FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (m_file == INVALID_HANDLE_VALUE) { FL_LOG("[FILE] File doesn't exist: ", fileLocation.c_str(), LOG_ERROR); return false; }
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+		FL_LOG("[FILE] File is empty or unreadable: ", fileLocation.c_str(), LOG_ERROR);
+		Close();
+		return false;
+	}
+
+	m_size = (size_t)fileSize.QuadPart;
+
+	//--- Create a read only mapping of the entire file and then get a view of it
+	m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!m_mapping) { FL_LOG("[FILE] Could not map file: ", fileLocation.c_str(), LOG_ERROR); Close(); return false; }
+
+	m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!m_data) { FL_LOG("[FILE] Could not view mapped file: ", fileLocation.c_str(), LOG_ERROR); Close(); return false; }
+
+	FL_LOG("[FILE] File mapped successfully: ", fileLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps the file and closes all handles
+*******************************************************************************************************************/
+void MappedFile::Close()
+{
+	if (m_data)							{ UnmapViewOfFile(m_data); m_data = nullptr; }
+	if (m_mapping)						{ CloseHandle(m_mapping); m_mapping = nullptr; }
+	if (m_file != INVALID_HANDLE_VALUE)	{ CloseHandle(m_file); m_file = INVALID_HANDLE_VALUE; }
+
+	m_size = 0;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const char* MappedFile::GetData() const	{ return m_data; }
+size_t MappedFile::GetSize() const		{ return m_size; }
+bool MappedFile::IsOpen() const			{ return m_data != nullptr; }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+/*******************************************************************************************************************
+	MappedFile.h, MappedFile.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Maps a file into memory (read only) so that its contents can be scanned in place.
+
+	[Features]
+	No copies of the file data are made - the operating system pages the file in as we read through it.
+	The mapping is released when the object goes out of scope, or when Close() is called.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Empty files cannot be mapped on Windows, so opening a file of 0 bytes will fail.
+
+*******************************************************************************************************************/
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <string>
+
+class MappedFile {
+
+public:
+	MappedFile();
+	~MappedFile();
+
+public:
+	bool Open(const std::string& fileLocation);
+	void Close();
+
+public:
+	const char*	GetData() const;
+	size_t		GetSize() const;
+	bool		IsOpen() const;
+
+private:
+	MappedFile(const MappedFile&)				= delete;
+	MappedFile& operator=(const MappedFile&)	= delete;
+
+private:
+	HANDLE		m_file;
+	HANDLE		m_mapping;
+	const char*	m_data;
+	size_t		m_size;
+};
\ No newline at end of file
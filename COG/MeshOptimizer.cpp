@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+#include "MeshOptimizer.h"
+#include "Tools.h"
+#include "Log.h"
+
+namespace mesh_optimizer {
+
+	//--- The size of the cache we score against when reordering (bigger than any real cache, as recommended by Forsyth)
+	static const unsigned int SCORING_CACHE_SIZE	= 32;
+
+	//--- The size of the FIFO cache we simulate when splitting clusters for overdraw
+	static const unsigned int CLUSTER_CACHE_SIZE	= 16;
+
+	static const unsigned int INVALID_INDEX			= UINT_MAX;
+
+
+	/*******************************************************************************************************************
+		Scores a vertex based on its position in the cache and how many triangles still need it (Forsyth's scoring).
+		Vertices used by the last triangle get a fixed score, so the next triangle doesn't just re-use the same edge
+	*******************************************************************************************************************/
+	static float VertexScore(int cachePosition, unsigned int remainingTriangles)
+	{
+		//--- No triangles left to draw, so this vertex is no use to us
+		if (remainingTriangles == 0) { return -1.0f; }
+
+		float score = 0.0f;
+
+		if (cachePosition >= 0) {
+			if (cachePosition < 3)	{ score = 0.75f; }
+			else					{ score = powf(1.0f - (float)(cachePosition - 3) / (SCORING_CACHE_SIZE - 3), 1.5f); }
+		}
+
+		//--- Boost vertices with only a few triangles left, so we finish them off rather than leave lone triangles behind
+		return score + 2.0f / sqrtf((float)remainingTriangles);
+	}
+
+
+	/*******************************************************************************************************************
+		Returns the number of vertices of a triangle that miss a FIFO cache, updating the cache as it goes.
+		A vertex is in the cache if fewer than cacheSize misses have happened since it was last loaded
+	*******************************************************************************************************************/
+	static unsigned int SimulateTriangle(const unsigned int* triangle, std::vector<unsigned int>& timestamps, unsigned int& timestamp, unsigned int cacheSize)
+	{
+		unsigned int misses = 0;
+
+		for (unsigned int corner = 0; corner < 3; corner++) {
+
+			unsigned int vertex = triangle[corner];
+
+			if (timestamp - timestamps[vertex] > cacheSize) {
+				timestamps[vertex] = timestamp++;
+				misses++;
+			}
+		}
+
+		return misses;
+	}
+
+
+	/*******************************************************************************************************************
+		Simulates a FIFO post transform cache and returns how many vertices had to be transformed
+	*******************************************************************************************************************/
+	CacheStatistics AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+	{
+		CacheStatistics statistics = { 0.0f, 0.0f, 0 };
+
+		if (indices.size() < 3) { return statistics; }
+
+		//--- Starting the clock past the cache size means every vertex begins outside the cache
+		std::vector<unsigned int> timestamps(vertexCount, 0);
+		std::vector<bool> isUsed(vertexCount, false);
+		unsigned int timestamp		= cacheSize + 1;
+		unsigned int usedVertices	= 0;
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			statistics.transformed += SimulateTriangle(&indices[i], timestamps, timestamp, cacheSize);
+		}
+
+		for (unsigned int index : indices) { if (!isUsed[index]) { isUsed[index] = true; usedVertices++; } }
+
+		statistics.acmr = (float)statistics.transformed / (indices.size() / 3);
+		statistics.atvr = (float)statistics.transformed / usedVertices;
+
+		return statistics;
+	}
+
+
+	/*******************************************************************************************************************
+		Reorders the triangles so that each one re-uses as many vertices as possible that were recently transformed.
+		This is Tom Forsyth's greedy algorithm - the next triangle is always the highest scoring triangle that uses
+		a vertex in the cache, and only the triangles touching the cache have their scores updated each step
+	*******************************************************************************************************************/
+	void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+	{
+		size_t triangleCount = indices.size() / 3;
+
+		if (triangleCount < 2) { return; }
+
+		//--- Build a list of the triangles that use each vertex (all stored in one array, using offsets)
+		std::vector<unsigned int> remaining(vertexCount, 0);
+		std::vector<unsigned int> offsets(vertexCount + 1, 0);
+		std::vector<unsigned int> adjacency(triangleCount * 3);
+
+		for (size_t i = 0; i < triangleCount * 3; i++) { remaining[indices[i]]++; }
+		for (size_t vertex = 0; vertex < vertexCount; vertex++) { offsets[vertex + 1] = offsets[vertex] + remaining[vertex]; }
+
+		{
+			std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; i++) { adjacency[cursor[indices[i]]++] = (unsigned int)(i / 3); }
+		}
+
+		//--- Score every vertex and triangle
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		std::vector<float> triangleScore(triangleCount, 0.0f);
+		std::vector<bool> isEmitted(triangleCount, false);
+
+		for (size_t vertex = 0; vertex < vertexCount; vertex++) { vertexScore[vertex] = VertexScore(-1, remaining[vertex]); }
+		for (size_t i = 0; i < triangleCount * 3; i++) { triangleScore[i / 3] += vertexScore[indices[i]]; }
+
+		std::vector<unsigned int> cache, nextCache;
+		cache.reserve(SCORING_CACHE_SIZE + 3);
+		nextCache.reserve(SCORING_CACHE_SIZE + 3);
+
+		std::vector<unsigned int> output;
+		output.reserve(triangleCount * 3);
+
+		size_t nextUnemitted	= 0;
+		int best				= -1;
+
+		while (output.size() < triangleCount * 3) {
+
+			//--- If no triangle touches the cache, carry on from the first triangle we haven't drawn yet
+			if (best < 0) {
+				while (isEmitted[nextUnemitted]) { nextUnemitted++; }
+				best = (int)nextUnemitted;
+			}
+
+			const unsigned int* triangle = &indices[best * 3];
+
+			output.insert(output.end(), triangle, triangle + 3);
+			isEmitted[best] = true;
+
+			//--- Remove the triangle from each of its vertices' lists (the active part of the list is the first 'remaining' entries)
+			for (unsigned int corner = 0; corner < 3; corner++) {
+
+				unsigned int vertex	= triangle[corner];
+				unsigned int* list	= &adjacency[offsets[vertex]];
+
+				for (unsigned int i = 0; i < remaining[vertex]; i++) {
+					if (list[i] == (unsigned int)best) { std::swap(list[i], list[remaining[vertex] - 1]); remaining[vertex]--; break; }
+				}
+			}
+
+			//--- The triangle's vertices move to the front of the cache, pushing the rest back
+			nextCache.clear();
+
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				if (std::find(nextCache.begin(), nextCache.end(), triangle[corner]) == nextCache.end()) { nextCache.push_back(triangle[corner]); }
+			}
+
+			for (unsigned int vertex : cache) {
+				if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) { nextCache.push_back(vertex); }
+			}
+
+			//--- Re-score every vertex that moved (including those pushed out of the cache) and their triangles
+			for (unsigned int i = 0; i < nextCache.size(); i++) {
+
+				unsigned int vertex	= nextCache[i];
+				cachePosition[vertex]	= (i < SCORING_CACHE_SIZE) ? (int)i : -1;
+
+				float score	= VertexScore(cachePosition[vertex], remaining[vertex]);
+				float delta	= score - vertexScore[vertex];
+
+				vertexScore[vertex] = score;
+
+				for (unsigned int j = 0; j < remaining[vertex]; j++) { triangleScore[adjacency[offsets[vertex] + j]] += delta; }
+			}
+
+			if (nextCache.size() > SCORING_CACHE_SIZE) { nextCache.resize(SCORING_CACHE_SIZE); }
+			cache.swap(nextCache);
+
+			//--- Pick the highest scoring triangle that uses a vertex in the cache
+			best = -1;
+			float bestScore = -1.0f;
+
+			for (unsigned int vertex : cache) {
+				for (unsigned int j = 0; j < remaining[vertex]; j++) {
+
+					unsigned int candidate = adjacency[offsets[vertex] + j];
+
+					if (triangleScore[candidate] > bestScore) { best = (int)candidate; bestScore = triangleScore[candidate]; }
+				}
+			}
+		}
+
+		indices.swap(output);
+	}
+
+
+	/*******************************************************************************************************************
+		Reorders clusters of triangles so that the outward facing ones are drawn first, reducing overdraw.
+		The triangles should already be in cache order - clusters are only split where the cache would be mostly
+		cold anyway, or where splitting only makes the ACMR worse by the threshold (1.05 = 5% worse) at most
+	*******************************************************************************************************************/
+	void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<glm::vec3>& positions, float threshold)
+	{
+		size_t triangleCount = indices.size() / 3;
+
+		if (triangleCount < 2) { return; }
+
+		std::vector<unsigned int> timestamps(positions.size(), 0);
+		unsigned int timestamp = CLUSTER_CACHE_SIZE + 1;
+
+		//--- Hard boundaries - a triangle with no vertices in the cache starts a new cluster
+		std::vector<unsigned int> misses(triangleCount);
+		std::vector<size_t> hardBoundaries;
+
+		for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+			misses[triangle] = SimulateTriangle(&indices[triangle * 3], timestamps, timestamp, CLUSTER_CACHE_SIZE);
+			if (triangle == 0 || misses[triangle] == 3) { hardBoundaries.push_back(triangle); }
+		}
+
+		hardBoundaries.push_back(triangleCount);
+
+		//--- Soft boundaries - split each hard cluster again, as soon as the ACMR of the new cluster (starting with a
+		//--- cold cache) gets within the threshold of the ACMR of the whole hard cluster
+		std::vector<size_t> boundaries;
+
+		for (size_t cluster = 0; cluster + 1 < hardBoundaries.size(); cluster++) {
+
+			size_t start	= hardBoundaries[cluster];
+			size_t end		= hardBoundaries[cluster + 1];
+
+			unsigned int clusterMisses = 0;
+			for (size_t triangle = start; triangle < end; triangle++) { clusterMisses += misses[triangle]; }
+
+			float targetAcmr = threshold * (float)clusterMisses / (end - start);
+
+			size_t softStart			= start;
+			unsigned int softMisses		= 0;
+
+			timestamp += CLUSTER_CACHE_SIZE + 1;
+			boundaries.push_back(start);
+
+			for (size_t triangle = start; triangle < end; triangle++) {
+
+				softMisses += SimulateTriangle(&indices[triangle * 3], timestamps, timestamp, CLUSTER_CACHE_SIZE);
+
+				if (triangle + 1 < end && (float)softMisses / (triangle + 1 - softStart) <= targetAcmr) {
+					softStart	= triangle + 1;
+					softMisses	= 0;
+					timestamp	+= CLUSTER_CACHE_SIZE + 1;
+					boundaries.push_back(softStart);
+				}
+			}
+		}
+
+		boundaries.push_back(triangleCount);
+
+		//--- Find the centre of the whole mesh, weighted by area
+		glm::vec3 meshCentroid	= glm::vec3(0.0f);
+		float meshArea			= 0.0f;
+
+		std::vector<glm::vec3> triangleCentroid(triangleCount);
+		std::vector<glm::vec3> triangleNormal(triangleCount);
+
+		for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+
+			const glm::vec3& a = positions[indices[triangle * 3 + 0]];
+			const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+			const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+
+			//--- The length of the cross product is twice the area, so the normals are already weighted by area
+			triangleNormal[triangle]	= glm::cross(b - a, c - a);
+			triangleCentroid[triangle]	= (a + b + c) / 3.0f;
+
+			float area		= glm::length(triangleNormal[triangle]);
+			meshCentroid	+= triangleCentroid[triangle] * area;
+			meshArea		+= area;
+		}
+
+		if (meshArea > 0.0f) { meshCentroid /= meshArea; }
+
+		//--- Clusters whose average normal points away from the centre of the mesh are likely to be in front,
+		//--- so they get the highest sort key and are drawn first
+		struct Cluster {
+			size_t	start, end;
+			float	sortKey;
+		};
+
+		std::vector<Cluster> clusters;
+		clusters.reserve(boundaries.size());
+
+		for (size_t cluster = 0; cluster + 1 < boundaries.size(); cluster++) {
+
+			size_t start	= boundaries[cluster];
+			size_t end		= boundaries[cluster + 1];
+
+			glm::vec3 centroid	= glm::vec3(0.0f);
+			glm::vec3 normal	= glm::vec3(0.0f);
+			float area			= 0.0f;
+
+			for (size_t triangle = start; triangle < end; triangle++) {
+				float triangleArea	= glm::length(triangleNormal[triangle]);
+				centroid			+= triangleCentroid[triangle] * triangleArea;
+				normal				+= triangleNormal[triangle];
+				area				+= triangleArea;
+			}
+
+			float sortKey		= 0.0f;
+			float normalLength	= glm::length(normal);
+
+			if (area > 0.0f && normalLength > 0.0f) { sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength); }
+
+			clusters.push_back({ start, end, sortKey });
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& first, const Cluster& second) {
+			return first.sortKey > second.sortKey;
+		});
+
+		std::vector<unsigned int> output;
+		output.reserve(indices.size());
+
+		for (const Cluster& cluster : clusters) {
+			output.insert(output.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+		}
+
+		indices.swap(output);
+	}
+
+
+	/*******************************************************************************************************************
+		Renumbers the vertices in the order the indices first use them and returns that order, so that the vertex
+		data can be reordered to match (see Reorder). Vertices that are never used are moved to the end
+	*******************************************************************************************************************/
+	std::vector<unsigned int> OptimizeVertexFetch(std::vector<unsigned int>& indices, size_t vertexCount)
+	{
+		std::vector<unsigned int> remap(vertexCount, INVALID_INDEX);
+		std::vector<unsigned int> order;
+		order.reserve(vertexCount);
+
+		for (unsigned int& index : indices) {
+
+			if (remap[index] == INVALID_INDEX) {
+				remap[index] = (unsigned int)order.size();
+				order.push_back(index);
+			}
+
+			index = remap[index];
+		}
+
+		for (unsigned int vertex = 0; vertex < vertexCount; vertex++) {
+			if (remap[vertex] == INVALID_INDEX) { order.push_back(vertex); }
+		}
+
+		return order;
+	}
+
+
+	/*******************************************************************************************************************
+		Runs every optimization on a model's data, logging the ACMR and ATVR before and after
+	*******************************************************************************************************************/
+	void OptimizeMesh(std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& indices, const std::string& tag)
+	{
+		if (vertices.empty() || indices.size() < 3) { return; }
+
+		CacheStatistics before = AnalyzeVertexCache(indices, vertices.size());
+
+		OptimizeVertexCache(indices, vertices.size());
+
+		std::vector<glm::vec3> positions;
+		positions.reserve(vertices.size());
+
+		for (const VertexBuffer::PackedVertex& vertex : vertices) { positions.push_back(vertex.position); }
+
+		OptimizeOverdraw(indices, positions);
+
+		Reorder(vertices, OptimizeVertexFetch(indices, vertices.size()));
+
+		CacheStatistics after = AnalyzeVertexCache(indices, vertices.size());
+
+		FL_LOG("[MESH OPTIMIZER] " + tag + " - ACMR: " + NumberToString(before.acmr) + " -> " + NumberToString(after.acmr) +
+			   ", ATVR: " + NumberToString(before.atvr) + " -> ", after.atvr, LOG_MESSAGE);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+/*******************************************************************************************************************
+	MeshOptimizer.h, MeshOptimizer.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Reorders the index and vertex data of a mesh so the graphics card can draw it faster.
+	References: Linear-Speed Vertex Cache Optimisation, by Tom Forsyth
+				Fast Triangle Reordering for Vertex Locality and Reduced Overdraw, by Pedro Sander et al.
+
+	[Features]
+	OptimizeVertexCache reorders triangles so that vertices are re-used while they're still in the post transform cache.
+	OptimizeOverdraw then splits the triangles in to clusters (without undoing much of the cache order) and sorts the
+	clusters so that triangles facing outwards are drawn first, so fewer pixels are shaded twice.
+	OptimizeVertexFetch finally reorders the vertices in the order they are first used, so memory is read in order.
+	AnalyzeVertexCache reports the ACMR (average cache miss ratio - vertices transformed per triangle, 0.5 is
+	perfect, 3.0 is the worst) and ATVR (average transformed vertex ratio - 1.0 is perfect).
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	All functions work on indexed triangle lists only. This is run when a model is imported (before it is baked),
+	so it costs nothing at runtime.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include <string>
+#include "VertexBuffer.h"
+
+namespace mesh_optimizer {
+
+	struct CacheStatistics {
+		float			acmr;
+		float			atvr;
+		unsigned int	transformed;
+	};
+
+	CacheStatistics AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+	void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+	void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f);
+	std::vector<unsigned int> OptimizeVertexFetch(std::vector<unsigned int>& indices, size_t vertexCount);
+
+	void OptimizeMesh(std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& indices, const std::string& tag);
+
+	template <typename T> void Reorder(std::vector<T>& data, const std::vector<unsigned int>& order);
+}
+
+
+/*******************************************************************************************************************
+	A template function that reorders data so that data[i] becomes data[order[i]] (see OptimizeVertexFetch)
+*******************************************************************************************************************/
+template <typename T> void mesh_optimizer::Reorder(std::vector<T>& data, const std::vector<unsigned int>& order)
+{
+	std::vector<T> reordered;
+	reordered.reserve(order.size());
+
+	for (unsigned int index : order) { reordered.push_back(data[index]); }
+
+	data.swap(reordered);
+}
\ No newline at end of file
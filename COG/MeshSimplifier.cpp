@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "Log.h"
+#include "Tools.h"
+
+namespace mesh_simplifier {
+
+	//--- A collapse that turns a triangle by more than this (cos of the angle, ~75 degrees) is treated as a flip
+	static const float MINIMUM_NORMAL_DOT = 0.25f;
+
+	//--- The LOD chain stops after this many levels, when a level gets too small or when it stops shrinking
+	static const unsigned int MAXIMUM_LODS			= 4;
+	static const unsigned int MINIMUM_LOD_TRIANGLES	= 64;
+	static const float MINIMUM_LOD_REDUCTION		= 0.9f;
+
+	//--- How far (as a fraction of the model's size) any LOD is allowed to move the surface
+	static const float MAXIMUM_LOD_ERROR = 0.25f;
+
+	/*******************************************************************************************************************
+		A symmetric 4x4 matrix built from planes. Evaluating it at a point gives the sum of the squared distances
+		from the point to every plane that has been added (weighted by the area of the triangle the plane came from)
+	*******************************************************************************************************************/
+	struct Quadric {
+
+		double a2, b2, c2, ab, ac, bc, ad, bd, cd, d2, weight;
+
+		void AddPlane(const glm::vec3& normal, float distance, float area)
+		{
+			double a = normal.x, b = normal.y, c = normal.z, d = distance;
+
+			a2 += a * a * area;	b2 += b * b * area;	c2 += c * c * area;
+			ab += a * b * area;	ac += a * c * area;	bc += b * c * area;
+			ad += a * d * area;	bd += b * d * area;	cd += c * d * area;
+			d2 += d * d * area;	weight += area;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a2 += other.a2;	b2 += other.b2;	c2 += other.c2;
+			ab += other.ab;	ac += other.ac;	bc += other.bc;
+			ad += other.ad;	bd += other.bd;	cd += other.cd;
+			d2 += other.d2;	weight += other.weight;
+		}
+
+		//--- Returns the average squared distance of the point from the planes
+		double Evaluate(const glm::vec3& point) const
+		{
+			double x = point.x, y = point.y, z = point.z;
+
+			double error =	x * x * a2 + y * y * b2 + z * z * c2 +
+							2.0 * (x * y * ab + x * z * ac + y * z * bc) +
+							2.0 * (x * ad + y * bd + z * cd) + d2;
+
+			return (weight > 0.0) ? std::fabs(error) / weight : 0.0;
+		}
+	};
+
+
+	struct Collapse {
+		unsigned int	from, to;
+		double			error;
+	};
+
+
+	/*******************************************************************************************************************
+		Packs an edge between two (welded) vertices in to one number, so the edges can be sorted and searched
+	*******************************************************************************************************************/
+	static unsigned long long EdgeKey(unsigned int from, unsigned int to)
+	{
+		return ((unsigned long long)from << 32) | to;
+	}
+
+
+	/*******************************************************************************************************************
+		Finds the vertices that can't move - those that share a position with another vertex (a seam, where the
+		texture coordinates or normals are different) and those on an open border (an edge with only one triangle)
+	*******************************************************************************************************************/
+	static std::vector<bool> FindLockedVertices(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices)
+	{
+		std::vector<bool> isLocked(positions.size(), false);
+
+		//--- Sort the vertices by position, so vertices in the same place end up next to each other
+		std::vector<unsigned int> sorted(positions.size());
+		for (unsigned int vertex = 0; vertex < sorted.size(); vertex++) { sorted[vertex] = vertex; }
+
+		std::sort(sorted.begin(), sorted.end(), [&positions](unsigned int first, unsigned int second) {
+			return memcmp(&positions[first], &positions[second], sizeof(glm::vec3)) < 0;
+		});
+
+		//--- Every vertex is welded to the first vertex in its position, which is what the border edges are built from
+		std::vector<unsigned int> weld(positions.size());
+
+		for (size_t i = 0; i < sorted.size(); i++) {
+
+			bool isSameAsPrevious = (i > 0 && memcmp(&positions[sorted[i]], &positions[sorted[i - 1]], sizeof(glm::vec3)) == 0);
+
+			weld[sorted[i]] = (isSameAsPrevious) ? weld[sorted[i - 1]] : sorted[i];
+
+			if (isSameAsPrevious) { isLocked[sorted[i]] = isLocked[sorted[i - 1]] = true; }
+		}
+
+		//--- An edge is on a border if no triangle uses it in the opposite direction
+		std::vector<unsigned long long> edges;
+		edges.reserve(indices.size());
+
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				edges.push_back(EdgeKey(weld[indices[i + corner]], weld[indices[i + (corner + 1) % 3]]));
+			}
+		}
+
+		std::sort(edges.begin(), edges.end());
+
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (unsigned int corner = 0; corner < 3; corner++) {
+
+				unsigned int from	= indices[i + corner];
+				unsigned int to		= indices[i + (corner + 1) % 3];
+
+				if (!std::binary_search(edges.begin(), edges.end(), EdgeKey(weld[to], weld[from]))) { isLocked[from] = isLocked[to] = true; }
+			}
+		}
+
+		return isLocked;
+	}
+
+
+	/*******************************************************************************************************************
+		Checks whether moving a vertex would flip (or badly fold) any of the triangles around it
+	*******************************************************************************************************************/
+	static bool IsFlipped(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const unsigned int* triangles,
+						  unsigned int triangleCount, unsigned int from, unsigned int to)
+	{
+		for (unsigned int i = 0; i < triangleCount; i++) {
+
+			const unsigned int* triangle = &indices[triangles[i] * 3];
+
+			//--- Triangles using both vertices disappear, so they can't flip
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to) { continue; }
+
+			glm::vec3 corners[3]	= { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+			glm::vec3 before		= glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+			for (unsigned int corner = 0; corner < 3; corner++) { if (triangle[corner] == from) { corners[corner] = positions[to]; } }
+
+			glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+			float lengths = glm::length(before) * glm::length(after);
+
+			if (lengths <= 0.0f || glm::dot(before, after) < MINIMUM_NORMAL_DOT * lengths) { return true; }
+		}
+
+		return false;
+	}
+
+
+	/*******************************************************************************************************************
+		Simplifies a mesh until it has no more than targetIndexCount indices, or until collapsing any more edges would
+		move the surface by more than maximumError. Returns the new indices, and the error reached in outError
+	*******************************************************************************************************************/
+	std::vector<unsigned int> Simplify(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+									   size_t targetIndexCount, float maximumError, float& outError)
+	{
+		std::vector<unsigned int> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+		outError = 0.0f;
+
+		if (result.size() <= targetIndexCount || positions.empty()) { return result; }
+
+		std::vector<bool> isLocked = FindLockedVertices(positions, result);
+
+		//--- Add the plane of every triangle to the quadrics of its three vertices
+		std::vector<Quadric> quadrics(positions.size());
+		memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+
+		for (size_t i = 0; i < result.size(); i += 3) {
+
+			const glm::vec3& a = positions[result[i]];
+			glm::vec3 normal = glm::cross(positions[result[i + 1]] - a, positions[result[i + 2]] - a);
+
+			float length = glm::length(normal);
+			if (length <= 0.0f) { continue; }
+
+			normal /= length;
+
+			for (unsigned int corner = 0; corner < 3; corner++) { quadrics[result[i + corner]].AddPlane(normal, -glm::dot(normal, a), length * 0.5f); }
+		}
+
+		double maximumSquaredError = (double)maximumError * maximumError;
+
+		std::vector<unsigned int> offsets(positions.size() + 1), adjacency, collapseTo(positions.size());
+		std::vector<bool> isTouched(positions.size());
+		std::vector<Collapse> collapses;
+
+		//--- Each pass collapses as many edges as it can without two collapses touching the same triangles
+		while (result.size() > targetIndexCount) {
+
+			//--- Build a list of the triangles around each vertex
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for (unsigned int index : result) { offsets[index + 1]++; }
+			for (size_t vertex = 0; vertex < positions.size(); vertex++) { offsets[vertex + 1] += offsets[vertex]; }
+
+			adjacency.resize(result.size());
+			{
+				std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+				for (size_t i = 0; i < result.size(); i++) { adjacency[cursor[result[i]]++] = (unsigned int)(i / 3); }
+			}
+
+			//--- Find the cheapest collapse for every vertex that is allowed to move
+			collapses.clear();
+
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (unsigned int corner = 0; corner < 6; corner++) {
+
+					//--- Both directions of each edge: 0->1, 1->2, 2->0, then 1->0, 2->1, 0->2
+					unsigned int from	= result[i + ((corner < 3) ? corner : (corner - 2) % 3)];
+					unsigned int to		= result[i + ((corner < 3) ? (corner + 1) % 3 : corner - 3)];
+
+					if (from == to || isLocked[from]) { continue; }
+
+					Quadric quadric = quadrics[from];
+					quadric.Add(quadrics[to]);
+
+					collapses.push_back({ from, to, quadric.Evaluate(positions[to]) });
+				}
+			}
+
+			if (collapses.empty()) { break; }
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& first, const Collapse& second) {
+				return (first.error != second.error) ? first.error < second.error
+													 : (first.from != second.from) ? first.from < second.from : first.to < second.to;
+			});
+
+			std::fill(isTouched.begin(), isTouched.end(), false);
+			for (unsigned int vertex = 0; vertex < collapseTo.size(); vertex++) { collapseTo[vertex] = vertex; }
+
+			size_t triangleCount	= result.size() / 3;
+			size_t targetTriangles	= targetIndexCount / 3;
+			bool hasCollapsed		= false;
+
+			for (const Collapse& collapse : collapses) {
+
+				if (collapse.error > maximumSquaredError || triangleCount <= targetTriangles) { break; }
+				if (isTouched[collapse.from] || isTouched[collapse.to]) { continue; }
+
+				const unsigned int* triangles	= &adjacency[offsets[collapse.from]];
+				unsigned int count				= offsets[collapse.from + 1] - offsets[collapse.from];
+
+				if (IsFlipped(positions, result, triangles, count, collapse.from, collapse.to)) { continue; }
+
+				//--- Lock everything around this collapse for the rest of the pass, so the next collapse sees the
+				//--- triangles as they really are
+				for (unsigned int i = 0; i < count; i++) {
+
+					const unsigned int* triangle = &result[triangles[i] * 3];
+
+					for (unsigned int corner = 0; corner < 3; corner++) { isTouched[triangle[corner]] = true; }
+
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) { triangleCount--; }
+				}
+
+				collapseTo[collapse.from] = collapse.to;
+				quadrics[collapse.to].Add(quadrics[collapse.from]);
+				outError		= std::max(outError, (float)std::sqrt(collapse.error));
+				hasCollapsed	= true;
+			}
+
+			if (!hasCollapsed) { break; }
+
+			//--- Apply the collapses and throw away the triangles that have collapsed to a line
+			size_t write = 0;
+
+			for (size_t i = 0; i < result.size(); i += 3) {
+
+				unsigned int a = collapseTo[result[i]], b = collapseTo[result[i + 1]], c = collapseTo[result[i + 2]];
+
+				if (a == b || b == c || c == a) { continue; }
+
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+
+			result.resize(write);
+		}
+
+		return result;
+	}
+
+
+	/*******************************************************************************************************************
+		Builds the LOD chain for a mesh. Each level is simplified from the one before (which is much quicker than
+		starting from the full mesh each time), so its error is added on to the error of the level before.
+		The LODs are appended to the indices and the returned table says where each one is - LOD 0 is the original mesh
+	*******************************************************************************************************************/
+	std::vector<Lod> GenerateLods(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& indices, const std::string& tag)
+	{
+		std::vector<Lod> lods = { { 0, (unsigned int)indices.size(), 0.0f } };
+
+		if (vertices.empty() || indices.size() < 3) { return lods; }
+
+		std::vector<glm::vec3> positions;
+		positions.reserve(vertices.size());
+
+		glm::vec3 minimum = vertices.front().position, maximum = vertices.front().position;
+
+		for (const VertexBuffer::PackedVertex& vertex : vertices) {
+			positions.push_back(vertex.position);
+			minimum = glm::min(minimum, vertex.position);
+			maximum = glm::max(maximum, vertex.position);
+		}
+
+		glm::vec3 size		= maximum - minimum;
+		float maximumError	= std::max(size.x, std::max(size.y, size.z)) * MAXIMUM_LOD_ERROR;
+
+		std::vector<unsigned int> previous(indices);
+		float error = 0.0f;
+
+		while (lods.size() < MAXIMUM_LODS && previous.size() / 3 > MINIMUM_LOD_TRIANGLES) {
+
+			float levelError = 0.0f;
+			std::vector<unsigned int> lod = Simplify(positions, previous, previous.size() / 6 * 3, maximumError - error, levelError);
+
+			if (lod.size() < 3 || lod.size() > previous.size() * MINIMUM_LOD_REDUCTION) { break; }
+
+			mesh_optimizer::OptimizeVertexCache(lod, vertices.size());
+
+			error += levelError;
+			lods.push_back({ (unsigned int)indices.size(), (unsigned int)lod.size(), error });
+			indices.insert(indices.end(), lod.begin(), lod.end());
+
+			FL_LOG("[MESH SIMPLIFIER] " + tag + " - LOD " + NumberToString(lods.size() - 1) + ": " + NumberToString(lod.size() / 3) +
+				   " triangles, error: ", error, LOG_MESSAGE);
+
+			previous.swap(lod);
+		}
+
+		return lods;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+/*******************************************************************************************************************
+	MeshSimplifier.h, MeshSimplifier.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Generates lower detail versions (LODs) of a mesh by collapsing edges, using quadric error metrics.
+	References: Surface Simplification Using Quadric Error Metrics, by Michael Garland and Paul Heckbert
+
+	[Features]
+	Each vertex keeps a quadric - the sum of the (area weighted) planes of the triangles around it - which tells us
+	how far the surface would move if the vertex moved. The cheapest edges are collapsed first, a batch at a time,
+	until the target triangle count or the maximum error is reached.
+	Vertices are only ever collapsed on to other existing vertices, so every LOD shares the same vertex buffer and
+	only needs its own range of indices.
+	Returns the error of the LOD in object space, which is used to pick a LOD based on how many pixels that error
+	would cover on screen (see Model::SelectLod).
+	GenerateLods builds a chain of up to MAXIMUM_LODS levels, each with about half the triangles of the one before,
+	and appends them all to the one index array.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Vertices on a texture seam or an open border are locked (other vertices can collapse on to them but they never
+	move), so seams never tear and holes never grow. This limits how far meshes with lots of seams can be reduced.
+	Collapses that would flip a triangle over are rejected.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include <string>
+#include "VertexBuffer.h"
+
+namespace mesh_simplifier {
+
+	struct Lod {
+		unsigned int	indexOffset;
+		unsigned int	indexCount;
+		float			error;
+	};
+
+	std::vector<unsigned int> Simplify(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+									   size_t targetIndexCount, float maximumError, float& outError);
+
+	std::vector<Lod> GenerateLods(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& indices, const std::string& tag);
+}
\ No newline at end of file
@@ -7,14 +7,20 @@
 #include "Model.h"
 #include "Log.h"
 #include "ResourceManager.h"
+#include "BakedMesh.h"
+#include "MeshOptimizer.h"
+#include "ScreenManager.h"
+#include "VertexCompressor.h"
+#include "VirtualFile.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
 *******************************************************************************************************************/
-Model::Model(const std::string& obj)
-	:	m_tag(obj)
+Model::Model(const std::string& obj, bool isCompact, bool isOccluder)
+	:	m_tag(obj),
+		m_lod(0)
 {
-	Load();
+	Load(isCompact, isOccluder);
 }
 
 
@@ -32,35 +38,251 @@ Model::~Model()
 *******************************************************************************************************************/
 void Model::Render()
 {
+	//--- If the model is still being loaded, there's nothing to draw yet
+	if (!IsResident()) { return; }
+
 	//--- Bind the VAO related to this model
 	Resource::Instance()->GetVAO(m_tag)->Bind();
 
-	//--- Render the EBO related to this model
-	Resource::Instance()->GetEBO(m_tag)->Render();
+	//--- Render the range of the EBO that holds the current LOD of this model
+	auto lods = s_lods.find(m_tag);
+
+	if (lods != s_lods.end() && m_lod < lods->second.size()) {
+		const mesh_simplifier::Lod& lod = lods->second[m_lod];
+		Resource::Instance()->GetEBO(m_tag)->Render(GL_TRIANGLES, lod.indexCount, lod.indexOffset);
+	}
+	else {
+		Resource::Instance()->GetEBO(m_tag)->Render();
+	}
 }
 
 
 /*******************************************************************************************************************
-	Function that loads the object data from an OBJ file using Assimp and stores the data into the relevant vectors
+	Picks which LOD to draw, based on how many pixels the error of each LOD would cover at this distance.
+	The scale is the model's largest scale, as the errors are stored in model space
 *******************************************************************************************************************/
-bool Model::Load()
+void Model::SelectLod(float distance, float scale)
+{
+	auto lods = s_lods.find(m_tag);
+
+	if (lods == s_lods.end()) { return; }
+
+	//--- How many pixels one unit covers at this distance (the projection's [1][1] is 1 / tan(fov / 2))
+	float pixelsPerUnit = Screen::Instance()->GetHeight() * 0.5f * Screen::Instance()->GetProjectionMatrix()[1][1] / std::max(distance, 0.1f);
+
+	unsigned int selected = 0;
+
+	for (unsigned int lod = 1; lod < lods->second.size(); lod++) {
+
+		//--- Dropping to a lower detail LOD than we're on now has to pass a stricter test than staying on it
+		float threshold = (lod > m_lod) ? s_lodPixelError * (1.0f - s_lodHysteresis) : s_lodPixelError;
+
+		if (lods->second[lod].error * scale * pixelsPerUnit > threshold) { break; }
+
+		selected = lod;
+	}
+
+	m_lod = selected;
+}
+
+
+/*******************************************************************************************************************
+	Function that loads the model, on a worker thread if asynchronous loading is switched on
+*******************************************************************************************************************/
+bool Model::Load(bool isCompact, bool isOccluder)
 {
 	if (m_tag.empty()) { return false; }
 
+	//--- The vertex format is chosen when a model is first loaded, so any later request for the other one is ignored
+	auto format = s_isCompact.try_emplace(m_tag, isCompact);
+
+	if (!format.second && format.first->second != isCompact) {
+		FL_LOG("[MODEL] Model already loaded with a different vertex format, model.compact ignored for: ", m_tag.c_str(), LOG_WARN);
+	}
+
+	//--- An occluder can be asked for after the model was first loaded without one, so it's copied on its own
+	auto occluder = s_isOccluder.try_emplace(m_tag, isOccluder);
+	bool isOccluderAdded = (!occluder.second && isOccluder && !occluder.first->second);
+
+	if (isOccluderAdded) { occluder.first->second = true; }
+
 	//--- Check if we already have a model with this tag and if so exit function and use pre-existing data
-	if (!Resource::Instance()->AddPackedBuffers(m_tag, true)) { return false; }
+	if (!Resource::Instance()->AddPackedBuffers(m_tag, true)) {
+		if (isOccluderAdded) { LoadOccluder(m_tag); }
+		return false;
+	}
+
+	//--- Read the file on a worker and upload it on the main thread when it's ready. Only the tag is captured,
+	//--- as this model is usually a temporary that gets copied in to an entity
+	if (Resource::Instance()->IsAsyncLoading()) {
+
+		std::string tag = m_tag;
+
+		Resource::Instance()->LoadAsync<MeshData>(	[tag, isCompact, isOccluder](MeshData& mesh) { return Read(tag, isCompact, isOccluder, mesh); },
+													[tag](MeshData& mesh) { Upload(tag, mesh); });
+		return true;
+	}
+
+	MeshData mesh;
+
+	if (!Read(m_tag, isCompact, isOccluder, mesh)) { return false; }
+
+	Upload(m_tag, mesh);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that copies the occluder of a model that is already loaded (or loading) without one. The model is read
+	again - from its baked file, if it has one - on a worker thread if asynchronous loading is switched on
+*******************************************************************************************************************/
+void Model::LoadOccluder(const std::string& tag)
+{
+	if (Resource::Instance()->IsAsyncLoading()) {
+
+		Resource::Instance()->LoadAsync<MeshData>(	[tag](MeshData& mesh) { return Read(tag, false, true, mesh); },
+													[tag](MeshData& mesh) { s_occluders.try_emplace(tag, std::move(mesh.occluder)); });
+		return;
+	}
+
+	MeshData mesh;
+
+	if (!Read(tag, false, true, mesh)) { return; }
+
+	s_occluders.try_emplace(tag, std::move(mesh.occluder));
+}
+
+
+/*******************************************************************************************************************
+	Function that reads the model from its baked .cogmesh file if it is up to date, otherwise from the source file.
+	No OpenGL calls are made here, so this is safe to run on a worker thread
+*******************************************************************************************************************/
+bool Model::Read(const std::string& tag, bool isCompact, bool isOccluder, MeshData& mesh)
+{
+	std::string src		= "Assets\\Models\\" + tag;
+	std::string baked	= src + ".cogmesh";
+
+	//--- No baked file (or it's out of date), so load the source with Assimp and bake it for next time
+	if (!ReadBaked(baked, src, mesh) && !ReadSource(src, baked, mesh)) { return false; }
+
+	//--- The baked file is always full precision, so quantising is done here (on the worker, if loading asynchronously)
+	if (isCompact) { Compress(mesh); }
+
+	if (isOccluder) { CopyOccluder(mesh); }
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that quantises the vertices and indices of the model in to the compact vertex format
+*******************************************************************************************************************/
+void Model::Compress(MeshData& mesh)
+{
+	const VertexBuffer::PackedVertex* vertices	= (mesh.baked) ? mesh.baked->GetVertices() : mesh.vertices.data();
+	const unsigned int* indices					= (mesh.baked) ? mesh.baked->GetIndices() : mesh.indices.data();
+	size_t vertexCount							= (mesh.baked) ? mesh.baked->GetVertexCount() : mesh.vertices.size();
+	size_t indexCount							= (mesh.baked) ? mesh.baked->GetIndexCount() : mesh.indices.size();
+
+	mesh.decode = vertex_compressor::CompressVertices(vertices, vertexCount, mesh.compactVertices);
+
+	//--- Models with too many vertices for 16-bit indices keep their 32-bit indices
+	vertex_compressor::CompressIndices(indices, indexCount, vertexCount, mesh.compactIndices);
+}
+
+
+/*******************************************************************************************************************
+	Function that copies the positions and full detail indices of the model, for rasterising it as an occluder on the
+	CPU. The simplified LODs can bulge outside the real surface, and would hide things that can really be seen
+*******************************************************************************************************************/
+void Model::CopyOccluder(MeshData& mesh)
+{
+	const VertexBuffer::PackedVertex* vertices	= (mesh.baked) ? mesh.baked->GetVertices() : mesh.vertices.data();
+	const unsigned int* indices					= (mesh.baked) ? mesh.baked->GetIndices() : mesh.indices.data();
+	size_t vertexCount							= (mesh.baked) ? mesh.baked->GetVertexCount() : mesh.vertices.size();
+	size_t indexCount							= (mesh.baked) ? mesh.baked->GetIndexCount() : mesh.indices.size();
+
+	//--- The LODs share one index buffer, with the full detail model first
+	if (!mesh.lods.empty()) { indexCount = mesh.lods.front().indexCount; }
+
+	mesh.occluder.positions.resize(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) { mesh.occluder.positions[vertex] = vertices[vertex].position; }
+
+	mesh.occluder.indices.assign(indices, indices + indexCount);
+}
+
+
+/*******************************************************************************************************************
+	Function that maps a baked model - no Assimp, no parsing, no copies
+*******************************************************************************************************************/
+bool Model::ReadBaked(const std::string& baked, const std::string& src, MeshData& mesh)
+{
+	mesh.baked = std::make_shared<BakedMesh>();
+
+	if (!mesh.baked->Open(baked, src)) { mesh.baked.reset(); return false; }
+
+	//--- The dimensions were calculated when the model was baked
+	mesh.dimension = mesh.baked->GetDimension();
+	mesh.lods.assign(mesh.baked->GetLods(), mesh.baked->GetLods() + mesh.baked->GetLodCount());
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that pushes the vertex and index data to the GPU - this must be called on the main thread
+*******************************************************************************************************************/
+void Model::Upload(const std::string& tag, MeshData& mesh)
+{
+	//--- Bind the VAO and push vertex and index buffer data to the GPU (straight from the mapped file, if baked)
+	Resource::Instance()->GetVAO(tag)->Bind();
+
+	VertexBuffer* vertexBuffer	= Resource::Instance()->GetPackedVBO(tag);
+	IndexBuffer* indexBuffer	= Resource::Instance()->GetEBO(tag);
+
+	if (!mesh.compactVertices.empty())	{ vertexBuffer->Push(mesh.compactVertices, false); }
+	else if (mesh.baked)				{ vertexBuffer->Push(mesh.baked->GetVertices(), mesh.baked->GetVertexCount(), false); }
+	else								{ vertexBuffer->Push(mesh.vertices, false); }
 
-	std::string src = "Assets\\Models\\" + m_tag;
+	if (!mesh.compactIndices.empty())	{ indexBuffer->Push(mesh.compactIndices); }
+	else if (mesh.baked)				{ indexBuffer->Push(mesh.baked->GetIndices(), mesh.baked->GetIndexCount()); }
+	else								{ indexBuffer->Push(mesh.indices); }
 
-	//--- Load in the model using Assimp
-	const aiScene* scene = aiImportFile(src.c_str(),	aiProcess_Triangulate |
-														aiProcess_FixInfacingNormals |
-														aiProcess_CalcTangentSpace |
-														aiProcess_FindInvalidData |
-														aiProcess_OptimizeMeshes |
-														aiProcess_OptimizeGraph |
-														aiProcess_FlipUVs |
-														aiProcess_ValidateDataStructure);
+	Resource::Instance()->GetVAO(tag)->Unbind();
+
+	//--- The model is now resident, and can be rendered
+	if (!mesh.compactVertices.empty()) { s_decodeMatrices.try_emplace(tag, mesh.decode); }
+	if (!mesh.occluder.indices.empty()) { s_occluders.try_emplace(tag, std::move(mesh.occluder)); }
+
+	s_lods.try_emplace(tag, mesh.lods);
+	m_dimensions.try_emplace(tag, mesh.dimension);
+
+	FL_LOG("[MODEL] Model created: ", tag.c_str(), LOG_RESOURCE);
+}
+
+
+/*******************************************************************************************************************
+	Function that loads the object data from an OBJ file using Assimp and stores the data into the relevant vectors
+*******************************************************************************************************************/
+bool Model::ReadSource(const std::string& src, const std::string& baked, MeshData& mesh)
+{
+	//--- Load in the model using Assimp, from a pack or from disk. The extension tells Assimp which format the data is in
+	VirtualFile file;
+
+	if (!file.Open(src)) { return false; }
+
+	size_t extension	= src.find_last_of('.');
+	std::string format	= (extension != std::string::npos) ? src.substr(extension + 1) : std::string();
+
+	const aiScene* scene = aiImportFileFromMemory(file.GetData(), (unsigned int)file.GetSize(),	aiProcess_Triangulate |
+																								aiProcess_FixInfacingNormals |
+																								aiProcess_CalcTangentSpace |
+																								aiProcess_FindInvalidData |
+																								aiProcess_OptimizeMeshes |
+																								aiProcess_OptimizeGraph |
+																								aiProcess_FlipUVs |
+																								aiProcess_ValidateDataStructure, format.c_str());
 
 	//--- Check for any errors
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
@@ -79,9 +301,11 @@ bool Model::Load()
 		vertexCount += scene->mMeshes[mesh]->mNumVertices;
 	}
 
-	//--- Create our temporary vectors, resizing/reserving memory as necessary
-	std::vector<VertexBuffer::PackedVertex> packedVertex(vertexCount);
-	std::vector<unsigned int> indices;
+	//--- Resize/reserve memory in our vectors as necessary
+	std::vector<VertexBuffer::PackedVertex>& packedVertex	= mesh.vertices;
+	std::vector<unsigned int>& indices						= mesh.indices;
+
+	packedVertex.resize(vertexCount);
 	indices.reserve(vertexCount);
 
 	//--- Get all the data from the file and store this into our containers
@@ -122,19 +346,25 @@ bool Model::Load()
 		}
 	}
 
-	//--- Bind the VAO and push vertex and index buffer data to the GPU
-	Resource::Instance()->GetVAO(m_tag)->Bind();
-		Resource::Instance()->GetPackedVBO(m_tag)->Push(packedVertex, false);
-		Resource::Instance()->GetEBO(m_tag)->Push(indices);
-	Resource::Instance()->GetVAO(m_tag)->Unbind();
+	//--- The baked file is stamped with the bytes it was made from, so it goes out of date when they change
+	unsigned long long sourceHash = file.GenerateHash();
 
-	//--- Destroy the data now the GPU has it
+	//--- Destroy the scene now we have copied the data out of it
 	aiReleaseImport(scene);
 
+	//--- Reorder the triangles and vertices so the model draws faster - this is baked in, so it only happens once
+	mesh_optimizer::OptimizeMesh(packedVertex, indices, src);
+
+	//--- Build the lower detail LODs, which are added to the end of the indices
+	mesh.lods = mesh_simplifier::GenerateLods(packedVertex, indices, src);
+
 	//--- Calculate the models' width, height and depth, which we will need for any collisions
-	CalculateDimension(packedVertex);
+	mesh.dimension = CalculateDimension(packedVertex);
+
+	//--- Bake the model, so that next time it can be loaded without Assimp
+	BakedMesh::Write(baked, sourceHash, packedVertex, indices, mesh.lods, mesh.dimension);
 
-	FL_LOG("[MODEL] Assimp model created: ", m_tag.c_str(), LOG_RESOURCE);
+	FL_LOG("[MODEL] Assimp model loaded: ", src.c_str(), LOG_RESOURCE);
 
 	return true;
 }
@@ -143,14 +373,14 @@ bool Model::Load()
 /*******************************************************************************************************************
 	Function that calculates the dimensions of a 3D model, based on min/max values of its vertices
 *******************************************************************************************************************/
-void Model::CalculateDimension(std::vector<VertexBuffer::PackedVertex>& container)
+glm::vec3 Model::CalculateDimension(const std::vector<VertexBuffer::PackedVertex>& container)
 {
+	glm::vec3 dimension = glm::vec3(0.0f);
+
 	if (!container.empty()) {
-	
-		glm::vec3 dimension = glm::vec3(0.0f);
 		
 		//--- Find the min and max value of the X vertex position
-		auto& x = std::minmax_element(container.begin(), container.end(),
+		auto x = std::minmax_element(container.begin(), container.end(),
 			[](const VertexBuffer::PackedVertex& first, const VertexBuffer::PackedVertex& second) {
 			return first.position.x < second.position.x;
 		});
@@ -159,7 +389,7 @@ void Model::CalculateDimension(std::vector<VertexBuffer::PackedVertex>& containe
 		dimension.x = (glm::distance(x.first->position.x, x.second->position.x));
 
 		//--- Find the min and max value of the Y vertex position
-		auto& y = std::minmax_element(container.begin(), container.end(),
+		auto y = std::minmax_element(container.begin(), container.end(),
 			[](const VertexBuffer::PackedVertex& first, const VertexBuffer::PackedVertex& second) {
 			return first.position.y < second.position.y;
 		});
@@ -168,26 +398,56 @@ void Model::CalculateDimension(std::vector<VertexBuffer::PackedVertex>& containe
 		dimension.y = (glm::distance(y.first->position.y, y.second->position.y));
 
 		//--- Find the min and max value of the Z vertex position
-		auto& z = std::minmax_element(container.begin(), container.end(),
+		auto z = std::minmax_element(container.begin(), container.end(),
 			[](const VertexBuffer::PackedVertex& first, const VertexBuffer::PackedVertex& second) {
 			return first.position.z < second.position.z;
 		});
 
 		//--- Store the depth value
 		dimension.z = (glm::distance(z.first->position.z, z.second->position.z));
-
-		m_dimensions.try_emplace(m_tag, dimension);
 	}
+
+	return dimension;
 }
 
 
 /*******************************************************************************************************************
 	Accessor methods
 *******************************************************************************************************************/
-const glm::vec3& Model::GetDimension() const { return m_dimensions[m_tag]; }
+const glm::vec3& Model::GetDimension() const
+{
+	//--- Models still loading have no dimensions yet
+	auto dimension = m_dimensions.find(m_tag);
+	return (dimension != m_dimensions.end()) ? dimension->second : s_noDimension;
+}
+
+bool Model::IsResident() const		{ return m_dimensions.find(m_tag) != m_dimensions.end(); }
+unsigned int Model::GetLod() const	{ return m_lod; }
+
+const Model::Occluder* Model::GetOccluder() const
+{
+	//--- Only models loaded as occluders have one, and only once they're resident
+	auto occluder = s_occluders.find(m_tag);
+	return (occluder != s_occluders.end()) ? &occluder->second : nullptr;
+}
+
+const glm::mat4* Model::GetDecodeMatrix() const
+{
+	//--- Only models using the compact vertex format have a decode matrix
+	auto decode = s_decodeMatrices.find(m_tag);
+	return (decode != s_decodeMatrices.end()) ? &decode->second : nullptr;
+}
 
 
 /*******************************************************************************************************************
 	Static variables and functions
 *******************************************************************************************************************/
-std::map<std::string, glm::vec3> Model::m_dimensions;
\ No newline at end of file
+std::map<std::string, glm::vec3> Model::m_dimensions;
+std::map<std::string, std::vector<mesh_simplifier::Lod>> Model::s_lods;
+std::map<std::string, glm::mat4> Model::s_decodeMatrices;
+std::map<std::string, bool> Model::s_isCompact;
+std::map<std::string, bool> Model::s_isOccluder;
+std::map<std::string, Model::Occluder> Model::s_occluders;
+const glm::vec3 Model::s_noDimension	= glm::vec3(0.0f);
+const float Model::s_lodPixelError		= 1.0f;
+const float Model::s_lodHysteresis		= 0.2f;
\ No newline at end of file
@@ -10,6 +10,19 @@
 
 	[Features]
 	Supports Assimp model loading.
+	The first time a model is loaded with Assimp it is baked to a binary .cogmesh file (see BakedMesh.h), which is
+	memory mapped and pushed straight to the GPU on every load after that. If the source model is changed,
+	the baked file is ignored and the model is loaded with Assimp and baked again.
+	Models are optimized for the vertex cache, overdraw and vertex fetch before they are baked (see MeshOptimizer.h).
+	Models get a chain of simplified LODs when they are baked (see MeshSimplifier.h). Each model instance picks the
+	lowest detail LOD whose error would cover less than s_lodPixelError pixels on screen, with some hysteresis so
+	models don't flicker between two LODs when they sit on the boundary.
+	Models can opt in to a quantised vertex format (see VertexCompressor.h) that uses less than half the memory.
+	The format belongs to the model, not the entity - the first entity to load a model decides it for every other.
+	Models can opt in to being occluders, keeping a copy of their full detail positions and indices on the CPU, for
+	hiding other objects behind them in software (see OcclusionBuffer.h). Unlike the vertex format, a model first
+	loaded without an occluder gets one copied as soon as any entity asks for it.
+	Supports asynchronous loading (see ResourceManager.h) - the model isn't drawn until it is resident.
 	Models only get created once - all models with the same name will re-use models already loaded.
 	(See ResourceManager to see how this works)
 	Supports obtaining the min/max extents of a model; able to retrieve width, height and depth
@@ -24,27 +37,73 @@
 *******************************************************************************************************************/
 #include <map>
 #include <string>
+#include <memory>
 #include "VertexBuffer.h"
+#include "MeshSimplifier.h"
+
+class BakedMesh;
 
 class Model {
 
 public:
-	Model(const std::string& obj);
+	struct Occluder {
+		std::vector<glm::vec3>		positions;
+		std::vector<unsigned int>	indices;
+	};
+
+private:
+	struct MeshData {
+		std::shared_ptr<BakedMesh>					baked;
+		std::vector<VertexBuffer::PackedVertex>		vertices;
+		std::vector<unsigned int>					indices;
+		std::vector<mesh_simplifier::Lod>			lods;
+		glm::vec3									dimension;
+		std::vector<VertexBuffer::CompactVertex>	compactVertices;
+		std::vector<GLushort>						compactIndices;
+		glm::mat4									decode;
+		Occluder									occluder;
+	};
+
+public:
+	Model(const std::string& obj, bool isCompact = false, bool isOccluder = false);
 	~Model();
 
 public:
 	void Render();
+	void SelectLod(float distance, float scale);
 
 public:
 	const glm::vec3& GetDimension() const;
+	bool IsResident() const;
+	unsigned int GetLod() const;
+	const glm::mat4* GetDecodeMatrix() const;
+	const Occluder* GetOccluder() const;
+
+private:
+	bool Load(bool isCompact, bool isOccluder);
 
 private:
-	bool Load();
-	void CalculateDimension(std::vector<VertexBuffer::PackedVertex>& container);
+	static void			LoadOccluder(const std::string& tag);
+	static bool			Read(const std::string& tag, bool isCompact, bool isOccluder, MeshData& mesh);
+	static bool			ReadBaked(const std::string& baked, const std::string& src, MeshData& mesh);
+	static bool			ReadSource(const std::string& src, const std::string& baked, MeshData& mesh);
+	static void			Compress(MeshData& mesh);
+	static void			CopyOccluder(MeshData& mesh);
+	static void			Upload(const std::string& tag, MeshData& mesh);
+	static glm::vec3	CalculateDimension(const std::vector<VertexBuffer::PackedVertex>& container);
 
 private:
-	std::string	m_tag;
+	std::string		m_tag;
+	unsigned int	m_lod;
 
 private:
 	static std::map<std::string, glm::vec3> m_dimensions;
+	static std::map<std::string, std::vector<mesh_simplifier::Lod>> s_lods;
+	static std::map<std::string, glm::mat4> s_decodeMatrices;
+	static std::map<std::string, bool> s_isCompact;
+	static std::map<std::string, bool> s_isOccluder;
+	static std::map<std::string, Occluder> s_occluders;
+	static const glm::vec3 s_noDimension;
+	static const float s_lodPixelError;
+	static const float s_lodHysteresis;
 };
\ No newline at end of file
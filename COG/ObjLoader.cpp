@@ -2,11 +2,17 @@
 #include "FileManager.h"
 #include "Log.h"
 #include "Tools.h"
+#include "VirtualFile.h"
+#include "VertexIndexer.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
 *******************************************************************************************************************/
-ObjLoader::ObjLoader()
+ObjLoader::ObjLoader(bool parallelIndexing)
+	:	m_parallelIndexing(parallelIndexing)
 {
 	FL_LOG("[OBJ LOADER CONSTRUCT]", FL_LOG_EMPTY, LOG_BREAK);
 }
@@ -25,10 +31,343 @@ ObjLoader::~ObjLoader()
 	Load an OBJ file and store the contents into the vector containers passed in
 *******************************************************************************************************************/
 bool ObjLoader::LoadObjFile(const std::string& obj, std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>* outIndices)
+{
+	//--- Map the OBJ file into memory (or find it in a pack), we read straight from its bytes from here on in
+	VirtualFile file;
+
+	if (!file.Open(obj)) { return false; }
+
+	const char* cursor	= file.GetData();
+	const char* end		= cursor + file.GetSize();
+
+	//--- Generate temporary vectors to store the obj data. We have no idea how many of each there are until
+	//--- we have scanned the file, so make a rough guess from the file size (roughly 32 bytes per line) to avoid most re-allocations
+	std::vector<glm::vec3> inVertices;
+	std::vector<glm::vec2> inTextureCoords;
+	std::vector<glm::vec3> inNormals;
+
+	size_t estimate = file.GetSize() / s_bytesPerLineEstimate;
+
+	inVertices.reserve(estimate / 4);
+	inTextureCoords.reserve(estimate / 4);
+	inNormals.reserve(estimate / 4);
+
+	m_vertices.clear();
+	m_textureCoords.clear();
+	m_normals.clear();
+
+	//--- If we aren't indexing, face corners are written directly to the vectors passed in.
+	//--- Otherwise they are staged in our member vectors, so that duplicates can be removed afterwards
+	std::vector<glm::vec3>& vertices		= (outIndices) ? m_vertices : outVertices;
+	std::vector<glm::vec2>& textureCoords	= (outIndices) ? m_textureCoords : outTextureCoords;
+	std::vector<glm::vec3>& normals			= (outIndices) ? m_normals : outNormals;
+
+	vertices.reserve(vertices.size() + estimate);
+	textureCoords.reserve(textureCoords.size() + estimate);
+	normals.reserve(normals.size() + estimate);
+
+	while (cursor < end) {
+
+		SkipSpaces(cursor, end);
+
+		if (cursor >= end) { break; }
+
+		//--- Check if the line begins with "v ", "vt ", "vn " or "f " and read in the data that follows
+		if (*cursor == 'v') {
+
+			if (IsSpace(cursor + 1, end)) {
+				cursor += 1;
+				glm::vec3 vertex(0.0f);
+				vertex.x = ParseFloat(cursor, end);
+				vertex.y = ParseFloat(cursor, end);
+				vertex.z = ParseFloat(cursor, end);
+				inVertices.emplace_back(vertex);
+			}
+			else if (cursor + 1 < end && cursor[1] == 't' && IsSpace(cursor + 2, end)) {
+				cursor += 2;
+				glm::vec2 textureCoord(0.0f);
+				textureCoord.s = ParseFloat(cursor, end);
+				textureCoord.t = ParseFloat(cursor, end);
+				inTextureCoords.emplace_back(textureCoord);
+			}
+			else if (cursor + 1 < end && cursor[1] == 'n' && IsSpace(cursor + 2, end)) {
+				cursor += 2;
+				glm::vec3 normal(0.0f);
+				normal.x = ParseFloat(cursor, end);
+				normal.y = ParseFloat(cursor, end);
+				normal.z = ParseFloat(cursor, end);
+				inNormals.emplace_back(normal);
+			}
+		}
+		else if (*cursor == 'f' && IsSpace(cursor + 1, end)) {
+			cursor += 1;
+			if (!GetFace(cursor, end, inVertices, inTextureCoords, inNormals, vertices, textureCoords, normals)) {
+				FL_LOG("[OBJ LOADER] Malformed face, it references data that doesn't exist: ", obj.c_str(), LOG_ERROR);
+				return false;
+			}
+		}
+
+		//--- Anything else (comments, groups, materials, etc.) is ignored
+		SkipLine(cursor, end);
+	}
+
+	//--- If we want to draw elements index-based (to avoid duplicated vertex data), we then call this function,
+	//--- which checks for multiple vertex data and then finally pushes the data to the out vectors
+	if (outIndices) { GenerateIndexedObject(outVertices, outTextureCoords, outNormals, *outIndices); }
+
+	//--- The mapping is released when the file goes out of scope
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that reads a face (of any number of corners) and writes its triangles into the vectors passed in
+*******************************************************************************************************************/
+bool ObjLoader::GetFace(const char*& cursor, const char* end, const std::vector<glm::vec3>& inVertices, const std::vector<glm::vec2>& inTextureCoords,
+						const std::vector<glm::vec3>& inNormals, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& textureCoords, std::vector<glm::vec3>& normals)
+{
+	FaceCorner first	= { 0, -1, -1 };
+	FaceCorner previous = { 0, -1, -1 };
+	FaceCorner current	= { 0, -1, -1 };
+
+	unsigned int cornerCount = 0;
+
+	//--- Read every corner on the line. Faces with more than 3 corners are triangulated as a fan around the first corner
+	while (GetFaceCorner(cursor, end, current)) {
+
+		if (!ResolveFaceCorner(current, inVertices.size(), inTextureCoords.size(), inNormals.size())) { return false; }
+
+		if (cornerCount >= 2) {
+
+			const FaceCorner* triangle[] = { &first, &previous, &current };
+
+			for (const FaceCorner* corner : triangle) {
+				vertices.emplace_back(inVertices[corner->vertex]);
+				textureCoords.emplace_back((corner->textureCoord >= 0) ? inTextureCoords[corner->textureCoord] : glm::vec2(0.0f));
+				normals.emplace_back((corner->normal >= 0) ? inNormals[corner->normal] : glm::vec3(0.0f));
+			}
+		}
+
+		if (cornerCount == 0) { first = current; }
+
+		previous = current;
+		cornerCount++;
+	}
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that reads a single face corner in the form v, v/vt, v//vn or v/vt/vn
+*******************************************************************************************************************/
+bool ObjLoader::GetFaceCorner(const char*& cursor, const char* end, FaceCorner& corner)
+{
+	corner = { 0, 0, 0 };
+
+	SkipSpaces(cursor, end);
+
+	if (!ParseInteger(cursor, end, corner.vertex)) { return false; }
+
+	if (cursor < end && *cursor == '/') {
+		cursor++;
+		ParseInteger(cursor, end, corner.textureCoord);
+
+		if (cursor < end && *cursor == '/') {
+			cursor++;
+			ParseInteger(cursor, end, corner.normal);
+		}
+	}
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that converts OBJ indices (which start from 1, or are negative when relative) to array indices
+*******************************************************************************************************************/
+bool ObjLoader::ResolveFaceCorner(FaceCorner& corner, size_t vertexCount, size_t textureCoordCount, size_t normalCount)
+{
+	//--- A zero index means the data wasn't given (or, for the vertex, is treated as the first vertex like before).
+	//--- Negative indices count backwards from the most recently read data, and must not count back past the first
+	auto resolve = [](int& index, size_t count, int missing) {
+		if (index > 0) { index = index - 1;				return index < (int)count; }
+		if (index < 0) { index = (int)count + index;	return index >= 0; }
+
+		index = missing;
+		return index < (int)count;
+	};
+
+	if (!resolve(corner.vertex, vertexCount, 0) || corner.vertex < 0)	{ return false; }
+	if (!resolve(corner.textureCoord, textureCoordCount, -1))			{ return false; }
+	if (!resolve(corner.normal, normalCount, -1))						{ return false; }
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that finalizes the file data, disregards duplicate vertices and pushes it to the vectors passed in
+*******************************************************************************************************************/
+void ObjLoader::GenerateIndexedObject(std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>& outIndices)
+{
+	//--- Pack each vertex so that it can be hashed and compared as one block of memory
+	std::vector<VertexBuffer::PackedVertex> packed;
+	packed.reserve(m_vertices.size());
+
+	for (unsigned int i = 0; i < m_vertices.size(); i++) {
+		packed.push_back({ m_vertices[i], m_textureCoords[i], m_normals[i], glm::vec3(0.0f), glm::vec3(0.0f) });
+	}
+
+	//--- Find the unique vertices, and the index of the unique vertex that each of our vertices maps to
+	std::vector<unsigned int> unique;
+	unique.reserve(m_vertices.size() / 4);
+
+	std::vector<unsigned int> indices;
+	VertexIndexer(m_parallelIndexing).Generate(packed, unique, indices);
+
+	//--- Reorder the triangles for the vertex cache and overdraw, then the unique vertices in the order they're used
+	std::vector<glm::vec3> positions;
+	positions.reserve(unique.size());
+	for (unsigned int vertex : unique) { positions.push_back(m_vertices[vertex]); }
+
+	mesh_optimizer::OptimizeVertexCache(indices, unique.size());
+	mesh_optimizer::OptimizeOverdraw(indices, positions);
+	mesh_optimizer::Reorder(unique, mesh_optimizer::OptimizeVertexFetch(indices, unique.size()));
+
+	//--- If the vectors passed in already contain data, our indices need to start after it
+	unsigned int indexOffset = (unsigned int)outVertices.size();
+
+	outIndices.reserve(outIndices.size() + indices.size());
+	for (unsigned int index : indices) { outIndices.emplace_back(index + indexOffset); }
+
+	//--- Push the unique vertices to the vectors passed in, in the order they were first seen
+	outVertices.reserve(outVertices.size() + unique.size());
+	outTextureCoords.reserve(outTextureCoords.size() + unique.size());
+	outNormals.reserve(outNormals.size() + unique.size());
+
+	for (unsigned int vertex : unique) {
+		outVertices.emplace_back(m_vertices[vertex]);
+		outTextureCoords.emplace_back(m_textureCoords[vertex]);
+		outNormals.emplace_back(m_normals[vertex]);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that parses a floating point number in place, moving the cursor past it
+*******************************************************************************************************************/
+float ObjLoader::ParseFloat(const char*& cursor, const char* end)
+{
+	SkipSpaces(cursor, end);
+
+	bool negative = false;
+
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) { negative = (*cursor == '-'); cursor++; }
+
+	//--- Accumulate all the digits into one integer (ignoring the decimal point) and count how many were after the point.
+	//--- Only the first 19 significant digits fit, which is far more than a float can hold anyway
+	unsigned long long mantissa	= 0;
+	int exponent				= 0;
+	int digits					= 0;
+
+	while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+		if (digits < 19)	{ mantissa = mantissa * 10 + (*cursor - '0'); if (mantissa) { digits++; } }
+		else				{ exponent++; }
+		cursor++;
+	}
+
+	if (cursor < end && *cursor == '.') {
+		cursor++;
+		while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+			if (digits < 19) { mantissa = mantissa * 10 + (*cursor - '0'); exponent--; if (mantissa) { digits++; } }
+			cursor++;
+		}
+	}
+
+	//--- Scientific notation, e.g. 1.5e-3
+	if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+		cursor++;
+		int power = 0;
+		ParseInteger(cursor, end, power);
+		exponent += power;
+	}
+
+	//--- Exact powers of ten are looked up, anything outwith the table (very rare in mesh data) falls back to pow
+	static const double powers[] = {	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+										1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	double value = (double)mantissa;
+
+	if		(exponent < 0)	{ value /= (-exponent <= 22) ? powers[-exponent] : std::pow(10.0, -exponent); }
+	else if (exponent > 0)	{ value *= (exponent <= 22) ? powers[exponent] : std::pow(10.0, exponent); }
+
+	return (float)((negative) ? -value : value);
+}
+
+
+/*******************************************************************************************************************
+	Function that parses a (signed) integer in place, returns false if there was no number to read
+*******************************************************************************************************************/
+bool ObjLoader::ParseInteger(const char*& cursor, const char* end, int& result)
+{
+	bool negative = false;
+
+	if (cursor < end && (*cursor == '-' || *cursor == '+')) { negative = (*cursor == '-'); cursor++; }
+
+	if (cursor >= end || *cursor < '0' || *cursor > '9') { return false; }
+
+	int value = 0;
+
+	while (cursor < end && *cursor >= '0' && *cursor <= '9') { value = value * 10 + (*cursor - '0'); cursor++; }
+
+	result = (negative) ? -value : value;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that moves the cursor past any spaces or tabs (but not past the end of the line)
+*******************************************************************************************************************/
+void ObjLoader::SkipSpaces(const char*& cursor, const char* end)
+{
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t')) { cursor++; }
+}
+
+
+/*******************************************************************************************************************
+	Function that moves the cursor to the beginning of the next line
+*******************************************************************************************************************/
+void ObjLoader::SkipLine(const char*& cursor, const char* end)
+{
+	const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+
+	cursor = (lineEnd) ? lineEnd + 1 : end;
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if the character at the cursor is a space or tab (tokens such as "v" must be followed by one)
+*******************************************************************************************************************/
+bool ObjLoader::IsSpace(const char* cursor, const char* end)
+{
+	return cursor < end && (*cursor == ' ' || *cursor == '\t');
+}
+
+
+/*******************************************************************************************************************
+	Load an OBJ file line by line through the FileManager and string streams (kept as a reference for benchmarking)
+*******************************************************************************************************************/
+bool ObjLoader::LoadObjFileStreamed(const std::string& obj, std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>* outIndices)
 {
 	//--- Open the OBJ file for reading only
 	if (!File::Instance()->OpenForReading(obj.c_str())) { return false; }
 
+	m_vertices.clear();
+	m_textureCoords.clear();
+	m_normals.clear();
+
 	//--- Generate temporary vectors to store the faces/indices data
 	std::vector<unsigned int> vertexIndices, textureCoordIndices, normalIndices;
 
@@ -76,57 +415,6 @@ bool ObjLoader::LoadObjFile(const std::string& obj, std::vector<glm::vec3>& outV
 }
 
 
-/*******************************************************************************************************************
-	Function that finalizes the file data, disregards duplicate vertices and pushes it to the vectors passed in
-*******************************************************************************************************************/
-void ObjLoader::GenerateIndexedObject(std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>& outIndices)
-{
-	std::map<VertexBuffer::PackedVertex, unsigned int> vertexToOutIndex;
-
-	//--- For each vertex stored in our m_vertices vector
-	for (unsigned int i = 0; i < m_vertices.size(); i++) {
-
-		VertexBuffer::PackedVertex packed = { m_vertices[i], m_textureCoords[i], m_normals[i] };
-
-		//--- Try to find a similar vertex in our vectors
-		unsigned int index = 0;
-		bool found = GetSimilarVertexIndex(packed, vertexToOutIndex, index);
-
-		//--- If we find a similar vertex, use that instead
-		if (found) { outIndices.emplace_back(index); }
-
-		//--- If not, push the data to the vectors passed in
-		else {
-			outVertices.emplace_back(m_vertices[i]);
-			outTextureCoords.emplace_back(m_textureCoords[i]);
-			outNormals.emplace_back(m_normals[i]);
-			unsigned int newIndex = (unsigned int)outVertices.size() - 1;
-			outIndices.emplace_back(newIndex);
-			vertexToOutIndex[packed] = newIndex;
-		}
-	}
-
-}
-
-
-/*******************************************************************************************************************
-	Function that checks if we have a similar vertex already stored
-*******************************************************************************************************************/
-bool ObjLoader::GetSimilarVertexIndex(VertexBuffer::PackedVertex& packed, std::map<VertexBuffer::PackedVertex, unsigned int>& vertexToOutIndex, unsigned int& result)
-{
-	//--- Loop through the map, looking for a vertex
-	std::map<VertexBuffer::PackedVertex, unsigned int>::iterator it = vertexToOutIndex.find(packed);
-
-	//--- If vertex is not found in the map, then we need to add it in the GenerateIndexedObject function, so return false
-	if (it == vertexToOutIndex.end()) { return false; }
-
-	//--- Otherwise, if the vertex is found in the map, then we just return this vertex and don't create another one
-	else { result = it->second; }
-
-	return true;
-}
-
-
 /*******************************************************************************************************************
 	Function that gets all the vertices from the OBJ file and stores them in to the vector passed in
 *******************************************************************************************************************/
@@ -216,4 +504,10 @@ void ObjLoader::GetIndices(std::vector<unsigned int>& vertexIndices, std::vector
 		textureCoordIndices.emplace_back(textureCoordIndex[i]);
 		normalIndices.emplace_back(normalIndex[i]);
 	}
-}
\ No newline at end of file
+}
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const unsigned int ObjLoader::s_bytesPerLineEstimate = 32;
\ No newline at end of file
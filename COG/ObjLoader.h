@@ -9,26 +9,55 @@
 	Loads in an OBJ file.
 	References: OpenGL Insights, by Patrick Cozzi and Cristophe Riccio
 
+	[Features]
+	The OBJ file is memory mapped and scanned in place - no line copies, no string streams and no
+	allocations per line. Numbers are parsed straight out of the mapped bytes and written into the output vectors.
+	Supports v, v/vt, v//vn and v/vt/vn faces, negative (relative) indices and polygons (triangulated as a fan).
+	Indexed objects are de-duplicated with a hash table (see VertexIndexer.h), split across the thread pool for
+	large files. Pass false in to the constructor to keep the de-duplication on the calling thread.
+	Indexed objects are then optimized for the vertex cache, overdraw and vertex fetch (see MeshOptimizer.h).
+
+	[Side Notes]
+	The original stream based loader is kept as LoadObjFileStreamed, purely so that the two can be compared
+	against each other (see Benchmark.h).
+
 *******************************************************************************************************************/
 #include <GLM.hpp>
 #include <vector>
-#include <map>
 #include <string>
 #include "VertexBuffer.h"
 
 class ObjLoader {
 
+private:
+	struct FaceCorner {
+		int vertex, textureCoord, normal;
+	};
+
 public:
-	ObjLoader();
+	ObjLoader(bool parallelIndexing = true);
 	~ObjLoader();
 
 public:
 	bool LoadObjFile(const std::string& obj, std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>* outIndices = nullptr);
+	bool LoadObjFileStreamed(const std::string& obj, std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>* outIndices = nullptr);
 
 private:
 	void GenerateIndexedObject(std::vector<glm::vec3>& outVertices, std::vector<glm::vec2>& outTextureCoords, std::vector<glm::vec3>& outNormals, std::vector<unsigned int>& outIndices);
-	bool GetSimilarVertexIndex(VertexBuffer::PackedVertex& packed, std::map<VertexBuffer::PackedVertex, unsigned int>& vertexToOutIndex, unsigned int& result);
 	
+private:
+	bool GetFace(const char*& cursor, const char* end, const std::vector<glm::vec3>& inVertices, const std::vector<glm::vec2>& inTextureCoords,
+				 const std::vector<glm::vec3>& inNormals, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& textureCoords, std::vector<glm::vec3>& normals);
+	bool GetFaceCorner(const char*& cursor, const char* end, FaceCorner& corner);
+	bool ResolveFaceCorner(FaceCorner& corner, size_t vertexCount, size_t textureCoordCount, size_t normalCount);
+
+private:
+	static float	ParseFloat(const char*& cursor, const char* end);
+	static bool		ParseInteger(const char*& cursor, const char* end, int& result);
+	static void		SkipSpaces(const char*& cursor, const char* end);
+	static void		SkipLine(const char*& cursor, const char* end);
+	static bool		IsSpace(const char* cursor, const char* end);
+
 private:
 	void GetVertices(std::vector<glm::vec3>& inVertices);
 	void GetTextureCoords(std::vector<glm::vec2>& inTextureCoords);
@@ -42,6 +71,10 @@ private:
 	std::vector<glm::vec3> m_vertices;
 	std::vector<glm::vec2> m_textureCoords;
 	std::vector<glm::vec3> m_normals;
+	bool m_parallelIndexing;
+
+private:
+	static const unsigned int s_bytesPerLineEstimate;
 };
 
 /*******************************************************************************************************************
@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "OcclusionBuffer.h"
+#include "ThreadPool.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+	:	m_viewProjection(1.0f),
+		m_width(width),
+		m_height(height),
+		m_tilesX(0),
+		m_tilesY(0)
+{
+	if (m_width <= 0)	{ m_width	= s_defaultWidth; }
+	if (m_height <= 0)	{ m_height	= s_defaultHeight; }
+
+	//--- Pixels are drawn 4 at a time, so each row is a multiple of 4 (and so is each tile, so a group never straddles two)
+	m_width = (m_width + 3) & ~3;
+
+	m_tilesX = (m_width + s_tileWidth - 1) / s_tileWidth;
+	m_tilesY = (m_height + s_tileHeight - 1) / s_tileHeight;
+
+	m_depth.resize((size_t)m_width * m_height, FLT_MAX);
+	m_tiles.resize((size_t)m_tilesX * m_tilesY);
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+OcclusionBuffer::~OcclusionBuffer()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that clears the buffer and its occluders, ready for a new frame seen through the view projection given
+*******************************************************************************************************************/
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+
+	std::fill(m_depth.begin(), m_depth.end(), FLT_MAX);
+
+	m_triangles.clear();
+	for (auto& tile : m_tiles) { tile.clear(); }
+}
+
+
+/*******************************************************************************************************************
+	Function that adds an occluder's triangles (counter clockwise, 3 indices each) to be drawn on the next Rasterize.
+	Its vertices are moved in to clip space 1 at a time with SSE2 (x, y, z and w at once), then its triangles are set up
+*******************************************************************************************************************/
+void OcclusionBuffer::AddOccluder(const glm::vec3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount, const glm::mat4& model)
+{
+	if (vertexCount == 0 || indexCount < 3) { return; }
+
+	glm::mat4 modelViewProjection = m_viewProjection * model;
+
+	__m128 column0 = _mm_loadu_ps(&modelViewProjection[0][0]);
+	__m128 column1 = _mm_loadu_ps(&modelViewProjection[1][0]);
+	__m128 column2 = _mm_loadu_ps(&modelViewProjection[2][0]);
+	__m128 column3 = _mm_loadu_ps(&modelViewProjection[3][0]);
+
+	m_clipPositions.resize(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++) {
+
+		__m128 clip = _mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(positions[i].x)), _mm_mul_ps(column1, _mm_set1_ps(positions[i].y))),
+								 _mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(positions[i].z)), column3));
+
+		_mm_storeu_ps(&m_clipPositions[i].x, clip);
+	}
+
+	SetupTriangles(indices, indexCount / 3);
+}
+
+
+/*******************************************************************************************************************
+	Function that draws every occluder added since Begin, with each tile of the screen drawn on its own worker
+*******************************************************************************************************************/
+void OcclusionBuffer::Rasterize()
+{
+	if (m_triangles.empty()) { return; }
+
+	Workers::Instance()->ParallelFor(m_tiles.size(), 1, [&](size_t firstTile, size_t lastTile) {
+		for (size_t tile = firstTile; tile < lastTile; tile++) { RasterizeTile((int)tile); }
+	});
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if any part of a box could be seen past the occluders. A box is hidden only when every pixel
+	its screen rectangle covers has an occluder nearer than the nearest of its corners.
+	Boxes crossing the near plane (or off the screen) are always visible, as there's no rectangle to test
+*******************************************************************************************************************/
+bool OcclusionBuffer::IsBoxVisible(const glm::vec3& minimum, const glm::vec3& maximum) const
+{
+	const glm::mat4& matrix = m_viewProjection;
+
+	//--- All 8 corners are moved in to clip space at once, 4 to a register (each lane is a corner)
+	__m128 cornersX = _mm_set_ps(maximum.x, minimum.x, maximum.x, minimum.x);
+	__m128 cornersY = _mm_set_ps(maximum.y, maximum.y, minimum.y, minimum.y);
+	__m128 nearZ	= _mm_set1_ps(minimum.z);
+	__m128 farZ		= _mm_set1_ps(maximum.z);
+
+	__m128 clip[4][2];
+
+	for (int row = 0; row < 4; row++) {
+
+		__m128 xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(matrix[0][row]), cornersX), _mm_mul_ps(_mm_set1_ps(matrix[1][row]), cornersY)),
+							   _mm_set1_ps(matrix[3][row]));
+
+		clip[row][0] = _mm_add_ps(xy, _mm_mul_ps(_mm_set1_ps(matrix[2][row]), nearZ));
+		clip[row][1] = _mm_add_ps(xy, _mm_mul_ps(_mm_set1_ps(matrix[2][row]), farZ));
+	}
+
+	__m128 nearW = _mm_set1_ps(s_nearW);
+	if (_mm_movemask_ps(_mm_or_ps(_mm_cmple_ps(clip[3][0], nearW), _mm_cmple_ps(clip[3][1], nearW)))) { return true; }
+
+	__m128 halfWidth	= _mm_set1_ps(m_width * 0.5f);
+	__m128 halfHeight	= _mm_set1_ps(m_height * 0.5f);
+	__m128 screen[3][2];
+
+	for (int half = 0; half < 2; half++) {
+
+		__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), clip[3][half]);
+
+		screen[0][half] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[0][half], inverse), halfWidth), halfWidth);
+		screen[1][half] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[1][half], inverse), halfHeight), halfHeight);
+		screen[2][half] = _mm_mul_ps(clip[2][half], inverse);
+	}
+
+	float minX		= HorizontalMin(_mm_min_ps(screen[0][0], screen[0][1]));
+	float minY		= HorizontalMin(_mm_min_ps(screen[1][0], screen[1][1]));
+	float maxX		= -HorizontalMin(_mm_sub_ps(_mm_setzero_ps(), _mm_max_ps(screen[0][0], screen[0][1])));
+	float maxY		= -HorizontalMin(_mm_sub_ps(_mm_setzero_ps(), _mm_max_ps(screen[1][0], screen[1][1])));
+	float nearest	= HorizontalMin(_mm_min_ps(screen[2][0], screen[2][1]));
+
+	if (maxX < 0.0f || maxY < 0.0f || minX >= (float)m_width || minY >= (float)m_height) { return true; }
+
+	int firstX	= std::max(0, (int)std::floor(minX));
+	int firstY	= std::max(0, (int)std::floor(minY));
+	int lastX	= std::min(m_width - 1, (int)std::floor(maxX));
+	int lastY	= std::min(m_height - 1, (int)std::floor(maxY));
+
+	__m128 depth	= _mm_set1_ps(nearest);
+	__m128i lanes	= _mm_set_epi32(3, 2, 1, 0);
+	__m128i first	= _mm_set1_epi32(firstX - 1);
+	__m128i last	= _mm_set1_epi32(lastX + 1);
+
+	for (int y = firstY; y <= lastY; y++) {
+
+		const float* row = &m_depth[(size_t)y * m_width];
+
+		for (int x = firstX & ~3; x <= lastX; x += 4) {
+
+			//--- Only the lanes inside the rectangle count, as the group can start before it or run past its end
+			__m128i column	= _mm_add_epi32(_mm_set1_epi32(x), lanes);
+			__m128i inside	= _mm_and_si128(_mm_cmpgt_epi32(column, first), _mm_cmplt_epi32(column, last));
+			__m128 isSeen	= _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), depth), _mm_castsi128_ps(inside));
+
+			if (_mm_movemask_ps(isSeen)) { return true; }
+		}
+	}
+
+	return false;
+}
+
+
+/*******************************************************************************************************************
+	Function that tests a batch of boxes across the worker threads, marking each one hidden by the occluders (1) or
+	not (0), and returns how many are hidden
+*******************************************************************************************************************/
+size_t OcclusionBuffer::CullBoxes(const glm::vec3* minimums, const glm::vec3* maximums, size_t count, std::vector<unsigned char>& outIsOccluded) const
+{
+	const size_t MINIMUM_BOXES = 64;
+
+	outIsOccluded.assign(count, 0);
+
+	if (m_triangles.empty()) { return 0; }
+
+	Workers::Instance()->ParallelFor(count, MINIMUM_BOXES, [&](size_t firstBox, size_t lastBox) {
+		for (size_t i = firstBox; i < lastBox; i++) { outIsOccluded[i] = !IsBoxVisible(minimums[i], maximums[i]); }
+	});
+
+	return (size_t)std::count(outIsOccluded.begin(), outIsOccluded.end(), (unsigned char)1);
+}
+
+
+/*******************************************************************************************************************
+	Function that sets up triangles 4 at a time with SSE2 - each lane is a triangle. Triangles crossing the near plane,
+	facing away, or not covering a single pixel are dropped, and the rest are sorted in to the tiles they cover.
+	Each edge is shifted in by half a pixel's width along its normal, so a pixel only passes when all of it is inside,
+	and the depth plane is pushed back by half a pixel's slope, so it's the furthest the triangle gets in that pixel
+*******************************************************************************************************************/
+void OcclusionBuffer::SetupTriangles(const unsigned int* indices, size_t triangleCount)
+{
+	const __m128 ZERO		= _mm_setzero_ps();
+	const __m128 HALF		= _mm_set1_ps(0.5f);
+	const __m128 ONE		= _mm_set1_ps(1.0f);
+	const __m128 NEAR_W		= _mm_set1_ps(s_nearW);
+	const __m128 HALF_WIDTH	= _mm_set1_ps(m_width * 0.5f);
+	const __m128 HALF_HEIGHT	= _mm_set1_ps(m_height * 0.5f);
+	const __m128 LAST_X		= _mm_set1_ps((float)(m_width - 1));
+	const __m128 LAST_Y		= _mm_set1_ps((float)(m_height - 1));
+	const __m128 SIGN		= _mm_set1_ps(-0.0f);
+
+	for (size_t first = 0; first < triangleCount; first += 4) {
+
+		//--- Gather the 4 triangles' corners, with the last triangle repeated in any lanes past the end
+		alignas(16) float clip[4][3][4];
+
+		for (int lane = 0; lane < 4; lane++) {
+
+			size_t triangle = std::min(first + lane, triangleCount - 1);
+
+			for (int vertex = 0; vertex < 3; vertex++) {
+				const glm::vec4& position = m_clipPositions[indices[triangle * 3 + vertex]];
+				clip[0][vertex][lane] = position.x;
+				clip[1][vertex][lane] = position.y;
+				clip[2][vertex][lane] = position.z;
+				clip[3][vertex][lane] = position.w;
+			}
+		}
+
+		__m128 x[3], y[3], z[3];
+		__m128 isKept = _mm_cmpeq_ps(ZERO, ZERO);
+
+		for (int vertex = 0; vertex < 3; vertex++) {
+
+			__m128 w		= _mm_load_ps(clip[3][vertex]);
+			__m128 inverse	= _mm_div_ps(ONE, w);
+
+			isKept		= _mm_and_ps(isKept, _mm_cmpgt_ps(w, NEAR_W));
+			x[vertex]	= _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_load_ps(clip[0][vertex]), inverse), HALF_WIDTH), HALF_WIDTH);
+			y[vertex]	= _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_load_ps(clip[1][vertex]), inverse), HALF_HEIGHT), HALF_HEIGHT);
+			z[vertex]	= _mm_mul_ps(_mm_load_ps(clip[2][vertex]), inverse);
+		}
+
+		//--- Twice the triangle's area, which is only positive for triangles facing the camera
+		__m128 x10 = _mm_sub_ps(x[1], x[0]), y10 = _mm_sub_ps(y[1], y[0]), z10 = _mm_sub_ps(z[1], z[0]);
+		__m128 x20 = _mm_sub_ps(x[2], x[0]), y20 = _mm_sub_ps(y[2], y[0]), z20 = _mm_sub_ps(z[2], z[0]);
+		__m128 area = _mm_sub_ps(_mm_mul_ps(x10, y20), _mm_mul_ps(x20, y10));
+
+		isKept = _mm_and_ps(isKept, _mm_cmpgt_ps(area, ZERO));
+
+		//--- Bounds, with triangles entirely off one side of the screen dropped
+		__m128 minX = _mm_min_ps(_mm_min_ps(x[0], x[1]), x[2]);
+		__m128 minY = _mm_min_ps(_mm_min_ps(y[0], y[1]), y[2]);
+		__m128 maxX = _mm_max_ps(_mm_max_ps(x[0], x[1]), x[2]);
+		__m128 maxY = _mm_max_ps(_mm_max_ps(y[0], y[1]), y[2]);
+
+		isKept = _mm_and_ps(isKept, _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(maxX, ZERO), _mm_cmpge_ps(maxY, ZERO)),
+											   _mm_and_ps(_mm_cmple_ps(minX, LAST_X), _mm_cmple_ps(minY, LAST_Y))));
+
+		int lanes = _mm_movemask_ps(isKept) & ((1 << (int)std::min((size_t)4, triangleCount - first)) - 1);
+		if (!lanes) { continue; }
+
+		//--- Edge functions (a * x + b * y + c), positive inside the triangle
+		__m128 edges[3][3];
+
+		for (int edge = 0; edge < 3; edge++) {
+
+			int next = (edge + 1) % 3;
+
+			__m128 a = _mm_sub_ps(y[edge], y[next]);
+			__m128 b = _mm_sub_ps(x[next], x[edge]);
+			__m128 c = _mm_sub_ps(_mm_mul_ps(x[edge], y[next]), _mm_mul_ps(x[next], y[edge]));
+
+			__m128 shift = _mm_mul_ps(HALF, _mm_add_ps(_mm_andnot_ps(SIGN, a), _mm_andnot_ps(SIGN, b)));
+
+			edges[edge][0] = a;
+			edges[edge][1] = b;
+			edges[edge][2] = _mm_sub_ps(c, shift);
+		}
+
+		//--- Depth plane (dz/dx * x + dz/dy * y + z at the origin)
+		__m128 inverseArea	= _mm_div_ps(ONE, area);
+		__m128 slopeX		= _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(z10, y20), _mm_mul_ps(z20, y10)), inverseArea);
+		__m128 slopeY		= _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(x10, z20), _mm_mul_ps(x20, z10)), inverseArea);
+		__m128 shift		= _mm_mul_ps(HALF, _mm_add_ps(_mm_andnot_ps(SIGN, slopeX), _mm_andnot_ps(SIGN, slopeY)));
+		__m128 origin		= _mm_add_ps(_mm_sub_ps(z[0], _mm_add_ps(_mm_mul_ps(slopeX, x[0]), _mm_mul_ps(slopeY, y[0]))), shift);
+
+		//--- Bounds clamped to the screen (never negative, so truncating is the same as flooring)
+		minX = _mm_max_ps(_mm_min_ps(minX, LAST_X), ZERO);
+		minY = _mm_max_ps(_mm_min_ps(minY, LAST_Y), ZERO);
+		maxX = _mm_max_ps(_mm_min_ps(maxX, LAST_X), ZERO);
+		maxY = _mm_max_ps(_mm_min_ps(maxY, LAST_Y), ZERO);
+
+		alignas(16) float setup[3][3][4], depth[3][4];
+		alignas(16) int bounds[4][4];
+
+		for (int edge = 0; edge < 3; edge++) {
+			for (int term = 0; term < 3; term++) { _mm_store_ps(setup[edge][term], edges[edge][term]); }
+		}
+
+		_mm_store_ps(depth[0], slopeX);
+		_mm_store_ps(depth[1], slopeY);
+		_mm_store_ps(depth[2], origin);
+
+		_mm_store_si128((__m128i*)bounds[0], _mm_cvttps_epi32(minX));
+		_mm_store_si128((__m128i*)bounds[1], _mm_cvttps_epi32(minY));
+		_mm_store_si128((__m128i*)bounds[2], _mm_cvttps_epi32(maxX));
+		_mm_store_si128((__m128i*)bounds[3], _mm_cvttps_epi32(maxY));
+
+		for (int lane = 0; lane < 4; lane++) {
+
+			if (!(lanes & (1 << lane))) { continue; }
+
+			Triangle triangle;
+
+			for (int edge = 0; edge < 3; edge++) {
+				for (int term = 0; term < 3; term++) { triangle.edges[edge][term] = setup[edge][term][lane]; }
+			}
+
+			for (int term = 0; term < 3; term++) { triangle.depth[term] = depth[term][lane]; }
+
+			triangle.minX = bounds[0][lane];
+			triangle.minY = bounds[1][lane];
+			triangle.maxX = bounds[2][lane];
+			triangle.maxY = bounds[3][lane];
+
+			unsigned int index = (unsigned int)m_triangles.size();
+			m_triangles.push_back(triangle);
+
+			for (int tileY = triangle.minY / s_tileHeight; tileY <= triangle.maxY / s_tileHeight; tileY++) {
+				for (int tileX = triangle.minX / s_tileWidth; tileX <= triangle.maxX / s_tileWidth; tileX++) {
+					m_tiles[(size_t)tileY * m_tilesX + tileX].push_back(index);
+				}
+			}
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that draws the triangles sorted in to a tile, 4 pixels at a time. A pixel keeps the nearest depth of every
+	triangle covering all of it
+*******************************************************************************************************************/
+void OcclusionBuffer::RasterizeTile(int tile)
+{
+	int tileX = (tile % m_tilesX) * s_tileWidth;
+	int tileY = (tile / m_tilesX) * s_tileHeight;
+
+	int tileLastX = std::min(tileX + s_tileWidth, m_width) - 1;
+	int tileLastY = std::min(tileY + s_tileHeight, m_height) - 1;
+
+	const __m128 OFFSETS = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+	for (unsigned int index : m_tiles[tile]) {
+
+		const Triangle& triangle = m_triangles[index];
+
+		int firstX	= std::max(triangle.minX, tileX) & ~3;
+		int firstY	= std::max(triangle.minY, tileY);
+		int lastX	= std::min(triangle.maxX, tileLastX);
+		int lastY	= std::min(triangle.maxY, tileLastY);
+
+		__m128 a[3], step[3];
+
+		for (int edge = 0; edge < 3; edge++) {
+			a[edge]		= _mm_set1_ps(triangle.edges[edge][0]);
+			step[edge]	= _mm_set1_ps(triangle.edges[edge][0] * 4.0f);
+		}
+
+		__m128 slopeX		= _mm_set1_ps(triangle.depth[0]);
+		__m128 depthStep	= _mm_set1_ps(triangle.depth[0] * 4.0f);
+		__m128 columns		= _mm_add_ps(_mm_set1_ps((float)firstX), OFFSETS);
+
+		for (int y = firstY; y <= lastY; y++) {
+
+			float centerY = y + 0.5f;
+
+			//--- Each row starts from the left of the group, then steps 4 pixels along at a time
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(a[0], columns), _mm_set1_ps(triangle.edges[0][1] * centerY + triangle.edges[0][2]));
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(a[1], columns), _mm_set1_ps(triangle.edges[1][1] * centerY + triangle.edges[1][2]));
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(a[2], columns), _mm_set1_ps(triangle.edges[2][1] * centerY + triangle.edges[2][2]));
+			__m128 depth = _mm_add_ps(_mm_mul_ps(slopeX, columns), _mm_set1_ps(triangle.depth[1] * centerY + triangle.depth[2]));
+
+			float* row = &m_depth[(size_t)y * m_width];
+
+			for (int x = firstX; x <= lastX; x += 4) {
+
+				__m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, _mm_setzero_ps()), _mm_cmpge_ps(edge1, _mm_setzero_ps())),
+											 _mm_cmpge_ps(edge2, _mm_setzero_ps()));
+
+				if (_mm_movemask_ps(isInside)) {
+					__m128 current = _mm_loadu_ps(row + x);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(isInside, _mm_min_ps(current, depth)), _mm_andnot_ps(isInside, current)));
+				}
+
+				edge0 = _mm_add_ps(edge0, step[0]);
+				edge1 = _mm_add_ps(edge1, step[1]);
+				edge2 = _mm_add_ps(edge2, step[2]);
+				depth = _mm_add_ps(depth, depthStep);
+			}
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the smallest of a register's 4 lanes
+*******************************************************************************************************************/
+float OcclusionBuffer::HorizontalMin(__m128 values)
+{
+	values = _mm_min_ps(values, _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 3, 0, 1)));
+	values = _mm_min_ps(values, _mm_shuffle_ps(values, values, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	return _mm_cvtss_f32(values);
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+size_t OcclusionBuffer::GetTriangleCount() const { return m_triangles.size(); }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const int OcclusionBuffer::s_defaultWidth		= 256;
+const int OcclusionBuffer::s_defaultHeight		= 128;
+const int OcclusionBuffer::s_tileWidth			= 32;
+const int OcclusionBuffer::s_tileHeight			= 16;
+const float OcclusionBuffer::s_nearW			= 0.0001f;
\ No newline at end of file
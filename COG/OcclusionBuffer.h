@@ -0,0 +1,84 @@
+#pragma once
+
+/*******************************************************************************************************************
+	OcclusionBuffer.h, OcclusionBuffer.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A small depth buffer drawn on the CPU, for culling objects hidden behind large ones (buildings, rocks, etc.) before
+	they are sent to the GPU.
+
+	[Features]
+	Occluders are drawn as triangle meshes in to a low resolution depth buffer, and objects are tested by the screen
+	rectangle and nearest depth of their bounding box - anything with no pixel in its rectangle further away than it
+	is hidden.
+	Vertices are transformed with SSE2, and triangles are set up (edges, depth planes and bounds) 4 at a time.
+	Triangles are sorted in to tiles of the screen, and the tiles are drawn across the worker threads (see
+	ThreadPool.h) 4 pixels at a time - each tile is only ever touched by one thread, so there are no locks.
+	Boxes are tested across the worker threads too.
+	Everything is conservative, so an object is never hidden unless it really is behind an occluder - a pixel is only
+	drawn when the triangle covers all of it, with the furthest depth the triangle has in that pixel.
+	Needs no GPU (or OpenGL context) at all.
+
+	[Upcoming]
+	Drawing the occluders nearest first, and stopping once the screen is full.
+
+	[Side Notes]
+	Triangles that cross the near plane are skipped rather than clipped, which only ever makes the buffer see less.
+	Back facing triangles are skipped, as the front of a closed mesh is always in front of its back.
+	Depths are stored as z / w, which is linear across the screen, and the buffer is cleared to FLT_MAX.
+
+*******************************************************************************************************************/
+#include <emmintrin.h>
+#include <glm.hpp>
+#include <vector>
+
+class OcclusionBuffer {
+
+private:
+	struct Triangle {
+		float	edges[3][3];
+		float	depth[3];
+		int		minX, minY;
+		int		maxX, maxY;
+	};
+
+public:
+	OcclusionBuffer(int width = 0, int height = 0);
+	~OcclusionBuffer();
+
+public:
+	void Begin(const glm::mat4& viewProjection);
+	void AddOccluder(const glm::vec3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount, const glm::mat4& model);
+	void Rasterize();
+
+public:
+	bool IsBoxVisible(const glm::vec3& minimum, const glm::vec3& maximum) const;
+	size_t CullBoxes(const glm::vec3* minimums, const glm::vec3* maximums, size_t count, std::vector<unsigned char>& outIsOccluded) const;
+
+public:
+	size_t GetTriangleCount() const;
+
+private:
+	void SetupTriangles(const unsigned int* indices, size_t triangleCount);
+	void RasterizeTile(int tile);
+
+private:
+	static float HorizontalMin(__m128 values);
+
+private:
+	glm::mat4								m_viewProjection;
+	std::vector<float>						m_depth;
+	std::vector<glm::vec4>					m_clipPositions;
+	std::vector<Triangle>					m_triangles;
+	std::vector<std::vector<unsigned int>>	m_tiles;
+	int										m_width, m_height;
+	int										m_tilesX, m_tilesY;
+
+private:
+	static const int						s_defaultWidth;
+	static const int						s_defaultHeight;
+	static const int						s_tileWidth;
+	static const int						s_tileHeight;
+	static const float						s_nearW;
+};
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "PackFile.h"
+#include "Lz4.h"
+#include "Tools.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+PackFile::PackFile()
+	:	m_header(nullptr),
+		m_entries(nullptr),
+		m_names(nullptr)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+PackFile::~PackFile()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Maps a pack file and checks that its directory is valid
+*******************************************************************************************************************/
+bool PackFile::Open(const std::string& fileLocation)
+{
+	Close();
+
+	//--- A missing pack file isn't an error, the assets are just read from the Assets folder instead
+	if (GetFileAttributes(fileLocation.c_str()) == INVALID_FILE_ATTRIBUTES) { return false; }
+
+	if (!m_file.Open(fileLocation)) { return false; }
+
+	const char* data	= m_file.GetData();
+	size_t size			= m_file.GetSize();
+
+	const Header* header = (const Header*)data;
+
+	if (size < sizeof(Header) || memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 || header->version != s_version) {
+		FL_LOG("[PACK] Pack is not a valid .cogpak (or is an old version): ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	//--- Make sure the file actually contains the directory the header says it does, and that every name ends inside it
+	if (header->entryOffset + (unsigned long long)header->entryCount * sizeof(Entry) > size ||
+		header->nameOffset + header->nameSize > size || header->nameSize == 0 || data[header->nameOffset + header->nameSize - 1] != '\0') {
+		FL_LOG("[PACK] Pack is truncated: ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	const Entry* entries = (const Entry*)(data + header->entryOffset);
+
+	for (unsigned int entry = 0; entry < header->entryCount; entry++) {
+		//--- Uncompressed entries are read straight from the mapping, so their size must be exactly what is stored
+		bool isCompressed = (entries[entry].flags & ENTRY_COMPRESSED) != 0;
+
+		if (entries[entry].name >= header->nameSize || entries[entry].offset + entries[entry].storedSize > size ||
+			(!isCompressed && entries[entry].size != entries[entry].storedSize)) {
+			FL_LOG("[PACK] Pack has an invalid entry: ", fileLocation.c_str(), LOG_WARN);
+			Close();
+			return false;
+		}
+	}
+
+	m_header	= header;
+	m_entries	= entries;
+	m_names		= data + header->nameOffset;
+
+	FL_LOG("[PACK] Pack mapped, entries found: ", m_header->entryCount, LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps the pack file
+*******************************************************************************************************************/
+void PackFile::Close()
+{
+	m_header	= nullptr;
+	m_entries	= nullptr;
+	m_names		= nullptr;
+
+	m_file.Close();
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the entry for a file, returning nullptr if the file isn't in the pack
+*******************************************************************************************************************/
+const PackFile::Entry* PackFile::Find(const std::string& fileLocation) const
+{
+	if (!m_header) { return nullptr; }
+
+	std::string path		= NormalizePath(fileLocation);
+	unsigned long long hash	= Hash(path);
+
+	const Entry* first	= m_entries;
+	const Entry* last	= m_entries + m_header->entryCount;
+
+	//--- Entries are sorted by hash, so there's only ever a (very rare) collision or two to check by name
+	for (const Entry* entry = std::lower_bound(first, last, hash, [](const Entry& entry, unsigned long long hash) { return entry.hash < hash; });
+		 entry != last && entry->hash == hash; entry++) {
+		if (path == m_names + entry->name) { return entry; }
+	}
+
+	return nullptr;
+}
+
+
+/*******************************************************************************************************************
+	Builds a pack file from every file in a directory (and its sub directories).
+	The pack is written to a temporary file first and then moved in to place, so a crash or a full disk
+	can never leave a half written .cogpak behind
+*******************************************************************************************************************/
+bool PackFile::Build(const std::string& directory, const std::string& fileLocation, bool isCompressed)
+{
+	//--- Find every file, without recursion, using a list of directories still to search
+	std::vector<std::string> files, directories = { directory };
+
+	while (!directories.empty()) {
+
+		std::string folder = directories.back();
+		directories.pop_back();
+
+		WIN32_FIND_DATA found;
+		HANDLE search = FindFirstFile((folder + "\\*").c_str(), &found);
+
+		if (search == INVALID_HANDLE_VALUE) { continue; }
+
+		do {
+			std::string name = found.cFileName;
+
+			if (name == "." || name == "..") { continue; }
+
+			if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)	{ directories.push_back(folder + "\\" + name); }
+			else if (!IsSkipped(name))								{ files.push_back(folder + "\\" + name); }
+
+		} while (FindNextFile(search, &found));
+
+		FindClose(search);
+	}
+
+	//--- The directory and names are written first, so we know where the data starts before we read any files
+	std::vector<Entry> entries(files.size());
+	std::string names;
+
+	for (size_t file = 0; file < files.size(); file++) {
+
+		std::string path = NormalizePath(files[file]);
+
+		entries[file]		= {};
+		entries[file].hash	= Hash(path);
+		entries[file].name	= (unsigned int)names.size();
+
+		names.append(path.c_str(), path.size() + 1);
+	}
+
+	if (names.empty()) { names.push_back('\0'); }
+
+	auto align = [](unsigned long long offset) { return (offset + s_alignment - 1) / s_alignment * s_alignment; };
+
+	static_assert(sizeof(Header) == 32 && sizeof(Entry) == 32, "PackFile records must be tightly packed");
+
+	Header header = {};
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+
+	header.version		= s_version;
+	header.entryCount	= (unsigned int)entries.size();
+	header.nameSize		= (unsigned int)names.size();
+	header.entryOffset	= sizeof(Header);
+	header.nameOffset	= header.entryOffset + entries.size() * sizeof(Entry);
+
+	std::string temporaryLocation = fileLocation + ".tmp";
+
+	HANDLE pack = CreateFile(temporaryLocation.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (pack == INVALID_HANDLE_VALUE) { Debug("[PACK] Could not create " + fileLocation); return false; }
+
+	DWORD written				= 0;
+	unsigned long long offset	= align(header.nameOffset + header.nameSize);
+	unsigned long long original	= 0, stored = 0;
+	std::vector<char> zeros(s_alignment, 0), compressed;
+
+	//--- Skip over the space for the directory and names, the file is zero filled up to the first entry
+	LARGE_INTEGER position;
+	position.QuadPart = (LONGLONG)offset;
+
+	bool success = SetFilePointerEx(pack, position, nullptr, FILE_BEGIN) != FALSE;
+
+	for (size_t file = 0; file < files.size() && success; file++) {
+
+		//--- Empty files can't be mapped, but are still stored so that they can be found
+		MappedFile source;
+		const char* data	= "";
+		size_t size			= 0;
+
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+		if (GetFileAttributesEx(files[file].c_str(), GetFileExInfoStandard, &attributes) && (attributes.nFileSizeLow || attributes.nFileSizeHigh)) {
+
+			if (!source.Open(files[file])) { success = false; break; }
+
+			data = source.GetData();
+			size = source.GetSize();
+		}
+
+		Entry& entry	= entries[file];
+		entry.offset	= offset;
+		entry.size		= (unsigned int)size;
+		entry.storedSize	= (unsigned int)size;
+
+		//--- Only keep the compressed copy if it's worth the time it takes to decompress
+		if (isCompressed && size) {
+
+			compressed.resize(lz4::GetMaximumCompressedSize(size));
+
+			size_t compressedSize = lz4::Compress(data, size, compressed.data(), compressed.size());
+
+			if (compressedSize && compressedSize <= size - size / 8) {
+				data				= compressed.data();
+				entry.storedSize	= (unsigned int)compressedSize;
+				entry.flags			|= ENTRY_COMPRESSED;
+			}
+		}
+
+		unsigned long long next = align(offset + entry.storedSize);
+
+		success =	WriteFile(pack, data, entry.storedSize, &written, nullptr) &&
+					WriteFile(pack, zeros.data(), (DWORD)(next - offset - entry.storedSize), &written, nullptr);
+
+		original	+= entry.size;
+		stored		+= entry.storedSize;
+		offset		= next;
+	}
+
+	//--- Now every entry knows where its data is, sort the directory by hash and write it at the start of the file
+	std::sort(entries.begin(), entries.end(), [](const Entry& left, const Entry& right) { return left.hash < right.hash; });
+
+	position.QuadPart = 0;
+
+	success = success && SetFilePointerEx(pack, position, nullptr, FILE_BEGIN) &&
+			  WriteFile(pack, &header, sizeof(Header), &written, nullptr) &&
+			  (entries.empty() || WriteFile(pack, entries.data(), (DWORD)(entries.size() * sizeof(Entry)), &written, nullptr)) &&
+			  WriteFile(pack, names.data(), (DWORD)names.size(), &written, nullptr);
+
+	CloseHandle(pack);
+
+	if (!success || !MoveFileEx(temporaryLocation.c_str(), fileLocation.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		Debug("[PACK] Could not write " + fileLocation);
+		DeleteFile(temporaryLocation.c_str());
+		return false;
+	}
+
+	Debug("[PACK] " + fileLocation + " written, files: " + NumberToString(files.size()) +
+		  ", bytes: " + NumberToString(original) + " -> " + NumberToString(stored));
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const char* PackFile::GetData(const Entry& entry) const	{ return m_file.GetData() + entry.offset; }
+const char* PackFile::GetName(const Entry& entry) const	{ return m_names + entry.name; }
+unsigned int PackFile::GetEntryCount() const			{ return (m_header) ? m_header->entryCount : 0; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const char PackFile::s_magic[4]				= { 'C', 'P', 'A', 'K' };
+const unsigned int PackFile::s_version		= 2;
+const unsigned int PackFile::s_alignment	= 4096;
+
+//--- Temporary files, and the caches baked next to their sources - a packed cache would hide every rebake of it
+const char* const PackFile::s_skippedExtensions[4] = { ".tmp", ".cogmesh", ".cogcfg", ".cogterrain" };
+
+bool PackFile::IsSkipped(const std::string& name)
+{
+	std::string path = NormalizePath(name);
+
+	for (const char* extension : s_skippedExtensions) {
+
+		size_t length = strlen(extension);
+		if (path.size() >= length && path.compare(path.size() - length, length, extension) == 0) { return true; }
+	}
+
+	return false;
+}
+
+std::string PackFile::NormalizePath(const std::string& fileLocation)
+{
+	std::string path = fileLocation;
+
+	for (char& character : path) {
+		if (character == '\\')							{ character = '/'; }
+		else if (character >= 'A' && character <= 'Z')	{ character = character - 'A' + 'a'; }
+	}
+
+	return path;
+}
+
+unsigned long long PackFile::Hash(const std::string& path)
+{
+	//--- 64-bit FNV-1a, so collisions between asset paths are practically impossible
+	unsigned long long hash = 14695981039346656037ull;
+
+	for (char character : path) { hash = (hash ^ (unsigned char)character) * 1099511628211ull; }
+
+	return hash;
+}
\ No newline at end of file
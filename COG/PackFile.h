@@ -0,0 +1,94 @@
+#pragma once
+
+/*******************************************************************************************************************
+	PackFile.h, PackFile.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Reads and builds .cogpak files - every asset the game uses, packed in to one file that is memory mapped at start up.
+
+	[Features]
+	A .cogpak holds a small header, a directory of entries sorted by the hash of their path, a block of path names
+	and then the data of every entry. Finding an entry is a binary search over the directory, with no file system
+	calls at all. Each entry's data starts on a 4K boundary, so uncompressed entries can be handed straight to the
+	loaders from the mapping with no copies (see VirtualFile.h).
+	Entries are compressed with LZ4 (see Lz4.h) when it saves at least an eighth of their size. Files that are
+	compressed already (PNG, JPG, etc.) don't, so they are stored as they are.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Run the game with the -pack argument to build Assets.cogpak from the Assets folder.
+	Paths are stored in lower case with forward slashes, so "Assets\\Textures\\Grass.png" and "assets/textures/grass.png"
+	are the same entry, just like they are to the Windows file system.
+	The pack is built from whatever is in the Assets folder at the time, so rebuild it after changing any assets.
+	Baked caches (.cogmesh, .cogcfg and .cogterrain) are left out of the pack, so they are always read from (and
+	rebaked to) the Assets folder.
+
+*******************************************************************************************************************/
+#include <string>
+#include "MappedFile.h"
+
+class PackFile {
+
+public:
+	struct Entry {
+		unsigned long long	hash;
+		unsigned long long	offset;
+		unsigned int		storedSize;
+		unsigned int		size;
+		unsigned int		name;
+		unsigned int		flags;
+	};
+
+	enum EntryFlags { ENTRY_COMPRESSED = 1 };
+
+private:
+	struct Header {
+		char				magic[4];
+		unsigned int		version;
+		unsigned int		entryCount;
+		unsigned int		nameSize;
+		unsigned long long	entryOffset;
+		unsigned long long	nameOffset;
+	};
+
+public:
+	PackFile();
+	~PackFile();
+
+public:
+	bool Open(const std::string& fileLocation);
+	void Close();
+
+public:
+	const Entry*	Find(const std::string& fileLocation) const;
+	const char*		GetData(const Entry& entry) const;
+	const char*		GetName(const Entry& entry) const;
+	unsigned int	GetEntryCount() const;
+
+public:
+	static bool Build(const std::string& directory, const std::string& fileLocation, bool isCompressed = true);
+
+private:
+	PackFile(const PackFile&)				= delete;
+	PackFile& operator=(const PackFile&)	= delete;
+
+private:
+	static std::string NormalizePath(const std::string& fileLocation);
+	static unsigned long long Hash(const std::string& path);
+	static bool IsSkipped(const std::string& name);
+
+private:
+	MappedFile		m_file;
+	const Header*	m_header;
+	const Entry*	m_entries;
+	const char*		m_names;
+
+private:
+	static const char			s_magic[4];
+	static const unsigned int	s_version;
+	static const unsigned int	s_alignment;
+	static const char* const	s_skippedExtensions[4];
+};
\ No newline at end of file
@@ -27,4 +27,8 @@ public:
 		const auto end = Clock::now();
 		FL_LOG("[TIMER] Stop Elapsed: ", std::chrono::duration_cast<Resolution>(end - mStart).count(), LOG_WARN);
 	}
+
+	inline long long Elapsed() const {
+		return (long long)std::chrono::duration_cast<Resolution>(Clock::now() - mStart).count();
+	}
 }; 
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Picker.h"
 #include "InputManager.h"
 #include "ScreenManager.h"
+#include "Terrain.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
@@ -112,6 +113,17 @@ bool Picker::IsColliding(const AABounds3D& bounds, float range)
 }
 
 
+/*******************************************************************************************************************
+	A function which checks if the 3D ray hits the terrain within range, and gives back the point it hits the ground
+*******************************************************************************************************************/
+bool Picker::IsColliding(const Terrain* terrain, float range, glm::vec3& outPosition)
+{
+	if (!terrain) { return false; }
+
+	return terrain->Raycast(m_origin, m_ray, range, outPosition);
+}
+
+
 /*******************************************************************************************************************
 	A function which calculates the 3D ray
 	Reference: http://antongerdelan.net/opengl/raycasting.html
@@ -3,7 +3,7 @@
 /*******************************************************************************************************************
 	Picker.h, Picker.cpp
 	Created by Kim Kane
-	Last updated: 08/04/2018
+	Last updated: 17/10/2026
 
 	A picker class, which is used to cast a directional ray from a 2D point(x, y)
 	to a 3D position in world space.
@@ -11,6 +11,7 @@
 	[Features]
 	Supports mouse picking.
 	Only checks for collision's when object's are within range.
+	Finds the point on the terrain under the mouse (see Terrain::Raycast).
 
 	[Upcoming]
 	Support for PS4 controller.
@@ -23,6 +24,8 @@
 #include "Camera.h"
 #include "AABounds3D.h"
 
+class Terrain;
+
 class Picker {
 
 public:
@@ -37,6 +40,7 @@ public:
 
 public:
 	bool IsColliding(const AABounds3D& bounds, float range);
+	bool IsColliding(const Terrain* terrain, float range, glm::vec3& outPosition);
 
 private:
 	glm::vec3 CalculateMouseRay();
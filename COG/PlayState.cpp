@@ -1,5 +1,6 @@
 #include "PlayState.h"
 #include "GameManager.h"
+#include "ResourceManager.h"
 #include "Log.h"
 
 /*******************************************************************************************************************
@@ -19,10 +20,16 @@ PlayState::PlayState(GameState* previousState)
 		m_menuButton(nullptr),
 		m_helpButton(nullptr),
 		m_lightCount(10),
+		m_hiddenCount(0),
+		m_occludedCount(0),
+		m_planeTestCount(0),
+		m_bruteForceCount(0),
+		m_isCollectableVisible(false),
 		m_finalEventIssued(false),
 		m_debugMode(false),
 		m_wireFrameMode(false),
-		m_finishedEvents(false)
+		m_finishedEvents(false),
+		m_playerBody(-1)
 {
 	Initialize();
 }
@@ -107,6 +114,10 @@ void PlayState::LoadObjects()
 	// ObjectFactory->Create(Resource->Load("SomeObject")) - I got a bit carried away with OpenGL and shaders (kind of the point lol)
 	//---
 
+	//--- The skybox, the terrain, and the entities' models and textures are loaded across the worker threads and uploaded
+	//--- a few at a time each frame; nothing is drawn until it has been uploaded (and the ground is flat until then)
+	Resource::Instance()->SetAsyncLoading(true);
+
 	m_skybox	= new Skybox("Night", "Left", "Right", "Top", "Bottom", "Front", "Back");
 	m_terrain	= Terrain::Create("Terrain");
 	m_player	= Player::Create("Player");
@@ -123,12 +134,36 @@ void PlayState::LoadObjects()
 	for (unsigned int i = 0; i < s_maxEntities; i++) {
 		AddToScene(m_entities, Entity::Create("Object" + std::to_string(i))); 
 	}
+
+	//--- Entities whose models are still loading have empty bounds for now, so they're given their real bounds (and
+	//--- moved in the tree and grid) once their models are resident (see UpdateObjects)
+	for (unsigned int i = 0; i < m_entities.size(); i++) {
+		if (!m_entities[i]->GetModel()->IsResident()) { m_loadingEntities.push_back(i); }
+	}
+
+	//--- Index the entities by their bounds too, so culling only looks at the ones near the camera
+	ReserveMemory(m_entityProxies, s_maxEntities);
+	for (unsigned int i = 0; i < m_entities.size(); i++) {
+		m_entityProxies.push_back(m_entityTree.Insert(m_entities[i]->GetBound().GetMin(), m_entities[i]->GetBound().GetMax(), i));
+	}
+
+	//--- And add the player and every collidable entity to the collision grid (the entities don't move by themselves,
+	//--- so they're static and only ever paired with the player)
+	m_playerBody = m_collisionGrid.Insert(m_player->GetBound().GetMin(), m_player->GetBound().GetMax(), 0, true);
+
+	ReserveMemory(m_entityBodies, s_maxEntities);
+	for (unsigned int i = 0; i < m_entities.size(); i++) {
+		bool isCollidable = m_entities[i]->HasCollisionResponse();
+		m_entityBodies.push_back((isCollidable) ? m_collisionGrid.Insert(m_entities[i]->GetBound().GetMin(), m_entities[i]->GetBound().GetMax(), i, false) : -1);
+	}
 	
 	//--- Add all the collectables to the scene (using a deque so no need to reserve memory like the other containers)
 	for (unsigned int i = 0; i < s_maxCollectables; i++) {
 		AddToScene(m_collectables, Entity::Create("Collectable" + std::to_string(i)));
 		if (i >= 1) { m_collectables[i]->SetActive(false); }
 	}
+
+	Resource::Instance()->SetAsyncLoading(false);
 }
 
 
@@ -148,6 +183,9 @@ void PlayState::LoadComponents()
 	//--- Create the mouse ray and frustum (these will be components as well, eventually)
 	m_picker	= new Picker(m_mainCamera);
 	m_frustum	= new Frustum(Screen::Instance()->GetProjectionMatrix(), m_mainCamera->GetViewMatrix());
+
+	//--- Find what can be seen before the first update
+	CullObjects();
 }
 
 
@@ -301,25 +339,13 @@ void PlayState::RenderWorld()
 	m_shaders[SHADER_ENTITY]->DebugMode(m_debugMode);
 #endif
 	m_shaders[SHADER_ENTITY]->SetLights(m_lights);
-		for (auto entity : m_entities) {
-			//--- Entities are only rendered when within view
-			if (m_frustum->IsRectangleInside(
-				entity->GetBound().GetPosition(),
-				entity->GetBound().GetHalfDimension())) {
-				
-					entity->Render(m_shaders[SHADER_ENTITY]);
-			}
-		}
+		//--- Entities are only rendered when within view (and not hidden behind the terrain)
+		for (auto entity : m_visibleEntities) { m_entities[entity]->Render(m_shaders[SHADER_ENTITY]); }
 		
 		//--- Only if there is still items to be collected do we render them
 		if (!m_player->HasCollectedAllItems()) {
 			//--- Collectables are only rendered when within view
-			if (m_frustum->IsRectangleInside(
-				m_collectables.front()->GetBound().GetPosition(),
-				m_collectables.front()->GetBound().GetHalfDimension())) {
-				
-				m_collectables.front()->Render(m_shaders[SHADER_ENTITY]);
-			}
+			if (m_isCollectableVisible) { m_collectables.front()->Render(m_shaders[SHADER_ENTITY]); }
 		}
 	m_shaders[SHADER_ENTITY]->Unbind();
 }
@@ -353,6 +379,9 @@ void PlayState::RenderInterface()
 		m_text->Render(m_shaders[SHADER_TEXT], "FPS : " + std::to_string(Game::Instance()->GetFramesPerSecond()), Transform(glm::vec2(10.0f, 200.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
 		m_text->Render(m_shaders[SHADER_TEXT], "Frame Time : " + std::to_string(Game::Instance()->GetCurrentFrameTime()), Transform(glm::vec2(10.0f, 180.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
 		m_text->Render(m_shaders[SHADER_TEXT], "CPU % : " + std::to_string(Game::Instance()->GetMainframePercentage()), Transform(glm::vec2(10.0f, 160.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
+		m_text->Render(m_shaders[SHADER_TEXT], "Hidden by terrain : " + std::to_string(m_hiddenCount), Transform(glm::vec2(10.0f, 140.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
+		m_text->Render(m_shaders[SHADER_TEXT], "Occluded : " + std::to_string(m_occludedCount), Transform(glm::vec2(10.0f, 100.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
+		m_text->Render(m_shaders[SHADER_TEXT], "Plane tests : " + std::to_string(m_planeTestCount) + " / " + std::to_string(m_bruteForceCount), Transform(glm::vec2(10.0f, 120.0f), glm::vec2(1.0f)), glm::vec4(1.0, 1.0f, 1.0f, 1.0f));
 #endif
 	m_shaders[SHADER_TEXT]->Unbind();
 }
@@ -364,6 +393,8 @@ void PlayState::RenderInterface()
 void PlayState::UpdateObjects()
 {
 	//--- Update terrain before player so the player is walking in sync with terrain height
+	//--- (a streamed terrain also loads the tiles around wherever the player is heading)
+	m_terrain->SetFocus(m_player->GetTransform()->GetPosition(), m_player->GetTransform()->GetForward());
 	m_terrain->Update();
 	m_player->Update();
 
@@ -371,9 +402,7 @@ void PlayState::UpdateObjects()
 	if (!m_player->HasCollectedAllItems()) {
 			
 		//--- Don't update anything unless we can see it
-		if (m_frustum->IsRectangleInside(
-			m_collectables.front()->GetBound().GetPosition(),
-			m_collectables.front()->GetBound().GetHalfDimension())) {
+		if (m_isCollectableVisible) {
 
 			//--- Check if the mouse ray is colliding and if the user clicks then pickup the item and add to inventory
 			if (m_picker->IsColliding(m_collectables.front()->GetBound(), s_maxCollectableRange)) {
@@ -392,22 +421,47 @@ void PlayState::UpdateObjects()
 		}
 	}
 
-	for (auto entity : m_entities) {
-		
-		//--- Don't update anything unless we can see it
-		if (m_frustum->IsRectangleInside(
-			entity->GetBound().GetPosition(),
-			entity->GetBound().GetHalfDimension())) {
+	//--- Entities still waiting on their models when they were indexed are updated as soon as they arrive, whether we
+	//--- can see them or not - the tree only finds them (and the grid only collides them) by their real bounds
+	for (size_t loading = 0; loading < m_loadingEntities.size();) {
 
-			//--- Check if the object is even collidable (some objects are outwith world bounds and so don't need to be checked!)
-			if (entity->HasCollisionResponse()) {
+		unsigned int entity = m_loadingEntities[loading];
 
-				//--- If the player collides then stop movement (set to players previous position)
-				//--- (Eventually I'll figure out how to implement wall sliding...)
-				if (m_player->GetBound().IsColliding(entity->GetBound())) { m_player->Stop(); }
-			}
-			entity->Update();
-		}
+		if (!m_entities[entity]->GetModel()->IsResident()) { loading++; continue; }
+
+		m_entities[entity]->Update();
+
+		const AABounds3D& bound = m_entities[entity]->GetBound();
+		m_entityTree.Move(m_entityProxies[entity], bound.GetMin(), bound.GetMax());
+
+		if (m_entityBodies[entity] != -1) { m_collisionGrid.Move(m_entityBodies[entity], bound.GetMin(), bound.GetMax()); }
+
+		m_loadingEntities[loading] = m_loadingEntities.back();
+		m_loadingEntities.pop_back();
+	}
+
+	//--- Don't update anything unless we can see it
+	for (auto entity : m_visibleEntities) {
+
+		m_entities[entity]->Update();
+
+		//--- Then let the tree and grid know where it is now (neither does anything unless it has moved)
+		const AABounds3D& bound = m_entities[entity]->GetBound();
+		m_entityTree.Move(m_entityProxies[entity], bound.GetMin(), bound.GetMax());
+
+		if (m_entityBodies[entity] != -1) { m_collisionGrid.Move(m_entityBodies[entity], bound.GetMin(), bound.GetMax()); }
+	}
+
+	//--- Check for collisions between everything that has moved - whether we can see it or not, as the camera can lose
+	//--- sight of something the player is touching
+	m_collisionGrid.Move(m_playerBody, m_player->GetBound().GetMin(), m_player->GetBound().GetMax());
+	m_collisionGrid.Update();
+
+	for (const auto& pair : m_collisionGrid.GetPairs()) {
+
+		//--- If the player collides then stop movement (set to players previous position)
+		//--- (Eventually I'll figure out how to implement wall sliding...)
+		if (pair.first == m_playerBody || pair.second == m_playerBody) { m_player->Stop(); break; }
 	}
 }
 
@@ -434,6 +488,93 @@ void PlayState::UpdateComponents()
 
 	//--- Create our new frustum every frame - must be done at the end of all 3D objects updates
 	m_frustum->Update(Screen::Instance()->GetProjectionMatrix(), m_mainCamera->GetViewMatrix());
+
+	//--- Then find what can be seen from where the camera is now
+	CullObjects();
+}
+
+
+/*******************************************************************************************************************
+	Function that finds which entities (and the current collectable) can be seen this frame. The entity tree gives the
+	entities that are inside the frustum and those crossing its sides, the crossing ones are culled against it in one
+	batch along with the collectable (numbered after the entities), and only what is inside is checked against the
+	terrain
+*******************************************************************************************************************/
+void PlayState::CullObjects()
+{
+	size_t planeTests = m_frustum->GetPlaneTestCount();
+
+	//--- Entities whose leaves are entirely inside the frustum need no more testing, only the ones crossing its sides
+	m_entityTree.QueryFrustum(*m_frustum, m_insideObjects, m_queriedObjects);
+
+	if (!m_collectables.empty()) { m_queriedObjects.push_back((unsigned int)m_entities.size()); }
+
+	m_cullPositions.clear();
+	m_cullHalfDimensions.clear();
+
+	for (auto object : m_queriedObjects) {
+		Entity* entity = (object < m_entities.size()) ? m_entities[object] : m_collectables.front();
+		m_cullPositions.push_back((entity->GetBound().GetMin() + entity->GetBound().GetMax()) * 0.5f);
+		m_cullHalfDimensions.push_back((entity->GetBound().GetMax() - entity->GetBound().GetMin()) * 0.5f);
+	}
+
+	//--- Room for every object, then trimmed down to the ones inside (numbered by the tree's results, so numbered back)
+	m_crossingObjects.resize(m_cullPositions.size());
+	m_crossingObjects.resize(m_frustum->CullRectangles(m_cullPositions.data(), m_cullHalfDimensions.data(), m_cullPositions.size(), m_crossingObjects.data()));
+
+	for (auto object : m_crossingObjects) { m_insideObjects.push_back(m_queriedObjects[object]); }
+
+	//--- How many planes were tested, next to testing every side for every object
+	m_planeTestCount	= m_frustum->GetPlaneTestCount() - planeTests;
+	m_bruteForceCount	= 6 * (m_entities.size() + ((m_collectables.empty()) ? 0 : 1));
+
+	m_hiddenMinimums.clear();
+	m_hiddenMaximums.clear();
+
+	for (auto object : m_insideObjects) {
+		Entity* entity = (object < m_entities.size()) ? m_entities[object] : m_collectables.front();
+		m_hiddenMinimums.push_back(entity->GetBound().GetMin());
+		m_hiddenMaximums.push_back(entity->GetBound().GetMax());
+	}
+
+	m_hiddenCount = m_terrain->CullHidden(m_mainCamera->GetPosition(), m_hiddenMinimums.data(), m_hiddenMaximums.data(),
+										  m_hiddenMinimums.size(), m_isHidden);
+
+	//--- Entities marked as occluders (in their config) are drawn in to the occlusion buffer, unless the terrain hides them
+	m_occlusionBuffer.Begin(Screen::Instance()->GetProjectionMatrix() * m_mainCamera->GetViewMatrix());
+	m_isOccluder.assign(m_insideObjects.size(), 0);
+
+	for (size_t inside = 0; inside < m_insideObjects.size(); inside++) {
+
+		if (m_isHidden[inside] || m_insideObjects[inside] >= m_entities.size()) { continue; }
+
+		Entity* entity = m_entities[m_insideObjects[inside]];
+		const Model::Occluder* occluder = entity->GetModel()->GetOccluder();
+
+		if (occluder) {
+			m_occlusionBuffer.AddOccluder(occluder->positions.data(), occluder->positions.size(), occluder->indices.data(), occluder->indices.size(),
+										  entity->GetTransform()->GetTransformationMatrix());
+			m_isOccluder[inside] = 1;
+		}
+	}
+
+	m_occlusionBuffer.Rasterize();
+	m_occlusionBuffer.CullBoxes(m_hiddenMinimums.data(), m_hiddenMaximums.data(), m_hiddenMinimums.size(), m_isOccluded);
+
+	m_visibleEntities.clear();
+	m_isCollectableVisible = false;
+	m_occludedCount = 0;
+
+	for (size_t inside = 0; inside < m_insideObjects.size(); inside++) {
+
+		if (m_isHidden[inside]) { continue; }
+
+		//--- Bounds ignore rotation, so an occluder's mesh can poke out of its box - never let one hide itself
+		if (m_isOccluded[inside] && !m_isOccluder[inside]) { m_occludedCount++; continue; }
+
+		if (m_insideObjects[inside] < m_entities.size())	{ m_visibleEntities.push_back(m_insideObjects[inside]); }
+		else												{ m_isCollectableVisible = true; }
+	}
 }
 
 
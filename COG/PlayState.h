@@ -28,6 +28,9 @@
 #include "MinimapWidget.h"
 #include "Light.h"
 #include "Frustum.h"
+#include "BoundingVolumeTree.h"
+#include "CollisionGrid.h"
+#include "OcclusionBuffer.h"
 #include "Button.h"
 
 class PlayState : public GameState {
@@ -57,6 +60,7 @@ private:
 	void UpdateObjects();
 	void UpdateComponents();
 	void UpdateInterface();
+	void CullObjects();
 
 private:
 	void RenderWorld();
@@ -84,6 +88,11 @@ private:
 
 private:
 	unsigned int	m_lightCount;
+	size_t			m_hiddenCount;
+	size_t			m_occludedCount;
+	size_t			m_planeTestCount;
+	size_t			m_bruteForceCount;
+	bool			m_isCollectableVisible;
 	bool			m_finalEventIssued;
 	bool			m_debugMode;
 	bool			m_wireFrameMode;
@@ -96,6 +105,28 @@ private:
 	std::vector<Light*>				m_lights;
 	std::vector<GameComponent*>		m_components;
 
+private:
+	BoundingVolumeTree				m_entityTree;
+	std::vector<int>				m_entityProxies;
+	CollisionGrid					m_collisionGrid;
+	std::vector<int>				m_entityBodies;
+	std::vector<unsigned int>		m_loadingEntities;
+	int								m_playerBody;
+	OcclusionBuffer					m_occlusionBuffer;
+
+private:
+	std::vector<unsigned int>		m_queriedObjects;
+	std::vector<glm::vec3>			m_cullPositions;
+	std::vector<glm::vec3>			m_cullHalfDimensions;
+	std::vector<unsigned int>		m_crossingObjects;
+	std::vector<unsigned int>		m_insideObjects;
+	std::vector<glm::vec3>			m_hiddenMinimums;
+	std::vector<glm::vec3>			m_hiddenMaximums;
+	std::vector<unsigned char>		m_isHidden;
+	std::vector<unsigned char>		m_isOccluded;
+	std::vector<unsigned char>		m_isOccluder;
+	std::vector<unsigned int>		m_visibleEntities;
+
 private:
 	static const unsigned int s_maxEntities;
 	static const unsigned int s_maxShaders;
@@ -1,6 +1,6 @@
 #include "Player.h"
 #include "InputManager.h"
-#include "FileManager.h"
+#include "ConfigManager.h"
 #include "Tools.h"
 #include "AudioManager.h"
 
@@ -34,22 +34,13 @@ Player::~Player()
 *******************************************************************************************************************/
 Player* Player::Create(const std::string& tag)
 {
-	File::Instance()->OpenForReading("Assets\\Files\\gameObjects.config");
+	ConfigObject data = Config::Instance()->Find("Assets\\Files\\gameObjects.config", tag);
 
-	std::map<std::string, std::map<std::string, std::string>> data;
+	glm::vec3 position	= data.GetVector3("transform");
+	glm::vec3 rotation	= data.GetVector3("rotation");
+	glm::vec3 scale		= data.GetVector3("scale");
 
-	File::Instance()->GetObjectData(tag, data);
-
-	glm::vec3 position	= glm::vec3(StringToFloat(data[tag]["transform.x"]), StringToFloat(data[tag]["transform.y"]), StringToFloat(data[tag]["transform.z"]));
-	glm::vec3 rotation	= glm::vec3(StringToFloat(data[tag]["rotation.x"]), StringToFloat(data[tag]["rotation.y"]), StringToFloat(data[tag]["rotation.z"]));
-	glm::vec3 scale		= glm::vec3(StringToFloat(data[tag]["scale.x"]), StringToFloat(data[tag]["scale.y"]), StringToFloat(data[tag]["scale.z"]));
-
-	//--- NOTE
-	// This function was made for ease of use/quickness and is not optimized at all, so please ignore (I know it's ugly!)
-	// Later I plan on tidying up file handling and building a proper file parsing system (I never got round to this!)
-	//---
-
-	return new Player(data[tag]["tag"], Transform(position, rotation, scale));
+	return new Player(data.GetString("tag"), Transform(position, rotation, scale));
 }
 
 
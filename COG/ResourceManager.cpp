@@ -1,10 +1,13 @@
 #include "ResourceManager.h"
+#include "Timer.h"
 #include "Log.h"
 
 /*******************************************************************************************************************
 	Default Constructor
 *******************************************************************************************************************/
 ResourceManager::ResourceManager()
+	:	m_pendingLoads(0),
+		m_isAsyncLoading(false)
 {
 	FL_LOG("[RESOURCE MANAGER CONSTRUCT]", FL_LOG_EMPTY, LOG_BREAK);
 }
@@ -15,6 +18,13 @@ ResourceManager::ResourceManager()
 *******************************************************************************************************************/
 void ResourceManager::Shutdown()
 {
+	//--- Any uploads still waiting are thrown away, their data is freed along with them
+	{
+		std::lock_guard<std::mutex> lock(m_uploadLock);
+		m_uploads.clear();
+		m_pendingLoads = 0;
+	}
+
 	m_bufferCache.Unload();
 	m_fontCache.Unload();
 	m_textureCache.Unload();
@@ -23,6 +33,52 @@ void ResourceManager::Shutdown()
 }
 
 
+/*******************************************************************************************************************
+	A function that runs the OpenGL uploads of finished loads, until the budget (in milliseconds) has been used up.
+	At least one upload is always run, so loading can never stall, no matter how small the budget
+*******************************************************************************************************************/
+void ResourceManager::ProcessUploads(float budget)
+{
+	if (m_pendingLoads == 0) { return; }
+
+	Timer uploadTime(true);
+	uploadTime.Start();
+
+	do {
+		std::function<void()> upload;
+
+		{
+			std::lock_guard<std::mutex> lock(m_uploadLock);
+			if (m_uploads.empty()) { return; }
+
+			upload = std::move(m_uploads.front());
+			m_uploads.pop_front();
+		}
+
+		upload();
+		m_pendingLoads--;
+
+	} while (uploadTime.ElapsedMilliseconds() < budget);
+}
+
+
+/*******************************************************************************************************************
+	A function that blocks until every pending load has finished and been uploaded
+*******************************************************************************************************************/
+void ResourceManager::FinishLoading()
+{
+	while (m_pendingLoads > 0) {
+
+		{
+			std::unique_lock<std::mutex> lock(m_uploadLock);
+			m_uploadCondition.wait(lock, [this]() { return !m_uploads.empty(); });
+		}
+
+		ProcessUploads(0.0f);
+	}
+}
+
+
 /*******************************************************************************************************************
 	A function that adds a new font to our font cache and relevant buffers needed to the buffer cache
 *******************************************************************************************************************/
@@ -99,6 +155,15 @@ bool ResourceManager::AddPackedBuffers(const std::string& tag, bool isIndexed)
 }
 
 
+/*******************************************************************************************************************
+	A function that removes a single VAO, packed VBO and EBO from our buffer cache
+*******************************************************************************************************************/
+void ResourceManager::RemovePackedBuffers(const std::string& tag)
+{
+	m_bufferCache.RemovePackedBuffers(tag);
+}
+
+
 /*******************************************************************************************************************
 	A function that adds UBO to our buffer cache and binds it to the data passed in
 *******************************************************************************************************************/
@@ -186,4 +251,23 @@ VertexArray* ResourceManager::GetVAO(const std::string& tag)
 IndexBuffer* ResourceManager::GetEBO(const std::string& tag)
 {
 	return m_bufferCache.GetEBO(tag);
-}
\ No newline at end of file
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+unsigned int ResourceManager::GetPendingLoads() const	{ return m_pendingLoads; }
+bool ResourceManager::IsAsyncLoading() const			{ return m_isAsyncLoading; }
+
+
+/*******************************************************************************************************************
+	Modifier methods
+*******************************************************************************************************************/
+void ResourceManager::SetAsyncLoading(bool isAsyncLoading) { m_isAsyncLoading = isAsyncLoading; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const float ResourceManager::s_uploadBudget = 4.0f;
\ No newline at end of file
@@ -14,6 +14,9 @@
 	memory being allocated and de-allocated whilst debugging.
 	Has various error checking features embedded into our cache classes (these aren't perfect, but will improve later).
 	Resources are loaded when they are first called and don't get destroyed until the end of the game.
+	Supports asynchronous loading: the CPU side of a load (reading files, parsing, decoding) runs on the worker
+	threads (see ThreadPool.h), and the OpenGL side is queued up and run on the main thread, a few milliseconds
+	worth per frame (see ProcessUploads). Models and textures load this way while SetAsyncLoading(true) is set.
 
 	[Upcoming]
 	A more improved error checking system; exception handling, try/catch, throw. Popup dialog's when thing's go
@@ -29,8 +32,14 @@
 *******************************************************************************************************************/
 #include <GLEW.h>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 
 #include "Singleton.h"
+#include "ThreadPool.h"
 #include "TextureCache.h"
 #include "FontCache.h"
 #include "BufferCache.h"
@@ -43,6 +52,14 @@ public:
 public:
 	void Shutdown();
 
+public:
+	template <typename T> void LoadAsync(std::function<bool(T&)> load, std::function<void(T&)> upload);
+	void ProcessUploads(float budget = s_uploadBudget);
+	void FinishLoading();
+	unsigned int GetPendingLoads() const;
+	bool IsAsyncLoading() const;
+	void SetAsyncLoading(bool isAsyncLoading);
+
 public:
 	void AddFont(const std::string& tag, const std::map<GLchar, FontCache::Character>& glyphs);
 	void AddTexture(const std::string& tag, GLuint id);
@@ -51,6 +68,7 @@ public:
 	bool AddBuffers(const std::string& tag, bool isIndexed,
 					bool hasTextureCoords = false, bool hasNormals = false, bool hasTangentsAndBitangents = false);
 	bool AddPackedBuffers(const std::string& tag, bool isIndexed);
+	void RemovePackedBuffers(const std::string& tag);
 
 public:
 	bool AddBinding(GLsizeiptr byteSize, GLuint binding, bool dynamic);
@@ -83,6 +101,40 @@ private:
 	BufferCache		m_bufferCache;
 	FontCache		m_fontCache;
 	TextureCache	m_textureCache;
+
+private:
+	std::deque<std::function<void()>>	m_uploads;
+	std::mutex							m_uploadLock;
+	std::condition_variable				m_uploadCondition;
+	unsigned int						m_pendingLoads;
+	bool								m_isAsyncLoading;
+
+private:
+	static const float s_uploadBudget;
 };
 
-typedef Singleton<ResourceManager> Resource;
\ No newline at end of file
+typedef Singleton<ResourceManager> Resource;
+
+
+/*******************************************************************************************************************
+	A template function that runs load on a worker thread, then queues upload to run on the main thread.
+	Anything the two need to share must be held in T - neither function should capture the object being loaded,
+	as it may have been copied or destroyed by the time they run. Upload is skipped if load returns false
+*******************************************************************************************************************/
+template <typename T> void ResourceManager::LoadAsync(std::function<bool(T&)> load, std::function<void(T&)> upload)
+{
+	m_pendingLoads++;
+
+	Workers::Instance()->Enqueue([this, load, upload]() {
+
+		std::shared_ptr<T> data = std::make_shared<T>();
+		bool isLoaded = load(*data);
+
+		{
+			std::lock_guard<std::mutex> lock(m_uploadLock);
+			m_uploads.emplace_back([data, isLoaded, upload]() { if (isLoaded) { upload(*data); } });
+		}
+
+		m_uploadCondition.notify_one();
+	});
+}
\ No newline at end of file
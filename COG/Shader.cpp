@@ -1,9 +1,9 @@
-#include <fstream>
 #include <gtc/type_ptr.hpp>
 #include "Shader.h"
 #include "Log.h"
 #include "vsGLInfoLib.h"
 #include "Camera.h"
+#include "VirtualFile.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
@@ -110,24 +110,12 @@ bool Shader::CompileShader(const std::string& fileLocation)
 	else if (fileLocation.find(".frag") != std::string::npos)			{ shaderType = m_fragmentShader; }
 	else { FL_LOG("[SHADER] Invalid shader file extension: ", fileLocation.c_str(), LOG_ERROR); return false; }
 
-	std::string fileData;
-	std::ifstream shaderFile;
+	//--- Open the shader file (from a pack, or from disk) and copy its contents in to our string
+	VirtualFile shaderFile;
 
-	//--- Ensure the ifstream object we created above can throw exceptions
-	shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		try {
-			//--- Create the shader stream that will hold the file data and then open the file
-			std::stringstream shaderStream;
-			shaderFile.open(fileLocation);
+	if (!shaderFile.Open(fileLocation)) { FL_LOG("[SHADER] Problem loading shader file: ", fileLocation.c_str(), LOG_ERROR); return false; }
 
-			//--- Read the files buffer contents in to the stream and then close the file
-			shaderStream << shaderFile.rdbuf();
-			shaderFile.close();
-
-			//--- Convert the stream data in to a string and then store it in to our string
-			fileData = shaderStream.str();
-		}
-		catch (std::ifstream::failure e) { FL_LOG("[SHADER] Problem loading shader file: ", fileLocation.c_str(), LOG_ERROR); return false; }
+	std::string fileData(shaderFile.GetData(), shaderFile.GetSize());
 
 	FL_LOG("[SHADER] Loaded shader successfully: ", fileLocation.c_str(), LOG_SUCCESS);
 
@@ -424,6 +412,7 @@ void Shader::SetBool(const std::string& uniformName, const bool value)
 }
 
 void Shader::SwapCamera(Camera* camera) { m_camera = camera; }
+Camera* Shader::GetCamera() const		{ return m_camera; }
 
 
 /*******************************************************************************************************************
@@ -103,6 +103,7 @@ public:
 
 public:
 	void SwapCamera(Camera* camera);
+	Camera* GetCamera() const;
 
 public:
 	static int GetTextureUnit(TextureUnit unit);
@@ -3,7 +3,7 @@
 /*******************************************************************************************************************
 	Skybox.h, Skybox.cpp
 	Created by Kim Kane
-	Last updated: 21/03/2018
+	Last updated: 17/10/2026
 	Class finalized: 02/04/2018
 
 	Generates a skybox of any size around our 3D world.
@@ -11,6 +11,7 @@
 	[Features]
 	Supports OpenGL cube maps.
 	Size can be changed dynamically.
+	Supports asynchronous loading (see ResourceManager.h) - the faces are decoded on a worker thread (see Texture.h).
 
 	[Upcoming]
 	Skydomes.
@@ -1,30 +1,46 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include <algorithm>
+#include <emmintrin.h>
 #include "Terrain.h"
 #include "Log.h"
 #include "Maths.h"
 #include "TerrainShader.h"
 #include "ResourceManager.h"
 #include "Tools.h"
-#include "FileManager.h"
+#include "ConfigManager.h"
+#include "VirtualFile.h"
+#include "TerrainGenerator.h"
+#include "ScreenManager.h"
+#include "Camera.h"
+#include "ThreadPool.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set all default values of variables
 *******************************************************************************************************************/
 Terrain::Terrain(const std::string& tag, const Transform& transform, const TexturePack& textures,
-				 const TexturePack& normals, const std::string& heightmap, float level)
+				 const TexturePack& normals, const std::string& heightmap, float level, bool isLodEnabled,
+				 const TerrainStreamer::Settings& streaming, const TerrainNoise::Settings& noise)
 
 	:	GameObject(tag + ".terrain", transform),
-		m_grid({ 0, 0, 0.0f, 0.0f }),
+		m_grid({ 0.0f, 0.0f }),
 		m_width(0),
 		m_height(0),
 		m_level(level),
 		m_minimapMode(false),
+		m_heights(nullptr),
+		m_isLodEnabled(isLodEnabled),
+		m_frustum(glm::mat4(1.0f), glm::mat4(1.0f)),
+		m_focus(0.0f),
+		m_heading(0.0f),
 		m_textures(textures),
 		m_normals(normals),
 		m_bounds({ { -70.0f, 0.0f, -208.0f }, { 70.0f, 0.0f, -45.0f} })
 {
+	if (streaming.tilesX > 0 && streaming.tilesZ > 0) { m_streamer = std::make_unique<TerrainStreamer>(m_tag, streaming); }
+	if (noise.octaves > 0) { m_noise = std::make_shared<const TerrainNoise>(noise); }
+
 	Load(heightmap);
 }
 
@@ -43,137 +59,521 @@ Terrain::~Terrain()
 *******************************************************************************************************************/
 Terrain* Terrain::Create(const std::string& tag)
 {
-	File::Instance()->OpenForReading("Assets\\Files\\gameObjects.config");
-	
-	std::map<std::string, std::map<std::string, std::string>> data;
-	
-	File::Instance()->GetObjectData(tag, data);
+	ConfigObject data = Config::Instance()->Find("Assets\\Files\\gameObjects.config", tag);
 
-	glm::vec3 position	= glm::vec3(StringToFloat(data[tag]["transform.x"]), StringToFloat(data[tag]["transform.y"]), StringToFloat(data[tag]["transform.z"]));
-	glm::vec3 rotation	= glm::vec3(StringToFloat(data[tag]["rotation.x"]), StringToFloat(data[tag]["rotation.y"]), StringToFloat(data[tag]["rotation.z"]));
-	glm::vec3 scale		= glm::vec3(StringToFloat(data[tag]["scale.x"]), StringToFloat(data[tag]["scale.y"]), StringToFloat(data[tag]["scale.z"]));
+	glm::vec3 position	= data.GetVector3("transform");
+	glm::vec3 rotation	= data.GetVector3("rotation");
+	glm::vec3 scale		= data.GetVector3("scale");
 
-	float level			= StringToFloat(data[tag]["level"]);
+	float level			= data.GetFloat("level");
+	bool isLodEnabled	= data.GetBool("lod");
 
-	//--- NOTE
-	// This function was made for ease of use/quickness and is not optimized at all, so please ignore (I know it's ugly!)
-	// Later I plan on tidying up file handling and building a proper file parsing system (I never got round to this!)
-	//---
+	//--- Only a streamed terrain has tiles, the memory budget is in megabytes
+	glm::vec2 tiles		= data.GetVector2("tiles");
+
+	TerrainStreamer::Settings streaming = {
+		(int)tiles.x, (int)tiles.y, data.GetInteger("tile.size"), data.GetFloat("stream.radius"),
+		(size_t)data.GetInteger("stream.budget") * 1024 * 1024
+	};
+
+	//--- Only a procedural terrain has octaves of noise, anything left as 0 gets a default (see TerrainNoise)
+	TerrainNoise::Settings noise = {
+		(unsigned int)data.GetInteger("noise.seed"),
+		(std::string(data.GetString("noise.type")) == "ridged") ? TerrainNoise::NOISE_RIDGED : TerrainNoise::NOISE_FRACTAL,
+		data.GetInteger("noise.size"), data.GetInteger("noise.octaves"), data.GetFloat("noise.frequency"),
+		data.GetFloat("noise.lacunarity"), data.GetFloat("noise.gain"), data.GetFloat("noise.warp")
+	};
 
 	return new Terrain(
-		data[tag]["tag"], Transform(position, rotation, scale),
-		TexturePack(data[tag]["base"], data[tag]["red"], data[tag]["green"], data[tag]["blue"], data[tag]["blendmap"]),
-		TexturePack(data[tag]["base.normal"], data[tag]["red.normal"], data[tag]["green.normal"], data[tag]["blue.normal"]),
-		data[tag]["heightmap"], level);
+		data.GetString("tag"), Transform(position, rotation, scale),
+		TexturePack(data.GetString("base"), data.GetString("red"), data.GetString("green"), data.GetString("blue"), data.GetString("blendmap")),
+		TexturePack(data.GetString("base.normal"), data.GetString("red.normal"), data.GetString("green.normal"), data.GetString("blue.normal")),
+		data.GetString("heightmap"), level, isLodEnabled, streaming, noise);
 }
 
 
 /*******************************************************************************************************************
-	Function that initializes all necessary start-up procedures
+	Function that initializes all necessary start-up procedures. The heightfield is read on a worker and its buffers
+	are made on the main thread if asynchronous loading is switched on - only the settings are captured, and the
+	terrain picks up its heightfield once it's resident (see Update)
 *******************************************************************************************************************/
 bool Terrain::Load(const std::string& heightmap)
 {
-	//--- Generate the heightmap for the terrain
-	if (!GenerateHeightMap(heightmap)) { return false; }
+	//--- A streamed terrain is loaded a tile at a time as the player moves around
+	if (m_streamer) { return LoadStreamedTerrain(heightmap); }
+
+	//--- Flip the blend map texture
+	m_textures.GetBlendMap()->SetMirrored(true);
+
+	//--- stb_image's flip setting is shared by every thread, so set it here before the heightmap is decoded on a worker
+	stbi_set_flip_vertically_on_load(true);
+
+	//--- If we already have buffers, the heightfield they were made from can be re-used if it's still resident
+	bool hasBuffers = !Resource::Instance()->AddPackedBuffers(m_tag, true);
+	auto found		= s_heightfields.find(m_tag);
+
+	std::shared_ptr<Heightfield> resident = (hasBuffers && found != s_heightfields.end()) ? found->second : nullptr;
+
+	if (Resource::Instance()->IsAsyncLoading()) {
+
+		std::string tag								= m_tag;
+		float level									= m_level;
+		bool isLodEnabled							= m_isLodEnabled;
+		std::shared_ptr<const TerrainNoise> noise	= m_noise;
+
+		auto loading	= std::make_shared<std::shared_ptr<Heightfield>>();
+		m_loading		= loading;
+
+		Resource::Instance()->LoadAsync<HeightfieldData>(
+			[heightmap, level, isLodEnabled, noise, resident](HeightfieldData& data) {
+				return ReadHeightfield(heightmap, level, isLodEnabled, noise, resident, data);
+			},
+			[tag, isLodEnabled, loading](HeightfieldData& data) {
+				UploadHeightfield(tag, isLodEnabled, data);
+				*loading = data.heightfield;
+			});
+
+		return true;
+	}
+
+	HeightfieldData data;
+
+	if (!ReadHeightfield(heightmap, m_level, m_isLodEnabled, m_noise, resident, data)) { return false; }
+
+	UploadHeightfield(m_tag, m_isLodEnabled, data);
+	AttachHeightfield(data.heightfield);
 	
-	//--- Level out the heightmap so that the height of the terrain is not too high
-	LevelHeightMap();
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that reads (or generates) everything the terrain is made from. No OpenGL calls are made here, so this
+	is safe to run on a worker thread
+*******************************************************************************************************************/
+bool Terrain::ReadHeightfield(const std::string& heightmap, float level, bool isLodEnabled, const std::shared_ptr<const TerrainNoise>& noise,
+							  const std::shared_ptr<Heightfield>& resident, HeightfieldData& outData)
+{
+	std::string fileLocation	= "Assets\\Terrain\\" + heightmap;
+	std::string cacheLocation	= fileLocation + ".cogterrain";
+
+	//--- The heightmap's bytes (and the settings we generate the terrain with) decide whether anything we made before can be re-used.
+	//--- A procedural terrain has no heightmap file, its noise settings decide instead
+	VirtualFile file;
+	unsigned long long key = 0;
+
+	if (noise) { key = noise->GenerateKey(level, isLodEnabled); }
+
+	else if (!file.Open(fileLocation)) {
+		FL_LOG("[TERRAIN] Problem loading heightmap file: ", fileLocation.c_str(), LOG_ERROR);
+		return false;
+	}
+
+	else { key = TerrainCache::GenerateKey(file.GetData(), file.GetSize(), level, isLodEnabled); }
+
+	//--- The resident heightfield was made from the same heightmap, so re-use it and its buffers
+	if (resident && resident->key == key) {
+		outData.isResident	= true;
+		outData.heightfield	= resident;
+		FL_LOG("[TERRAIN] Re-using resident terrain: ", fileLocation.c_str(), LOG_SUCCESS);
+		return true;
+	}
+
+	outData.heightfield = std::make_shared<Heightfield>();
+
+	Heightfield& field	= *outData.heightfield;
+	field.key			= key;
+
+	//--- Read everything back from the cache if we can, otherwise generate it and write the cache for next time
+	if (!LoadCachedTerrain(cacheLocation, isLodEnabled, field)) {
+
+		//--- Generate the heightmap for the terrain (leveled out, so that the height of the terrain is not too high)
+		bool isGenerated = (noise) ? GenerateNoiseHeights(*noise, level, isLodEnabled, field) : GenerateHeightMap(file, fileLocation, level, isLodEnabled, field);
+
+		if (!isGenerated) { return false; }
+
+		//--- A LOD terrain only needs the heights, the full resolution mesh is never made
+		if (isLodEnabled) {
+			TerrainCache::Write(cacheLocation, key, field.width, field.height, level, field.heights,
+								std::vector<VertexBuffer::PackedVertex>(), std::vector<unsigned int>(), field.quadtree);
+		}
+
+		//--- Otherwise, generate the geometry for the terrain
+		else if (!GenerateTerrain(cacheLocation, level, outData)) { return false; }
+	}
+
+	//--- A LOD terrain is drawn with patches chosen from its own quadtree
+	if (isLodEnabled) { field.lod.Build(field.heights, field.width, field.height); }
+
+	//--- Every kind of terrain can be raycast against, and the pyramid is quick to build, so it isn't cached
+	field.pyramid.Build(field.heights, field.width, field.height);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that reads a terrain back from its cache, if the cache was made from this heightmap with these settings.
+	The heights are used straight from the mapped file, and the mesh is pushed straight from it to the GPU
+*******************************************************************************************************************/
+bool Terrain::LoadCachedTerrain(const std::string& cacheLocation, bool isLodEnabled, Heightfield& field)
+{
+	TerrainCache& cache = field.cache;
+
+	if (!cache.Open(cacheLocation, field.key)) { return false; }
+
+	//--- A cache written by the other kind of terrain won't match the key, but never push a mesh that isn't there
+	if (!isLodEnabled && cache.GetVertexCount() == 0) { cache.Close(); return false; }
+
+	field.width		= cache.GetWidth();
+	field.height	= cache.GetHeight();
+	field.heights	= cache.GetHeights();
+
+	if (!isLodEnabled) { field.quadtree.Restore(cache.GetNodes(), cache.GetNodeCount(), cache.GetChunks(), cache.GetChunkCount()); }
+
+	FL_LOG("[TERRAIN] Terrain loaded from cache: ", cacheLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that pushes a heightfield's mesh to the GPU, and keeps it resident - this must be called on the main thread.
+	A terrain read from its cache is pushed straight from the mapped file
+*******************************************************************************************************************/
+void Terrain::UploadHeightfield(const std::string& tag, bool isLodEnabled, HeightfieldData& data)
+{
+	//--- A resident heightfield already has its buffers
+	if (data.isResident) { return; }
+
+	const TerrainCache& cache = data.heightfield->cache;
+
+	Resource::Instance()->GetVAO(tag)->Bind();
+
+	//--- A LOD terrain only needs the shared grid patch. The vertices change every frame, so they're pushed when the terrain is rendered
+	if (isLodEnabled) {
+
+		std::vector<GLushort> indices;
+		TerrainLod::GeneratePatchIndices(indices);
+
+		Resource::Instance()->GetEBO(tag)->Push(indices);
+
+		FL_LOG("[TERRAIN] Terrain LOD patch generated, vertices: ", TerrainLod::GetPatchVertexCount(), LOG_SUCCESS);
+	}
+
+	else if (data.vertices.empty()) {
+		Resource::Instance()->GetPackedVBO(tag)->Push(cache.GetVertices(), cache.GetVertexCount(), false);
+		Resource::Instance()->GetEBO(tag)->Push(cache.GetIndices(), cache.GetIndexCount());
+	}
+
+	//--- Push the vertex and index data to the GPU for rendering	(hurrah)
+	else {
+		Resource::Instance()->GetPackedVBO(tag)->Push(data.vertices, false);
+		Resource::Instance()->GetEBO(tag)->Push(data.indices);
+	}
+
+	Resource::Instance()->GetVAO(tag)->Unbind();
+
+	s_heightfields[tag] = data.heightfield;
+}
+
 
-	//--- Calculate normals for terrain lighting (make sure this is done after leveling the terrain)
-	CalculateNormals();
+/*******************************************************************************************************************
+	Function that makes a resident heightfield the one the terrain is drawn, collided and raycast with
+*******************************************************************************************************************/
+void Terrain::AttachHeightfield(const std::shared_ptr<Heightfield>& heightfield)
+{
+	m_heightfield	= heightfield;
+	m_width			= m_heightfield->width;
+	m_height		= m_heightfield->height;
+	m_heights		= m_heightfield->heights;
 
 	//--- Calculate the terrain grid length
-	m_grid.length = (float)(m_heights.size() - 1);
+	m_grid.length = (float)(m_width - 1);
 
 	//--- Determine the grids square size. Will always be 1 in this case
 	m_grid.square = (float)(m_width - 1) / m_grid.length;
+}
+
+
+/*******************************************************************************************************************
+	Function that sets up a streamed terrain. Only the overview heights are loaded here, the tiles are loaded
+	around the player as they move (see Update and SetFocus)
+*******************************************************************************************************************/
+bool Terrain::LoadStreamedTerrain(const std::string& heightmap)
+{
+	if (!m_streamer->Load(heightmap, m_level, m_noise)) { m_streamer.reset(); return false; }
+
+	m_width		= m_streamer->GetGridWidth();
+	m_height	= m_streamer->GetGridHeight();
+
+	m_grid.length = (float)(m_width - 1);
+	m_grid.square = (float)(m_width - 1) / m_grid.length;
 
-	//--- Flip the blend map texture
 	m_textures.GetBlendMap()->SetMirrored(true);
-	
-	//--- If we already have buffers just re-use them
-	if (!Resource::Instance()->AddPackedBuffers(m_tag, false)) { return false; }
 
-	//--- Otherwise, initialize the vertex buffer that holds the geometry for the terrain
-	if (!GenerateTerrain()) { return false; }
-	
+	//--- The whole point of a streamed world is to walk across it, so the bounds are the edges of the world
+	glm::vec3 position = m_transform.GetPosition();
+
+	m_bounds.minimum = glm::vec3(position.x, 0.0f, -(position.z + (m_height - 1) * m_grid.square));
+	m_bounds.maximum = glm::vec3(position.x + (m_width - 1) * m_grid.square, 0.0f, -position.z);
+
 	return true;
 }
 
 
 /*******************************************************************************************************************
-	Function that returns the height of a given x and z position within the terrain (for collision)
+	Function that returns the height of a given x and z position within the terrain (for collision).
+	Nothing is written to the terrain, so it can be called from any number of threads at once
 *******************************************************************************************************************/
-float Terrain::GetHeight(float xPosition, float zPosition, float offset)
+float Terrain::GetHeight(float xPosition, float zPosition, float offset) const
 {
 	//--- Convert the object coordinate passed in, into a position relative to the terrain
-	float x	= xPosition - m_transform.GetPosition().x;
-	float z	= -zPosition - m_transform.GetPosition().z;
+	float x	= (xPosition - m_transform.GetPosition().x) / m_grid.square;
+	float z	= (-zPosition - m_transform.GetPosition().z) / m_grid.square;
+
+	//--- A streamed terrain finds the tile underneath, or the coarse overview heights if that tile isn't loaded yet
+	if (m_streamer) { return m_streamer->IsInside(x, z) ? m_streamer->GetHeight(x, z) + offset : 0.0f; }
 
-	//--- Determine which grid square the object is in
-	m_grid.x = (int)std::floor(x / m_grid.square);
-	m_grid.z = (int)std::floor(z / m_grid.square);
+	//--- Make sure the object coordinates are within a valid grid square on the terrain, if not return the height as 0.
+	//--- The grid square is made up of 2 triangles, the height is interpolated across the one the object is standing on
+	float height = 0.0f;
 
-	//--- Make sure the object coordinates are within a valid grid square on the terrain, if not return the height as 0
-	if (m_grid.x >= m_grid.length || m_grid.z >= m_grid.length || m_grid.x < 0 || m_grid.z < 0)
-	{
-		return 0.0f;
+	if (!terrain_generator::SampleHeight(m_heights, m_width, m_height, x, z, height)) { return 0.0f; }
+
+	//--- Finally, return the calculated height, plus any additional offset provided
+	//--- (add an offset for when you want objects to have an additional height, still relative to the terrain height, e.g birds!)
+	return height + offset;
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the terrain height under many x and z positions at once, the same as calling GetHeight for each.
+	Four positions are worked out at a time with SSE2 - only reading the corner heights is done one position at a time.
+	Like GetHeight, it's safe to call from any number of threads
+*******************************************************************************************************************/
+void Terrain::GetHeights(const glm::vec2* positions, float* outHeights, size_t count, float offset) const
+{
+	if (m_width < 2 || m_height < 2) { std::fill(outHeights, outHeights + count, 0.0f); return; }
+
+	//--- A streamed terrain's heights are spread over its tiles, so they're found one at a time
+	if (m_streamer) {
+		for (size_t position = 0; position < count; position++) { outHeights[position] = GetHeight(positions[position].x, positions[position].y, offset); }
+		return;
 	}
 
-	//--- Find out where on the grid square the object is located.
-	//--- Get the x and z distance of object from top left corner of the grid square by using % operator,
-	//--- and then divide the result by the grid square size, which will give us an x and z coordinate between 0 and 1.
-	glm::vec3 object = glm::vec3(0.0f);
-	object.x = (std::fmod(x, m_grid.square)) / m_grid.square;
-	object.z = (std::fmod(z, m_grid.square)) / m_grid.square;
-	
-	//--- The grid square is made up of 2 triangles, so figure out which triangle within the grid square the object is standing on
-	if (object.x <= (1 - object.z)) {
-
-		//--- If the object is in the left triangle, use Barycentric interpolation
-		//--- to figure out the height of the terrain where the object is located
-		object.y = maths::Barycentric(	glm::vec3(0, m_heights[m_grid.x][m_grid.z], 0),
-										glm::vec3(1, m_heights[m_grid.x + 1][m_grid.z], 0),
-										glm::vec3(0, m_heights[m_grid.x][m_grid.z + 1], 1),
-										glm::vec2(object.x, object.z));
+	const __m128 ONE			= _mm_set1_ps(1.0f);
+	const __m128 ZERO			= _mm_setzero_ps();
+	const __m128 OFFSET			= _mm_set1_ps(offset);
+	const __m128 POSITION_X		= _mm_set1_ps(m_transform.GetPosition().x);
+	const __m128 POSITION_Z		= _mm_set1_ps(m_transform.GetPosition().z);
+	const __m128 INVERSE_SQUARE	= _mm_set1_ps(1.0f / m_grid.square);
+	const __m128 LAST_COLUMN	= _mm_set1_ps((float)(m_width - 1));
+	const __m128 LAST_ROW		= _mm_set1_ps((float)(m_height - 1));
+
+	alignas(16) int columns[4], rows[4];
+	alignas(16) float corners[4][4];
+
+	size_t position = 0;
+
+	for (; position + 4 <= count; position += 4) {
+
+		//--- Split 4 interleaved x and z pairs in to 4 x values and 4 z values
+		__m128 first	= _mm_loadu_ps(&positions[position].x);
+		__m128 second	= _mm_loadu_ps(&positions[position + 2].x);
+		__m128 x		= _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z		= _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+
+		x = _mm_mul_ps(_mm_sub_ps(x, POSITION_X), INVERSE_SQUARE);
+		z = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(ZERO, z), POSITION_Z), INVERSE_SQUARE);
+
+		//--- Round down (truncating rounds towards zero, so take one off anything that was rounded up)
+		__m128 gridX = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		__m128 gridZ = _mm_cvtepi32_ps(_mm_cvttps_epi32(z));
+
+		gridX = _mm_sub_ps(gridX, _mm_and_ps(_mm_cmpgt_ps(gridX, x), ONE));
+		gridZ = _mm_sub_ps(gridZ, _mm_and_ps(_mm_cmpgt_ps(gridZ, z), ONE));
+
+		//--- Positions off the terrain are read from the first grid square, and given a height of 0 at the end
+		__m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(gridX, ZERO), _mm_cmplt_ps(gridX, LAST_COLUMN)),
+									 _mm_and_ps(_mm_cmpge_ps(gridZ, ZERO), _mm_cmplt_ps(gridZ, LAST_ROW)));
+
+		_mm_store_si128((__m128i*)columns, _mm_cvttps_epi32(_mm_and_ps(gridX, isInside)));
+		_mm_store_si128((__m128i*)rows, _mm_cvttps_epi32(_mm_and_ps(gridZ, isInside)));
+
+		for (int lane = 0; lane < 4; lane++) {
+			const float* corner = &m_heights[(size_t)rows[lane] * m_width + columns[lane]];
+			corners[0][lane] = corner[0];
+			corners[1][lane] = corner[1];
+			corners[2][lane] = corner[m_width];
+			corners[3][lane] = corner[m_width + 1];
+		}
+
+		__m128 bottomLeft	= _mm_load_ps(corners[0]);
+		__m128 bottomRight	= _mm_load_ps(corners[1]);
+		__m128 topLeft		= _mm_load_ps(corners[2]);
+		__m128 topRight		= _mm_load_ps(corners[3]);
+
+		__m128 objectX = _mm_sub_ps(x, gridX);
+		__m128 objectZ = _mm_sub_ps(z, gridZ);
+
+		//--- Work out the height on both triangles, then keep the one each position is standing on
+		__m128 left		= _mm_add_ps(bottomLeft, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(bottomRight, bottomLeft), objectX),
+																_mm_mul_ps(_mm_sub_ps(topLeft, bottomLeft), objectZ)));
+
+		__m128 right	= _mm_add_ps(bottomRight, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(topRight, bottomRight), objectZ),
+																 _mm_mul_ps(_mm_sub_ps(topLeft, topRight), _mm_sub_ps(ONE, objectX))));
+
+		__m128 isLeft = _mm_cmple_ps(objectX, _mm_sub_ps(ONE, objectZ));
+		__m128 height = _mm_or_ps(_mm_and_ps(isLeft, left), _mm_andnot_ps(isLeft, right));
+
+		_mm_storeu_ps(&outHeights[position], _mm_and_ps(_mm_add_ps(height, OFFSET), isInside));
 	}
-	else {
 
-		//--- If the object is in the right triangle, use Barycentric interpolation 
-		//--- to figure out the height of the terrain where the object is located
-		object.y = maths::Barycentric(	glm::vec3(1, m_heights[m_grid.x + 1][m_grid.z], 0),
-										glm::vec3(1, m_heights[m_grid.x + 1][m_grid.z + 1], 1),
-										glm::vec3(0, m_heights[m_grid.x][m_grid.z + 1], 1),
-										glm::vec2(object.x, object.z));
+	//--- Any positions left over are done one at a time
+	for (; position < count; position++) {
+		outHeights[position] = GetHeight(positions[position].x, positions[position].y, offset);
 	}
-	
-	//--- Finally, return the calculated height, plus any additional offset provided
-	//--- (add an offset for when you want objects to have an additional height, still relative to the terrain height, e.g birds!)
-	return object.y + offset;
 }
 
 
 /*******************************************************************************************************************
-	Function that loads in a grayscale heightmap image
+	Function that finds the first point a ray hits the ground, in world space, within maxDistance of its origin.
+	Returns false if the ray doesn't hit the terrain (or the part of the terrain that is loaded, when streaming)
+*******************************************************************************************************************/
+bool Terrain::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, glm::vec3& outPosition) const
+{
+	if (glm::length(direction) == 0.0f) { return false; }
+
+	glm::vec3 normalized	= glm::normalize(direction);
+	float distance			= 0.0f;
+
+	if (!FindRayDistance(origin, normalized, maxDistance, distance)) { return false; }
+
+	outPosition = origin + normalized * distance;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that casts many rays at once, split across the worker threads. Each distance is how far along its
+	direction that ray hits the ground (in lengths of the direction, so normalize them to get real distances),
+	or -1 if it doesn't
+*******************************************************************************************************************/
+void Terrain::Raycast(const glm::vec3* origins, const glm::vec3* directions, size_t count, float maxDistance, float* outDistances) const
+{
+	const size_t MINIMUM_RAYS = 64;
+
+	Workers::Instance()->ParallelFor(count, MINIMUM_RAYS, [&](size_t firstRay, size_t lastRay) {
+		for (size_t ray = firstRay; ray < lastRay; ray++) {
+			float distance		= 0.0f;
+			outDistances[ray]	= FindRayDistance(origins[ray], directions[ray], maxDistance, distance) ? distance : -1.0f;
+		}
+	});
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if the ground is in the way between two points in world space (line of sight, for AI)
+*******************************************************************************************************************/
+bool Terrain::IsVisible(const glm::vec3& from, const glm::vec3& to) const
+{
+	if (m_streamer) { return m_streamer->IsVisible(GetTerrainPosition(from), GetTerrainPosition(to)); }
+
+	return !m_heightfield || m_heightfield->pyramid.IsVisible(GetTerrainPosition(from), GetTerrainPosition(to));
+}
+
+
+/*******************************************************************************************************************
+	Function that finds which of count boxes (as their lowest and highest corners in world space) are hidden from
+	the eye behind the ground. Sets outIsHidden to 1 for each box that is hidden, and 0 otherwise, and returns how many
+	are hidden. Cheap enough to run every frame - the ground is only looked at in cells that shrink towards the eye
+*******************************************************************************************************************/
+size_t Terrain::CullHidden(const glm::vec3& eye, const glm::vec3* minimums, const glm::vec3* maximums, size_t count,
+						   std::vector<unsigned char>& outIsHidden)
+{
+	if (!m_streamer && !m_heightfield) {
+		outIsHidden.assign(count, 0);
+		return 0;
+	}
+
+	//--- z runs the other way on the grid, so the corners of each box swap over in terrain space
+	m_hiddenMinimums.resize(count);
+	m_hiddenMaximums.resize(count);
+
+	for (size_t box = 0; box < count; box++) {
+
+		glm::vec3 first		= GetTerrainPosition(minimums[box]);
+		glm::vec3 second	= GetTerrainPosition(maximums[box]);
+
+		m_hiddenMinimums[box] = glm::min(first, second);
+		m_hiddenMaximums[box] = glm::max(first, second);
+	}
+
+	m_horizon.Begin(GetTerrainPosition(eye), m_hiddenMinimums.data(), m_hiddenMaximums.data(), count);
+
+	if (m_streamer) { m_streamer->AddOccluders(m_horizon); }
+	else			{ m_horizon.AddOccluders(m_heightfield->pyramid, glm::vec2(0.0f)); }
+
+	return m_horizon.Cull(outIsHidden);
+}
+
+
+/*******************************************************************************************************************
+	Function that moves a ray in to terrain space and finds where it hits the ground. Terrain space is only moved
+	and scaled along each axis from world space, so a distance along the ray is the same in both
+*******************************************************************************************************************/
+bool Terrain::FindRayDistance(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const
+{
+	glm::vec3 terrainOrigin		= GetTerrainPosition(origin);
+	glm::vec3 terrainDirection	= GetTerrainDirection(direction);
+
+	if (m_streamer) { return m_streamer->Raycast(terrainOrigin, terrainDirection, maxDistance, outDistance); }
+
+	return m_heightfield && m_heightfield->pyramid.Raycast(terrainOrigin, terrainDirection, maxDistance, outDistance);
+}
+
+
+/*******************************************************************************************************************
+	Function that converts a world position in to terrain space (columns and rows on the grid), the same as GetHeight
+*******************************************************************************************************************/
+glm::vec3 Terrain::GetTerrainPosition(const glm::vec3& position) const
+{
+	return glm::vec3((position.x - m_transform.GetPosition().x) / m_grid.square, position.y,
+					 (-position.z - m_transform.GetPosition().z) / m_grid.square);
+}
+
+
+/*******************************************************************************************************************
+	Function that converts a world direction in to terrain space (z runs the other way on the grid)
+*******************************************************************************************************************/
+glm::vec3 Terrain::GetTerrainDirection(const glm::vec3& direction) const
+{
+	return glm::vec3(direction.x / m_grid.square, direction.y, -direction.z / m_grid.square);
+}
+
+
+/*******************************************************************************************************************
+	Function that decodes a grayscale heightmap image
 	References:
 	http://www.rastertek.com/tertut02.html
 *******************************************************************************************************************/
-bool Terrain::GenerateHeightMap(const std::string& heightmap)
+bool Terrain::GenerateHeightMap(const VirtualFile& file, const std::string& fileLocation, float level, bool isLodEnabled, Heightfield& field)
 {
 	//--- NOTE
 	// I use stb_image as I find it more lightweight than SDL for loading in simple heightmaps
 	//---
 
-	std::string fileLocation	= "Assets\\Terrain\\" + heightmap;
-	unsigned char* imageData	= nullptr;
-	int bytesPerPixel			= s_rgbOffset;
-	
-	//--- Load in the heightmap file. Image must be flipped vertically, otherwise pixel data will be read in incorrectly.
-	stbi_set_flip_vertically_on_load(true);
+	int width			= 0;
+	int height			= 0;
+	int bytesPerPixel	= s_rgbOffset;
 	
+	//--- Load in the heightmap file. Image must be flipped vertically, otherwise pixel data will be read in incorrectly
+	//--- (the flip is switched on in Load, as it's shared by every thread).
 	//--- Note we pass in 3 as the bytesPerPixel (channel value) - we want to read only RBG values.
 	//--- If we wanted transparency we would change this to 4.
-	imageData = stbi_load(fileLocation.c_str(), &m_width, &m_height, &bytesPerPixel, bytesPerPixel);
+	unsigned char* imageData = stbi_load_from_memory((const stbi_uc*)file.GetData(), (int)file.GetSize(), &width, &height, &bytesPerPixel, bytesPerPixel);
 	
 	//--- Check the file loaded correctly.
 	if (!imageData) { 
@@ -182,55 +582,25 @@ bool Terrain::GenerateHeightMap(const std::string& heightmap)
 	}
 	
 	//--- Make sure the heightmap file has power of 2 dimensions, e.g. 128x128, 256x256, 512x512, etc.
-	if ((m_width & (m_width - 1)) != 0 || (m_height & (m_height - 1)) != 0) {
+	//--- A LOD terrain clamps its patches to the edges of the terrain, so it can be any size
+	if (!isLodEnabled && ((width & (width - 1)) != 0 || (height & (height - 1)) != 0)) {
 		FL_LOG("[TERRAIN] Heightmap file is not power of 2 dimensions: ", fileLocation.c_str(), LOG_ERROR);
+		stbi_image_free(imageData);
 		return false;
 	}
 
 	FL_LOG("[TERRAIN] Heightmap file loaded successfully: ", fileLocation.c_str(), LOG_SUCCESS);
 
-	//--- Create the structure to hold the height map data
-	m_map.resize((m_width) * (m_height));
-	
-	//--- Create the structure to hold the height data for terrain collision checks & normal calculations
-	m_heights.resize(m_width);
-	
-	//--- Temporary variables to aid us in storing the data correctly
-	unsigned char height	= 0;
-	int rgb					= 0;
-	int index				= 0;
-
-	//--- Loop through the heightmap pixels
-	for (int row = 0; row < m_height; row++) {
-		for (int column = 0; column < m_width; column++) {
+	//--- Store the pixel values read in from the heightmap file as the heights of the terrain, so we can access them later
+	//--- to determine collision and normals, and to build the mesh. The heights are leveled out as they are read.
+	//--- One contiguous grid, a row at a time, so neighbouring heights are next to each other in memory.
+	//--- We only need to read in the 'r' (red) value, as RGB will be the same colour values, due to it being a grayscale image.
+	//--- stb_image always gives us the 3 channels we asked for, whatever the file has, so we step 3 bytes at a time
+	terrain_generator::ConvertHeights(imageData, s_rgbOffset, width, height, level, field.generated);
 
-			//--- Set the height variable to the RGB pixel value read in from the heightmap file
-			height = imageData[rgb];
-	
-			//--- Create the structure to hold the height data for terrain collision checks & normal calculations
-			m_heights[column].resize(m_width);
-	
-			//--- Store the height of the terrain at this point into the heights container
-			//--- so we can access it later to determine collision and normals
-			m_heights[column][row] = height;
-	
-			//--- Move through the heightmap file and increment the index each time
-			index = (m_height * row) + column;
-
-			//--- Finally, set the heightmap data to the values calculated; y being the pixel data read
-			//--- in from the heightmap image, and x and z being the incrementation of our nested for loops (0 - width, 0 - height)
-			m_map[index].position.x = (float)column;
-			m_map[index].position.y = (float)height;
-			m_map[index].position.z = (float)row;
-
-			m_map[index].textureCoord.s = (float)column;
-			m_map[index].textureCoord.t = (float)row;
-
-			//--- We only need to read in the 'r' (red) value, as RGB will be the same colour values, 
-			//--- due to it being a grayscale image. So, we increment by 3, skipping the green and blue colour values.
-			rgb += bytesPerPixel;
-		}
-	}
+	field.width		= width;
+	field.height	= height;
+	field.heights	= field.generated.data();
 
 	//--- Delete the image data now we have it stored in our containers
 	if (imageData) {
@@ -238,12 +608,9 @@ bool Terrain::GenerateHeightMap(const std::string& heightmap)
 	}
 
 	//--- NOTE 
-	// m_map struct could also have an 'a' float that we could use to store the alpha value,
+	// We could also keep a grid of alpha values alongside the heights,
 	// then do some fancy stuff with transparency later! (floating terrain/cliffs/black holes!)
-	// Also note that we don't currently store the terrain anywhere once it has been loaded in
-	// Every time a new game state is made, the terrain height map is loaded and the heightmap data is re-generated
-	// In future, we probably want to store this data somewhere in memory so we can just reference previous
-	// heightmap data, rather that loading it every time. Or, we could have a game object cache/object pool of some sort
+	// This only happens the first time a heightmap is used - after that the terrain comes from the cache
 	//---
 
 	return true;
@@ -251,224 +618,233 @@ bool Terrain::GenerateHeightMap(const std::string& heightmap)
 
 
 /*******************************************************************************************************************
-	Function that calculates terrain normals, using finite difference method 
-	References:
-	https://en.wikipedia.org/wiki/Finite_difference_method
-	https://www.youtube.com/watch?v=O9v6olrHPwI&list=PLRIWtICgwaX0u7Rf9zkZhLoLuZVfUksDP&index=21
+	Function that generates the heights of a procedural terrain from its noise, in place of a heightmap
 *******************************************************************************************************************/
-void Terrain::CalculateNormals()
+bool Terrain::GenerateNoiseHeights(const TerrainNoise& noise, float level, bool isLodEnabled, Heightfield& field)
 {
-	int index = 0;
+	int size = noise.GetSettings().size;
 
-	//--- Neighbouring vertices - left, right, bottom and top
-	struct { float l, r, b, t; } neighbours = { 0 };
-	
-	for (int row = 0; row < m_height; row++) {
-		for (int column = 0; column < m_width; column++) {
+	//--- The same rules as a heightmap - power of 2 dimensions, unless it's a LOD terrain
+	if (size < 2 || (!isLodEnabled && (size & (size - 1)) != 0)) {
+		FL_LOG("[TERRAIN] Procedural terrain size is not valid (must be a power of 2): ", size, LOG_ERROR);
+		return false;
+	}
 
-			index = (m_height * row) + column;
+	noise.Generate(0, 0, size, size, level, field.generated);
 
-			//--- We calculate the height of all 4 neighbouring vertices
-			neighbours.l = FindHeightAtPoint(column - 1, row);
-			neighbours.r = FindHeightAtPoint(column + 1, row);
-			neighbours.b = FindHeightAtPoint(column, row - 1);
-			neighbours.t = FindHeightAtPoint(column, row + 1);
+	field.width		= size;
+	field.height	= size;
+	field.heights	= field.generated.data();
 
-			//--- Then create the normal from the data generated above
-			glm::vec3 normal = glm::normalize(glm::vec3(neighbours.l - neighbours.r, 2.0f, neighbours.b - neighbours.t));
-			
-			m_map[index].normal = normal;
-		}
-	}
+	FL_LOG("[TERRAIN] Procedural heights generated, size: ", size, LOG_SUCCESS);
+
+	return true;
 }
 
 
 /*******************************************************************************************************************
-	Function that returns the height of the terrain at a specific point
+	Function that generates the terrain vertex positions, prior to sending the data to GPU for rendering
 *******************************************************************************************************************/
-float Terrain::FindHeightAtPoint(int column, int row)
+bool Terrain::GenerateTerrain(const std::string& cacheLocation, float level, HeightfieldData& data)
 {
-	if (column < 0)			{ column = 0; }
-	if (row < 0)			{ row = 0; }
-	if (column >= m_width)	{ column = (m_width - 1); }
-	if (row >= m_height)	{ row = (m_height - 1); }
+	Heightfield& field = *data.heightfield;
 
-	return m_heights[column][row];
+	//--- Every point on the heightmap is one vertex, shared by the (up to 6) triangles that touch it.
+	//--- Normals (for terrain lighting) use the finite difference method, and tangents and bitangents (for normal mapping)
+	//--- are averaged over the triangles that share each vertex.
+	//--- References: 
+	//--- https://en.wikipedia.org/wiki/Finite_difference_method
+	//--- http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-13-normal-mapping/
+	terrain_generator::GenerateVertices(field.heights, field.width, field.height, data.vertices);
+
+	//--- Split the grid in to chunks, the index data comes back one chunk after another so each chunk can be drawn on its own
+	field.quadtree.Build(data.vertices, field.width, field.height, data.indices);
+
+	FL_LOG("[TERRAIN] Terrain mesh generated, vertices: ", data.vertices.size(), LOG_SUCCESS);
+
+	//--- Save everything we just made, so the next time this heightmap is used none of it has to be made again
+	TerrainCache::Write(cacheLocation, field.key, field.width, field.height, level, field.heights, data.vertices, data.indices, field.quadtree);
+
+	return true;
 }
 
 
 /*******************************************************************************************************************
-	Function that levels out a heightmap (shrinks/expands the height/width/depth of terrain)
+	Function that updates the terrain providing any changes have happened
 *******************************************************************************************************************/
-void Terrain::LevelHeightMap()
+void Terrain::Update()
 {
-	for (int row = 0; row < m_height; row++) {
-		for (int column = 0; column < m_width; column++) {
-			m_map[(m_height * row) + column].position.y	/= m_level;
-			m_heights[column][row]						/= m_level;
-		}
+	m_transform.Update();
+
+	//--- A terrain loaded asynchronously takes its heightfield as soon as it's resident
+	if (m_loading && *m_loading) {
+		AttachHeightfield(*m_loading);
+		m_loading.reset();
 	}
+
+	if (m_streamer) { m_streamer->Update(m_transform, m_focus, m_heading); }
 }
 
 
 /*******************************************************************************************************************
-	Function that generates the terrain vertex positions, prior to sending the data to GPU for rendering
+	Function that sets the point the tiles of a streamed terrain are loaded around (the player), and the direction
+	it's moving in - tiles ahead are loaded first
 *******************************************************************************************************************/
-bool Terrain::GenerateTerrain()
+void Terrain::SetFocus(const glm::vec3& position, const glm::vec3& forward)
 {
-	//--- We do -1 to make the width and height of terrain an odd number, necessary for accurate placement of vertex data
-	int offsetHeight	= (m_height - 1);
-	int offsetWidth		= (m_width - 1);
+	//--- The same conversion in to grid columns and rows as GetHeight
+	m_focus = glm::vec2((position.x - m_transform.GetPosition().x) / m_grid.square, (-position.z - m_transform.GetPosition().z) / m_grid.square);
 
-	//--- Calculate number of vertices in terrain mesh (6 points/vertices to make 1 face - 2 x triangles, 3 points per triangle)
-	unsigned int vertexCount = (offsetHeight) * (offsetWidth) * s_vertexCount;
+	glm::vec2 heading = glm::vec2(forward.x, -forward.z);
+	m_heading = (glm::length(heading) > 0.0f) ? glm::normalize(heading) : glm::vec2(0.0f);
+}
 
-	//--- Resize vector to the size of the vertex count
-	std::vector<VertexBuffer::PackedVertex> vertices(vertexCount);
 
-	unsigned int index	= 0;
-	
-	//--- Vertex positions for each vertex - bottom left, bottom right, top left and top right
-	struct { int bottomLeft, bottomRight, topLeft, topRight; } vertex = { 0 };
+/*******************************************************************************************************************
+	Function that renders the terrain to the screen
+*******************************************************************************************************************/
+void Terrain::Render(Shader* shader)
+{
+	if (!m_heightfield && !m_streamer) { return; }
 
-	//--- Temporary variables for tangent and bitangent calculations
-	struct { glm::vec3 first, second; } deltaPosition = {};
-	struct { glm::vec2 first, second; } deltaTexCoord = {};
-	
-	float denominator	= 0.0f;
-	
-	glm::vec3 tangent	= glm::vec3(0.0f);
-	glm::vec3 bitangent = glm::vec3(0.0f);
-
-	//--- Loop through the terrain and place vertices in relevant positions, adding the data to the vertices vector
-	for (int row = 0; row < offsetHeight; row++) {
-		for (int column = 0; column < offsetWidth; column++) {
-			
-			//--- Calculate the vertex positions on the screen
-			vertex.bottomLeft	= (m_height * row) + column;
-			vertex.bottomRight	= (m_height * row) + (column + 1);
-			vertex.topLeft		= (m_height * (row + 1)) + column;
-			vertex.topRight		= (m_height * (row + 1)) + (column + 1);
-
-			//--- Ugly maths formula's to get the tangent and bitangent of the terrain for normal mapping.
-			//--- References: 
-			//--- http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-13-normal-mapping/
-			//--- https://learnopengl.com/Advanced-Lighting/Normal-Mapping
-			//--- This could be made a lot cleaner in future - but I kept it simple so that we can see how the terrain is generated
-			
-			//--- First Triangle
-			deltaPosition.first		= m_map[vertex.topLeft].position - m_map[vertex.topRight].position;
-			deltaPosition.second	= m_map[vertex.bottomLeft].position - m_map[vertex.topRight].position;
-			deltaTexCoord.first		= m_map[vertex.topLeft].textureCoord - m_map[vertex.topRight].textureCoord;
-			deltaTexCoord.second	= m_map[vertex.bottomLeft].textureCoord - m_map[vertex.topRight].textureCoord;
-
-			denominator	= 1.0f / (deltaTexCoord.first.x * deltaTexCoord.second.y - deltaTexCoord.second.x * deltaTexCoord.first.y);
-			tangent		= denominator * (deltaTexCoord.second.y * deltaPosition.first - deltaTexCoord.first.y * deltaPosition.second);
-			bitangent	= denominator * (-deltaTexCoord.second.x * deltaPosition.first + deltaTexCoord.first.x * deltaPosition.second);
-			
-			glm::normalize(tangent);
-			glm::normalize(bitangent);
-
-			vertices[index].position		= m_map[vertex.topRight].position;
-			vertices[index].textureCoord	= m_map[vertex.topRight].textureCoord;
-			vertices[index].normal			= m_map[vertex.topRight].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
-
-			vertices[index].position		= m_map[vertex.topLeft].position;
-			vertices[index].textureCoord	= m_map[vertex.topLeft].textureCoord;
-			vertices[index].normal			= m_map[vertex.topLeft].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
-
-			vertices[index].position		= m_map[vertex.bottomLeft].position;
-			vertices[index].textureCoord	= m_map[vertex.bottomLeft].textureCoord;
-			vertices[index].normal			= m_map[vertex.bottomLeft].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
-
-			//--- Second Triangle
-			deltaPosition.first		= m_map[vertex.bottomRight].position - m_map[vertex.bottomLeft].position;
-			deltaPosition.second	= m_map[vertex.topRight].position - m_map[vertex.bottomLeft].position;
-			deltaTexCoord.first		= m_map[vertex.bottomRight].textureCoord - m_map[vertex.bottomLeft].textureCoord;
-			deltaTexCoord.second	= m_map[vertex.topRight].textureCoord - m_map[vertex.bottomLeft].textureCoord;
-
-			denominator = 1.0f / (deltaTexCoord.first.x * deltaTexCoord.second.y - deltaTexCoord.second.x * deltaTexCoord.first.y);
-			tangent		= denominator * (deltaTexCoord.second.y * deltaPosition.first - deltaTexCoord.first.y * deltaPosition.second);
-			bitangent	= denominator * (-deltaTexCoord.second.x * deltaPosition.first + deltaTexCoord.first.x * deltaPosition.second);
-			
-			glm::normalize(tangent);
-			glm::normalize(bitangent);
-
-			vertices[index].position		= m_map[vertex.bottomLeft].position;
-			vertices[index].textureCoord	= m_map[vertex.bottomLeft].textureCoord;
-			vertices[index].normal			= m_map[vertex.bottomLeft].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
-
-			vertices[index].position		= m_map[vertex.bottomRight].position;
-			vertices[index].textureCoord	= m_map[vertex.bottomRight].textureCoord;
-			vertices[index].normal			= m_map[vertex.bottomRight].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
-
-			vertices[index].position		= m_map[vertex.topRight].position;
-			vertices[index].textureCoord	= m_map[vertex.topRight].textureCoord;
-			vertices[index].normal			= m_map[vertex.topRight].normal;
-			vertices[index].tangent			= tangent;
-			vertices[index].bitangent		= bitangent;
-			index++;
+	if (TerrainShader* terrainShader = Downcast<TerrainShader>(shader)) {
+
+		terrainShader->SetInstanceData(&m_transform, m_textures.GetBlendMap(), m_minimapMode);
+
+		m_textures.Bind();
+		m_normals.Bind();
+
+		if (m_streamer) {
+			RenderTiles(terrainShader, shader->GetCamera());
 		}
+
+		else {
+			Resource::Instance()->GetVAO(m_tag)->Bind();
+
+			if (m_isLodEnabled)	{ RenderPatches(shader->GetCamera()); }
+			else				{ RenderChunks(shader->GetCamera()); }
+		}
+
+		m_normals.Unbind();
+		m_textures.Unbind();
 	}
+}
 
 
-	//--- NOTE
-	// The above generation of vertex data was previously encapsulated into one function
-	// However I have since wrote it out in its plainest form to make it easier to see what is happening
-	// The code looks ugly imo! But it is easier to understand this way, for those who haven't used heightmaps before
-	// Hint: Render the terrain in wireframe mode to see some magic happening ;)
-	//---
+/*******************************************************************************************************************
+	Function that draws only the terrain chunks the camera can see.
+	Each camera keeps its own visible set (the main view and the minimap look at different parts of the terrain),
+	and chunks that sit next to each other in the index buffer are drawn with a single call
+*******************************************************************************************************************/
+void Terrain::RenderChunks(const Camera* camera)
+{
+	IndexBuffer* indexBuffer = Resource::Instance()->GetEBO(m_tag);
 
-	//--- Push the vertex data to the GPU for rendering	(hurrah)
-	Resource::Instance()->GetVAO(m_tag)->Bind();
-		Resource::Instance()->GetPackedVBO(m_tag)->Push(vertices, false);
-	Resource::Instance()->GetVAO(m_tag)->Unbind();
+	//--- Without a camera we have nothing to cull against, so just draw everything
+	if (!camera) { indexBuffer->Render(); return; }
 
-	return true;
+	TerrainQuadtree& quadtree = m_heightfield->quadtree;
+
+	quadtree.Update(m_transform.GetTransformationMatrix());
+	m_frustum.Update(Screen::Instance()->GetProjectionMatrix(), camera->GetViewMatrix());
+
+	std::vector<unsigned int>& visibleChunks = m_visibleChunks[camera];
+	quadtree.Cull(m_frustum, visibleChunks);
+
+	DrawChunks(quadtree, indexBuffer, visibleChunks);
 }
 
 
 /*******************************************************************************************************************
-	Function that updates the terrain providing any changes have happened
+	Function that draws the visible chunks of a quadtree. Chunks that sit next to each other in the index buffer
+	are drawn with a single call
 *******************************************************************************************************************/
-void Terrain::Update()
+void Terrain::DrawChunks(const TerrainQuadtree& quadtree, IndexBuffer* indexBuffer, const std::vector<unsigned int>& visibleChunks)
 {
-	m_transform.Update();
+	for (size_t visible = 0; visible < visibleChunks.size();) {
+
+		const TerrainQuadtree::Chunk& first = quadtree.GetChunk(visibleChunks[visible]);
+		unsigned int indexCount = first.indexCount;
+
+		//--- Merge any following chunks whose indices carry on straight after this one
+		for (visible++; visible < visibleChunks.size(); visible++) {
+			const TerrainQuadtree::Chunk& next = quadtree.GetChunk(visibleChunks[visible]);
+			if (next.indexOffset != first.indexOffset + indexCount) { break; }
+			indexCount += next.indexCount;
+		}
+
+		indexBuffer->Render(GL_TRIANGLES, indexCount, first.indexOffset);
+	}
 }
 
 
 /*******************************************************************************************************************
-	Function that renders the terrain to the screen
+	Function that draws the loaded tiles of a streamed terrain that the camera can see. Each tile has its own
+	buffers and quadtree, and is drawn with its own transform (the terrain's, moved along to where the tile starts)
 *******************************************************************************************************************/
-void Terrain::Render(Shader* shader)
+void Terrain::RenderTiles(TerrainShader* shader, const Camera* camera)
 {
-	if (TerrainShader* terrainShader = Downcast<TerrainShader>(shader)) {
+	if (!camera) { return; }
 
-		terrainShader->SetInstanceData(&m_transform, m_textures.GetBlendMap(), m_minimapMode);
+	m_frustum.Update(Screen::Instance()->GetProjectionMatrix(), camera->GetViewMatrix());
 
-		m_textures.Bind();
-		m_normals.Bind();
+	std::vector<unsigned int>& visibleChunks = m_visibleChunks[camera];
 
-		Resource::Instance()->GetVAO(m_tag)->Bind();
-		Resource::Instance()->GetPackedVBO(m_tag)->Render();
+	for (auto& tile : m_streamer->GetTiles()) {
 
-		m_normals.Unbind();
-		m_textures.Unbind();
+		if (tile->state != TerrainStreamer::TILE_RESIDENT) { continue; }
+
+		tile->quadtree.Update(tile->transform.GetTransformationMatrix());
+		tile->quadtree.Cull(m_frustum, visibleChunks);
+
+		if (visibleChunks.empty()) { continue; }
+
+		shader->SetInstanceData(&tile->transform, m_textures.GetBlendMap(), m_minimapMode);
+
+		Resource::Instance()->GetVAO(tile->tag)->Bind();
+		DrawChunks(tile->quadtree, Resource::Instance()->GetEBO(tile->tag), visibleChunks);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that draws a LOD terrain for a camera. The patches chosen for the camera are built in to one vertex
+	buffer, and the shared patch indices are drawn once per patch, offset to that patch's vertices
+*******************************************************************************************************************/
+void Terrain::RenderPatches(const Camera* camera)
+{
+	if (!camera) { return; }
+
+	TerrainLod& lod = m_heightfield->lod;
+
+	lod.Update(m_transform.GetTransformationMatrix());
+	m_frustum.Update(Screen::Instance()->GetProjectionMatrix(), camera->GetViewMatrix());
+
+	std::vector<TerrainLod::Patch>& visiblePatches = m_visiblePatches[camera];
+	lod.Select(camera->GetPosition(), m_frustum, visiblePatches);
+
+	if (visiblePatches.empty()) { return; }
+
+	lod.GenerateVertices(camera->GetPosition(), visiblePatches, m_patchVertices);
+	Resource::Instance()->GetPackedVBO(m_tag)->Push(m_patchVertices, true);
+
+	IndexBuffer* indexBuffer	= Resource::Instance()->GetEBO(m_tag);
+	unsigned int quadrantCount	= TerrainLod::GetQuadrantIndexCount();
+
+	for (size_t patch = 0; patch < visiblePatches.size(); patch++) {
+
+		int baseVertex = (int)(patch * TerrainLod::GetPatchVertexCount());
+
+		//--- Draw each run of neighbouring quarters with a single call
+		for (unsigned int quadrant = 0; quadrant < 4;) {
+
+			if (!(visiblePatches[patch].quadrants & (1 << quadrant))) { quadrant++; continue; }
+
+			unsigned int first = quadrant;
+			while (quadrant < 4 && (visiblePatches[patch].quadrants & (1 << quadrant))) { quadrant++; }
+
+			indexBuffer->Render(GL_TRIANGLES, (quadrant - first) * quadrantCount, first * quadrantCount, baseVertex);
+		}
 	}
 }
 
@@ -486,9 +862,10 @@ void Terrain::SetMinimapMode(bool minimapMode)	{ m_minimapMode = minimapMode; }
 	Static variables and functions
 *******************************************************************************************************************/
 const unsigned int Terrain::s_rgbOffset		= 3;
-const unsigned int Terrain::s_vertexCount	= 6;
 const unsigned int Terrain::s_maxTextures	= 5;
 const unsigned int Terrain::s_maxNormalMaps	= 4;
 
+std::map<std::string, std::shared_ptr<Terrain::Heightfield>> Terrain::s_heightfields;
+
 const unsigned int Terrain::GetMaxTextures()		{ return s_maxTextures; }
 const unsigned int Terrain::GetMaxNormalMaps()		{ return s_maxNormalMaps; }
\ No newline at end of file
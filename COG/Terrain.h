@@ -3,31 +3,56 @@
 /*******************************************************************************************************************
 	Terrain.h, Terrain.cpp
 	Created by Kim Kane
-	Last updated: 17/03/2018
+	Last updated: 17/10/2026
 
 	Terrain class that loads in pixel data from a heightmap file, allowing open-world multi-height terrain generation.
 	
 	[Features]
-	Collision using barycentric coordinates.
+	Collision using barycentric coordinates. GetHeight is const (safe to call from any thread), and GetHeights finds
+	the height under many positions at once with SSE2, for large numbers of objects following the terrain.
+	Heights are kept in one contiguous row-major grid, which the mesh, normals, collision and LOD all read from.
 	Terrain mesh transformations/rotations and scaling (for OpenGL, make the z coordinate of the scale -1).
 	Multi-textures.
 	Transparency (easy to grab the alpha channel from the height map data).
 	2D grid implementation, useful for trigger points/spawn locations/grid collisions.
 	Normal generation using finite difference method (good for lighting!)
-	Tangent and bitangent support for normal mapping.
+	Tangent and bitangent support for normal mapping (averaged over the triangles that share each vertex).
+	Heights, normals, tangents and bitangents are generated with SSE2 across the worker threads (see TerrainGenerator).
+	Indexed rendering - one vertex per heightmap point, shared by every triangle that uses it.
+	Chunked rendering - the grid is split in to chunks in a quadtree (see TerrainQuadtree), and only the chunks
+	inside a camera's frustum are drawn, so draw cost follows what is on screen rather than the size of the heightmap.
+	Continuous LOD mode ("lod: 1" in the config) - the terrain is drawn with one small grid patch, scaled and morphed
+	by distance (see TerrainLod), so very large heightmaps (4096x4096 and beyond, any size) draw a near constant
+	number of triangles. Collision still uses the full resolution heights.
+	Terrain caching - the heights, mesh and quadtree are written to a .cogterrain file the first time a heightmap is
+	loaded, and memory mapped from it every time after that (see TerrainCache), so the image is never decoded again.
+	Everything made from the heightmap also stays resident in memory, alongside the terrain's buffers on the GPU,
+	so a new game state re-uses it all without touching the disk (only the heightmap's hash is checked).
+	Raycasts and line of sight - a min/max height pyramid is built over the heights (see TerrainPyramid), so the point
+	a ray hits the ground is found without marching across every square, for picking, gameplay and AI. Rays can be
+	batched across the worker threads, and are safe to cast from any thread.
+	Streaming mode ("tiles: x z" in the config) - the world is made of a grid of heightmap tiles, loaded in the
+	background around the player under a memory budget (see TerrainStreamer), so the world can be any size.
+	Procedural mode ("noise.octaves" in the config) - the heights are generated from fractal noise rather than read
+	from a heightmap (see TerrainNoise), for a single terrain or every tile of a streamed one, so no heightmap files
+	need to be shipped at all.
+	Horizon culling - objects hidden behind hills can be culled before they're updated or drawn (see TerrainHorizon),
+	using the pyramid of the whole terrain, or of every loaded tile when streaming.
+	Supports asynchronous loading (see ResourceManager.h) - the heightmap is read, decoded and processed (or read back
+	from its cache) on a worker thread, and only the buffers are made on the main thread. Until then the terrain isn't
+	drawn, and has no ground (heights are 0, and nothing is hit or hidden).
 
 	[Upcoming]
-	Indexed rendering of terrain mesh.
 	Terrain will be a complete mesh in future using a PackedVertex struct like every other mesh.
 	Tangents and bitangents will be calculated elsewhere.
-	OBJ parser allowing us to save the terrain mesh we generated to an obj file & then load in binary form (faster load times).
-	Terrain will be cached in memory - allowing re-use of an already generated heightmap.
 
 	[Side Notes]
 	A heightmap file is a grayscale image of RBG color values, all of which are the same.
 	An alpha channel is not necessary (unless you want to mimic holes or semi-transparent illusions in your terrain).
 	Due to this, I use PNG files for the heightmap, but ignore the alpha channel.
 	In future, if we decided to have transparency, this would be simple to implement.
+	A procedural terrain's "heightmap" only names its cache file (island becomes island.cogterrain), and its
+	size comes from "noise.size".
 
 	This class is a forever on-going project of mine (I will need it for my dissertation)
 	and it will continue being updated constantly. It is impossible to do the work in the time frame 
@@ -37,20 +62,26 @@
 #include <glm.hpp>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 #include "GameObject.h"
 #include "TexturePack.h"
+#include "TerrainQuadtree.h"
+#include "TerrainLod.h"
+#include "TerrainCache.h"
+#include "TerrainStreamer.h"
+#include "TerrainPyramid.h"
+#include "TerrainNoise.h"
+#include "TerrainHorizon.h"
+
+class Camera;
+class TerrainShader;
+class IndexBuffer;
 
 class Terrain : public GameObject {
 
 private:
-	struct HeightMap {
-		glm::vec3 position;
-		glm::vec2 textureCoord;
-		glm::vec3 normal;
-	};
-
 	struct TerrainGrid {
-		int x, z;
 		float length;
 		float square;
 	};
@@ -59,9 +90,28 @@ private:
 		glm::vec3 minimum, maximum;
 	};
 
+	struct Heightfield {
+		unsigned long long	key;
+		int					width, height;
+		const float*		heights;
+		std::vector<float>	generated;
+		TerrainCache		cache;
+		TerrainQuadtree		quadtree;
+		TerrainLod			lod;
+		TerrainPyramid		pyramid;
+	};
+
+	struct HeightfieldData {
+		bool									isResident;
+		std::shared_ptr<Heightfield>			heightfield;
+		std::vector<VertexBuffer::PackedVertex>	vertices;
+		std::vector<unsigned int>				indices;
+	};
+
 public:
 	Terrain(const std::string& tag, const Transform& transform, const TexturePack& textures,
-			const TexturePack& normals, const std::string& heightmap, float level = 15.0f);
+			const TexturePack& normals, const std::string& heightmap, float level = 15.0f, bool isLodEnabled = false,
+			const TerrainStreamer::Settings& streaming = TerrainStreamer::Settings(), const TerrainNoise::Settings& noise = TerrainNoise::Settings());
 	virtual ~Terrain();
 
 public:
@@ -72,11 +122,18 @@ public:
 	static Terrain* Create(const std::string& tag);
 
 public:
-	float			GetHeight(float xPosition, float zPosition, float offset = 0.0f);
+	float			GetHeight(float xPosition, float zPosition, float offset = 0.0f) const;
+	void			GetHeights(const glm::vec2* positions, float* outHeights, size_t count, float offset = 0.0f) const;
+	bool			Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, glm::vec3& outPosition) const;
+	void			Raycast(const glm::vec3* origins, const glm::vec3* directions, size_t count, float maxDistance, float* outDistances) const;
+	bool			IsVisible(const glm::vec3& from, const glm::vec3& to) const;
+	size_t			CullHidden(const glm::vec3& eye, const glm::vec3* minimums, const glm::vec3* maximums, size_t count,
+							   std::vector<unsigned char>& outIsHidden);
 	TerrainGrid*	GetGrid();
 	WorldBounds*	GetBounds();
 
 public:
+	void SetFocus(const glm::vec3& position, const glm::vec3& forward);
 	void SetMinimapMode(bool minimapMode);
 	bool IsMinimapEnabled();
 
@@ -86,20 +143,53 @@ public:
 
 private:
 	bool Load(const std::string& heightmap);
+	bool LoadStreamedTerrain(const std::string& heightmap);
+	void AttachHeightfield(const std::shared_ptr<Heightfield>& heightfield);
 	
 private:
-	bool GenerateHeightMap(const std::string& heightmap);
-	void LevelHeightMap();
-	void CalculateNormals();
-	bool GenerateTerrain();
+	static bool ReadHeightfield(const std::string& heightmap, float level, bool isLodEnabled, const std::shared_ptr<const TerrainNoise>& noise,
+								const std::shared_ptr<Heightfield>& resident, HeightfieldData& outData);
+	static bool LoadCachedTerrain(const std::string& cacheLocation, bool isLodEnabled, Heightfield& field);
+	static bool GenerateHeightMap(const VirtualFile& file, const std::string& fileLocation, float level, bool isLodEnabled, Heightfield& field);
+	static bool GenerateNoiseHeights(const TerrainNoise& noise, float level, bool isLodEnabled, Heightfield& field);
+	static bool GenerateTerrain(const std::string& cacheLocation, float level, HeightfieldData& data);
+	static void UploadHeightfield(const std::string& tag, bool isLodEnabled, HeightfieldData& data);
 
 private:
-	float FindHeightAtPoint(int column, int row);
-	
+	bool FindRayDistance(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const;
+	glm::vec3 GetTerrainPosition(const glm::vec3& position) const;
+	glm::vec3 GetTerrainDirection(const glm::vec3& direction) const;
+
+private:
+	void RenderChunks(const Camera* camera);
+	void RenderPatches(const Camera* camera);
+	void RenderTiles(TerrainShader* shader, const Camera* camera);
+	void DrawChunks(const TerrainQuadtree& quadtree, IndexBuffer* indexBuffer, const std::vector<unsigned int>& visibleChunks);
+
 private:
 	int		m_width, m_height;
 	float	m_level;
 	bool	m_minimapMode;
+	bool	m_isLodEnabled;
+
+private:
+	std::shared_ptr<Heightfield>	m_heightfield;
+	const float*					m_heights;
+	Frustum							m_frustum;
+
+private:
+	std::shared_ptr<std::shared_ptr<Heightfield>>	m_loading;
+
+private:
+	std::unique_ptr<TerrainStreamer>	m_streamer;
+	std::shared_ptr<const TerrainNoise>	m_noise;
+	glm::vec2							m_focus;
+	glm::vec2							m_heading;
+
+private:
+	TerrainHorizon			m_horizon;
+	std::vector<glm::vec3>	m_hiddenMinimums;
+	std::vector<glm::vec3>	m_hiddenMaximums;
 
 private:
 	TerrainGrid m_grid;
@@ -108,12 +198,13 @@ private:
 	WorldBounds m_bounds;
 
 private:
-	std::vector<HeightMap>			m_map;
-	std::vector<std::vector<float>> m_heights;
+	std::map<const Camera*, std::vector<unsigned int>>			m_visibleChunks;
+	std::map<const Camera*, std::vector<TerrainLod::Patch>>	m_visiblePatches;
+	std::vector<VertexBuffer::PackedVertex>					m_patchVertices;
 
 private:
 	static const unsigned int s_maxTextures;
 	static const unsigned int s_maxNormalMaps;
 	static const unsigned int s_rgbOffset;
-	static const unsigned int s_vertexCount;
+	static std::map<std::string, std::shared_ptr<Heightfield>> s_heightfields;
 };
\ No newline at end of file
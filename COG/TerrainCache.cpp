@@ -0,0 +1,268 @@
+#include <cstring>
+#include <algorithm>
+
+#include "TerrainCache.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainCache::TerrainCache()
+	:	m_header(nullptr)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainCache::~TerrainCache()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Maps a cached terrain and checks that it is valid and was made from the same heightmap and settings (the key)
+*******************************************************************************************************************/
+bool TerrainCache::Open(const std::string& fileLocation, unsigned long long key)
+{
+	Close();
+
+	//--- A missing cache isn't an error, the terrain just hasn't been loaded before
+	if (!VirtualFile::Exists(fileLocation)) { return false; }
+
+	if (!m_file.Open(fileLocation)) { return false; }
+
+	const Header* header = (const Header*)m_file.GetData();
+
+	if (m_file.GetSize() < sizeof(Header) || memcmp(header->magic, s_magic, sizeof(s_magic)) != 0 || header->version != s_version ||
+		header->vertexSize != sizeof(VertexBuffer::PackedVertex) || header->nodeSize != sizeof(TerrainQuadtree::Node) ||
+		header->chunkSize != sizeof(TerrainQuadtree::Chunk)) {
+		FL_LOG("[TERRAIN] Terrain cache is not a valid .cogterrain (or is an old version): ", fileLocation.c_str(), LOG_WARN);
+		Close();
+		return false;
+	}
+
+	//--- If the heightmap or the terrain's settings have changed since we cached it, the cached data is out of date
+	if (header->key != key) {
+		FL_LOG("[TERRAIN] Terrain cache is out of date: ", fileLocation.c_str(), LOG_MESSAGE);
+		Close();
+		return false;
+	}
+
+	m_header = header;
+
+	if (!IsValid(fileLocation)) { Close(); return false; }
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that makes sure the file actually contains all of the data the header says it does,
+	and that the quadtree only points at nodes, chunks and indices that exist - otherwise we'd draw garbage
+*******************************************************************************************************************/
+bool TerrainCache::IsValid(const std::string& fileLocation) const
+{
+	unsigned long long heightBytes	= (unsigned long long)m_header->width * m_header->height * sizeof(float);
+	unsigned long long vertexBytes	= (unsigned long long)m_header->vertexCount * sizeof(VertexBuffer::PackedVertex);
+	unsigned long long indexBytes	= (unsigned long long)m_header->indexCount * sizeof(unsigned int);
+	unsigned long long nodeBytes	= (unsigned long long)m_header->nodeCount * sizeof(TerrainQuadtree::Node);
+	unsigned long long chunkBytes	= (unsigned long long)m_header->chunkCount * sizeof(TerrainQuadtree::Chunk);
+
+	if (m_header->width < 2 || m_header->height < 2 ||
+		m_header->heightOffset + heightBytes > m_file.GetSize() || m_header->vertexOffset + vertexBytes > m_file.GetSize() ||
+		m_header->indexOffset + indexBytes > m_file.GetSize() || m_header->nodeOffset + nodeBytes > m_file.GetSize() ||
+		m_header->chunkOffset + chunkBytes > m_file.GetSize()) {
+		FL_LOG("[TERRAIN] Terrain cache is truncated: ", fileLocation.c_str(), LOG_WARN);
+		return false;
+	}
+
+	//--- Without a mesh (a LOD terrain) there's nothing more to check
+	if (m_header->vertexCount == 0) { return true; }
+
+	if (m_header->vertexCount != (unsigned long long)m_header->width * m_header->height || m_header->nodeCount == 0) {
+		FL_LOG("[TERRAIN] Terrain cache has an invalid mesh: ", fileLocation.c_str(), LOG_WARN);
+		return false;
+	}
+
+	const TerrainQuadtree::Node* nodes		= GetNodes();
+	const TerrainQuadtree::Chunk* chunks	= GetChunks();
+
+	for (unsigned int node = 0; node < m_header->nodeCount; node++) {
+
+		//--- Leaves store their chunk, other nodes store how many children they have
+		bool isValid = (nodes[node].firstChild == 0)
+			? nodes[node].chunk < m_header->chunkCount
+			: (unsigned long long)nodes[node].firstChild + nodes[node].chunk <= m_header->nodeCount && nodes[node].firstChild > node;
+
+		if (!isValid) {
+			FL_LOG("[TERRAIN] Terrain cache has an invalid quadtree node: ", fileLocation.c_str(), LOG_WARN);
+			return false;
+		}
+	}
+
+	for (unsigned int chunk = 0; chunk < m_header->chunkCount; chunk++) {
+		if ((unsigned long long)chunks[chunk].indexOffset + chunks[chunk].indexCount > m_header->indexCount) {
+			FL_LOG("[TERRAIN] Terrain cache has an invalid chunk: ", fileLocation.c_str(), LOG_WARN);
+			return false;
+		}
+	}
+
+	//--- Every index goes straight to the GPU, so each one must name a real vertex. The whole buffer is read for the
+	//--- upload anyway, so finding the largest index costs little more
+	const unsigned int* indices	= GetIndices();
+	unsigned int largestIndex	= 0;
+
+	for (unsigned long long index = 0; index < m_header->indexCount; index++) { largestIndex = std::max(largestIndex, indices[index]); }
+
+	if (m_header->indexCount > 0 && largestIndex >= m_header->vertexCount) {
+		FL_LOG("[TERRAIN] Terrain cache has an invalid index: ", fileLocation.c_str(), LOG_WARN);
+		return false;
+	}
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that unmaps the cached terrain
+*******************************************************************************************************************/
+void TerrainCache::Close()
+{
+	m_header = nullptr;
+	m_file.Close();
+}
+
+
+/*******************************************************************************************************************
+	Writes the terrain's heights, mesh and quadtree to a cache file. Pass in empty vertices and indices (and an empty
+	quadtree) to cache just the heights. The data is written to a temporary file first and then moved in to place,
+	so a crash or a full disk can never leave a half written .cogterrain behind
+*******************************************************************************************************************/
+bool TerrainCache::Write(const std::string& fileLocation, unsigned long long key, int width, int height, float level, const float* heights,
+						 const std::vector<VertexBuffer::PackedVertex>& vertices, const std::vector<unsigned int>& indices,
+						 const TerrainQuadtree& quadtree)
+{
+	if (width < 2 || height < 2 || !heights) { return false; }
+
+	//--- The header is written as raw bytes, so make sure there's no padding hiding in it
+	static_assert(sizeof(Header) == 96, "TerrainCache::Header must be tightly packed");
+
+	const std::vector<TerrainQuadtree::Node>& nodes		= quadtree.GetNodes();
+	const std::vector<TerrainQuadtree::Chunk>& chunks	= quadtree.GetChunks();
+
+	Header header = {};
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+
+	header.version		= s_version;
+	header.key			= key;
+	header.width		= width;
+	header.height		= height;
+	header.level		= level;
+	header.vertexSize	= sizeof(VertexBuffer::PackedVertex);
+	header.nodeSize		= sizeof(TerrainQuadtree::Node);
+	header.chunkSize	= sizeof(TerrainQuadtree::Chunk);
+	header.vertexCount	= (unsigned int)vertices.size();
+	header.indexCount	= (unsigned int)indices.size();
+	header.nodeCount	= (unsigned int)nodes.size();
+	header.chunkCount	= (unsigned int)chunks.size();
+	header.heightOffset	= sizeof(Header);
+	header.vertexOffset	= header.heightOffset + (unsigned long long)width * height * sizeof(float);
+	header.indexOffset	= header.vertexOffset + vertices.size() * sizeof(VertexBuffer::PackedVertex);
+	header.nodeOffset	= header.indexOffset + indices.size() * sizeof(unsigned int);
+	header.chunkOffset	= header.nodeOffset + nodes.size() * sizeof(TerrainQuadtree::Node);
+
+	std::string temporaryLocation = fileLocation + ".tmp";
+
+	HANDLE file = CreateFile(temporaryLocation.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) { FL_LOG("[TERRAIN] Could not create terrain cache: ", fileLocation.c_str(), LOG_WARN); return false; }
+
+	//--- WriteFile can only write 4GB at a time, so larger blocks are written in pieces (empty blocks write nothing)
+	auto write = [file](const void* data, unsigned long long size) {
+		for (const char* bytes = (const char*)data; size > 0;) {
+			DWORD piece = (DWORD)std::min(size, 1ull << 30), written = 0;
+			if (!WriteFile(file, bytes, piece, &written, nullptr) || written != piece) { return false; }
+			bytes	+= piece;
+			size	-= piece;
+		}
+		return true;
+	};
+
+	bool success =	write(&header, sizeof(Header)) &&
+					write(heights, header.vertexOffset - header.heightOffset) &&
+					write(vertices.data(), header.indexOffset - header.vertexOffset) &&
+					write(indices.data(), header.nodeOffset - header.indexOffset) &&
+					write(nodes.data(), header.chunkOffset - header.nodeOffset) &&
+					write(chunks.data(), chunks.size() * sizeof(TerrainQuadtree::Chunk));
+
+	CloseHandle(file);
+
+	if (!success || !MoveFileEx(temporaryLocation.c_str(), fileLocation.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		FL_LOG("[TERRAIN] Could not write terrain cache: ", fileLocation.c_str(), LOG_WARN);
+		DeleteFile(temporaryLocation.c_str());
+		return false;
+	}
+
+	FL_LOG("[TERRAIN] Terrain cache written: ", fileLocation.c_str(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that makes the key a cache is stored under, from the bytes of the heightmap file and the settings that
+	change what is generated from it. A heightmap can be many megabytes, so it's hashed 8 bytes at a time
+*******************************************************************************************************************/
+unsigned long long TerrainCache::GenerateKey(const char* heightmap, size_t size, float level, bool isLodEnabled)
+{
+	//--- 64-bit FNV-1a, applied to whole words rather than single bytes, with the settings mixed in at the end
+	const unsigned long long PRIME = 1099511628211ull;
+
+	unsigned long long hash = 14695981039346656037ull;
+	unsigned long long word = 0;
+	size_t byte = 0;
+
+	for (; byte + sizeof(word) <= size; byte += sizeof(word)) {
+		memcpy(&word, heightmap + byte, sizeof(word));
+		hash = (hash ^ word) * PRIME;
+	}
+
+	for (; byte < size; byte++) { hash = (hash ^ (unsigned char)heightmap[byte]) * PRIME; }
+
+	unsigned int levelBits = 0;
+	memcpy(&levelBits, &level, sizeof(levelBits));
+
+	hash = (hash ^ size) * PRIME;
+	hash = (hash ^ levelBits) * PRIME;
+	hash = (hash ^ (isLodEnabled ? 1u : 0u)) * PRIME;
+	hash = (hash ^ s_version) * PRIME;
+
+	return hash;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+int TerrainCache::GetWidth() const										{ return m_header->width; }
+int TerrainCache::GetHeight() const										{ return m_header->height; }
+const float* TerrainCache::GetHeights() const							{ return (const float*)(m_file.GetData() + m_header->heightOffset); }
+const VertexBuffer::PackedVertex* TerrainCache::GetVertices() const		{ return (const VertexBuffer::PackedVertex*)(m_file.GetData() + m_header->vertexOffset); }
+const unsigned int* TerrainCache::GetIndices() const					{ return (const unsigned int*)(m_file.GetData() + m_header->indexOffset); }
+const TerrainQuadtree::Node* TerrainCache::GetNodes() const				{ return (const TerrainQuadtree::Node*)(m_file.GetData() + m_header->nodeOffset); }
+const TerrainQuadtree::Chunk* TerrainCache::GetChunks() const			{ return (const TerrainQuadtree::Chunk*)(m_file.GetData() + m_header->chunkOffset); }
+unsigned int TerrainCache::GetVertexCount() const						{ return m_header->vertexCount; }
+unsigned int TerrainCache::GetIndexCount() const						{ return m_header->indexCount; }
+unsigned int TerrainCache::GetNodeCount() const							{ return m_header->nodeCount; }
+unsigned int TerrainCache::GetChunkCount() const						{ return m_header->chunkCount; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const char TerrainCache::s_magic[4]			= { 'C', 'O', 'G', 'T' };
+const unsigned int TerrainCache::s_version	= 2;
\ No newline at end of file
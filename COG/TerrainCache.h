@@ -0,0 +1,102 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainCache.h, TerrainCache.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Reads and writes .cogterrain files - everything the terrain makes from its heightmap, in the layout it is used in,
+	so a terrain that has been loaded once never has to decode its image or generate its mesh again.
+
+	[Features]
+	A .cogterrain holds a small header, the leveled height grid, the PackedVertex array (positions, normals, tangents
+	and bitangents), the chunked index array and the quadtree nodes and chunks (see TerrainQuadtree.h).
+	A LOD terrain only stores the height grid, as its vertices are made every frame (see TerrainLod.h).
+	Files are memory mapped (or read from a pack, see VirtualFile.h), so the heights are used straight from the file
+	and the vertex and index data is handed straight to the buffers, with no parsing and no copies.
+	The header stores a key made from a hash of the heightmap file's bytes, the level and the format version, so if
+	the heightmap or its settings change the cached file is ignored and written again.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	The scale of the terrain isn't part of the key, it's applied by the terrain's transformation matrix and never
+	touches the cached data.
+	The data is stored in the native layout of this machine (little endian, sizeof(PackedVertex) per vertex).
+	Bump s_version whenever the generated data or the header changes, so that older files are written again.
+	A full resolution terrain caches around 90 bytes per heightmap point - a LOD terrain only 4.
+
+*******************************************************************************************************************/
+#include <vector>
+#include <string>
+#include "VirtualFile.h"
+#include "VertexBuffer.h"
+#include "TerrainQuadtree.h"
+
+class TerrainCache {
+
+private:
+	struct Header {
+		char				magic[4];
+		unsigned int		version;
+		unsigned long long	key;
+		int					width, height;
+		float				level;
+		unsigned int		vertexSize;
+		unsigned int		nodeSize;
+		unsigned int		chunkSize;
+		unsigned int		vertexCount;
+		unsigned int		indexCount;
+		unsigned int		nodeCount;
+		unsigned int		chunkCount;
+		unsigned long long	heightOffset;
+		unsigned long long	vertexOffset;
+		unsigned long long	indexOffset;
+		unsigned long long	nodeOffset;
+		unsigned long long	chunkOffset;
+	};
+
+public:
+	TerrainCache();
+	~TerrainCache();
+
+public:
+	bool Open(const std::string& fileLocation, unsigned long long key);
+	void Close();
+
+public:
+	static bool Write(const std::string& fileLocation, unsigned long long key, int width, int height, float level, const float* heights,
+					  const std::vector<VertexBuffer::PackedVertex>& vertices, const std::vector<unsigned int>& indices,
+					  const TerrainQuadtree& quadtree);
+
+	static unsigned long long GenerateKey(const char* heightmap, size_t size, float level, bool isLodEnabled);
+
+public:
+	int									GetWidth() const;
+	int									GetHeight() const;
+	const float*						GetHeights() const;
+	const VertexBuffer::PackedVertex*	GetVertices() const;
+	const unsigned int*					GetIndices() const;
+	const TerrainQuadtree::Node*		GetNodes() const;
+	const TerrainQuadtree::Chunk*		GetChunks() const;
+	unsigned int						GetVertexCount() const;
+	unsigned int						GetIndexCount() const;
+	unsigned int						GetNodeCount() const;
+	unsigned int						GetChunkCount() const;
+
+private:
+	TerrainCache(const TerrainCache&)				= delete;
+	TerrainCache& operator=(const TerrainCache&)	= delete;
+
+private:
+	bool IsValid(const std::string& fileLocation) const;
+
+private:
+	VirtualFile		m_file;
+	const Header*	m_header;
+
+private:
+	static const char			s_magic[4];
+	static const unsigned int	s_version;
+};
\ No newline at end of file
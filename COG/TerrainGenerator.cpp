@@ -0,0 +1,233 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+#include "TerrainGenerator.h"
+#include "ThreadPool.h"
+
+namespace terrain_generator {
+
+	//--- The fewest rows handed to a worker at once
+	static const size_t MINIMUM_ROWS = 16;
+
+	//--- A triangle touching a vertex - the grid square it's in (relative to the vertex) and which of the square's 2 triangles
+	struct Triangle { int column, row, half; };
+
+	//--- The 6 triangles around a vertex, as made by TerrainQuadtree::GenerateIndices
+	static const Triangle TRIANGLES[6] = { { 0, 0, 0 }, { 0, 0, 1 }, { -1, 0, 1 }, { 0, -1, 0 }, { -1, -1, 0 }, { -1, -1, 1 } };
+
+
+	/*******************************************************************************************************************
+		Function that returns the height at a point, clamped to the edges of the grid
+	*******************************************************************************************************************/
+	static float FindHeightAtPoint(const float* heights, int width, int height, int column, int row)
+	{
+		column	= std::min(std::max(column, 0), width - 1);
+		row		= std::min(std::max(row, 0), height - 1);
+
+		return heights[(width * row) + column];
+	}
+
+
+	/*******************************************************************************************************************
+		Function that works out a single vertex one triangle at a time, skipping any triangles that don't exist (on the edges)
+	*******************************************************************************************************************/
+	static void GenerateVertex(const float* heights, int width, int height, int column, int row, VertexBuffer::PackedVertex& outVertex)
+	{
+		const float* point = &heights[(width * row) + column];
+
+		outVertex.position		= glm::vec3((float)column, *point, (float)row);
+		outVertex.textureCoord	= glm::vec2((float)column, (float)row);
+
+		//--- Neighbouring heights - left, right, bottom and top
+		float left		= FindHeightAtPoint(heights, width, height, column - 1, row);
+		float right		= FindHeightAtPoint(heights, width, height, column + 1, row);
+		float bottom	= FindHeightAtPoint(heights, width, height, column, row - 1);
+		float top		= FindHeightAtPoint(heights, width, height, column, row + 1);
+
+		outVertex.normal = glm::normalize(glm::vec3(left - right, 2.0f, bottom - top));
+
+		//--- Each triangle's tangent is (1, slope along x, 0) and its bitangent (0, slope along z, 1)
+		glm::vec3 tangent(0.0f), bitangent(0.0f);
+
+		for (const Triangle& triangle : TRIANGLES) {
+
+			int squareColumn	= column + triangle.column;
+			int squareRow		= row + triangle.row;
+
+			if (squareColumn < 0 || squareRow < 0 || squareColumn >= width - 1 || squareRow >= height - 1) { continue; }
+
+			const float* bottomLeft = &heights[(width * squareRow) + squareColumn];
+
+			//--- (top right, top left, bottom left) or (bottom left, bottom right, top right)
+			if (triangle.half == 0) {
+				tangent		+= glm::vec3(1.0f, bottomLeft[width + 1] - bottomLeft[width], 0.0f);
+				bitangent	+= glm::vec3(0.0f, bottomLeft[width] - bottomLeft[0], 1.0f);
+			}
+			else {
+				tangent		+= glm::vec3(1.0f, bottomLeft[1] - bottomLeft[0], 0.0f);
+				bitangent	+= glm::vec3(0.0f, bottomLeft[width + 1] - bottomLeft[1], 1.0f);
+			}
+		}
+
+		outVertex.tangent	= glm::normalize(tangent - outVertex.normal * glm::dot(outVertex.normal, tangent));
+		outVertex.bitangent	= glm::normalize(bitangent);
+	}
+
+
+	/*******************************************************************************************************************
+		Function that works out 4 neighbouring vertices inside the grid (not on its edges) at once.
+		All 6 triangles exist here, so the sums of their slopes can be written out in full:
+		along x - (topRight - top) + 2 * (right - left) + (bottom - bottomLeft)
+		along z - 2 * (top - bottom) + (topRight - right) + (left - bottomLeft)
+	*******************************************************************************************************************/
+	static void GenerateInnerVertices(const float* heights, int width, int column, int row, VertexBuffer::PackedVertex* outVertices)
+	{
+		const float* middle	= &heights[(width * row) + column];
+		const float* below	= middle - width;
+		const float* above	= middle + width;
+
+		const __m128 TWO	= _mm_set1_ps(2.0f);
+		const __m128 SIX	= _mm_set1_ps(6.0f);
+		const __m128 ONE	= _mm_set1_ps(1.0f);
+
+		__m128 centre		= _mm_loadu_ps(middle);
+		__m128 left			= _mm_loadu_ps(middle - 1);
+		__m128 right		= _mm_loadu_ps(middle + 1);
+		__m128 bottom		= _mm_loadu_ps(below);
+		__m128 bottomLeft	= _mm_loadu_ps(below - 1);
+		__m128 top			= _mm_loadu_ps(above);
+		__m128 topRight		= _mm_loadu_ps(above + 1);
+
+		//--- Normal (left - right, 2, bottom - top), normalized
+		__m128 normalX		= _mm_sub_ps(left, right);
+		__m128 normalZ		= _mm_sub_ps(bottom, top);
+		__m128 inverse		= _mm_div_ps(ONE, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, normalX), _mm_set1_ps(4.0f)), _mm_mul_ps(normalZ, normalZ))));
+
+		normalX				= _mm_mul_ps(normalX, inverse);
+		__m128 normalY		= _mm_mul_ps(TWO, inverse);
+		normalZ				= _mm_mul_ps(normalZ, inverse);
+
+		//--- Tangent (6, sum of slopes along x, 0), kept at right angles to the normal
+		__m128 slopeX		= _mm_add_ps(_mm_add_ps(_mm_sub_ps(topRight, top), _mm_mul_ps(TWO, _mm_sub_ps(right, left))), _mm_sub_ps(bottom, bottomLeft));
+		__m128 dot			= _mm_add_ps(_mm_mul_ps(normalX, SIX), _mm_mul_ps(normalY, slopeX));
+
+		__m128 tangentX		= _mm_sub_ps(SIX, _mm_mul_ps(normalX, dot));
+		__m128 tangentY		= _mm_sub_ps(slopeX, _mm_mul_ps(normalY, dot));
+		__m128 tangentZ		= _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(normalZ, dot));
+
+		inverse				= _mm_div_ps(ONE, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tangentX, tangentX), _mm_mul_ps(tangentY, tangentY)), _mm_mul_ps(tangentZ, tangentZ))));
+		tangentX			= _mm_mul_ps(tangentX, inverse);
+		tangentY			= _mm_mul_ps(tangentY, inverse);
+		tangentZ			= _mm_mul_ps(tangentZ, inverse);
+
+		//--- Bitangent (0, sum of slopes along z, 6), normalized
+		__m128 slopeZ		= _mm_add_ps(_mm_add_ps(_mm_mul_ps(TWO, _mm_sub_ps(top, bottom)), _mm_sub_ps(topRight, right)), _mm_sub_ps(left, bottomLeft));
+
+		inverse				= _mm_div_ps(ONE, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(slopeZ, slopeZ), _mm_mul_ps(SIX, SIX))));
+		__m128 bitangentY	= _mm_mul_ps(slopeZ, inverse);
+		__m128 bitangentZ	= _mm_mul_ps(SIX, inverse);
+
+		//--- The vertices are interleaved, so write them out one at a time
+		alignas(16) float results[9][4];
+
+		__m128 lanes[9] = { centre, normalX, normalY, normalZ, tangentX, tangentY, tangentZ, bitangentY, bitangentZ };
+		for (int lane = 0; lane < 9; lane++) { _mm_store_ps(results[lane], lanes[lane]); }
+
+		for (int vertex = 0; vertex < 4; vertex++) {
+			outVertices[vertex].position		= glm::vec3((float)(column + vertex), results[0][vertex], (float)row);
+			outVertices[vertex].textureCoord	= glm::vec2((float)(column + vertex), (float)row);
+			outVertices[vertex].normal			= glm::vec3(results[1][vertex], results[2][vertex], results[3][vertex]);
+			outVertices[vertex].tangent			= glm::vec3(results[4][vertex], results[5][vertex], results[6][vertex]);
+			outVertices[vertex].bitangent		= glm::vec3(0.0f, results[7][vertex], results[8][vertex]);
+		}
+	}
+
+
+	/*******************************************************************************************************************
+		Function that reads the first channel of every pixel as a height, and divides it by the level
+	*******************************************************************************************************************/
+	void ConvertHeights(const unsigned char* pixels, int bytesPerPixel, int width, int height, float level, std::vector<float>& outHeights)
+	{
+		outHeights.resize((size_t)width * height);
+
+		const __m128 LEVEL = _mm_set1_ps(level);
+
+		Workers::Instance()->ParallelFor((size_t)height, MINIMUM_ROWS, [&](size_t firstRow, size_t lastRow) {
+
+			for (size_t row = firstRow; row < lastRow; row++) {
+
+				const unsigned char* pixel	= &pixels[row * width * bytesPerPixel];
+				float* output				= &outHeights[row * width];
+				int column					= 0;
+
+				for (; column + 4 <= width; column += 4, pixel += bytesPerPixel * 4) {
+					__m128i values = _mm_setr_epi32(pixel[0], pixel[bytesPerPixel], pixel[bytesPerPixel * 2], pixel[bytesPerPixel * 3]);
+					_mm_storeu_ps(&output[column], _mm_div_ps(_mm_cvtepi32_ps(values), LEVEL));
+				}
+
+				for (; column < width; column++, pixel += bytesPerPixel) { output[column] = (float)pixel[0] / level; }
+			}
+		});
+	}
+
+
+	/*******************************************************************************************************************
+		Function that creates one vertex for every height in the grid
+	*******************************************************************************************************************/
+	void GenerateVertices(const float* heights, int width, int height, std::vector<VertexBuffer::PackedVertex>& outVertices)
+	{
+		outVertices.resize((size_t)width * height);
+
+		Workers::Instance()->ParallelFor((size_t)height, MINIMUM_ROWS, [&](size_t firstRow, size_t lastRow) {
+
+			for (int row = (int)firstRow; row < (int)lastRow; row++) {
+
+				VertexBuffer::PackedVertex* vertices = &outVertices[(size_t)width * row];
+
+				//--- The first and last rows and columns are missing some of their neighbours, and any columns left over
+				//--- after the groups of 4 are done one at a time
+				if (row == 0 || row == height - 1) {
+					for (int column = 0; column < width; column++) { GenerateVertex(heights, width, height, column, row, vertices[column]); }
+					continue;
+				}
+
+				GenerateVertex(heights, width, height, 0, row, vertices[0]);
+
+				int column = 1;
+
+				for (; column + 4 <= width - 1; column += 4) { GenerateInnerVertices(heights, width, column, row, &vertices[column]); }
+				for (; column < width; column++) { GenerateVertex(heights, width, height, column, row, vertices[column]); }
+			}
+		});
+	}
+
+
+	/*******************************************************************************************************************
+		Function that returns the height at any point on the grid (in columns and rows), interpolated across the triangle
+		the point is on - the same result as Barycentric interpolation, written out for each triangle.
+		Returns false if the point is off the grid
+	*******************************************************************************************************************/
+	bool SampleHeight(const float* heights, int width, int height, float x, float z, float& outHeight)
+	{
+		//--- Determine which grid square the point is in
+		float gridX = std::floor(x);
+		float gridZ = std::floor(z);
+
+		if (!(gridX >= 0.0f && gridZ >= 0.0f && gridX < (float)(width - 1) && gridZ < (float)(height - 1))) { return false; }
+
+		//--- Find out where on the grid square the point is, as an x and z coordinate between 0 and 1,
+		//--- and the heights of the 4 corners of the square
+		const float* corner = &heights[(size_t)gridZ * width + (size_t)gridX];
+
+		float pointX = x - gridX;
+		float pointZ = z - gridZ;
+
+		//--- The grid square is made up of 2 triangles, so figure out which one the point is on
+		outHeight = (pointX <= (1.0f - pointZ))
+			? corner[0] + (corner[1] - corner[0]) * pointX + (corner[width] - corner[0]) * pointZ
+			: corner[1] + (corner[width + 1] - corner[1]) * pointZ + (corner[width] - corner[width + 1]) * (1.0f - pointX);
+
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainGenerator.h, TerrainGenerator.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Turns heightmap pixels in to the terrain's height grid, and the height grid in to the terrain's vertices.
+
+	[Features]
+	ConvertHeights reads the height out of every pixel and levels it in the same pass.
+	GenerateVertices works out the position, texture coordinate, normal, tangent and bitangent of every vertex.
+	Normals use the finite difference method. Tangents and bitangents are the sum of the slopes of the (up to 6)
+	triangles touching each vertex - the same result as adding up every triangle's tangent, but worked out
+	directly from the heights, so every vertex can be done on its own.
+	Both passes split the grid in to bands of rows across the worker threads, and work on 4 heights at a time with SSE2.
+	SampleHeight finds the height anywhere on a grid, interpolated across the triangle underneath (for collision).
+
+	[Upcoming]
+	An AVX version could do 8 heights at a time, but would need a check for CPU support at runtime.
+
+	[Side Notes]
+	The triangles are the ones TerrainQuadtree::GenerateIndices makes - (top right, top left, bottom left) and
+	(bottom left, bottom right, top right) in each grid square. If that changes, the tangents must change with it.
+	Texture coordinates are the column and row of each vertex, so the tangent runs along x and the bitangent along z.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include "VertexBuffer.h"
+
+namespace terrain_generator {
+
+	void ConvertHeights(const unsigned char* pixels, int bytesPerPixel, int width, int height, float level, std::vector<float>& outHeights);
+	void GenerateVertices(const float* heights, int width, int height, std::vector<VertexBuffer::PackedVertex>& outVertices);
+	bool SampleHeight(const float* heights, int width, int height, float x, float z, float& outHeight);
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "TerrainHorizon.h"
+#include "TerrainPyramid.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainHorizon::TerrainHorizon()
+	:	m_eye(0.0f),
+		m_count(0),
+		m_range(0.0f),
+		m_horizon(s_binCount)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainHorizon::~TerrainHorizon()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that starts a new horizon around the eye, for count boxes (as their lowest and highest corners),
+	clearing the ground and boxes of the last one
+*******************************************************************************************************************/
+void TerrainHorizon::Begin(const glm::vec3& eye, const glm::vec3* minimums, const glm::vec3* maximums, size_t count)
+{
+	m_eye	= eye;
+	m_count	= count;
+	m_range	= 0.0f;
+
+	m_occluders.clear();
+	m_objects.clear();
+
+	for (size_t index = 0; index < count; index++) {
+
+		glm::vec2 minimum(minimums[index].x, minimums[index].z);
+		glm::vec2 maximum(maximums[index].x, maximums[index].z);
+
+		float start, end, nearest, furthest;
+
+		if (!FindDistances(minimum, maximum, nearest, furthest)) { continue; }
+
+		FindDirections(minimum, maximum, start, end);
+
+		//--- Every bin the box touches, and the steepest slope any part of it could be seen at
+		float binSize	= 4.0f / s_binCount;
+		float rise		= maximums[index].y - m_eye.y;
+		float slope		= (rise >= 0.0f) ? rise / nearest : rise / furthest;
+
+		m_objects.push_back(Object{ nearest, slope, (int)std::floor(start / binSize), (int)std::floor(end / binSize), index });
+
+		//--- Ground any further away than this can't be in front of a whole box
+		m_range = std::max(m_range, nearest);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that adds the ground under a pyramid, whose first grid point is at origin, to the horizon.
+	The pyramid is walked down from the top, and a cell is used whole once it is small enough next to its distance
+	from the eye - so the ground close by is added in small cells, and the ground far away in a few large ones
+*******************************************************************************************************************/
+void TerrainHorizon::AddOccluders(const TerrainPyramid& pyramid, const glm::vec2& origin)
+{
+	struct Cell {
+		int level, x, z;
+	};
+
+	//--- How wide a cell can be for each square of distance between it and the eye
+	const float MAX_CELL_SIZE	= 1.0f / 8.0f;
+	const int MAX_CELLS			= 3 * 32 + 1;
+
+	if (pyramid.IsEmpty() || m_objects.empty()) { return; }
+
+	Cell cells[MAX_CELLS];
+	int cellCount = 0;
+
+	int top = pyramid.GetLevelCount() - 1;
+	cells[cellCount++] = { top, 0, 0 };
+
+	while (cellCount > 0) {
+
+		Cell cell = cells[--cellCount];
+
+		glm::vec3 minimum, maximum;
+		pyramid.GetCellBounds(cell.level, cell.x, cell.z, minimum, maximum);
+
+		glm::vec2 cellMinimum = origin + glm::vec2(minimum.x, minimum.z);
+		glm::vec2 cellMaximum = origin + glm::vec2(maximum.x, maximum.z);
+
+		float start, end, nearest, furthest;
+		bool isOutside = FindDistances(cellMinimum, cellMaximum, nearest, furthest);
+
+		if (isOutside && nearest > m_range) { continue; }
+
+		float size = std::max(cellMaximum.x - cellMinimum.x, cellMaximum.y - cellMinimum.y);
+
+		//--- Split a cell that is too big for its distance (or that the eye is above) into the cells below it
+		if (cell.level > 0 && (!isOutside || size > nearest * MAX_CELL_SIZE)) {
+			for (int z = cell.z * 2; z < std::min(cell.z * 2 + 2, pyramid.GetCellsZ(cell.level - 1)); z++) {
+				for (int x = cell.x * 2; x < std::min(cell.x * 2 + 2, pyramid.GetCellsX(cell.level - 1)); x++) {
+					cells[cellCount++] = { cell.level - 1, x, z };
+				}
+			}
+			continue;
+		}
+
+		if (!isOutside || furthest > m_range) { continue; }
+
+		FindDirections(cellMinimum, cellMaximum, start, end);
+
+		//--- Only the bins the cell covers completely, as the ground might not be in the way for the rest of a bin
+		float binSize	= 4.0f / s_binCount;
+		int firstBin	= (int)std::ceil(start / binSize);
+		int lastBin		= (int)std::floor(end / binSize) - 1;
+
+		if (firstBin > lastBin) { continue; }
+
+		//--- The lowest slope anything in the cell could be seen at, using the lowest height in it
+		float rise	= minimum.y - m_eye.y;
+		float slope	= (rise >= 0.0f) ? rise / furthest : rise / nearest;
+
+		m_occluders.push_back(Occluder{ furthest, slope, firstBin, lastBin, 0 });
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that tests the boxes passed to Begin against the ground added since. Sets outIsHidden to 1 for each box
+	that is hidden behind the ground, and 0 otherwise, and returns how many are hidden
+*******************************************************************************************************************/
+size_t TerrainHorizon::Cull(std::vector<unsigned char>& outIsHidden)
+{
+	outIsHidden.assign(m_count, 0);
+
+	if (m_objects.empty() || m_occluders.empty()) { return 0; }
+
+	std::sort(m_objects.begin(), m_objects.end(), [](const Object& first, const Object& second) { return first.distance < second.distance; });
+
+	//--- There are far more occluders than objects, so rather than sorting them, each one is put in front of the
+	//--- first object that is further away than all of it (a counting sort)
+	m_firstOccluders.assign(m_objects.size() + 1, 0);
+
+	for (Occluder& ground : m_occluders) {
+
+		auto object = std::lower_bound(m_objects.begin(), m_objects.end(), ground.distance,
+									   [](const Object& object, float distance) { return object.distance < distance; });
+
+		ground.object = object - m_objects.begin();
+		m_firstOccluders[ground.object]++;
+	}
+
+	size_t total = 0;
+
+	for (size_t& first : m_firstOccluders) {
+		size_t count	= first;
+		first			= total;
+		total			+= count;
+	}
+
+	m_sortedOccluders.resize(m_occluders.size());
+
+	for (const Occluder& ground : m_occluders) { m_sortedOccluders[m_firstOccluders[ground.object]++] = ground; }
+
+	std::fill(m_horizon.begin(), m_horizon.end(), -FLT_MAX);
+
+	size_t hiddenCount	= 0;
+	size_t occluder		= 0;
+
+	for (size_t index = 0; index < m_objects.size(); index++) {
+
+		const Object& object = m_objects[index];
+
+		//--- Raise the horizon with all of the ground that is closer than the whole object
+		for (; occluder < m_firstOccluders[index]; occluder++) {
+
+			const Occluder& ground = m_sortedOccluders[occluder];
+
+			for (int bin = ground.firstBin; bin <= ground.lastBin; bin++) {
+				float& horizon	= m_horizon[bin & (s_binCount - 1)];
+				horizon			= std::max(horizon, ground.slope);
+			}
+		}
+
+		bool isHidden = true;
+
+		for (int bin = object.firstBin; bin <= object.lastBin && isHidden; bin++) {
+			isHidden = object.slope < m_horizon[bin & (s_binCount - 1)];
+		}
+
+		if (isHidden) {
+			outIsHidden[object.index] = 1;
+			hiddenCount++;
+		}
+	}
+
+	return hiddenCount;
+}
+
+
+/*******************************************************************************************************************
+	Function that works out the nearest and furthest a rectangle is from the eye (across the ground).
+	Returns false if the eye is above or inside the rectangle
+*******************************************************************************************************************/
+bool TerrainHorizon::FindDistances(const glm::vec2& minimum, const glm::vec2& maximum, float& outNearest, float& outFurthest) const
+{
+	glm::vec2 eye(m_eye.x, m_eye.z);
+
+	if (eye.x >= minimum.x && eye.x <= maximum.x && eye.y >= minimum.y && eye.y <= maximum.y) { return false; }
+
+	glm::vec2 closest	= glm::clamp(eye, minimum, maximum);
+	glm::vec2 furthest	= glm::max(glm::abs(minimum - eye), glm::abs(maximum - eye));
+	outNearest			= glm::length(closest - eye);
+	outFurthest			= glm::length(furthest);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that works out the range of directions (as diamond angles) a rectangle covers from the eye, which must
+	be outside of it. The start can be below 0 and the end above 4, where the range wraps around
+*******************************************************************************************************************/
+void TerrainHorizon::FindDirections(const glm::vec2& minimum, const glm::vec2& maximum, float& outStart, float& outEnd) const
+{
+	glm::vec2 eye(m_eye.x, m_eye.z);
+
+	//--- The rectangle covers less than half of the way around the eye, so its corners can be measured from its centre
+	glm::vec2 centre	= (minimum + maximum) * 0.5f - eye;
+	float middle		= GetDiamondAngle(centre.x, centre.y);
+	float lowest		= 0.0f;
+	float highest		= 0.0f;
+
+	glm::vec2 corners[4] = { minimum, glm::vec2(maximum.x, minimum.y), glm::vec2(minimum.x, maximum.y), maximum };
+
+	for (const glm::vec2& corner : corners) {
+
+		glm::vec2 direction = corner - eye;
+		float difference	= GetDiamondAngle(direction.x, direction.y) - middle;
+
+		if (difference > 2.0f)	{ difference -= 4.0f; }
+		if (difference < -2.0f)	{ difference += 4.0f; }
+
+		lowest	= std::min(lowest, difference);
+		highest	= std::max(highest, difference);
+	}
+
+	outStart	= middle + lowest;
+	outEnd		= middle + highest;
+}
+
+
+/*******************************************************************************************************************
+	Function that turns a direction into a number from 0 up to 4, going round in the same order as its angle
+*******************************************************************************************************************/
+float TerrainHorizon::GetDiamondAngle(float x, float z)
+{
+	if (z >= 0.0f)	{ return (x >= 0.0f) ? z / (x + z) : 1.0f - x / (z - x); }
+	else			{ return (x < 0.0f) ? 2.0f - z / (-x - z) : 3.0f + x / (x - z); }
+}
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const int TerrainHorizon::s_binCount = 1024;
\ No newline at end of file
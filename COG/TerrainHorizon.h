@@ -0,0 +1,82 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainHorizon.h, TerrainHorizon.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A horizon buffer for culling objects that are hidden behind hills, worked out on the CPU every frame.
+
+	[Features]
+	The horizon is a ring of bins around the eye, one per direction, each holding the steepest slope (rise over
+	distance) of the ground seen so far in that direction.
+	The ground is added from the cells of a terrain's min/max pyramid (see TerrainPyramid), using the lowest height of
+	each cell, so a cell can only ever make the horizon lower than the real ground is - never higher.
+	Only the ground closer than the furthest object is looked at, so culling a few objects close by is very cheap.
+	Objects and ground are swept together from near to far, so each object is tested against the ground that is closer
+	to the eye than all of it. An object is hidden if the steepest slope it could possibly be seen at is below the
+	horizon in every direction it covers.
+	A cell only raises the bins it covers completely, and an object is tested against every bin it touches, so an
+	object is never culled unless it really is behind the ground.
+
+	[Upcoming]
+	Cells closer to the eye could come from lower levels of the pyramid, for a tighter horizon nearby.
+
+	[Side Notes]
+	Everything is in terrain space - x and z in grid columns and rows, y in leveled heights (see Terrain::CullHidden).
+	Directions are binned by a "diamond angle", which goes round the eye in the same order as a real angle but needs
+	no trigonometry to work out.
+	Objects the eye is above or inside (in x and z) are never culled.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+
+class TerrainPyramid;
+
+class TerrainHorizon {
+
+private:
+	struct Occluder {
+		float	distance;
+		float	slope;
+		int		firstBin, lastBin;
+		size_t	object;
+	};
+
+	struct Object {
+		float	distance;
+		float	slope;
+		int		firstBin, lastBin;
+		size_t	index;
+	};
+
+public:
+	TerrainHorizon();
+	~TerrainHorizon();
+
+public:
+	void Begin(const glm::vec3& eye, const glm::vec3* minimums, const glm::vec3* maximums, size_t count);
+	void AddOccluders(const TerrainPyramid& pyramid, const glm::vec2& origin);
+	size_t Cull(std::vector<unsigned char>& outIsHidden);
+
+private:
+	bool FindDistances(const glm::vec2& minimum, const glm::vec2& maximum, float& outNearest, float& outFurthest) const;
+	void FindDirections(const glm::vec2& minimum, const glm::vec2& maximum, float& outStart, float& outEnd) const;
+
+private:
+	static float GetDiamondAngle(float x, float z);
+
+private:
+	glm::vec3				m_eye;
+	size_t					m_count;
+	float					m_range;
+	std::vector<Occluder>	m_occluders;
+	std::vector<Occluder>	m_sortedOccluders;
+	std::vector<size_t>		m_firstOccluders;
+	std::vector<Object>		m_objects;
+	std::vector<float>		m_horizon;
+
+private:
+	static const int		s_binCount;
+};
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "TerrainLod.h"
+#include "TerrainQuadtree.h"
+#include "ThreadPool.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainLod::TerrainLod()
+	:	m_heights(nullptr),
+		m_width(0),
+		m_height(0),
+		m_world(0.0f),
+		m_inverseWorld(1.0f),
+		m_extent(1.0f)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainLod::~TerrainLod()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Builds the levels of the quadtree from a row-major grid of width x height heights
+*******************************************************************************************************************/
+void TerrainLod::Build(const float* heights, int width, int height)
+{
+	m_heights	= heights;
+	m_width		= width;
+	m_height	= height;
+	m_world		= glm::mat4(0.0f);
+
+	m_levels.clear();
+
+	if (width < 2 || height < 2) { return; }
+
+	//--- Keep adding levels until one node covers the whole terrain
+	int squares		= std::max(width, height) - 1;
+	int levelCount	= 1;
+
+	while ((s_patchSize << (levelCount - 1)) < squares) { levelCount++; }
+
+	m_levels.resize(levelCount);
+
+	for (int level = 0; level < levelCount; level++) {
+
+		Level& current	= m_levels[level];
+		int nodeSize	= s_patchSize << level;
+
+		current.nodesX = (width - 2) / nodeSize + 1;
+		current.nodesZ = (height - 2) / nodeSize + 1;
+
+		current.minimum.resize(current.nodesX * current.nodesZ);
+		current.maximum.resize(current.nodesX * current.nodesZ);
+
+		//--- Each level reaches twice as far as the one below it, and morphs in to the next level over the end of its range.
+		//--- The top level has to cover everything, so it never runs out of range and never morphs
+		float previousRange	= (level == 0) ? 0.0f : m_levels[level - 1].range;
+		current.range		= (level == levelCount - 1) ? FLT_MAX : s_patchSize * s_rangeRatio * (float)(1 << level);
+		current.morphEnd	= current.range;
+		current.morphStart	= (level == levelCount - 1) ? FLT_MAX : previousRange + (current.range - previousRange) * s_morphStartRatio;
+
+		for (int z = 0; z < current.nodesZ; z++) {
+			for (int x = 0; x < current.nodesX; x++) {
+
+				float& minimum = current.minimum[z * current.nodesX + x];
+				float& maximum = current.maximum[z * current.nodesX + x];
+
+				minimum =  FLT_MAX;
+				maximum = -FLT_MAX;
+
+				//--- The bottom level reads the heights, every other level is made from the (up to) 4 nodes below it
+				if (level == 0) {
+					for (int row = z * nodeSize; row <= std::min((z + 1) * nodeSize, height - 1); row++) {
+						for (int column = x * nodeSize; column <= std::min((x + 1) * nodeSize, width - 1); column++) {
+							minimum = std::min(minimum, heights[row * width + column]);
+							maximum = std::max(maximum, heights[row * width + column]);
+						}
+					}
+					continue;
+				}
+
+				const Level& below = m_levels[level - 1];
+
+				for (int child = 0; child < 4; child++) {
+
+					int childX = x * 2 + (child & 1);
+					int childZ = z * 2 + (child >> 1);
+
+					if (childX >= below.nodesX || childZ >= below.nodesZ) { continue; }
+
+					minimum = std::min(minimum, below.minimum[childZ * below.nodesX + childX]);
+					maximum = std::max(maximum, below.maximum[childZ * below.nodesX + childX]);
+				}
+			}
+		}
+	}
+
+	FL_LOG("[TERRAIN] Terrain LOD levels built: ", m_levels.size(), LOG_SUCCESS);
+}
+
+
+/*******************************************************************************************************************
+	Function that stores the terrain's transform, if it has changed, for moving the cameras and node bounds between spaces
+*******************************************************************************************************************/
+void TerrainLod::Update(const glm::mat4& world)
+{
+	if (world == m_world) { return; }
+
+	m_world			= world;
+	m_inverseWorld	= glm::inverse(world);
+
+	//--- The absolute rotation and scale of the transform, used to find the half size of a transformed box
+	m_extent = glm::mat3(world);
+
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) { m_extent[column][row] = std::abs(m_extent[column][row]); }
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that chooses which patches to draw for a camera (the camera position is in world space)
+*******************************************************************************************************************/
+void TerrainLod::Select(const glm::vec3& cameraPosition, Frustum& frustum, std::vector<Patch>& outPatches) const
+{
+	outPatches.clear();
+
+	if (m_levels.empty()) { return; }
+
+	glm::vec3 camera = glm::vec3(m_inverseWorld * glm::vec4(cameraPosition, 1.0f));
+
+	int top = (int)m_levels.size() - 1;
+
+	for (int z = 0; z < m_levels[top].nodesZ; z++) {
+		for (int x = 0; x < m_levels[top].nodesX; x++) { SelectNode(top, x, z, camera, frustum, outPatches); }
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that selects a node, or the parts of it not covered by its children.
+	Returns false if the node is out of its range, meaning the level above should draw this area instead
+*******************************************************************************************************************/
+bool TerrainLod::SelectNode(int level, int x, int z, const glm::vec3& camera, Frustum& frustum, std::vector<Patch>& outPatches) const
+{
+	glm::vec3 minimum, maximum;
+	GetNodeBounds(level, x, z, minimum, maximum);
+
+	if (!IsInRange(minimum, maximum, camera, m_levels[level].range)) { return false; }
+
+	//--- Nothing to draw, but the area has been dealt with
+	glm::vec3 centre		= glm::vec3(m_world * glm::vec4((minimum + maximum) * 0.5f, 1.0f));
+	glm::vec3 halfDimension	= m_extent * ((maximum - minimum) * 0.5f);
+
+	if (!frustum.IsRectangleInside(centre, halfDimension)) { return true; }
+
+	//--- If the camera isn't close enough for the level below, draw the whole node at this level
+	if (level == 0 || !IsInRange(minimum, maximum, camera, m_levels[level - 1].range)) {
+		outPatches.push_back({ level, x, z, 0xF });
+		return true;
+	}
+
+	//--- Otherwise let the children draw themselves, and fill in any quarter they can't
+	const Level& below		= m_levels[level - 1];
+	unsigned int quadrants	= 0;
+
+	for (int child = 0; child < 4; child++) {
+
+		int childX = x * 2 + (child & 1);
+		int childZ = z * 2 + (child >> 1);
+
+		if (childX >= below.nodesX || childZ >= below.nodesZ) { continue; }
+
+		if (!SelectNode(level - 1, childX, childZ, camera, frustum, outPatches)) { quadrants |= (1 << child); }
+	}
+
+	if (quadrants) { outPatches.push_back({ level, x, z, quadrants }); }
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that builds the vertices of every patch, one after another (the camera position is in world space)
+*******************************************************************************************************************/
+void TerrainLod::GenerateVertices(const glm::vec3& cameraPosition, const std::vector<Patch>& patches, std::vector<VertexBuffer::PackedVertex>& outVertices) const
+{
+	outVertices.resize(patches.size() * GetPatchVertexCount());
+
+	if (patches.empty()) { return; }
+
+	glm::vec3 camera = glm::vec3(m_inverseWorld * glm::vec4(cameraPosition, 1.0f));
+
+	Workers::Instance()->ParallelFor(patches.size(), 1, [&](size_t begin, size_t end) {
+
+		for (size_t patch = begin; patch < end; patch++) {
+
+			const Level& level	= m_levels[patches[patch].level];
+			int stride			= 1 << patches[patch].level;
+			int firstColumn		= patches[patch].x * (s_patchSize << patches[patch].level);
+			int firstRow		= patches[patch].z * (s_patchSize << patches[patch].level);
+			float morphLength	= level.morphEnd - level.morphStart;
+
+			VertexBuffer::PackedVertex* vertex = &outVertices[patch * GetPatchVertexCount()];
+
+			for (int row = 0; row <= s_patchSize; row++) {
+				for (int column = 0; column <= s_patchSize; column++, vertex++) {
+
+					//--- Find how far this vertex is in to its morph range (0 is not morphed, 1 is fully morphed)
+					int pointX	= std::min(firstColumn + column * stride, m_width - 1);
+					int pointZ	= std::min(firstRow + row * stride, m_height - 1);
+					float morph	= 0.0f;
+
+					if (morphLength > 0.0f) {
+						float distance	= glm::length(glm::vec3((float)pointX, GetHeightAtPoint(pointX, pointZ), (float)pointZ) - camera);
+						morph			= glm::clamp((distance - level.morphStart) / morphLength, 0.0f, 1.0f);
+					}
+
+					float left, right, bottom, top, height;
+
+					//--- Most vertices are either not morphed or fully morphed, so they sit on a heightmap point and can read it directly
+					if (morph == 0.0f || morph == 1.0f) {
+
+						if (morph == 1.0f) {
+							pointX = std::min(firstColumn + (column & ~1) * stride, m_width - 1);
+							pointZ = std::min(firstRow + (row & ~1) * stride, m_height - 1);
+						}
+
+						height	= GetHeightAtPoint(pointX, pointZ);
+						left	= GetHeightAtPoint(pointX - 1, pointZ);
+						right	= GetHeightAtPoint(pointX + 1, pointZ);
+						bottom	= GetHeightAtPoint(pointX, pointZ - 1);
+						top		= GetHeightAtPoint(pointX, pointZ + 1);
+
+						vertex->position = glm::vec3((float)pointX, height, (float)pointZ);
+					}
+
+					//--- Otherwise slide the odd vertices towards their even neighbour, so a fully morphed patch matches the level above
+					else {
+
+						float x = std::min((float)firstColumn + ((float)column - (float)(column & 1) * morph) * stride, (float)(m_width - 1));
+						float z = std::min((float)firstRow + ((float)row - (float)(row & 1) * morph) * stride, (float)(m_height - 1));
+
+						height	= GetHeight(x, z);
+						left	= GetHeight(x - 1.0f, z);
+						right	= GetHeight(x + 1.0f, z);
+						bottom	= GetHeight(x, z - 1.0f);
+						top		= GetHeight(x, z + 1.0f);
+
+						vertex->position = glm::vec3(x, height, z);
+					}
+
+					//--- Normals use the finite difference method, the same as a full resolution terrain
+					vertex->textureCoord	= glm::vec2(vertex->position.x, vertex->position.z);
+					vertex->normal			= glm::normalize(glm::vec3(left - right, 2.0f, bottom - top));
+
+					//--- The texture coordinates follow x and z, so the tangent and bitangent run along the slope in each direction
+					glm::vec3 tangent		= glm::vec3(2.0f, right - left, 0.0f);
+					vertex->tangent			= glm::normalize(tangent - vertex->normal * glm::dot(vertex->normal, tangent));
+					vertex->bitangent		= glm::normalize(glm::vec3(0.0f, top - bottom, 2.0f));
+				}
+			}
+		}
+	});
+}
+
+
+/*******************************************************************************************************************
+	Function that generates the indices of the grid patch shared by every node. Each quarter of the patch is
+	contiguous (in the order the quadrants bitmask uses), so any neighbouring quarters can be drawn in one call
+*******************************************************************************************************************/
+void TerrainLod::GeneratePatchIndices(std::vector<GLushort>& outIndices)
+{
+	std::vector<unsigned int> indices;
+	int half = s_patchSize / 2;
+
+	for (int quadrant = 0; quadrant < 4; quadrant++) {
+
+		int column	= (quadrant & 1) * half;
+		int row		= (quadrant >> 1) * half;
+
+		TerrainQuadtree::GenerateIndices(column, column + half, row, row + half, s_patchSize + 1, indices);
+	}
+
+	outIndices.assign(indices.begin(), indices.end());
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the terrain space bounding box of a node, clamped to the edges of the terrain
+*******************************************************************************************************************/
+void TerrainLod::GetNodeBounds(int level, int x, int z, glm::vec3& outMinimum, glm::vec3& outMaximum) const
+{
+	const Level& current	= m_levels[level];
+	int nodeSize			= s_patchSize << level;
+
+	outMinimum = glm::vec3((float)(x * nodeSize), current.minimum[z * current.nodesX + x], (float)(z * nodeSize));
+	outMaximum = glm::vec3((float)std::min((x + 1) * nodeSize, m_width - 1), current.maximum[z * current.nodesX + x], 
+						   (float)std::min((z + 1) * nodeSize, m_height - 1));
+}
+
+
+/*******************************************************************************************************************
+	Function that returns the height at any point on the terrain, blending between the 4 nearest heights
+*******************************************************************************************************************/
+float TerrainLod::GetHeight(float x, float z) const
+{
+	x = glm::clamp(x, 0.0f, (float)(m_width - 1));
+	z = glm::clamp(z, 0.0f, (float)(m_height - 1));
+
+	int column	= std::min((int)x, m_width - 2);
+	int row		= std::min((int)z, m_height - 2);
+
+	const float* heights = &m_heights[row * m_width + column];
+
+	float bottom	= glm::mix(heights[0], heights[1], x - (float)column);
+	float top		= glm::mix(heights[m_width], heights[m_width + 1], x - (float)column);
+
+	return glm::mix(bottom, top, z - (float)row);
+}
+
+
+/*******************************************************************************************************************
+	Function that returns the height at a heightmap point, clamped to the edges of the terrain
+*******************************************************************************************************************/
+float TerrainLod::GetHeightAtPoint(int column, int row) const
+{
+	column	= glm::clamp(column, 0, m_width - 1);
+	row		= glm::clamp(row, 0, m_height - 1);
+
+	return m_heights[row * m_width + column];
+}
+
+
+/*******************************************************************************************************************
+	A function that checks whether a box comes within range of a position
+*******************************************************************************************************************/
+bool TerrainLod::IsInRange(const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& position, float range)
+{
+	if (range == FLT_MAX) { return true; }
+
+	glm::vec3 closest = glm::clamp(position, minimum, maximum);
+
+	return glm::dot(closest - position, closest - position) <= range * range;
+}
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const int	TerrainLod::s_patchSize			= 32;
+const float TerrainLod::s_rangeRatio		= 3.0f;
+const float TerrainLod::s_morphStartRatio	= 0.66f;
+
+unsigned int TerrainLod::GetPatchVertexCount()		{ return (s_patchSize + 1) * (s_patchSize + 1); }
+unsigned int TerrainLod::GetQuadrantIndexCount()	{ return (s_patchSize / 2) * (s_patchSize / 2) * 6; }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainLod.h, TerrainLod.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Continuous distance-based level of detail for large terrains (CDLOD). The whole terrain is drawn with copies of
+	one small grid patch, placed and scaled by a quadtree, so the number of triangles drawn stays roughly the same
+	however large the heightmap is.
+
+	[Features]
+	Every level of the quadtree has twice the node size and twice the viewing range of the level below it.
+	Nodes are chosen each frame from the camera's distance and the frustum - near the camera small, full resolution
+	patches are drawn, and further away the same patch covers a larger area with fewer samples.
+	Patches are morphed in to the next level before they reach the end of their range, so there is no popping and no
+	cracks between levels - every odd vertex slides on to its even neighbour, until the patch matches the one above.
+	Only a quarter of a node can be drawn, where the rest of it is covered by the level below.
+	Node bounds use the real minimum and maximum heights underneath them.
+	Heights are read from CPU-side data (the terrain's own heightfield, which isn't copied), and the patch vertices
+	are built across the worker threads.
+
+	[Upcoming]
+	Displacing the patch in the vertex shader from a height texture would leave just a few uniforms per patch.
+
+	[Side Notes]
+	Any size of heightmap is supported, nodes on the far edges are clamped to the terrain.
+	Distances are measured in terrain space (heightmap units), before the terrain's transform is applied.
+	The patch has 33x33 vertices, so its indices are 16-bit.
+	The heights passed to Build must stay alive for as long as the LOD is used.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include "VertexBuffer.h"
+#include "Frustum.h"
+
+class TerrainLod {
+
+public:
+	struct Patch {
+		int				level;
+		int				x, z;
+		unsigned int	quadrants;
+	};
+
+private:
+	struct Level {
+		int					nodesX, nodesZ;
+		float				range;
+		float				morphStart, morphEnd;
+		std::vector<float>	minimum, maximum;
+	};
+
+public:
+	TerrainLod();
+	~TerrainLod();
+
+public:
+	void Build(const float* heights, int width, int height);
+	void Update(const glm::mat4& world);
+	void Select(const glm::vec3& cameraPosition, Frustum& frustum, std::vector<Patch>& outPatches) const;
+	void GenerateVertices(const glm::vec3& cameraPosition, const std::vector<Patch>& patches, std::vector<VertexBuffer::PackedVertex>& outVertices) const;
+
+public:
+	static void GeneratePatchIndices(std::vector<GLushort>& outIndices);
+	static unsigned int GetPatchVertexCount();
+	static unsigned int GetQuadrantIndexCount();
+
+private:
+	bool SelectNode(int level, int x, int z, const glm::vec3& camera, Frustum& frustum, std::vector<Patch>& outPatches) const;
+	void GetNodeBounds(int level, int x, int z, glm::vec3& outMinimum, glm::vec3& outMaximum) const;
+	float GetHeight(float x, float z) const;
+	float GetHeightAtPoint(int column, int row) const;
+
+private:
+	static bool IsInRange(const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& position, float range);
+
+private:
+	const float*		m_heights;
+	std::vector<Level>	m_levels;
+	int					m_width, m_height;
+	glm::mat4			m_world;
+	glm::mat4			m_inverseWorld;
+	glm::mat3			m_extent;
+
+private:
+	static const int	s_patchSize;
+	static const float	s_rangeRatio;
+	static const float	s_morphStartRatio;
+};
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include <emmintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include "TerrainNoise.h"
+#include "TerrainCache.h"
+#include "TerrainGenerator.h"
+#include "ThreadPool.h"
+
+//--- The fewest rows handed to a worker at once
+static const size_t MINIMUM_ROWS = 8;
+
+//--- The heights noise is scaled to before the level is applied, the same as a heightmap pixel
+static const float MAX_PIXEL = 255.0f;
+
+
+/*******************************************************************************************************************
+	Function that multiplies 4 pairs of 32-bit integers, keeping the low 32 bits of each (SSE2 can only multiply
+	2 pairs at a time, so the even and odd lanes are done separately and put back together)
+*******************************************************************************************************************/
+static inline __m128i MultiplyIntegers(__m128i first, __m128i second)
+{
+	__m128i even	= _mm_mul_epu32(first, second);
+	__m128i odd		= _mm_mul_epu32(_mm_srli_epi64(first, 32), _mm_srli_epi64(second, 32));
+
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+
+/*******************************************************************************************************************
+	Function that rounds 4 values down (truncating rounds towards zero, so take one off anything that was rounded up)
+*******************************************************************************************************************/
+static inline __m128 Floor(__m128 value)
+{
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, value), _mm_set1_ps(1.0f)));
+}
+
+
+/*******************************************************************************************************************
+	Function that hashes 4 grid points and a seed in to 4 well mixed 32-bit values (the MurmurHash3 finalizer)
+*******************************************************************************************************************/
+static inline __m128i Hash(__m128i x, __m128i z, __m128i seed)
+{
+	__m128i hash = _mm_xor_si128(seed, _mm_xor_si128(MultiplyIntegers(x, _mm_set1_epi32(0x27D4EB2D)),
+													 MultiplyIntegers(z, _mm_set1_epi32(0x165667B1))));
+
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 16));
+	hash = MultiplyIntegers(hash, _mm_set1_epi32((int)0x85EBCA6B));
+	hash = _mm_xor_si128(hash, _mm_srli_epi32(hash, 13));
+	hash = MultiplyIntegers(hash, _mm_set1_epi32((int)0xC2B2AE35));
+
+	return _mm_xor_si128(hash, _mm_srli_epi32(hash, 16));
+}
+
+
+/*******************************************************************************************************************
+	Function that picks one of 8 gradients from each hash and returns its dot product with the offset (x, z) -
+	the 4 diagonals (1, 1) or the 4 axes scaled to the same length (1.41, 0)
+*******************************************************************************************************************/
+static inline __m128 Gradient(__m128i hash, __m128 x, __m128 z)
+{
+	const __m128 ONE	= _mm_set1_ps(1.0f);
+	const __m128 ROOT2	= _mm_set1_ps(1.41421356f);
+
+	//--- The lowest 2 bits flip the signs of x and z, the next 2 pick a diagonal (0 or 1), the x axis (2) or the z axis (3)
+	x = _mm_xor_ps(x, _mm_castsi128_ps(_mm_slli_epi32(hash, 31)));
+	z = _mm_xor_ps(z, _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(hash, 1), 31)));
+
+	__m128i axis	= _mm_and_si128(_mm_srli_epi32(hash, 2), _mm_set1_epi32(3));
+	__m128 isX		= _mm_castsi128_ps(_mm_cmpeq_epi32(axis, _mm_set1_epi32(2)));
+	__m128 isZ		= _mm_castsi128_ps(_mm_cmpeq_epi32(axis, _mm_set1_epi32(3)));
+	__m128 diagonal	= _mm_andnot_ps(_mm_or_ps(isX, isZ), ONE);
+
+	__m128 weightX	= _mm_or_ps(_mm_and_ps(isX, ROOT2), diagonal);
+	__m128 weightZ	= _mm_or_ps(_mm_and_ps(isZ, ROOT2), diagonal);
+
+	return _mm_add_ps(_mm_mul_ps(x, weightX), _mm_mul_ps(z, weightZ));
+}
+
+
+/*******************************************************************************************************************
+	Function that returns 2D gradient noise at 4 points, between -1 and 1. The gradients at the 4 corners of each
+	grid square are blended with the quintic fade curve 6t^5 - 15t^4 + 10t^3, so the noise is smooth across squares
+	Reference: https://mrl.cs.nyu.edu/~perlin/paper445.pdf
+*******************************************************************************************************************/
+static inline __m128 GradientNoise(__m128 x, __m128 z, __m128i seed)
+{
+	const __m128 ONE	= _mm_set1_ps(1.0f);
+	const __m128i STEP	= _mm_set1_epi32(1);
+
+	__m128 floorX	= Floor(x);
+	__m128 floorZ	= Floor(z);
+	__m128i left	= _mm_cvttps_epi32(floorX);
+	__m128i bottom	= _mm_cvttps_epi32(floorZ);
+	__m128i right	= _mm_add_epi32(left, STEP);
+	__m128i top		= _mm_add_epi32(bottom, STEP);
+
+	__m128 pointX	= _mm_sub_ps(x, floorX);
+	__m128 pointZ	= _mm_sub_ps(z, floorZ);
+
+	__m128 bottomLeft	= Gradient(Hash(left, bottom, seed), pointX, pointZ);
+	__m128 bottomRight	= Gradient(Hash(right, bottom, seed), _mm_sub_ps(pointX, ONE), pointZ);
+	__m128 topLeft		= Gradient(Hash(left, top, seed), pointX, _mm_sub_ps(pointZ, ONE));
+	__m128 topRight		= Gradient(Hash(right, top, seed), _mm_sub_ps(pointX, ONE), _mm_sub_ps(pointZ, ONE));
+
+	auto fade = [](__m128 t) {
+		__m128 curve = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+		return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), curve);
+	};
+
+	__m128 fadeX = fade(pointX);
+	__m128 fadeZ = fade(pointZ);
+
+	__m128 lower = _mm_add_ps(bottomLeft, _mm_mul_ps(fadeX, _mm_sub_ps(bottomRight, bottomLeft)));
+	__m128 upper = _mm_add_ps(topLeft, _mm_mul_ps(fadeX, _mm_sub_ps(topRight, topLeft)));
+
+	return _mm_add_ps(lower, _mm_mul_ps(fadeZ, _mm_sub_ps(upper, lower)));
+}
+
+
+/*******************************************************************************************************************
+	Function that adds up octaves of noise at 4 points, each octave with its own seed. Fractal noise comes back
+	between -1 and 1, ridged noise (each octave folded to 1 - |noise|, squared) between 0 and 1
+*******************************************************************************************************************/
+static inline __m128 FractalNoise(const TerrainNoise::Settings& settings, TerrainNoise::NoiseType type, int octaves, unsigned int seed, __m128 x, __m128 z)
+{
+	const __m128 ONE		= _mm_set1_ps(1.0f);
+	const __m128 SIGN_BIT	= _mm_set1_ps(-0.0f);
+
+	__m128 sum			= _mm_setzero_ps();
+	float amplitude		= 1.0f;
+	float total			= 0.0f;
+	float frequency		= settings.frequency;
+
+	for (int octave = 0; octave < octaves; octave++) {
+
+		__m128 frequencies	= _mm_set1_ps(frequency);
+		__m128 noise		= GradientNoise(_mm_mul_ps(x, frequencies), _mm_mul_ps(z, frequencies), _mm_set1_epi32((int)(seed + octave * 0x9E3779B9u)));
+
+		if (type == TerrainNoise::NOISE_RIDGED) {
+			noise = _mm_sub_ps(ONE, _mm_andnot_ps(SIGN_BIT, noise));
+			noise = _mm_mul_ps(noise, noise);
+		}
+
+		sum			= _mm_add_ps(sum, _mm_mul_ps(noise, _mm_set1_ps(amplitude)));
+		total		+= amplitude;
+		amplitude	*= settings.gain;
+		frequency	*= settings.lacunarity;
+	}
+
+	return _mm_div_ps(sum, _mm_set1_ps(total));
+}
+
+
+/*******************************************************************************************************************
+	Function that works out the heights at 4 points (in grid columns and rows), scaled to 0 to 255 and leveled
+*******************************************************************************************************************/
+static inline __m128 SampleHeights(const TerrainNoise::Settings& settings, __m128 x, __m128 z, __m128 scale)
+{
+	//--- Bend the coordinates with 2 more layers of noise (with their own seeds), before the terrain's noise is sampled
+	if (settings.warp > 0.0f) {
+
+		const int WARP_OCTAVES = 3;
+
+		__m128 warp		= _mm_set1_ps(settings.warp);
+		__m128 warpX	= FractalNoise(settings, TerrainNoise::NOISE_FRACTAL, WARP_OCTAVES, settings.seed ^ 0x68E31DA4u, x, z);
+		__m128 warpZ	= FractalNoise(settings, TerrainNoise::NOISE_FRACTAL, WARP_OCTAVES, settings.seed ^ 0xB5297A4Du, x, z);
+
+		x = _mm_add_ps(x, _mm_mul_ps(warpX, warp));
+		z = _mm_add_ps(z, _mm_mul_ps(warpZ, warp));
+	}
+
+	__m128 noise = FractalNoise(settings, settings.type, settings.octaves, settings.seed, x, z);
+
+	//--- Fractal noise is moved up in to 0 to 1, the same range as ridged noise
+	if (settings.type == TerrainNoise::NOISE_FRACTAL) { noise = _mm_add_ps(_mm_mul_ps(noise, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f)); }
+
+	noise = _mm_min_ps(_mm_max_ps(noise, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+	return _mm_mul_ps(noise, scale);
+}
+
+
+/*******************************************************************************************************************
+	Constructor that fills in any settings that were left as 0 with their defaults
+*******************************************************************************************************************/
+TerrainNoise::TerrainNoise(const Settings& settings)
+	:	m_settings(settings)
+{
+	if (m_settings.frequency <= 0.0f)	{ m_settings.frequency	= s_defaultFrequency; }
+	if (m_settings.lacunarity <= 0.0f)	{ m_settings.lacunarity	= s_defaultLacunarity; }
+	if (m_settings.gain <= 0.0f)		{ m_settings.gain		= s_defaultGain; }
+
+	m_settings.octaves = std::min(std::max(m_settings.octaves, 1), s_maxOctaves);
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainNoise::~TerrainNoise()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that fills a row-major grid of width x height heights, starting from the grid point (originX, originZ)
+*******************************************************************************************************************/
+void TerrainNoise::Generate(int originX, int originZ, int width, int height, float level, std::vector<float>& outHeights) const
+{
+	outHeights.resize((size_t)width * height);
+
+	const __m128 SCALE	= _mm_set1_ps(MAX_PIXEL / level);
+	const __m128 LANES	= _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+	Workers::Instance()->ParallelFor((size_t)height, MINIMUM_ROWS, [&](size_t firstRow, size_t lastRow) {
+
+		alignas(16) float remainder[4];
+
+		for (size_t row = firstRow; row < lastRow; row++) {
+
+			float* output	= &outHeights[row * width];
+			__m128 z		= _mm_set1_ps((float)(originZ + (int)row));
+			int column		= 0;
+
+			for (; column + 4 <= width; column += 4) {
+				__m128 x = _mm_add_ps(_mm_set1_ps((float)(originX + column)), LANES);
+				_mm_storeu_ps(&output[column], SampleHeights(m_settings, x, z, SCALE));
+			}
+
+			//--- Any columns left over are still worked out 4 at a time, and only the ones we need are kept
+			if (column < width) {
+				__m128 x = _mm_add_ps(_mm_set1_ps((float)(originX + column)), LANES);
+				_mm_store_ps(remainder, SampleHeights(m_settings, x, z, SCALE));
+				std::copy(remainder, remainder + (width - column), &output[column]);
+			}
+		}
+	});
+}
+
+
+/*******************************************************************************************************************
+	Function that returns the height at any point (in grid columns and rows), interpolated across the triangle the
+	point is on, exactly as it would be on a generated grid
+*******************************************************************************************************************/
+float TerrainNoise::GetHeight(float x, float z, float level) const
+{
+	float column	= std::floor(x);
+	float row		= std::floor(z);
+
+	//--- Just the 4 corners of the grid square
+	alignas(16) float corners[4];
+
+	__m128 cornersX = _mm_setr_ps(column, column + 1.0f, column, column + 1.0f);
+	__m128 cornersZ = _mm_setr_ps(row, row, row + 1.0f, row + 1.0f);
+
+	_mm_store_ps(corners, SampleHeights(m_settings, cornersX, cornersZ, _mm_set1_ps(MAX_PIXEL / level)));
+
+	float height = 0.0f;
+	terrain_generator::SampleHeight(corners, 2, 2, x - column, z - row, height);
+
+	return height;
+}
+
+
+/*******************************************************************************************************************
+	Function that makes the key a generated terrain is cached under (see TerrainCache), from every setting that
+	changes the heights
+*******************************************************************************************************************/
+unsigned long long TerrainNoise::GenerateKey(float level, bool isLodEnabled) const
+{
+	unsigned int values[9] = { s_version, m_settings.seed, (unsigned int)m_settings.type, (unsigned int)m_settings.size, (unsigned int)m_settings.octaves };
+
+	memcpy(&values[5], &m_settings.frequency, sizeof(float));
+	memcpy(&values[6], &m_settings.lacunarity, sizeof(float));
+	memcpy(&values[7], &m_settings.gain, sizeof(float));
+	memcpy(&values[8], &m_settings.warp, sizeof(float));
+
+	return TerrainCache::GenerateKey((const char*)values, sizeof(values), level, isLodEnabled);
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const TerrainNoise::Settings& TerrainNoise::GetSettings() const { return m_settings; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const unsigned int TerrainNoise::s_version		= 1;
+const float TerrainNoise::s_defaultFrequency	= 1.0f / 256.0f;
+const float TerrainNoise::s_defaultLacunarity	= 2.0f;
+const float TerrainNoise::s_defaultGain			= 0.5f;
+const int TerrainNoise::s_maxOctaves			= 16;
\ No newline at end of file
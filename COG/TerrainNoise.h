@@ -0,0 +1,71 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainNoise.h, TerrainNoise.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Procedural heights for terrains that don't have a heightmap file. Fills the same height grid a heightmap does,
+	so the mesh, collision, LOD, caching and streaming all work the same way on a generated terrain.
+
+	[Features]
+	Fractal gradient (Perlin) noise - octaves of noise added together, each at a higher frequency and lower amplitude.
+	Ridged noise (NOISE_RIDGED) folds each octave, for sharp mountain ridges rather than rolling hills.
+	Domain warping ("warp" in grid squares) bends the coordinates with another layer of noise before they're sampled,
+	for more natural, eroded looking shapes.
+	4 heights are worked out at a time with SSE2, including the hashing, and the rows are split across the worker threads.
+	Noise is made from a hash of each point's grid coordinates and the seed, with no tables, so the same seed always
+	gives the same terrain - on any thread, in any order, in any size of block. A tile generated on its own matches the
+	same part of a whole terrain exactly, so a streamed world (see TerrainStreamer) can be generated a tile at a time.
+
+	[Upcoming]
+	An AVX version could do 8 heights at a time, but would need a check for CPU support at runtime.
+
+	[Side Notes]
+	Noise is scaled to the same 0 to 255 range as a heightmap's pixels, and then divided by the terrain's level.
+	The frequency is in cycles per grid square, so 1/256 gives roughly one hill per 256 squares.
+	Coordinates are converted to 32-bit integers, so a world can be up to around 16 million squares across before
+	the heights lose precision.
+	Bump s_version whenever the noise changes, so that terrains cached from the old noise are generated again.
+
+*******************************************************************************************************************/
+#include <vector>
+
+class TerrainNoise {
+
+public:
+	enum NoiseType { NOISE_FRACTAL, NOISE_RIDGED };
+
+	struct Settings {
+		unsigned int	seed;
+		NoiseType		type;
+		int				size;
+		int				octaves;
+		float			frequency;
+		float			lacunarity;
+		float			gain;
+		float			warp;
+	};
+
+public:
+	TerrainNoise(const Settings& settings);
+	~TerrainNoise();
+
+public:
+	void Generate(int originX, int originZ, int width, int height, float level, std::vector<float>& outHeights) const;
+	float GetHeight(float x, float z, float level) const;
+	unsigned long long GenerateKey(float level, bool isLodEnabled) const;
+
+public:
+	const Settings& GetSettings() const;
+
+private:
+	Settings m_settings;
+
+private:
+	static const unsigned int	s_version;
+	static const float			s_defaultFrequency;
+	static const float			s_defaultLacunarity;
+	static const float			s_defaultGain;
+	static const int			s_maxOctaves;
+};
\ No newline at end of file
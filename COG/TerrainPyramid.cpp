@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "TerrainPyramid.h"
+#include "ThreadPool.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainPyramid::TerrainPyramid()
+	:	m_heights(nullptr),
+		m_width(0),
+		m_height(0)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainPyramid::~TerrainPyramid()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Builds the levels of the pyramid from a row-major grid of width x height heights. Every level is worked out a band
+	of rows at a time across the worker threads, from the level below it
+*******************************************************************************************************************/
+void TerrainPyramid::Build(const float* heights, int width, int height)
+{
+	const size_t MINIMUM_ROWS = 16;
+
+	m_heights	= heights;
+	m_width		= width;
+	m_height	= height;
+
+	m_levels.clear();
+
+	if (!heights || width < 2 || height < 2) { return; }
+
+	//--- The bottom level has one cell per grid square, holding the lowest and highest of its 4 corners
+	m_levels.push_back(Level{ width - 1, height - 1, std::vector<float>((size_t)(width - 1) * (height - 1)),
+										 std::vector<float>((size_t)(width - 1) * (height - 1)) });
+
+	Level& squares = m_levels.back();
+
+	Workers::Instance()->ParallelFor((size_t)squares.cellsZ, MINIMUM_ROWS, [&](size_t firstRow, size_t lastRow) {
+		for (size_t row = firstRow; row < lastRow; row++) {
+
+			const float* bottom	= &heights[row * width];
+			const float* top	= bottom + width;
+			float* minimum		= &squares.minimum[row * squares.cellsX];
+			float* maximum		= &squares.maximum[row * squares.cellsX];
+
+			for (int column = 0; column < squares.cellsX; column++) {
+				minimum[column] = std::min(std::min(bottom[column], bottom[column + 1]), std::min(top[column], top[column + 1]));
+				maximum[column] = std::max(std::max(bottom[column], bottom[column + 1]), std::max(top[column], top[column + 1]));
+			}
+		}
+	});
+
+	//--- Each level above has one cell per 2x2 cells below it (a cell on an odd edge just has fewer below it),
+	//--- until one cell covers the whole terrain
+	while (m_levels.back().cellsX > 1 || m_levels.back().cellsZ > 1) {
+
+		const Level& below	= m_levels.back();
+		int cellsX			= (below.cellsX + 1) / 2;
+		int cellsZ			= (below.cellsZ + 1) / 2;
+
+		Level current = { cellsX, cellsZ, std::vector<float>((size_t)cellsX * cellsZ), std::vector<float>((size_t)cellsX * cellsZ) };
+
+		Workers::Instance()->ParallelFor((size_t)cellsZ, MINIMUM_ROWS, [&](size_t firstRow, size_t lastRow) {
+			for (int z = (int)firstRow; z < (int)lastRow; z++) {
+				for (int x = 0; x < cellsX; x++) {
+
+					float minimum =  FLT_MAX;
+					float maximum = -FLT_MAX;
+
+					for (int childZ = z * 2; childZ < std::min(z * 2 + 2, below.cellsZ); childZ++) {
+						for (int childX = x * 2; childX < std::min(x * 2 + 2, below.cellsX); childX++) {
+							minimum = std::min(minimum, below.minimum[(size_t)childZ * below.cellsX + childX]);
+							maximum = std::max(maximum, below.maximum[(size_t)childZ * below.cellsX + childX]);
+						}
+					}
+
+					current.minimum[(size_t)z * cellsX + x] = minimum;
+					current.maximum[(size_t)z * cellsX + x] = maximum;
+				}
+			}
+		});
+
+		m_levels.push_back(std::move(current));
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the first point a ray hits the ground, within maxDistance lengths of its direction.
+	Returns false if the ray doesn't hit the terrain
+*******************************************************************************************************************/
+bool TerrainPyramid::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const
+{
+	return Intersect(origin, direction, 0.0f, maxDistance, outDistance);
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if the ground is in the way between two points (line of sight).
+	The two points themselves are allowed to touch the ground, so something standing on the terrain can still be seen
+*******************************************************************************************************************/
+bool TerrainPyramid::IsVisible(const glm::vec3& from, const glm::vec3& to) const
+{
+	const float MARGIN = 1e-4f;
+
+	float distance = 0.0f;
+	return !Intersect(from, to - from, MARGIN, 1.0f - MARGIN, distance);
+}
+
+
+/*******************************************************************************************************************
+	Function that walks the pyramid down from the top, front to back along the ray, between distances start and end.
+	Cells are visited in the order the ray enters them, and the cells next to each other never overlap,
+	so the first square that is hit is the closest one
+*******************************************************************************************************************/
+bool TerrainPyramid::Intersect(const glm::vec3& origin, const glm::vec3& direction, float start, float end, float& outDistance) const
+{
+	struct Cell {
+		int		level, x, z;
+		float	start, end;
+	};
+
+	//--- Each level down adds at most 3 cells to the stack (the 4th is popped straight away)
+	const int MAX_CELLS = 3 * 32 + 1;
+
+	if (m_levels.empty() || !(end >= start)) { return false; }
+
+	//--- Keep the direction away from zero, so the inverse never divides by it (and 0 * infinity never happens)
+	glm::vec3 inverse;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float component	= (std::fabs(direction[axis]) < 1e-12f) ? std::copysign(1e-12f, direction[axis]) : direction[axis];
+		inverse[axis]	= 1.0f / component;
+	}
+
+	Cell cells[MAX_CELLS];
+	int cellCount = 0;
+
+	glm::vec3 minimum, maximum;
+
+	int top = (int)m_levels.size() - 1;
+	GetCellBounds(top, 0, 0, minimum, maximum);
+
+	if (!IntersectBox(minimum, maximum, origin, inverse, start, end)) { return false; }
+
+	cells[cellCount++] = { top, 0, 0, start, end };
+
+	while (cellCount > 0) {
+
+		Cell cell = cells[--cellCount];
+
+		//--- A bottom level cell is one grid square, so test it against its triangles
+		if (cell.level == 0) {
+			if (IntersectSquare(cell.x, cell.z, origin, direction, cell.start, cell.end, outDistance)) { return true; }
+			continue;
+		}
+
+		//--- Otherwise find which of the cells below it the ray passes through, within their heights
+		const Level& below = m_levels[cell.level - 1];
+
+		Cell children[4];
+		int childCount = 0;
+
+		for (int z = cell.z * 2; z < std::min(cell.z * 2 + 2, below.cellsZ); z++) {
+			for (int x = cell.x * 2; x < std::min(cell.x * 2 + 2, below.cellsX); x++) {
+
+				float childStart	= cell.start;
+				float childEnd		= cell.end;
+
+				GetCellBounds(cell.level - 1, x, z, minimum, maximum);
+
+				if (IntersectBox(minimum, maximum, origin, inverse, childStart, childEnd)) {
+					children[childCount++] = { cell.level - 1, x, z, childStart, childEnd };
+				}
+			}
+		}
+
+		//--- Push the furthest first, so the nearest is the next one popped
+		std::sort(children, children + childCount, [](const Cell& first, const Cell& second) { return first.start > second.start; });
+
+		for (int child = 0; child < childCount; child++) { cells[cellCount++] = children[child]; }
+	}
+
+	return false;
+}
+
+
+/*******************************************************************************************************************
+	Function that intersects a ray with the 2 triangles of a grid square, the same triangles SampleHeight uses
+	(see TerrainGenerator.h). Each triangle is a plane, so the ray meets it at one distance, which only counts
+	if it is between start and end and lands on that triangle's half of the square
+*******************************************************************************************************************/
+bool TerrainPyramid::IntersectSquare(int column, int row, const glm::vec3& origin, const glm::vec3& direction, float start, float end, float& outDistance) const
+{
+	//--- A little slack, so a ray along a shared edge can't slip between two squares
+	const float EPSILON = 1e-5f;
+
+	const float* corner = &m_heights[(size_t)row * m_width + column];
+
+	float bottomLeft	= corner[0];
+	float bottomRight	= corner[1];
+	float topLeft		= corner[m_width];
+	float topRight		= corner[m_width + 1];
+
+	//--- The ray, relative to the bottom left corner of the square
+	float x = origin.x - (float)column;
+	float z = origin.z - (float)row;
+
+	//--- Both planes as height = base + slopeX * x + slopeZ * z
+	float bases[2]		= { bottomLeft, bottomRight + topLeft - topRight };
+	float slopesX[2]	= { bottomRight - bottomLeft, topRight - topLeft };
+	float slopesZ[2]	= { topLeft - bottomLeft, topRight - bottomRight };
+
+	bool isHit = false;
+
+	for (int triangle = 0; triangle < 2; triangle++) {
+
+		//--- How far above the plane the ray starts, and how fast it moves towards it
+		float above		= origin.y - (bases[triangle] + slopesX[triangle] * x + slopesZ[triangle] * z);
+		float closing	= direction.y - (slopesX[triangle] * direction.x + slopesZ[triangle] * direction.z);
+
+		if (closing == 0.0f) { continue; }
+
+		float distance = -above / closing;
+
+		if (distance < start - EPSILON || distance > end + EPSILON || (isHit && distance >= outDistance)) { continue; }
+
+		float pointX = x + direction.x * distance;
+		float pointZ = z + direction.z * distance;
+
+		bool isOnTriangle = (triangle == 0)
+			? pointX >= -EPSILON && pointZ >= -EPSILON && pointX + pointZ <= 1.0f + EPSILON
+			: pointX <= 1.0f + EPSILON && pointZ <= 1.0f + EPSILON && pointX + pointZ >= 1.0f - EPSILON;
+
+		if (isOnTriangle) {
+			outDistance	= std::max(distance, start);
+			isHit		= true;
+		}
+	}
+
+	return isHit;
+}
+
+
+/*******************************************************************************************************************
+	Function that works out the box a cell covers - the grid squares underneath it and their lowest and highest heights
+*******************************************************************************************************************/
+void TerrainPyramid::GetCellBounds(int level, int x, int z, glm::vec3& outMinimum, glm::vec3& outMaximum) const
+{
+	const Level& current	= m_levels[level];
+	size_t cell				= (size_t)z * current.cellsX + x;
+
+	outMinimum = glm::vec3((float)(x << level), current.minimum[cell], (float)(z << level));
+	outMaximum = glm::vec3((float)std::min((x + 1) << level, m_width - 1), current.maximum[cell], (float)std::min((z + 1) << level, m_height - 1));
+}
+
+
+/*******************************************************************************************************************
+	Function that clips the part of a ray between start and end to a box (the slab method).
+	Returns false if none of it is inside the box
+*******************************************************************************************************************/
+bool TerrainPyramid::IntersectBox(const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& origin, const glm::vec3& inverse,
+								  float& inOutStart, float& inOutEnd)
+{
+	float start	= inOutStart;
+	float end	= inOutEnd;
+
+	for (int axis = 0; axis < 3; axis++) {
+
+		float nearest	= (minimum[axis] - origin[axis]) * inverse[axis];
+		float furthest	= (maximum[axis] - origin[axis]) * inverse[axis];
+
+		if (nearest > furthest) { std::swap(nearest, furthest); }
+
+		start	= std::max(start, nearest);
+		end		= std::min(end, furthest);
+	}
+
+	if (start > end) { return false; }
+
+	inOutStart	= start;
+	inOutEnd	= end;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that returns how much memory the pyramid uses (not counting the heights, which it doesn't own)
+*******************************************************************************************************************/
+size_t TerrainPyramid::GetBytes() const
+{
+	size_t bytes = 0;
+
+	for (const Level& level : m_levels) { bytes += (level.minimum.size() + level.maximum.size()) * sizeof(float); }
+
+	return bytes;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+bool TerrainPyramid::IsEmpty() const		{ return m_levels.empty(); }
+float TerrainPyramid::GetMinimum() const	{ return m_levels.empty() ? 0.0f : m_levels.back().minimum[0]; }
+float TerrainPyramid::GetMaximum() const	{ return m_levels.empty() ? 0.0f : m_levels.back().maximum[0]; }
+int TerrainPyramid::GetLevelCount() const	{ return (int)m_levels.size(); }
+int TerrainPyramid::GetCellsX(int level) const	{ return m_levels[level].cellsX; }
+int TerrainPyramid::GetCellsZ(int level) const	{ return m_levels[level].cellsZ; }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainPyramid.h, TerrainPyramid.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	A min/max height pyramid over a terrain's height grid, for finding where rays hit the ground (mouse picking,
+	projectiles, placing objects) and whether one point can see another (AI), without marching across every square.
+
+	[Features]
+	The bottom level stores the lowest and highest corner of every grid square, and each level above stores the lowest
+	and highest of the 2x2 cells below it, up to one cell covering the whole terrain.
+	Rays walk down the pyramid from the top, front to back, and any cell the ray passes over (or under) is skipped
+	whole - so the sky, and long runs of ground far below the ray, cost a handful of box tests rather than a square each.
+	Only the squares the ray actually reaches are tested against their 2 triangles, the same triangles the terrain is
+	drawn with and GetHeight interpolates across, so a hit is exactly on the visible ground.
+	Line of sight checks stop at the first bit of ground found between the two points.
+	Everything is const once built, so any number of threads can cast rays at the same time.
+	The cells of any level can be read back, as coarse bounds of the ground (see TerrainHorizon).
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Rays are in terrain space - x and z in grid columns and rows, y in leveled heights (see Terrain::Raycast for world space).
+	Distances are measured in lengths of the direction passed in, so pass a normalized direction to get real distances.
+	The heights passed to Build must stay alive for as long as the pyramid is used.
+	The pyramid takes around 2.7 floats per heightmap point, on top of the heights themselves.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+
+class TerrainPyramid {
+
+private:
+	struct Level {
+		int					cellsX, cellsZ;
+		std::vector<float>	minimum, maximum;
+	};
+
+public:
+	TerrainPyramid();
+	~TerrainPyramid();
+
+public:
+	void Build(const float* heights, int width, int height);
+
+public:
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const;
+	bool IsVisible(const glm::vec3& from, const glm::vec3& to) const;
+
+public:
+	void GetCellBounds(int level, int x, int z, glm::vec3& outMinimum, glm::vec3& outMaximum) const;
+	size_t GetBytes() const;
+
+public:
+	bool IsEmpty() const;
+	float GetMinimum() const;
+	float GetMaximum() const;
+	int GetLevelCount() const;
+	int GetCellsX(int level) const;
+	int GetCellsZ(int level) const;
+
+private:
+	bool Intersect(const glm::vec3& origin, const glm::vec3& direction, float start, float end, float& outDistance) const;
+	bool IntersectSquare(int column, int row, const glm::vec3& origin, const glm::vec3& direction, float start, float end, float& outDistance) const;
+
+private:
+	static bool IntersectBox(const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& origin, const glm::vec3& inverse,
+							 float& inOutStart, float& inOutEnd);
+
+private:
+	const float*		m_heights;
+	int					m_width, m_height;
+	std::vector<Level>	m_levels;
+};
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <algorithm>
+
+#include "TerrainQuadtree.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainQuadtree::TerrainQuadtree()
+	:	m_world(0.0f)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+TerrainQuadtree::~TerrainQuadtree()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Splits a width x height grid of vertices in to chunks, and generates the index data of every chunk, in quadtree order
+*******************************************************************************************************************/
+void TerrainQuadtree::Build(const std::vector<VertexBuffer::PackedVertex>& vertices, int width, int height, std::vector<unsigned int>& outIndices)
+{
+	m_nodes.clear();
+	m_chunks.clear();
+	outIndices.clear();
+
+	//--- Force the world bounds to be calculated the next time Update is called
+	m_world = glm::mat4(0.0f);
+
+	if (width < 2 || height < 2) { return; }
+
+	outIndices.reserve((size_t)(width - 1) * (height - 1) * 6);
+
+	//--- We do -1 as there is one less grid square than there are points along each side of the grid
+	m_nodes.push_back({});
+	BuildNode(0, vertices, width, 0, width - 1, 0, height - 1, outIndices);
+
+	FL_LOG("[TERRAIN] Terrain quadtree built, chunks: ", m_chunks.size(), LOG_SUCCESS);
+}
+
+
+/*******************************************************************************************************************
+	Builds a node (already in the list) covering the grid squares from the first column/row up to (not including) the
+	last column/row. Nodes bigger than one chunk are split in to 4 children (or 2, along a thin edge of the grid)
+*******************************************************************************************************************/
+void TerrainQuadtree::BuildNode(unsigned int node, const std::vector<VertexBuffer::PackedVertex>& vertices, int stride, int firstColumn, int lastColumn,
+								int firstRow, int lastRow, std::vector<unsigned int>& outIndices)
+{
+	//--- A node that fits in one chunk is a leaf, so generate its indices and find its real height range
+	if (lastColumn - firstColumn <= s_chunkSize && lastRow - firstRow <= s_chunkSize) {
+
+		Chunk chunk	= {};
+		chunk.indexOffset	= (unsigned int)outIndices.size();
+
+		GenerateIndices(firstColumn, lastColumn, firstRow, lastRow, stride, outIndices);
+
+		chunk.indexCount	= (unsigned int)outIndices.size() - chunk.indexOffset;
+		chunk.minimum		= vertices[firstRow * stride + firstColumn].position;
+		chunk.maximum		= chunk.minimum;
+
+		for (int row = firstRow; row <= lastRow; row++) {
+			for (int column = firstColumn; column <= lastColumn; column++) {
+				chunk.minimum = glm::min(chunk.minimum, vertices[row * stride + column].position);
+				chunk.maximum = glm::max(chunk.maximum, vertices[row * stride + column].position);
+			}
+		}
+
+		m_nodes[node].minimum		= chunk.minimum;
+		m_nodes[node].maximum		= chunk.maximum;
+		m_nodes[node].firstChild	= 0;
+		m_nodes[node].chunk			= (unsigned int)m_chunks.size();
+
+		m_chunks.push_back(chunk);
+
+		return;
+	}
+
+	//--- Split on chunk boundaries, so every chunk (except those on the far edges) is a full s_chunkSize square
+	int chunkColumns	= (lastColumn - firstColumn + s_chunkSize - 1) / s_chunkSize;
+	int chunkRows		= (lastRow - firstRow + s_chunkSize - 1) / s_chunkSize;
+
+	int splitColumn		= (chunkColumns > 1) ? firstColumn + (chunkColumns / 2) * s_chunkSize : lastColumn;
+	int splitRow		= (chunkRows > 1) ? firstRow + (chunkRows / 2) * s_chunkSize : lastRow;
+
+	int columns[3]	= { firstColumn, splitColumn, lastColumn };
+	int rows[3]		= { firstRow, splitRow, lastRow };
+
+	struct Range { int firstColumn, lastColumn, firstRow, lastRow; };
+	std::vector<Range> children;
+
+	for (int row = 0; row < 2; row++) {
+		for (int column = 0; column < 2; column++) {
+			if (columns[column] < columns[column + 1] && rows[row] < rows[row + 1]) {
+				children.push_back({ columns[column], columns[column + 1], rows[row], rows[row + 1] });
+			}
+		}
+	}
+
+	//--- Children are stored straight after each other, so a node only needs to know where the first of them is.
+	//--- That means making room for all of them before building any, or the first child's own children would land
+	//--- where its brothers should be
+	unsigned int firstChild = (unsigned int)m_nodes.size();
+	m_nodes.resize(m_nodes.size() + children.size());
+
+	m_nodes[node].firstChild	= firstChild;
+	m_nodes[node].chunk			= (unsigned int)children.size();
+
+	for (unsigned int child = 0; child < children.size(); child++) {
+		BuildNode(firstChild + child, vertices, stride, children[child].firstColumn, children[child].lastColumn,
+				  children[child].firstRow, children[child].lastRow, outIndices);
+	}
+
+	m_nodes[node].minimum = m_nodes[firstChild].minimum;
+	m_nodes[node].maximum = m_nodes[firstChild].maximum;
+
+	for (unsigned int child = firstChild; child < firstChild + children.size(); child++) {
+		m_nodes[node].minimum = glm::min(m_nodes[node].minimum, m_nodes[child].minimum);
+		m_nodes[node].maximum = glm::max(m_nodes[node].maximum, m_nodes[child].maximum);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that generates the triangle list for part of a grid, 2 triangles per grid square.
+	The grid is walked in narrow bands of columns, row by row, so the vertices shared with the row above are still
+	in the GPU's vertex cache (even a small, 16 entry one) - each vertex is transformed about 1.2 times, instead of twice
+*******************************************************************************************************************/
+void TerrainQuadtree::GenerateIndices(int firstColumn, int lastColumn, int firstRow, int lastRow, int stride, std::vector<unsigned int>& outIndices)
+{
+	//--- Vertex positions for each vertex - bottom left, bottom right, top left and top right
+	struct { unsigned int bottomLeft, bottomRight, topLeft, topRight; } vertex = { 0 };
+
+	for (int band = firstColumn; band < lastColumn; band += s_bandWidth) {
+
+		int bandEnd = std::min(band + s_bandWidth, lastColumn);
+
+		for (int row = firstRow; row < lastRow; row++) {
+			for (int column = band; column < bandEnd; column++) {
+
+				vertex.bottomLeft	= (stride * row) + column;
+				vertex.bottomRight	= (stride * row) + (column + 1);
+				vertex.topLeft		= (stride * (row + 1)) + column;
+				vertex.topRight		= (stride * (row + 1)) + (column + 1);
+
+				//--- First Triangle
+				outIndices.push_back(vertex.topRight);
+				outIndices.push_back(vertex.topLeft);
+				outIndices.push_back(vertex.bottomLeft);
+
+				//--- Second Triangle
+				outIndices.push_back(vertex.bottomLeft);
+				outIndices.push_back(vertex.bottomRight);
+				outIndices.push_back(vertex.topRight);
+			}
+		}
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that moves the bounds of every node in to world space, if the terrain's transform has changed
+*******************************************************************************************************************/
+void TerrainQuadtree::Update(const glm::mat4& world)
+{
+	if (world == m_world) { return; }
+
+	m_world = world;
+
+	//--- A transformed box is bounded by a box with the same (transformed) centre, 
+	//--- and a half size made from the absolute values of the transform's rotation and scale
+	glm::mat3 extent = glm::mat3(world);
+
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) { extent[column][row] = std::abs(extent[column][row]); }
+	}
+
+	for (Node& node : m_nodes) {
+		node.centre			= glm::vec3(world * glm::vec4((node.minimum + node.maximum) * 0.5f, 1.0f));
+		node.halfDimension	= extent * ((node.maximum - node.minimum) * 0.5f);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds every chunk inside the frustum. Chunks are returned in the same order as their index data
+*******************************************************************************************************************/
+void TerrainQuadtree::Cull(Frustum& frustum, std::vector<unsigned int>& outChunks) const
+{
+	outChunks.clear();
+
+	if (!m_nodes.empty()) { CullNode(0, frustum, outChunks); }
+}
+
+
+/*******************************************************************************************************************
+	Replaces the quadtree with nodes and chunks that were built earlier (read back from a terrain cache, for example)
+*******************************************************************************************************************/
+void TerrainQuadtree::Restore(const Node* nodes, unsigned int nodeCount, const Chunk* chunks, unsigned int chunkCount)
+{
+	m_nodes.assign(nodes, nodes + nodeCount);
+	m_chunks.assign(chunks, chunks + chunkCount);
+
+	//--- The saved world bounds belong to whatever transform they were saved with, so recalculate them on the next Update
+	m_world = glm::mat4(0.0f);
+}
+
+
+/*******************************************************************************************************************
+	Function that tests a node against the frustum, and then its children if it is inside
+*******************************************************************************************************************/
+void TerrainQuadtree::CullNode(unsigned int node, Frustum& frustum, std::vector<unsigned int>& outChunks) const
+{
+	const Node& current = m_nodes[node];
+
+	if (!frustum.IsRectangleInside(current.centre, current.halfDimension)) { return; }
+
+	//--- Leaves store their chunk, other nodes store how many children they have
+	if (!current.firstChild) { outChunks.push_back(current.chunk); return; }
+
+	for (unsigned int child = 0; child < current.chunk; child++) { CullNode(current.firstChild + child, frustum, outChunks); }
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const TerrainQuadtree::Chunk& TerrainQuadtree::GetChunk(unsigned int chunk) const	{ return m_chunks[chunk]; }
+unsigned int TerrainQuadtree::GetChunkCount() const								{ return (unsigned int)m_chunks.size(); }
+const std::vector<TerrainQuadtree::Node>& TerrainQuadtree::GetNodes() const		{ return m_nodes; }
+const std::vector<TerrainQuadtree::Chunk>& TerrainQuadtree::GetChunks() const	{ return m_chunks; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const int TerrainQuadtree::s_chunkSize	= 32;
+const int TerrainQuadtree::s_bandWidth	= 6;
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainQuadtree.h, TerrainQuadtree.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Splits the terrain grid in to square chunks and organises them in a quadtree, so that only the chunks inside the
+	viewing frustum are drawn.
+
+	[Features]
+	Each chunk's indices are contiguous in the terrain's index buffer, and chunks are stored in quadtree order, so
+	neighbouring visible chunks can be drawn together in one call.
+	Every node has a bounding box made from the real minimum and maximum heights underneath it, so flat chunks are
+	culled tightly. If a node is outside the frustum, none of the chunks under it are tested.
+	World space bounds are only recalculated when the terrain's transform changes.
+	A built quadtree can be saved and restored as it is, with no rebuilding (see TerrainCache.h).
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	The quadtree only decides which parts of the index buffer to draw - the vertex buffer is still one shared grid.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include "VertexBuffer.h"
+#include "Frustum.h"
+
+class TerrainQuadtree {
+
+public:
+	struct Chunk {
+		unsigned int	indexOffset;
+		unsigned int	indexCount;
+		glm::vec3		minimum, maximum;
+	};
+
+	struct Node {
+		glm::vec3		minimum, maximum;
+		glm::vec3		centre, halfDimension;
+		unsigned int	firstChild;
+		unsigned int	chunk;
+	};
+
+public:
+	TerrainQuadtree();
+	~TerrainQuadtree();
+
+public:
+	void Build(const std::vector<VertexBuffer::PackedVertex>& vertices, int width, int height, std::vector<unsigned int>& outIndices);
+	void Update(const glm::mat4& world);
+	void Cull(Frustum& frustum, std::vector<unsigned int>& outChunks) const;
+	void Restore(const Node* nodes, unsigned int nodeCount, const Chunk* chunks, unsigned int chunkCount);
+
+public:
+	const Chunk&	GetChunk(unsigned int chunk) const;
+	unsigned int	GetChunkCount() const;
+	const std::vector<Node>&	GetNodes() const;
+	const std::vector<Chunk>&	GetChunks() const;
+
+public:
+	static void GenerateIndices(int firstColumn, int lastColumn, int firstRow, int lastRow, int stride, std::vector<unsigned int>& outIndices);
+
+private:
+	void BuildNode(unsigned int node, const std::vector<VertexBuffer::PackedVertex>& vertices, int stride, int firstColumn, int lastColumn,
+				   int firstRow, int lastRow, std::vector<unsigned int>& outIndices);
+	void CullNode(unsigned int node, Frustum& frustum, std::vector<unsigned int>& outChunks) const;
+
+private:
+	std::vector<Node>	m_nodes;
+	std::vector<Chunk>	m_chunks;
+	glm::mat4			m_world;
+
+private:
+	static const int s_chunkSize;
+	static const int s_bandWidth;
+};
\ No newline at end of file
@@ -0,0 +1,516 @@
+#include "stb_image.h"
+
+#include <algorithm>
+#include "TerrainStreamer.h"
+#include "TerrainGenerator.h"
+#include "ResourceManager.h"
+#include "VirtualFile.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+TerrainStreamer::TerrainStreamer(const std::string& tag, const Settings& settings)
+	:	m_tag(tag),
+		m_settings(settings),
+		m_level(0.0f),
+		m_tileLength(std::max(settings.tileSize - 1, 1)),
+		m_tileBytes(0),
+		m_frame(0),
+		m_world(0.0f),
+		m_coarseWidth(0),
+		m_coarseHeight(0)
+{
+	if (m_settings.radius <= 0.0f)	{ m_settings.radius = s_defaultRadius; }
+	if (m_settings.budget == 0)		{ m_settings.budget = s_defaultBudget; }
+
+	//--- Roughly what one tile costs once it's loaded - its heights, vertices, indices and height pyramid
+	//--- (a lowest and highest height per square, plus a third again for the levels above)
+	size_t points	= (size_t)m_settings.tileSize * m_settings.tileSize;
+	size_t squares	= (size_t)m_tileLength * m_tileLength;
+
+	m_tileBytes = points * (sizeof(float) + sizeof(VertexBuffer::PackedVertex)) + squares * 6 * sizeof(unsigned int) + squares * 8 / 3 * sizeof(float);
+}
+
+
+/*******************************************************************************************************************
+	Destructor - removes the buffers of every loaded tile. Tiles still loading are marked as discarded,
+	so that when their load finishes nothing is made for them
+*******************************************************************************************************************/
+TerrainStreamer::~TerrainStreamer()
+{
+	for (auto& tile : m_tiles) {
+		if (tile->state == TILE_RESIDENT) { UnloadTile(*tile); }
+		tile->isDiscarded = true;
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that loads the overview heightmap (the coarse heights of the whole world) and sets up the grid of tiles.
+	No tiles are loaded until the first Update
+*******************************************************************************************************************/
+bool TerrainStreamer::Load(const std::string& heightmap, float level, const std::shared_ptr<const TerrainNoise>& noise)
+{
+	if (m_settings.tilesX <= 0 || m_settings.tilesZ <= 0 || m_settings.tileSize < 2) {
+		FL_LOG("[TERRAIN] Terrain tile settings are not valid: ", m_tag.c_str(), LOG_ERROR);
+		return false;
+	}
+
+	m_heightmap	= heightmap;
+	m_level		= level;
+	m_noise		= noise;
+
+	//--- stb_image's flip setting is shared by every thread, so set it here before any tile is decoded on a worker
+	stbi_set_flip_vertically_on_load(true);
+
+	//--- A procedural terrain doesn't need an overview, its heights can be worked out anywhere
+	if (!m_noise) {
+
+		std::string fileLocation = "Assets\\Terrain\\" + heightmap;
+
+		VirtualFile file;
+
+		if (!file.Open(fileLocation) || !DecodeHeights(file.GetData(), file.GetSize(), level, m_coarseWidth, m_coarseHeight, m_coarse)) {
+			FL_LOG("[TERRAIN] No overview heightmap, the ground is flat until each tile loads: ", fileLocation.c_str(), LOG_WARN);
+		}
+	}
+
+	m_tiles.clear();
+	m_tiles.reserve((size_t)m_settings.tilesX * m_settings.tilesZ);
+
+	for (int z = 0; z < m_settings.tilesZ; z++) {
+		for (int x = 0; x < m_settings.tilesX; x++) {
+			std::string tileTag = m_tag + ".tile." + std::to_string(x) + "." + std::to_string(z);
+			m_tiles.push_back(std::make_shared<Tile>(Tile{ x, z, tileTag, TILE_UNLOADED, false, Transform(glm::vec3(0.0f)),
+														   std::vector<float>(), TerrainQuadtree(), TerrainPyramid(), 0, 0, 0.0f }));
+		}
+	}
+
+	FL_LOG("[TERRAIN] Terrain streaming set up, tiles: ", m_tiles.size(), LOG_SUCCESS);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that decides which tiles should be loaded around the focus point (a position on the grid, in columns
+	and rows), starts loading the most wanted ones and unloads the least recently used ones if we're over budget
+*******************************************************************************************************************/
+void TerrainStreamer::Update(const Transform& transform, const glm::vec2& focus, const glm::vec2& heading)
+{
+	m_frame++;
+
+	//--- Every tile is drawn with the terrain's transform, moved along to where the tile starts on the grid
+	if (transform.GetTransformationMatrix() != m_world) {
+
+		m_world = transform.GetTransformationMatrix();
+
+		for (auto& tile : m_tiles) {
+			glm::vec3 origin = glm::vec3(m_world * glm::vec4((float)(tile->x * m_tileLength), 0.0f, (float)(tile->z * m_tileLength), 1.0f));
+			tile->transform = Transform(origin, glm::degrees(transform.GetRotation()), transform.GetScale());
+		}
+	}
+
+	Rank(focus, heading, m_wanted);
+
+	unsigned int loadingTiles = 0;
+
+	for (auto& tile : m_tiles) { if (tile->state == TILE_LOADING) { loadingTiles++; } }
+
+	//--- Only a few tiles are loaded at once, so the tiles are re-ranked as the player moves, rather than
+	//--- a long queue of tiles being loaded for somewhere the player has already left
+	for (Tile* tile : m_wanted) {
+
+		if (loadingTiles >= s_maxLoadingTiles) { break; }
+
+		if (tile->state == TILE_UNLOADED) {
+			LoadTile(m_tiles[(size_t)tile->z * m_settings.tilesX + tile->x]);
+			loadingTiles++;
+		}
+	}
+
+	//--- Unload the least recently used tiles until we're back under budget (tiles still loading count at their
+	//--- estimated size). Tiles wanted this frame are never unloaded
+	size_t usedBytes = GetResidentBytes() + loadingTiles * m_tileBytes;
+
+	while (usedBytes > m_settings.budget) {
+
+		Tile* oldest = nullptr;
+
+		for (auto& tile : m_tiles) {
+			if (tile->state == TILE_RESIDENT && tile->lastUsed != m_frame && (!oldest || tile->lastUsed < oldest->lastUsed)) {
+				oldest = tile.get();
+			}
+		}
+
+		if (!oldest) { break; }
+
+		usedBytes -= oldest->bytes;
+		UnloadTile(*oldest);
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the tiles within range of the focus point, sorted so the most wanted tile comes first.
+	Tiles are ranked by their distance (in tiles) from the focus point, shortened for tiles in the direction
+	the player is heading. Only as many tiles as fit in the memory budget are wanted
+*******************************************************************************************************************/
+void TerrainStreamer::Rank(const glm::vec2& focus, const glm::vec2& heading, std::vector<Tile*>& outWanted)
+{
+	outWanted.clear();
+
+	glm::vec2 halfTile = glm::vec2(m_tileLength * 0.5f);
+
+	for (auto& tile : m_tiles) {
+
+		if (tile->state == TILE_MISSING) { continue; }
+
+		glm::vec2 toTile = (glm::vec2((float)tile->x, (float)tile->z) + 0.5f) * (float)m_tileLength - focus;
+
+		//--- The distance to the nearest edge of the tile, so the tile being stood on is always 0
+		float distance = glm::length(glm::max(glm::abs(toTile) - halfTile, glm::vec2(0.0f))) / m_tileLength;
+
+		if (distance > m_settings.radius) { continue; }
+
+		float facing = (glm::length(toTile) > 0.0f) ? glm::dot(glm::normalize(toTile), heading) : 0.0f;
+
+		//--- Tiles ahead of the player count as closer than they are, the tile being stood on still comes first
+		tile->priority = distance * (1.0f - s_headingBias * std::max(facing, 0.0f));
+		outWanted.push_back(tile.get());
+	}
+
+	std::sort(outWanted.begin(), outWanted.end(), [](const Tile* first, const Tile* second) { return first->priority < second->priority; });
+
+	//--- Always want at least the first tile, even if the budget is smaller than one tile
+	size_t count = std::min(outWanted.size(), std::max(m_settings.budget / m_tileBytes, (size_t)1));
+	outWanted.resize(count);
+
+	for (Tile* tile : outWanted) { tile->lastUsed = m_frame; }
+}
+
+
+/*******************************************************************************************************************
+	Function that starts loading a tile. The tile is read (or generated) on a worker, and its buffers are made on the
+	main thread as part of the resource manager's uploads. The tile itself is shared with the upload, so if the
+	streamer is destroyed first the upload can see that the tile was discarded
+*******************************************************************************************************************/
+void TerrainStreamer::LoadTile(const std::shared_ptr<Tile>& tile)
+{
+	tile->state = TILE_LOADING;
+
+	std::string fileLocation	= GetTileLocation(tile->x, tile->z);
+	std::string cacheLocation	= fileLocation + ".cogterrain";
+	float level					= m_level;
+	int size					= m_settings.tileSize;
+
+	//--- A procedural tile is generated from the noise where the tile starts on the grid
+	if (m_noise) {
+
+		std::shared_ptr<const TerrainNoise> noise = m_noise;
+
+		int originX = tile->x * m_tileLength;
+		int originZ = tile->z * m_tileLength;
+
+		Resource::Instance()->LoadAsync<TileData>(
+
+			[noise, originX, originZ, level, size](TileData& data) {
+				data.isLoaded = GenerateTile(*noise, originX, originZ, level, size, data);
+				return true;
+			},
+
+			[tile](TileData& data) { UploadTile(*tile, data); });
+
+		return;
+	}
+
+	Resource::Instance()->LoadAsync<TileData>(
+
+		//--- Always go on to the upload, so the tile finds out if it couldn't be loaded
+		[fileLocation, cacheLocation, level, size](TileData& data) {
+			data.isLoaded = ReadTile(fileLocation, cacheLocation, level, size, data);
+			return true;
+		},
+
+		[tile](TileData& data) { UploadTile(*tile, data); });
+}
+
+
+/*******************************************************************************************************************
+	Function that removes a tile's buffers and frees its heights
+*******************************************************************************************************************/
+void TerrainStreamer::UnloadTile(Tile& tile)
+{
+	Resource::Instance()->RemovePackedBuffers(tile.tag);
+
+	std::vector<float>().swap(tile.heights);
+
+	tile.quadtree	= TerrainQuadtree();
+	tile.pyramid	= TerrainPyramid();
+	tile.bytes		= 0;
+	tile.state		= TILE_UNLOADED;
+}
+
+
+/*******************************************************************************************************************
+	Function that returns the height at a point on the grid (in columns and rows) from the tile underneath,
+	or from the overview heightmap if that tile isn't loaded
+*******************************************************************************************************************/
+float TerrainStreamer::GetHeight(float x, float z) const
+{
+	int tileX = std::min(std::max((int)(x / m_tileLength), 0), m_settings.tilesX - 1);
+	int tileZ = std::min(std::max((int)(z / m_tileLength), 0), m_settings.tilesZ - 1);
+
+	const Tile& tile	= *m_tiles[(size_t)tileZ * m_settings.tilesX + tileX];
+	float height		= 0.0f;
+
+	if (tile.state == TILE_RESIDENT && terrain_generator::SampleHeight(tile.heights.data(), m_settings.tileSize, m_settings.tileSize,
+																		x - (float)(tileX * m_tileLength), z - (float)(tileZ * m_tileLength), height)) {
+		return height;
+	}
+
+	//--- A procedural terrain works the height out exactly, otherwise the overview covers the whole world, however many pixels it has
+	if (m_noise) { return m_noise->GetHeight(x, z, m_level); }
+
+	if (!m_coarse.empty()) {
+		float scaleX = (float)(m_coarseWidth - 1) / (float)(GetGridWidth() - 1);
+		float scaleZ = (float)(m_coarseHeight - 1) / (float)(GetGridHeight() - 1);
+
+		terrain_generator::SampleHeight(m_coarse.data(), m_coarseWidth, m_coarseHeight, x * scaleX, z * scaleZ, height);
+	}
+
+	return height;
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if a point on the grid (in columns and rows) is on the terrain
+*******************************************************************************************************************/
+bool TerrainStreamer::IsInside(float x, float z) const
+{
+	return x >= 0.0f && z >= 0.0f && x < (float)(GetGridWidth() - 1) && z < (float)(GetGridHeight() - 1);
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the first point a ray (on the grid, in columns and rows) hits the ground of a loaded tile.
+	Each tile's pyramid only covers its own squares, so the nearest hit over every loaded tile is the first one
+*******************************************************************************************************************/
+bool TerrainStreamer::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const
+{
+	bool isHit = false;
+
+	for (auto& tile : m_tiles) {
+
+		if (tile->state != TILE_RESIDENT) { continue; }
+
+		float distance	= 0.0f;
+		glm::vec3 start	= glm::vec3((float)(tile->x * m_tileLength), 0.0f, (float)(tile->z * m_tileLength));
+
+		//--- A hit any further than one we already have can't be the first
+		if (tile->pyramid.Raycast(origin - start, direction, isHit ? outDistance : maxDistance, distance)) {
+			outDistance	= distance;
+			isHit		= true;
+		}
+	}
+
+	return isHit;
+}
+
+
+/*******************************************************************************************************************
+	Function that checks if the ground of any loaded tile is in the way between two points on the grid (line of sight)
+*******************************************************************************************************************/
+bool TerrainStreamer::IsVisible(const glm::vec3& from, const glm::vec3& to) const
+{
+	for (auto& tile : m_tiles) {
+
+		if (tile->state != TILE_RESIDENT) { continue; }
+
+		glm::vec3 start = glm::vec3((float)(tile->x * m_tileLength), 0.0f, (float)(tile->z * m_tileLength));
+
+		if (!tile->pyramid.IsVisible(from - start, to - start)) { return false; }
+	}
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that adds the ground of every loaded tile to a horizon, for culling what is hidden behind it
+*******************************************************************************************************************/
+void TerrainStreamer::AddOccluders(TerrainHorizon& horizon) const
+{
+	for (auto& tile : m_tiles) {
+
+		if (tile->state != TILE_RESIDENT) { continue; }
+
+		horizon.AddOccluders(tile->pyramid, glm::vec2((float)(tile->x * m_tileLength), (float)(tile->z * m_tileLength)));
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that returns the file location of a tile - world.png is made of world_0_0.png, world_1_0.png, etc.
+*******************************************************************************************************************/
+std::string TerrainStreamer::GetTileLocation(int x, int z) const
+{
+	size_t extension	= m_heightmap.find_last_of('.');
+	std::string name	= m_heightmap.substr(0, extension);
+	std::string suffix	= (extension != std::string::npos) ? m_heightmap.substr(extension) : "";
+
+	return "Assets\\Terrain\\" + name + "_" + std::to_string(x) + "_" + std::to_string(z) + suffix;
+}
+
+
+/*******************************************************************************************************************
+	Function that reads a tile (runs on a worker). The tile comes from its cache if it has one, otherwise it's decoded
+	and generated, and the cache is written for next time
+*******************************************************************************************************************/
+bool TerrainStreamer::ReadTile(const std::string& fileLocation, const std::string& cacheLocation, float level, int size, TileData& outData)
+{
+	VirtualFile file;
+
+	if (!file.Open(fileLocation)) {
+		FL_LOG("[TERRAIN] Terrain tile is missing, using the overview heights: ", fileLocation.c_str(), LOG_WARN);
+		return false;
+	}
+
+	unsigned long long key = TerrainCache::GenerateKey(file.GetData(), file.GetSize(), level, false);
+
+	if (outData.cache.Open(cacheLocation, key)) {
+
+		if (outData.cache.GetVertexCount() > 0 && outData.cache.GetWidth() == size && outData.cache.GetHeight() == size) {
+			outData.heights.assign(outData.cache.GetHeights(), outData.cache.GetHeights() + (size_t)size * size);
+			outData.quadtree.Restore(outData.cache.GetNodes(), outData.cache.GetNodeCount(), outData.cache.GetChunks(), outData.cache.GetChunkCount());
+			outData.pyramid.Build(outData.heights.data(), size, size);
+			return true;
+		}
+
+		outData.cache.Close();
+	}
+
+	int width	= 0;
+	int height	= 0;
+
+	if (!DecodeHeights(file.GetData(), file.GetSize(), level, width, height, outData.heights)) {
+		FL_LOG("[TERRAIN] Problem loading terrain tile: ", fileLocation.c_str(), LOG_ERROR);
+		return false;
+	}
+
+	//--- Every tile must be the same size, or the tiles wouldn't line up
+	if (width != size || height != size) {
+		FL_LOG("[TERRAIN] Terrain tile is the wrong size: ", fileLocation.c_str(), LOG_ERROR);
+		return false;
+	}
+
+	terrain_generator::GenerateVertices(outData.heights.data(), size, size, outData.vertices);
+	outData.quadtree.Build(outData.vertices, size, size, outData.indices);
+
+	TerrainCache::Write(cacheLocation, key, size, size, level, outData.heights.data(), outData.vertices, outData.indices, outData.quadtree);
+
+	//--- The pyramid points at the heights, which keep the same memory when they're moved over to the tile
+	outData.pyramid.Build(outData.heights.data(), size, size);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that generates a procedural tile from noise (runs on a worker). A tile only takes a few milliseconds
+	to generate, so procedural tiles are never cached and nothing is written to disk
+*******************************************************************************************************************/
+bool TerrainStreamer::GenerateTile(const TerrainNoise& noise, int originX, int originZ, float level, int size, TileData& outData)
+{
+	noise.Generate(originX, originZ, size, size, level, outData.heights);
+
+	terrain_generator::GenerateVertices(outData.heights.data(), size, size, outData.vertices);
+	outData.quadtree.Build(outData.vertices, size, size, outData.indices);
+	outData.pyramid.Build(outData.heights.data(), size, size);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that makes a loaded tile's buffers and hands its heights and quadtree over to the tile (runs on the main thread).
+	A tile read from its cache is pushed straight from the mapped file
+*******************************************************************************************************************/
+void TerrainStreamer::UploadTile(Tile& tile, TileData& data)
+{
+	if (tile.isDiscarded) { return; }
+
+	if (!data.isLoaded) { tile.state = TILE_MISSING; return; }
+
+	bool isCached = data.vertices.empty();
+
+	const VertexBuffer::PackedVertex* vertices	= isCached ? data.cache.GetVertices() : data.vertices.data();
+	const unsigned int* indices					= isCached ? data.cache.GetIndices() : data.indices.data();
+	unsigned int vertexCount					= isCached ? data.cache.GetVertexCount() : (unsigned int)data.vertices.size();
+	unsigned int indexCount						= isCached ? data.cache.GetIndexCount() : (unsigned int)data.indices.size();
+
+	Resource::Instance()->AddPackedBuffers(tile.tag, true);
+
+	Resource::Instance()->GetVAO(tile.tag)->Bind();
+		Resource::Instance()->GetPackedVBO(tile.tag)->Push(vertices, vertexCount, false);
+		Resource::Instance()->GetEBO(tile.tag)->Push(indices, indexCount);
+	Resource::Instance()->GetVAO(tile.tag)->Unbind();
+
+	tile.heights	= std::move(data.heights);
+	tile.quadtree	= std::move(data.quadtree);
+	tile.pyramid	= std::move(data.pyramid);
+	tile.bytes		= vertexCount * sizeof(VertexBuffer::PackedVertex) + indexCount * sizeof(unsigned int) + tile.heights.size() * sizeof(float) +
+					  tile.pyramid.GetBytes();
+	tile.state		= TILE_RESIDENT;
+}
+
+
+/*******************************************************************************************************************
+	Function that decodes a grayscale heightmap image in to leveled heights (see Terrain::GenerateHeightMap)
+*******************************************************************************************************************/
+bool TerrainStreamer::DecodeHeights(const char* data, size_t size, float level, int& outWidth, int& outHeight, std::vector<float>& outHeights)
+{
+	const int RGB = 3;
+
+	int bytesPerPixel			= RGB;
+	unsigned char* imageData	= stbi_load_from_memory((const stbi_uc*)data, (int)size, &outWidth, &outHeight, &bytesPerPixel, RGB);
+
+	if (!imageData) { return false; }
+
+	terrain_generator::ConvertHeights(imageData, RGB, outWidth, outHeight, level, outHeights);
+
+	stbi_image_free(imageData);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that adds up the memory used by every loaded tile
+*******************************************************************************************************************/
+size_t TerrainStreamer::GetResidentBytes() const
+{
+	size_t bytes = 0;
+
+	for (auto& tile : m_tiles) { bytes += tile->bytes; }
+
+	return bytes;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const std::vector<std::shared_ptr<TerrainStreamer::Tile>>& TerrainStreamer::GetTiles() const	{ return m_tiles; }
+int TerrainStreamer::GetGridWidth() const														{ return m_settings.tilesX * m_tileLength + 1; }
+int TerrainStreamer::GetGridHeight() const														{ return m_settings.tilesZ * m_tileLength + 1; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const unsigned int TerrainStreamer::s_maxLoadingTiles	= 2;
+const float TerrainStreamer::s_headingBias				= 0.75f;
+const float TerrainStreamer::s_defaultRadius			= 1.5f;
+const size_t TerrainStreamer::s_defaultBudget			= 256 * 1024 * 1024;
\ No newline at end of file
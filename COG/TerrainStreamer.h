@@ -0,0 +1,148 @@
+#pragma once
+
+/*******************************************************************************************************************
+	TerrainStreamer.h, TerrainStreamer.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Builds a terrain out of a grid of heightmap tiles, and pages the tiles in and out around a focus point (the player)
+	so the world can be far bigger than what fits in memory.
+
+	[Features]
+	Tiles are named after the terrain's heightmap - world.png is made of world_0_0.png, world_1_0.png and so on, and
+	neighbouring tiles share their edge row/column of pixels, so tiles of 257x257 pixels are 256 grid squares apart.
+	The heightmap itself is a small overview of the whole world, kept in memory the whole time, so collision always has
+	coarse heights to fall back on while the tile underneath is still loading (or missing).
+	Tiles are loaded on the worker threads, through the terrain cache (see TerrainCache.h), so a tile is only ever
+	decoded and generated once. The buffers are made on the main thread a few at a time as part of the resource
+	manager's upload budget (see ResourceManager::LoadAsync), so crossing in to a new tile never stalls a frame.
+	Every update, the tiles within range are ranked by their distance from the focus point, with tiles in the direction
+	the player is heading brought forward, and only a couple are loaded at once, so the most useful tile is always next.
+	Tiles are unloaded least recently used first, once the memory used goes over the budget.
+	Every loaded tile has its own height pyramid (see TerrainPyramid.h), so rays and line of sight checks are tested
+	against the full resolution ground wherever the player is.
+
+	A procedural terrain (see TerrainNoise.h) generates its tiles from noise on the workers instead, with no files
+	and no cache, and while a tile loads its heights come straight from the noise.
+
+	[Upcoming]
+	Blend map tiles. Tiles use the terrain's textures for now, as textures can't be unloaded from the texture cache.
+
+	[Side Notes]
+	Each tile works out its normals on its own, so lighting can show a faint seam along tile edges.
+	A streamed terrain is always drawn in chunks, there's no LOD mode.
+	Tiles are only added and removed in Update, so GetHeight, Raycast and IsVisible must not be called from another
+	thread at the same time.
+	Rays pass straight over tiles that aren't loaded - the overview heights are only used for GetHeight.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include "Transform.h"
+#include "TerrainQuadtree.h"
+#include "TerrainCache.h"
+#include "TerrainPyramid.h"
+#include "TerrainNoise.h"
+#include "TerrainHorizon.h"
+
+class TerrainStreamer {
+
+public:
+	struct Settings {
+		int		tilesX, tilesZ;
+		int		tileSize;
+		float	radius;
+		size_t	budget;
+	};
+
+	enum TileState { TILE_UNLOADED, TILE_LOADING, TILE_RESIDENT, TILE_MISSING };
+
+	struct Tile {
+		int					x, z;
+		std::string			tag;
+		TileState			state;
+		bool				isDiscarded;
+		Transform			transform;
+		std::vector<float>	heights;
+		TerrainQuadtree		quadtree;
+		TerrainPyramid		pyramid;
+		size_t				bytes;
+		unsigned long long	lastUsed;
+		float				priority;
+	};
+
+private:
+	struct TileData {
+		bool									isLoaded;
+		TerrainCache							cache;
+		std::vector<float>						heights;
+		std::vector<VertexBuffer::PackedVertex>	vertices;
+		std::vector<unsigned int>				indices;
+		TerrainQuadtree							quadtree;
+		TerrainPyramid							pyramid;
+	};
+
+public:
+	TerrainStreamer(const std::string& tag, const Settings& settings);
+	~TerrainStreamer();
+
+public:
+	bool Load(const std::string& heightmap, float level, const std::shared_ptr<const TerrainNoise>& noise = nullptr);
+	void Update(const Transform& transform, const glm::vec2& focus, const glm::vec2& heading);
+
+public:
+	float GetHeight(float x, float z) const;
+	bool IsInside(float x, float z) const;
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& outDistance) const;
+	bool IsVisible(const glm::vec3& from, const glm::vec3& to) const;
+	void AddOccluders(TerrainHorizon& horizon) const;
+
+public:
+	const std::vector<std::shared_ptr<Tile>>&	GetTiles() const;
+	int											GetGridWidth() const;
+	int											GetGridHeight() const;
+	size_t										GetResidentBytes() const;
+
+private:
+	TerrainStreamer(const TerrainStreamer&)				= delete;
+	TerrainStreamer& operator=(const TerrainStreamer&)	= delete;
+
+private:
+	void Rank(const glm::vec2& focus, const glm::vec2& heading, std::vector<Tile*>& outWanted);
+	void LoadTile(const std::shared_ptr<Tile>& tile);
+	void UnloadTile(Tile& tile);
+	std::string GetTileLocation(int x, int z) const;
+
+private:
+	static bool ReadTile(const std::string& fileLocation, const std::string& cacheLocation, float level, int size, TileData& outData);
+	static bool GenerateTile(const TerrainNoise& noise, int originX, int originZ, float level, int size, TileData& outData);
+	static void UploadTile(Tile& tile, TileData& data);
+	static bool DecodeHeights(const char* data, size_t size, float level, int& outWidth, int& outHeight, std::vector<float>& outHeights);
+
+private:
+	std::string	m_tag;
+	Settings	m_settings;
+	std::string	m_heightmap;
+	float		m_level;
+	int			m_tileLength;
+	size_t		m_tileBytes;
+
+private:
+	std::vector<std::shared_ptr<Tile>>	m_tiles;
+	std::vector<Tile*>					m_wanted;
+	unsigned long long					m_frame;
+	glm::mat4							m_world;
+
+private:
+	std::vector<float>					m_coarse;
+	int									m_coarseWidth, m_coarseHeight;
+	std::shared_ptr<const TerrainNoise>	m_noise;
+
+private:
+	static const unsigned int	s_maxLoadingTiles;
+	static const float			s_headingBias;
+	static const float			s_defaultRadius;
+	static const size_t			s_defaultBudget;
+};
\ No newline at end of file
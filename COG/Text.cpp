@@ -8,6 +8,7 @@
 #include "ResourceManager.h"
 #include "TextShader.h"
 #include "Tools.h"
+#include "VirtualFile.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
@@ -53,9 +54,11 @@ bool Text::Load(unsigned int size)
 		return false;
 	}
 
-	//--- Load the font file, returns any number other than 0 on fail
+	//--- Load the font file, returns any number other than 0 on fail.
+	//--- FreeType reads the font from the file data while generating glyphs, so the file stays open until we're done
+	VirtualFile file;
 	FT_Face face = { 0 };
-	if (FT_New_Face(freeType, src.c_str(), 0, &face))
+	if (!file.Open(src) || FT_New_Memory_Face(freeType, (const FT_Byte*)file.GetData(), (FT_Long)file.GetSize(), 0, &face))
 	{
 		FL_LOG("[FONT] Failed to load font: ", src.c_str(), LOG_ERROR);
 		return false;
@@ -2,6 +2,7 @@
 #include "Log.h"
 #include "ResourceManager.h"
 #include "ScreenManager.h"
+#include "VirtualFile.h"
 
 /*******************************************************************************************************************
 	[Texture] Constructor with initializer list to set default values of data members
@@ -145,8 +146,29 @@ bool Texture::Load()
 
 	std::string src = "Assets\\Textures\\" + m_tag;
 
+	//--- Decode the image on a worker and upload it on the main thread when it's ready.
+	//--- The texture ID is generated now, so every copy of this texture (e.g. within a material) has it straight away.
+	//--- Until the upload has happened the texture is incomplete, which OpenGL samples as black
+	if (Resource::Instance()->IsAsyncLoading()) {
+
+		GenerateTexture();
+
+		GLuint id		= m_data.ID;
+		std::string tag	= m_tag;
+
+		Resource::Instance()->LoadAsync<std::shared_ptr<SDL_Surface>>(
+			[src](std::shared_ptr<SDL_Surface>& surface) {
+				surface.reset(Decode(src), SDL_FreeSurface);
+				if (!surface) { FL_LOG("[TEXTURE] Error loading texture file: ", src.c_str(), LOG_ERROR); return false; }
+				return true;
+			},
+			[tag, id, src](std::shared_ptr<SDL_Surface>& surface) { Upload(tag, id, surface.get(), src); });
+
+		return true;
+	}
+
 	//--- Load the texture and store it into our texture data variable
-	 SDL_Surface* textureData = IMG_Load(src.c_str());
+	SDL_Surface* textureData = Decode(src);
 
 	//--- If there was a problem loading discontinue and free the SDL surface before exiting out of the function (precautionary)
 	if (!textureData) { 
@@ -155,22 +177,45 @@ bool Texture::Load()
 		return false;
 	}
 
-	//--- Otherwise, generate OpenGL texture object, set the filters for the texture and add this new texture
+	//--- Otherwise, generate OpenGL texture object and add this new texture
 	//--- to the map of texture ID's, so we can bind it later
 	GenerateTexture();
 
+	m_width		= textureData->w;
+	m_height	= textureData->h;
+
+	Upload(m_tag, m_data.ID, textureData, src);
+
+	//--- Free (delete) the SDL surface we created, as OpenGL now has the data
+	SDL_FreeSurface(textureData);
+
+	//--- NOTE
+	// We need to make sure we generate the OpenGL texture ID after the file has been successfully loaded in
+	// Otherwise, we generate an OpenGL ID, which never get's bound and becomes useless and takes up memory.
+	//---
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that passes the pixels of a loaded texture file to an OpenGL texture object and sets its filters.
+	The size is kept by tag, as textures loaded asynchronously (or re-used from the cache) don't have it until now
+*******************************************************************************************************************/
+void Texture::Upload(const std::string& tag, GLuint id, SDL_Surface* textureData, const std::string& src)
+{
+	s_dimensions[tag] = glm::ivec2(textureData->w, textureData->h);
+
 	FL_LOG("[TEXTURE] Texture filters being set...", FL_LOG_EMPTY, LOG_MESSAGE);
 
 	//--- Similar to how a VAO works, bind the ID for use and then declare what filters we want set within this texture ID
-	Bind();
+	FL_GLCALL(glBindTexture(GL_TEXTURE_2D, id));
 	
 	unsigned char* pixels	= (unsigned char*)textureData->pixels;
 	unsigned int depth		= textureData->format->BytesPerPixel;
 	unsigned int format		= ((depth == 4) ? GL_RGBA : GL_RGB);
-	m_width					= textureData->w;
-	m_height				= textureData->h;
 
-	FL_GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format, GL_UNSIGNED_BYTE, pixels));
+	FL_GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, format, textureData->w, textureData->h, 0, format, GL_UNSIGNED_BYTE, pixels));
 
 	//--- Make sure we generate the mipmaps after we create the texture and before we set the filters below.
 	FL_GLCALL(glGenerateMipmap(GL_TEXTURE_2D));
@@ -191,20 +236,27 @@ bool Texture::Load()
 		FL_GLCALL(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, -1.0f));
 	}
 
-	//--- Free (delete) the SDL surface we created, as OpenGL now has the data
-	SDL_FreeSurface(textureData);
-
 	//--- Then unbind the texture ID, now the above data is stored in this ID
-	Unbind();
+	FL_GLCALL(glBindTexture(GL_TEXTURE_2D, 0));
 	
 	FL_LOG("[TEXTURE] Generated new texture: ", src.c_str(), LOG_RESOURCE);
+}
 
-	//--- NOTE
-	// We need to make sure we generate the OpenGL texture ID after the file has been successfully loaded in
-	// Otherwise, we generate an OpenGL ID, which never get's bound and becomes useless and takes up memory.
-	//---
 
-	return true;
+/*******************************************************************************************************************
+	Function that decodes an image file (from a pack, or from disk) in to an SDL surface, returning nullptr on failure
+*******************************************************************************************************************/
+SDL_Surface* Texture::Decode(const std::string& src)
+{
+	VirtualFile file;
+
+	if (!file.Open(src)) { return nullptr; }
+
+	//--- The extension is passed as a hint for formats that can't be detected from their contents (e.g. TGA)
+	size_t extension	= src.find_last_of('.');
+	std::string type	= (extension != std::string::npos) ? src.substr(extension + 1) : std::string();
+
+	return IMG_LoadTyped_RW(SDL_RWFromConstMem(file.GetData(), (int)file.GetSize()), 1, type.c_str());
 }
 
 
@@ -222,41 +274,81 @@ bool Texture::Load(const std::vector<std::string>& textures)
 		FL_LOG("[TEXTURE] Cube map texture ID already exists for tag: ", m_tag.c_str(), LOG_RESOURCE); return false;
 	}
 
-	bool initialized			= false;
-	SDL_Surface* textureData	= nullptr;
+	std::vector<std::string> sources;
 
-	for (unsigned int i = 0; i < textures.size(); i++) {
+	for (unsigned int i = 0; i < textures.size(); i++) { sources.emplace_back("Assets\\Textures\\Skybox\\" + textures[i] + ".png"); }
 
-		std::string src = "Assets\\Textures\\Skybox\\" + textures[i] + ".png";
+	//--- Decode every face on a worker and upload them all on the main thread when they're ready, the same as a 2D texture.
+	//--- Until the upload has happened the cube map is incomplete, which OpenGL samples as black
+	if (Resource::Instance()->IsAsyncLoading()) {
 
-		//--- Load the texture and store it into our texture data variable
-		textureData = IMG_Load(src.c_str());
+		GenerateTexture();
 
-		//--- If there was a problem loading discontinue and free the SDL surface before exiting out of the function (precautionary)
-		if (!textureData) { FL_LOG("[TEXTURE] Error loading cube map file: ", src.c_str(), LOG_ERROR); SDL_FreeSurface(textureData); return false; }
+		GLuint id		= m_data.ID;
+		std::string tag	= m_tag;
 
-		//--- If we haven't initialized a texture ID, generate just 1 texture ID for our cube map, and bind the cube map.
-		//--- Proceed to generate the texture data for each cube map face.
-		if (!initialized) {
-				 
-			GenerateTexture(); 
-			Bind();
-			initialized = true;
-		}
+		Resource::Instance()->LoadAsync<std::vector<std::shared_ptr<SDL_Surface>>>(
+			[sources](std::vector<std::shared_ptr<SDL_Surface>>& faces) { return DecodeCubeMap(sources, faces); },
+			[tag, id, sources](std::vector<std::shared_ptr<SDL_Surface>>& faces) { UploadCubeMap(tag, id, faces, sources); });
+
+		return true;
+	}
 
-		unsigned char* pixels	= (unsigned char*)textureData->pixels;
-		unsigned int depth		= textureData->format->BytesPerPixel;
+	std::vector<std::shared_ptr<SDL_Surface>> faces;
+
+	if (!DecodeCubeMap(sources, faces)) { return false; }
+
+	//--- Only generate the texture ID once every face has loaded, so a missing face doesn't leave an unused ID behind
+	GenerateTexture();
+
+	m_width		= faces.front()->w;
+	m_height	= faces.front()->h;
+
+	UploadCubeMap(m_tag, m_data.ID, faces, sources);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that decodes every face of a cube map, returning false if any of them couldn't be loaded.
+	No OpenGL calls are made here, so this is safe to run on a worker thread
+*******************************************************************************************************************/
+bool Texture::DecodeCubeMap(const std::vector<std::string>& sources, std::vector<std::shared_ptr<SDL_Surface>>& outFaces)
+{
+	for (const std::string& src : sources) {
+
+		std::shared_ptr<SDL_Surface> face(Decode(src), SDL_FreeSurface);
+
+		if (!face) { FL_LOG("[TEXTURE] Error loading cube map file: ", src.c_str(), LOG_ERROR); return false; }
+
+		outFaces.emplace_back(std::move(face));
+	}
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that passes the pixels of every decoded face to an OpenGL cube map and sets its filters.
+	The size is kept by tag, the same as a 2D texture
+*******************************************************************************************************************/
+void Texture::UploadCubeMap(const std::string& tag, GLuint id, const std::vector<std::shared_ptr<SDL_Surface>>& faces, const std::vector<std::string>& sources)
+{
+	s_dimensions[tag] = glm::ivec2(faces.front()->w, faces.front()->h);
+
+	FL_GLCALL(glBindTexture(GL_TEXTURE_CUBE_MAP, id));
+
+	for (unsigned int i = 0; i < faces.size(); i++) {
+
+		unsigned char* pixels	= (unsigned char*)faces[i]->pixels;
+		unsigned int depth		= faces[i]->format->BytesPerPixel;
 		unsigned int format		= ((depth == 4) ? GL_RGBA : GL_RGB);
-		m_width					= textureData->w;
-		m_height				= textureData->h;
 
 		//--- Pass the image data we obtained from SDL surface to OpenGL
-		FL_GLCALL(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, m_width, m_height, 0, format, GL_UNSIGNED_BYTE, pixels));
+		FL_GLCALL(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, faces[i]->w, faces[i]->h, 0, format, GL_UNSIGNED_BYTE, pixels));
 
-		//--- Free (delete) the SDL surface we created, as OpenGL now has the data
-		SDL_FreeSurface(textureData);
-			
-		FL_LOG("[TEXTURE] New cube map texture created: ", src.c_str(), LOG_RESOURCE);
+		FL_LOG("[TEXTURE] New cube map texture created: ", sources[i].c_str(), LOG_RESOURCE);
 	}
 
 	//--- Only done once per cube map, not to be done per cube map face
@@ -272,14 +364,7 @@ bool Texture::Load(const std::vector<std::string>& textures)
 	FL_GLCALL(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0));
 
 	//--- Unbind now OpenGL has all the texture data for our cube map
-	Unbind();
-	
-	//--- NOTE
-	// We need to make sure we generate the OpenGL texture ID after the file has been successfully loaded in
-	// Otherwise, we generate an OpenGL ID, which never get's bound and becomes useless and takes up memory.
-	//---
-
-	return true;
+	FL_GLCALL(glBindTexture(GL_TEXTURE_CUBE_MAP, 0));
 }
 
 
@@ -353,10 +438,21 @@ const glm::vec2& Texture::GetOffset() {
 /*******************************************************************************************************************
 	Accessor methods
 *******************************************************************************************************************/
-int Texture::GetWidth() const	{ return m_width; }
-int Texture::GetHeight() const	{ return m_height; }
 int Texture::GetRows() const	{ return m_rows; }
 
+int Texture::GetWidth() const
+{
+	//--- Until an asynchronous load has been uploaded this is 0, the same as a texture that failed to load
+	auto dimension = s_dimensions.find(m_tag);
+	return (m_width == 0 && dimension != s_dimensions.end()) ? dimension->second.x : m_width;
+}
+
+int Texture::GetHeight() const
+{
+	auto dimension = s_dimensions.find(m_tag);
+	return (m_height == 0 && dimension != s_dimensions.end()) ? dimension->second.y : m_height;
+}
+
 bool Texture::HasTransparency()	const	{ return m_hasTransparency; }
 bool Texture::HasFakeLighting()	const	{ return m_hasFakeLighting; }
 bool Texture::IsMirrored()	const 		{ return m_isMirrored; }
@@ -380,5 +476,6 @@ void Texture::SetTransparency(bool hasTransparency) { m_hasTransparency = hasTra
 *******************************************************************************************************************/
 unsigned int Texture::s_defaultIndex	= 0;
 unsigned int Texture::s_defaultRows		= 1;
+std::map<std::string, glm::ivec2> Texture::s_dimensions;
 
 unsigned int Texture::GetDefaultRows() { return s_defaultRows; }
\ No newline at end of file
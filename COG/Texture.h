@@ -3,7 +3,7 @@
 /*******************************************************************************************************************
 	Texture.h, Texture.cpp
 	Created by Kim Kane
-	Last updated: 21/03/2018
+	Last updated: 17/10/2026
 	Class finalized: 02/04/2018
 
 	Generates a 2D texture using the SDL library.
@@ -17,6 +17,8 @@
 	Texture atlases supported.
 	Texture mirroring supported.
 	Cube maps supported.
+	Supports asynchronous loading of 2D textures and cube maps (see ResourceManager.h) - images are decoded on a worker
+	thread, and their width and height are known once they've been uploaded.
 
 	[Upcoming]
 	Nothing at present.
@@ -30,6 +32,8 @@
 #include <SDL_image.h>
 #include <string>
 #include <vector>
+#include <memory>
+#include <map>
 
 class Texture {
 
@@ -83,6 +87,10 @@ private:
 
 private:
 	void GenerateTexture();
+	static void Upload(const std::string& tag, GLuint id, SDL_Surface* textureData, const std::string& src);
+	static SDL_Surface* Decode(const std::string& src);
+	static bool DecodeCubeMap(const std::vector<std::string>& sources, std::vector<std::shared_ptr<SDL_Surface>>& outFaces);
+	static void UploadCubeMap(const std::string& tag, GLuint id, const std::vector<std::shared_ptr<SDL_Surface>>& faces, const std::vector<std::string>& sources);
 
 private:
 	std::string			m_tag;
@@ -99,4 +107,5 @@ private:
 private:
 	static unsigned int s_defaultRows;
 	static unsigned int s_defaultIndex;
+	static std::map<std::string, glm::ivec2> s_dimensions;
 };
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor - creates one worker per hardware thread, leaving one for the main thread
+*******************************************************************************************************************/
+ThreadPool::ThreadPool()
+	:	m_isShutdown(false)
+{
+	unsigned int hardwareThreads	= std::thread::hardware_concurrency();
+	unsigned int workerCount		= (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+
+	m_workers.reserve(workerCount);
+
+	for (unsigned int i = 0; i < workerCount; i++) { m_workers.emplace_back(&ThreadPool::Work, this); }
+
+	FL_LOG("[THREAD POOL CONSTRUCT] Workers: ", workerCount, LOG_BREAK);
+}
+
+
+/*******************************************************************************************************************
+	Default destructor - makes sure all the workers have been joined
+*******************************************************************************************************************/
+ThreadPool::~ThreadPool()
+{
+	Shutdown();
+}
+
+
+/*******************************************************************************************************************
+	A function that finishes all queued work and joins the worker threads
+*******************************************************************************************************************/
+void ThreadPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_isShutdown) { return; }
+		m_isShutdown = true;
+	}
+
+	m_condition.notify_all();
+
+	for (auto& worker : m_workers) { if (worker.joinable()) { worker.join(); } }
+
+	m_workers.clear();
+
+	FL_LOG("[THREAD POOL SHUT DOWN]", FL_LOG_EMPTY, LOG_BREAK);
+}
+
+
+/*******************************************************************************************************************
+	The worker loop - sleeps until a task is queued, runs it, then goes back to sleep
+*******************************************************************************************************************/
+void ThreadPool::Work()
+{
+	while (true) {
+
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_condition.wait(lock, [this]() { return m_isShutdown || !m_tasks.empty(); });
+
+			//--- Only exit once the queue has been emptied, so no future is ever left unfulfilled
+			if (m_tasks.empty()) { return; }
+
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+
+/*******************************************************************************************************************
+	A function that runs one queued task on the calling thread, returns false if there was nothing to run
+*******************************************************************************************************************/
+bool ThreadPool::RunPendingTask()
+{
+	std::function<void()> task;
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_tasks.empty()) { return false; }
+
+		task = std::move(m_tasks.front());
+		m_tasks.pop_front();
+	}
+
+	task();
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+unsigned int ThreadPool::GetWorkerCount() const { return (unsigned int)m_workers.size(); }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+/*******************************************************************************************************************
+	ThreadPool.h, ThreadPool.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Singleton class that creates a pool of worker threads which CPU heavy work can be handed to.
+
+	[Features]
+	Enqueue any callable and get a std::future back for its result.
+	ParallelFor splits a range in to batches and runs them across all the workers (and the calling thread).
+	Threads waiting on work will help run queued tasks rather than sit idle, so ParallelFor can be
+	called from within a task without dead locking the pool.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	One worker is created per hardware thread, minus one for the main thread.
+	No OpenGL calls should ever be made from a worker - the OpenGL context only lives on the main thread.
+
+*******************************************************************************************************************/
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+
+#include "Singleton.h"
+
+class ThreadPool {
+
+public:
+	friend class Singleton<ThreadPool>;
+
+public:
+	~ThreadPool();
+
+public:
+	void Shutdown();
+
+public:
+	template <typename Function> auto Enqueue(Function&& function) -> std::future<decltype(function())>;
+	template <typename Function> void ParallelFor(size_t count, size_t minimumBatch, Function&& function);
+	template <typename T> void Wait(std::future<T>& future);
+
+public:
+	unsigned int GetWorkerCount() const;
+
+private:
+	ThreadPool();
+	ThreadPool(const ThreadPool&)				= delete;
+	ThreadPool& operator=(const ThreadPool&)	= delete;
+
+private:
+	void Work();
+	bool RunPendingTask();
+
+private:
+	std::vector<std::thread>			m_workers;
+	std::deque<std::function<void()>>	m_tasks;
+	std::mutex							m_lock;
+	std::condition_variable				m_condition;
+	bool								m_isShutdown;
+};
+
+typedef Singleton<ThreadPool> Workers;
+
+
+/*******************************************************************************************************************
+	A template function that queues a task for the workers and returns a future for its result
+*******************************************************************************************************************/
+template <typename Function> auto ThreadPool::Enqueue(Function&& function) -> std::future<decltype(function())>
+{
+	typedef decltype(function()) Result;
+
+	//--- std::function must be copyable, so the packaged task is shared
+	auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+
+	std::future<Result> result = task->get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		//--- If the pool has been shut down, just run the task here so the future is still fulfilled
+		if (m_isShutdown || m_workers.empty()) { (*task)(); return result; }
+
+		m_tasks.emplace_back([task]() { (*task)(); });
+	}
+
+	m_condition.notify_one();
+
+	return result;
+}
+
+
+/*******************************************************************************************************************
+	A template function that runs function(begin, end) over [0, count) in batches spread across the workers
+*******************************************************************************************************************/
+template <typename Function> void ThreadPool::ParallelFor(size_t count, size_t minimumBatch, Function&& function)
+{
+	if (count == 0) { return; }
+
+	//--- One batch per thread (including this one), but never smaller than the minimum batch size
+	size_t threads	= (size_t)GetWorkerCount() + 1;
+	size_t batch	= std::max(minimumBatch, (count + threads - 1) / threads);
+
+	if (batch >= count) { function((size_t)0, count); return; }
+
+	std::vector<std::future<void>> batches;
+	batches.reserve(count / batch + 1);
+
+	//--- Hand every batch but the first to the workers, then do the first one ourselves
+	for (size_t begin = batch; begin < count; begin += batch) {
+		size_t end = std::min(count, begin + batch);
+		batches.emplace_back(Enqueue([&function, begin, end]() { function(begin, end); }));
+	}
+
+	function((size_t)0, batch);
+
+	for (auto& future : batches) { Wait(future); }
+}
+
+
+/*******************************************************************************************************************
+	A template function that waits for a future, running queued tasks in the meantime
+*******************************************************************************************************************/
+template <typename T> void ThreadPool::Wait(std::future<T>& future)
+{
+	while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		if (!RunPendingTask()) { future.wait(); break; }
+	}
+}
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <cstring>
 #include "VertexBuffer.h"
 
 /*******************************************************************************************************************
@@ -53,9 +55,18 @@ void VertexBuffer::Render(GLenum mode) const
 	A function that pushes interleaved vertex data to the GPU (there is also a template rendition of this function)
 *******************************************************************************************************************/
 bool VertexBuffer::Push(const std::vector<PackedVertex>& data, bool dynamic)
+{
+	return Push((data.empty()) ? nullptr : &data.front(), data.size(), dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes interleaved vertex data to the GPU straight from memory (e.g. a memory mapped file)
+*******************************************************************************************************************/
+bool VertexBuffer::Push(const PackedVertex* data, size_t count, bool dynamic)
 {
 	//--- Make sure we have data before doing anything
-	if (data.empty()) {
+	if (!data || count == 0) {
 		FL_LOG("[BUFFER] Model vertex data vector container is empty", FL_LOG_EMPTY, LOG_ERROR); return false;
 	}
 
@@ -63,11 +74,11 @@ bool VertexBuffer::Push(const std::vector<PackedVertex>& data, bool dynamic)
 	Bind();
 
 	//--- Get the vertex count
-	m_vertexCount = data.size();
+	m_vertexCount = (unsigned int)count;
 
 	//--- Create the buffer store, passing in the total byte size of the data,
 	//--- the data itself and whether to draw in static/dynamic mode
-	FL_GLCALL(glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(PackedVertex), &data.front(), (dynamic)	? GL_DYNAMIC_DRAW
+	FL_GLCALL(glBufferData(GL_ARRAY_BUFFER, count * sizeof(PackedVertex), data, (dynamic)	? GL_DYNAMIC_DRAW
 																											: GL_STATIC_DRAW));
 
 	//--- Enable the vertex attribute pointers for the data, passing in the stride and the offset of each
@@ -88,15 +99,94 @@ bool VertexBuffer::Push(const std::vector<PackedVertex>& data, bool dynamic)
 
 
 /*******************************************************************************************************************
-	Function that defines an array of generic vertex attribute data & enables the layout location of the data
+	A function that pushes quantised vertex data to the GPU (see VertexCompressor.h)
+*******************************************************************************************************************/
+bool VertexBuffer::Push(const std::vector<CompactVertex>& data, bool dynamic)
+{
+	return Push((data.empty()) ? nullptr : &data.front(), data.size(), dynamic);
+}
+
+
+/*******************************************************************************************************************
+	A function that pushes quantised vertex data to the GPU straight from memory. Every attribute is converted back
+	to floats by the vertex fetch, so the same shaders work with both vertex formats
+*******************************************************************************************************************/
+bool VertexBuffer::Push(const CompactVertex* data, size_t count, bool dynamic)
+{
+	static_assert(sizeof(CompactVertex) == 24, "CompactVertex must be tightly packed");
+
+	//--- Make sure we have data before doing anything
+	if (!data || count == 0) {
+		FL_LOG("[BUFFER] Model vertex data vector container is empty", FL_LOG_EMPTY, LOG_ERROR); return false;
+	}
+
+	//--- Bind the VBO
+	Bind();
+
+	//--- Get the vertex count
+	m_vertexCount = (unsigned int)count;
+
+	FL_GLCALL(glBufferData(GL_ARRAY_BUFFER, count * sizeof(CompactVertex), data, (dynamic)	? GL_DYNAMIC_DRAW
+																											: GL_STATIC_DRAW));
+
+	//--- Positions are whole numbers (scaled back by the model's decode matrix), texture coordinates are half floats
+	//--- and the normal, tangent and bitangent are 10:10:10:2 signed normalized values
+	DefineAttributeData(LAYOUT_POSITION, sizeof(CompactVertex), offsetof(CompactVertex, position), GL_SHORT);
+	DefineAttributeData(LAYOUT_UV, sizeof(CompactVertex), offsetof(CompactVertex, textureCoord), GL_HALF_FLOAT);
+	DefineAttributeData(LAYOUT_NORMAL, sizeof(CompactVertex), offsetof(CompactVertex, normal), GL_INT_2_10_10_10_REV, true, 4);
+	DefineAttributeData(LAYOUT_TANGENT, sizeof(CompactVertex), offsetof(CompactVertex, tangent), GL_INT_2_10_10_10_REV, true, 4);
+	DefineAttributeData(LAYOUT_BITANGENT, sizeof(CompactVertex), offsetof(CompactVertex, bitangent), GL_INT_2_10_10_10_REV, true, 4);
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that defines an array of generic vertex attribute data & enables the layout location of the data.
+	Packed formats (e.g. GL_INT_2_10_10_10_REV) must pass an element count of 4, whatever the shader reads
 *******************************************************************************************************************/
-void VertexBuffer::DefineAttributeData(LayoutType layoutType, unsigned int stride, size_t offset, int dataType)
+void VertexBuffer::DefineAttributeData(LayoutType layoutType, unsigned int stride, size_t offset, int dataType, bool isNormalized, int elementCount)
 {
-	FL_GLCALL(glVertexAttribPointer(layoutType, s_bufferElements[layoutType], dataType, GL_FALSE, stride, (size_t*)offset));
+	if (elementCount == 0) { elementCount = s_bufferElements[layoutType]; }
+
+	FL_GLCALL(glVertexAttribPointer(layoutType, elementCount, dataType, (isNormalized) ? GL_TRUE : GL_FALSE, stride, (size_t*)offset));
 	FL_GLCALL(glEnableVertexAttribArray(layoutType));
 }
 
 
+/*******************************************************************************************************************
+	Hashes the raw bytes of a packed vertex (the same bytes operator== compares), one 32-bit word at a time
+*******************************************************************************************************************/
+size_t VertexBuffer::PackedVertex::Hash::operator()(const PackedVertex& vertex) const
+{
+	static_assert(sizeof(PackedVertex) % sizeof(uint32_t) == 0, "PackedVertex must be made up of 32-bit words");
+
+	uint32_t words[sizeof(PackedVertex) / sizeof(uint32_t)];
+	memcpy(words, &vertex, sizeof(PackedVertex));
+
+	//--- Murmur3 style mixing of each word, then a final avalanche so that nearby floats end up far apart
+	uint32_t hash = 0x9747b28c;
+
+	for (uint32_t word : words) {
+		word *= 0xcc9e2d51;
+		word = (word << 15) | (word >> 17);
+		word *= 0x1b873593;
+
+		hash ^= word;
+		hash = (hash << 13) | (hash >> 19);
+		hash = hash * 5 + 0xe6546b64;
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+
+	return (size_t)hash;
+}
+
+
 /*******************************************************************************************************************
 	Generate the buffer objects ID
 *******************************************************************************************************************/
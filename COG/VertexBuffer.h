@@ -11,6 +11,8 @@
 	[Features]
 	Supports an std::vector container of T data to send to the GPU, where T is templated data.
 	Also added support for common vertex data - See PackedVertex struct within this class.
+	Supports a quantised CompactVertex (24 bytes instead of PackedVertex's 56) that is decoded by the vertex fetch
+	hardware, so the shaders see exactly the same attributes - see VertexCompressor.h.
 	Ability to switch between render modes at run time and push dynamic/static data to the GPU.
 
 	[Upcoming]
@@ -64,6 +66,20 @@ public:
 		bool operator<(const PackedVertex that) const {
 			return memcmp((void*)this, (void*)&that, sizeof(PackedVertex))>0;
 		};
+		bool operator==(const PackedVertex& that) const {
+			return memcmp((void*)this, (void*)&that, sizeof(PackedVertex)) == 0;
+		};
+		struct Hash {
+			size_t operator()(const PackedVertex& vertex) const;
+		};
+	};
+
+	struct CompactVertex {
+		GLshort		position[4];
+		GLushort	textureCoord[2];
+		GLuint		normal;
+		GLuint		tangent;
+		GLuint		bitangent;
 	};
 
 public:
@@ -75,6 +91,9 @@ public:
 
 public:
 	bool Push(const std::vector<PackedVertex>& data, bool dynamic);
+	bool Push(const PackedVertex* data, size_t count, bool dynamic);
+	bool Push(const std::vector<CompactVertex>& data, bool dynamic);
+	bool Push(const CompactVertex* data, size_t count, bool dynamic);
 	
 public:
 	template <typename T> bool Push(const std::vector<T>& data, LayoutType layoutType, bool dynamic, int dataType = GL_FLOAT);
@@ -88,7 +107,8 @@ private:
 	void GenerateBufferObject();
 
 private:
-	void DefineAttributeData(LayoutType layoutType, unsigned int stride = 0, size_t offset = 0, int dataType = GL_FLOAT);
+	void DefineAttributeData(LayoutType layoutType, unsigned int stride = 0, size_t offset = 0, int dataType = GL_FLOAT,
+							 bool isNormalized = false, int elementCount = 0);
 
 private:
 	GLuint			m_vertexBufferObject;
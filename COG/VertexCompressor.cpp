@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "VertexCompressor.h"
+
+namespace vertex_compressor {
+
+	//--- Positions are scaled to -MAXIMUM_POSITION..MAXIMUM_POSITION, so rounding can never overflow a short
+	static const float MAXIMUM_POSITION = 32767.0f;
+
+	//--- The largest value a 10-bit signed normalized component can hold
+	static const float MAXIMUM_COMPONENT = 511.0f;
+
+
+	/*******************************************************************************************************************
+		Quantises the vertices and returns the matrix that turns the quantised positions back in to model space
+	*******************************************************************************************************************/
+	glm::mat4 CompressVertices(const VertexBuffer::PackedVertex* vertices, size_t count, std::vector<VertexBuffer::CompactVertex>& outVertices)
+	{
+		outVertices.clear();
+
+		if (!vertices || count == 0) { return glm::mat4(1.0f); }
+
+		//--- Centre the positions and use the same scale on every axis, so the decode matrix doesn't skew normals
+		glm::vec3 minimum = vertices[0].position, maximum = vertices[0].position;
+
+		for (size_t vertex = 0; vertex < count; vertex++) {
+			minimum = glm::min(minimum, vertices[vertex].position);
+			maximum = glm::max(maximum, vertices[vertex].position);
+		}
+
+		glm::vec3 centre	= (minimum + maximum) * 0.5f;
+		glm::vec3 extent	= (maximum - minimum) * 0.5f;
+		float scale			= std::max(extent.x, std::max(extent.y, extent.z)) / MAXIMUM_POSITION;
+
+		if (scale <= 0.0f) { scale = 1.0f; }
+
+		outVertices.resize(count);
+
+		for (size_t vertex = 0; vertex < count; vertex++) {
+
+			const VertexBuffer::PackedVertex& source	= vertices[vertex];
+			VertexBuffer::CompactVertex& compact		= outVertices[vertex];
+
+			glm::vec3 position = (source.position - centre) / scale;
+
+			compact.position[0]		= (GLshort)std::lround(glm::clamp(position.x, -MAXIMUM_POSITION, MAXIMUM_POSITION));
+			compact.position[1]		= (GLshort)std::lround(glm::clamp(position.y, -MAXIMUM_POSITION, MAXIMUM_POSITION));
+			compact.position[2]		= (GLshort)std::lround(glm::clamp(position.z, -MAXIMUM_POSITION, MAXIMUM_POSITION));
+			compact.position[3]		= 0;
+			compact.textureCoord[0]	= FloatToHalf(source.textureCoord.x);
+			compact.textureCoord[1]	= FloatToHalf(source.textureCoord.y);
+			compact.normal			= PackSignedNormalized(source.normal);
+			compact.tangent			= PackSignedNormalized(source.tangent);
+			compact.bitangent		= PackSignedNormalized(source.bitangent);
+		}
+
+		glm::mat4 decode(1.0f);
+		decode[0][0] = decode[1][1] = decode[2][2] = scale;
+		decode[3] = glm::vec4(centre, 1.0f);
+
+		return decode;
+	}
+
+
+	/*******************************************************************************************************************
+		Converts the indices to 16-bit, returning false if the mesh has too many vertices for that
+	*******************************************************************************************************************/
+	bool CompressIndices(const unsigned int* indices, size_t count, size_t vertexCount, std::vector<GLushort>& outIndices)
+	{
+		outIndices.clear();
+
+		if (!indices || count == 0 || vertexCount > 0xffff + 1) { return false; }
+
+		outIndices.assign(indices, indices + count);
+
+		return true;
+	}
+
+
+	/*******************************************************************************************************************
+		Converts a float to a 16-bit half float (round to nearest even). Values too big for a half become infinity
+	*******************************************************************************************************************/
+	GLushort FloatToHalf(float value)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		unsigned int sign		= (bits >> 16) & 0x8000;
+		int exponent			= (int)((bits >> 23) & 0xff) - 127 + 15;
+		unsigned int mantissa	= bits & 0x7fffff;
+
+		//--- NaN stays NaN, infinity and anything too big becomes infinity
+		if (((bits >> 23) & 0xff) == 0xff)	{ return (GLushort)(sign | 0x7c00 | ((mantissa) ? 0x200 : 0)); }
+		if (exponent >= 31)					{ return (GLushort)(sign | 0x7c00); }
+
+		//--- Too small to be a normal half, so becomes a denormal (or zero)
+		if (exponent <= 0) {
+
+			if (exponent < -10) { return (GLushort)sign; }
+
+			mantissa |= 0x800000;
+
+			unsigned int shift		= (unsigned int)(14 - exponent);
+			unsigned int half		= mantissa >> shift;
+			unsigned int remainder	= mantissa & ((1u << shift) - 1);
+			unsigned int halfway	= 1u << (shift - 1);
+
+			if (remainder > halfway || (remainder == halfway && (half & 1))) { half++; }
+
+			return (GLushort)(sign | half);
+		}
+
+		unsigned int half		= sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+		unsigned int remainder	= mantissa & 0x1fff;
+
+		//--- Rounding can carry in to the exponent, which correctly rounds up to the next power of two (or infinity)
+		if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) { half++; }
+
+		return (GLushort)half;
+	}
+
+
+	/*******************************************************************************************************************
+		Packs a unit vector in to GL_INT_2_10_10_10_REV format - x in the lowest 10 bits, then y, then z
+	*******************************************************************************************************************/
+	GLuint PackSignedNormalized(const glm::vec3& value)
+	{
+		GLuint packed = 0;
+
+		for (int component = 0; component < 3; component++) {
+
+			int quantised = (int)std::lround(glm::clamp(value[component], -1.0f, 1.0f) * MAXIMUM_COMPONENT);
+
+			packed |= ((GLuint)quantised & 0x3ff) << (component * 10);
+		}
+
+		return packed;
+	}
+}
\ No newline at end of file
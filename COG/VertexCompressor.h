@@ -0,0 +1,39 @@
+#pragma once
+
+/*******************************************************************************************************************
+	VertexCompressor.h, VertexCompressor.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Quantises PackedVertex data (56 bytes per vertex) down to a CompactVertex (24 bytes per vertex), and 32-bit
+	indices down to 16-bit indices when the mesh has few enough vertices.
+
+	[Features]
+	Positions are stored as 16-bit integers relative to the centre of the mesh. The decode matrix returned by
+	CompressVertices scales them back, and is multiplied in to the world matrix (see EntityShader::SetInstanceData),
+	so the decode costs nothing per vertex.
+	Texture coordinates are stored as half floats, so tiled coordinates outside of 0-1 still work.
+	Normals, tangents and bitangents are stored as 10:10:10:2 signed normalized values.
+	Everything is decoded by the vertex fetch hardware, so the shaders are the same for both vertex formats.
+
+	[Upcoming]
+	Octahedral normals and a quaternion tangent frame would get a vertex down to 16 bytes, but need decoding in the
+	shaders.
+
+	[Side Notes]
+	The position error is at most half of a step on each axis, where a step is 1/65534 of the largest size of the mesh.
+	Normals are accurate to about 0.1 degrees.
+
+*******************************************************************************************************************/
+#include <glm.hpp>
+#include <vector>
+#include "VertexBuffer.h"
+
+namespace vertex_compressor {
+
+	glm::mat4 CompressVertices(const VertexBuffer::PackedVertex* vertices, size_t count, std::vector<VertexBuffer::CompactVertex>& outVertices);
+	bool CompressIndices(const unsigned int* indices, size_t count, size_t vertexCount, std::vector<GLushort>& outIndices);
+
+	GLushort FloatToHalf(float value);
+	GLuint PackSignedNormalized(const glm::vec3& value);
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "VertexIndexer.h"
+#include "ThreadPool.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	[Table] Constructor - creates a power of 2 table with room for the expected count at under 50% load
+*******************************************************************************************************************/
+VertexIndexer::Table::Table(size_t expectedCount)
+	:	m_mask(0),
+		m_count(0)
+{
+	size_t capacity = 16;
+	while (capacity < expectedCount * 2) { capacity <<= 1; }
+
+	m_slots.assign(capacity, { 0, s_emptySlot });
+	m_mask = capacity - 1;
+}
+
+
+/*******************************************************************************************************************
+	[Table] Returns the first vertex equal to the one passed in, inserting the vertex passed in if there isn't one
+*******************************************************************************************************************/
+unsigned int VertexIndexer::Table::FindOrInsert(const std::vector<VertexBuffer::PackedVertex>& vertices, unsigned int vertex, unsigned int hash)
+{
+	//--- Keep the load factor below 70% so the probe sequences stay short
+	if ((m_count + 1) * 10 > m_slots.size() * 7) { Grow(vertices); }
+
+	size_t slot = hash & m_mask;
+
+	while (true) {
+
+		Slot& current = m_slots[slot];
+
+		//--- An empty slot means this vertex hasn't been seen before, so it becomes the first occurrence
+		if (current.vertex == s_emptySlot) {
+			current = { hash, vertex };
+			m_count++;
+			return vertex;
+		}
+
+		//--- Only compare the full 56 bytes when the hashes match
+		if (current.hash == hash && vertices[current.vertex] == vertices[vertex]) { return current.vertex; }
+
+		slot = (slot + 1) & m_mask;
+	}
+}
+
+
+/*******************************************************************************************************************
+	[Table] Doubles the size of the table and re-inserts every occupied slot
+*******************************************************************************************************************/
+void VertexIndexer::Table::Grow(const std::vector<VertexBuffer::PackedVertex>& vertices)
+{
+	std::vector<Slot> previous(m_slots.size() * 2, { 0, s_emptySlot });
+	previous.swap(m_slots);
+	m_mask = m_slots.size() - 1;
+
+	for (const Slot& occupied : previous) {
+		if (occupied.vertex == s_emptySlot) { continue; }
+
+		size_t slot = occupied.hash & m_mask;
+		while (m_slots[slot].vertex != s_emptySlot) { slot = (slot + 1) & m_mask; }
+		m_slots[slot] = occupied;
+	}
+}
+
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+VertexIndexer::VertexIndexer(bool parallel)
+	:	m_parallel(parallel)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+VertexIndexer::~VertexIndexer()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Function that fills outUnique with the position of every unique vertex (in the order they are first seen) and
+	outIndices with one index per vertex passed in, pointing in to outUnique
+*******************************************************************************************************************/
+void VertexIndexer::Generate(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& outUnique, std::vector<unsigned int>& outIndices)
+{
+	if (vertices.empty()) { return; }
+
+	//--- For every vertex, find the position of the first vertex that is identical to it (which may be itself)
+	std::vector<unsigned int> firstOccurrence(vertices.size());
+
+	if (m_parallel && vertices.size() >= s_minimumParallelCount && Workers::Instance()->GetWorkerCount() > 1) {
+		FindFirstOccurrencesParallel(vertices, firstOccurrence);
+	}
+	else { FindFirstOccurrences(vertices, firstOccurrence); }
+
+	//--- Merge: walk the vertices in order, giving each first occurrence the next index.
+	//--- A first occurrence always comes before (or is) the vertex pointing to it, so its index is always ready
+	std::vector<unsigned int> uniqueIndex(vertices.size());
+
+	size_t indexOffset = outIndices.size();
+	outIndices.resize(indexOffset + vertices.size());
+
+	for (unsigned int i = 0; i < vertices.size(); i++) {
+
+		if (firstOccurrence[i] == i) {
+			uniqueIndex[i] = (unsigned int)outUnique.size();
+			outUnique.emplace_back(i);
+		}
+
+		outIndices[indexOffset + i] = uniqueIndex[firstOccurrence[i]];
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the first occurrence of every vertex using a single hash table on this thread
+*******************************************************************************************************************/
+void VertexIndexer::FindFirstOccurrences(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& firstOccurrence)
+{
+	VertexBuffer::PackedVertex::Hash hasher;
+
+	//--- Most meshes share each vertex between ~4-6 triangles, so a quarter of the count is a good starting size
+	Table table(vertices.size() / 4);
+
+	for (unsigned int i = 0; i < vertices.size(); i++) {
+		firstOccurrence[i] = table.FindOrInsert(vertices, i, (unsigned int)hasher(vertices[i]));
+	}
+}
+
+
+/*******************************************************************************************************************
+	Function that finds the first occurrence of every vertex, spreading the work across the thread pool.
+	Equal vertices always have equal hashes, so sharding by hash means every shard can be de-duplicated
+	on its own, with no locking. Each shard walks the vertices in order, so the results match the serial version
+*******************************************************************************************************************/
+void VertexIndexer::FindFirstOccurrencesParallel(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& firstOccurrence)
+{
+	//--- Hash every vertex up front (in parallel), so each shard only has to read 4 bytes per vertex it skips
+	std::vector<unsigned int> hashes(vertices.size());
+
+	Workers::Instance()->ParallelFor(vertices.size(), s_minimumBatch, [&](size_t begin, size_t end) {
+		VertexBuffer::PackedVertex::Hash hasher;
+		for (size_t i = begin; i < end; i++) { hashes[i] = (unsigned int)hasher(vertices[i]); }
+	});
+
+	//--- One shard per thread. The top bits of the hash pick the shard, the bottom bits pick the table slot
+	unsigned int shardCount = Workers::Instance()->GetWorkerCount() + 1;
+
+	Workers::Instance()->ParallelFor(shardCount, 1, [&](size_t firstShard, size_t lastShard) {
+		for (size_t shard = firstShard; shard < lastShard; shard++) {
+
+			Table table(vertices.size() / (4 * shardCount));
+
+			for (unsigned int i = 0; i < vertices.size(); i++) {
+				if ((hashes[i] >> 16) % shardCount != shard) { continue; }
+				firstOccurrence[i] = table.FindOrInsert(vertices, i, hashes[i]);
+			}
+		}
+	});
+}
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+const unsigned int VertexIndexer::s_emptySlot			= 0xFFFFFFFF;
+const size_t VertexIndexer::s_minimumParallelCount		= 65536;
+const size_t VertexIndexer::s_minimumBatch				= 16384;
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+/*******************************************************************************************************************
+	VertexIndexer.h, VertexIndexer.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Removes duplicate vertices from a list of triangle corners and generates the index data to draw them.
+
+	[Features]
+	Uses an open addressing (linear probing) hash table keyed by PackedVertex::Hash - one flat array, no heap
+	node per vertex and no tree walks like the std::map it replaces.
+	Parallel mode splits the vertices in to shards by hash, de-duplicates each shard on its own core, then
+	merges the results. The output is always identical to the single threaded output: unique vertices are
+	kept in the order they are first seen, so index order is fully deterministic.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Vertices are compared byte for byte (like PackedVertex::operator<), so 0.0 and -0.0 are seen as different.
+
+*******************************************************************************************************************/
+#include <vector>
+#include "VertexBuffer.h"
+
+class VertexIndexer {
+
+private:
+	struct Slot {
+		unsigned int hash;
+		unsigned int vertex;
+	};
+
+	class Table {
+
+	public:
+		Table(size_t expectedCount);
+
+	public:
+		unsigned int FindOrInsert(const std::vector<VertexBuffer::PackedVertex>& vertices, unsigned int vertex, unsigned int hash);
+
+	private:
+		void Grow(const std::vector<VertexBuffer::PackedVertex>& vertices);
+
+	private:
+		std::vector<Slot>	m_slots;
+		size_t				m_mask;
+		size_t				m_count;
+	};
+
+public:
+	VertexIndexer(bool parallel = true);
+	~VertexIndexer();
+
+public:
+	void Generate(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& outUnique, std::vector<unsigned int>& outIndices);
+
+private:
+	void FindFirstOccurrences(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& firstOccurrence);
+	void FindFirstOccurrencesParallel(const std::vector<VertexBuffer::PackedVertex>& vertices, std::vector<unsigned int>& firstOccurrence);
+
+private:
+	bool m_parallel;
+
+private:
+	static const unsigned int	s_emptySlot;
+	static const size_t			s_minimumParallelCount;
+	static const size_t			s_minimumBatch;
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <cstring>
+#include "VirtualFile.h"
+#include "FileManager.h"
+#include "Lz4.h"
+#include "Log.h"
+
+/*******************************************************************************************************************
+	Constructor with initializer list to set default values of data members
+*******************************************************************************************************************/
+VirtualFile::VirtualFile()
+	:	m_data(nullptr),
+		m_size(0)
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Default destructor
+*******************************************************************************************************************/
+VirtualFile::~VirtualFile()
+{
+
+}
+
+
+/*******************************************************************************************************************
+	Opens a file from the mounted packs if it's in one of them, otherwise maps the file from disk
+*******************************************************************************************************************/
+bool VirtualFile::Open(const std::string& fileLocation)
+{
+	Close();
+
+	const PackFile* pack		= nullptr;
+	const PackFile::Entry* entry	= File::Instance()->FindPacked(fileLocation, pack);
+
+	if (!entry) {
+
+		if (!m_file.Open(fileLocation)) { return false; }
+
+		m_data = m_file.GetData();
+		m_size = m_file.GetSize();
+
+		return true;
+	}
+
+	if (entry->flags & PackFile::ENTRY_COMPRESSED) {
+
+		m_buffer.resize(entry->size);
+
+		if (!lz4::Decompress(pack->GetData(*entry), entry->storedSize, m_buffer.data(), m_buffer.size())) {
+			FL_LOG("[FILE] Packed file is corrupt: ", fileLocation.c_str(), LOG_ERROR);
+			Close();
+			return false;
+		}
+
+		m_data = m_buffer.data();
+	}
+	else { m_data = pack->GetData(*entry); }
+
+	m_size = entry->size;
+
+	return true;
+}
+
+
+/*******************************************************************************************************************
+	Function that releases the file data
+*******************************************************************************************************************/
+void VirtualFile::Close()
+{
+	m_file.Close();
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+/*******************************************************************************************************************
+	Function that hashes the file's data, 8 bytes at a time (64-bit FNV-1a applied to whole words)
+*******************************************************************************************************************/
+unsigned long long VirtualFile::GenerateHash() const
+{
+	const unsigned long long PRIME = 1099511628211ull;
+
+	unsigned long long hash = 14695981039346656037ull;
+	unsigned long long word = 0;
+	size_t byte = 0;
+
+	for (; byte + sizeof(word) <= m_size; byte += sizeof(word)) {
+		memcpy(&word, m_data + byte, sizeof(word));
+		hash = (hash ^ word) * PRIME;
+	}
+
+	for (; byte < m_size; byte++) { hash = (hash ^ (unsigned char)m_data[byte]) * PRIME; }
+
+	return (hash ^ m_size) * PRIME;
+}
+
+
+/*******************************************************************************************************************
+	Accessor methods
+*******************************************************************************************************************/
+const char* VirtualFile::GetData() const	{ return m_data; }
+size_t VirtualFile::GetSize() const			{ return m_size; }
+bool VirtualFile::IsOpen() const			{ return m_data != nullptr; }
+
+
+/*******************************************************************************************************************
+	Static variables and functions
+*******************************************************************************************************************/
+bool VirtualFile::Exists(const std::string& fileLocation)
+{
+	const PackFile* pack = nullptr;
+
+	return File::Instance()->FindPacked(fileLocation, pack) || GetFileAttributes(fileLocation.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+
+bool VirtualFile::GenerateHash(const std::string& fileLocation, unsigned long long& outHash)
+{
+	VirtualFile file;
+
+	if (!file.Open(fileLocation)) { return false; }
+
+	outHash = file.GenerateHash();
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+/*******************************************************************************************************************
+	VirtualFile.h, VirtualFile.cpp
+	Created by Kim Kane
+	Last updated: 17/10/2026
+
+	Opens a file for reading from the mounted pack files (see FileManager::Mount), or from disk if it isn't packed.
+	Every loader reads its files through this class, so none of them need to know where the data actually lives.
+
+	[Features]
+	Uncompressed pack entries are read straight from the pack's mapping, and loose files are memory mapped (see
+	MappedFile.h), so no copies are made. Compressed pack entries are decompressed in to a buffer owned by this object.
+	The data stays valid until the object goes out of scope, or until Close() is called.
+	Files can be hashed, so caches built from them can tell if the bytes they were built from have changed - wherever
+	those bytes came from.
+
+	[Upcoming]
+	Nothing at present.
+
+	[Side Notes]
+	Opening files is thread safe, as long as packs aren't mounted or unmounted while files are being loaded.
+
+*******************************************************************************************************************/
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+class VirtualFile {
+
+public:
+	VirtualFile();
+	~VirtualFile();
+
+public:
+	bool Open(const std::string& fileLocation);
+	void Close();
+
+public:
+	const char*	GetData() const;
+	size_t		GetSize() const;
+	bool		IsOpen() const;
+
+public:
+	unsigned long long GenerateHash() const;
+
+public:
+	static bool Exists(const std::string& fileLocation);
+	static bool GenerateHash(const std::string& fileLocation, unsigned long long& outHash);
+
+private:
+	VirtualFile(const VirtualFile&)				= delete;
+	VirtualFile& operator=(const VirtualFile&)	= delete;
+
+private:
+	MappedFile			m_file;
+	std::vector<char>	m_buffer;
+	const char*			m_data;
+	size_t				m_size;
+};
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include "InterfaceShader.h"
 #include "Tools.h"
 #include "InputManager.h"
-#include "FileManager.h"
+#include "ConfigManager.h"
 
 /*******************************************************************************************************************
 	Constructor with initializer list to set default values of data members
@@ -31,22 +31,13 @@ Widget::~Widget()
 *******************************************************************************************************************/
 Widget* Widget::Create(const std::string& tag)
 {
-	File::Instance()->OpenForReading("Assets\\Files\\interfaceObjects.config");
+	ConfigObject data = Config::Instance()->Find("Assets\\Files\\interfaceObjects.config", tag);
 
-	std::map<std::string, std::map<std::string, std::string>> data;
-
-	File::Instance()->GetObjectData(tag, data);
-
-	glm::vec2 position	= glm::vec2(StringToFloat(data[tag]["transform.x"]), StringToFloat(data[tag]["transform.y"]));
-	glm::vec2 dimension = glm::vec2(StringToFloat(data[tag]["width"]), StringToFloat(data[tag]["height"]));
-	glm::vec2 toggle	= glm::vec2(StringToFloat(data[tag]["toggle.x"]), StringToFloat(data[tag]["toggle.y"]));
+	glm::vec2 position	= data.GetVector2("transform");
+	glm::vec2 dimension = glm::vec2(data.GetFloat("width"), data.GetFloat("height"));
+	glm::vec2 toggle	= data.GetVector2("toggle");
 	
-	//--- NOTE
-	// This function was made for ease of use/quickness and is not optimized at all, so please ignore (I know it's ugly!)
-	// Later I plan on tidying up file handling and building a proper file parsing system (I never got round to this!)
-	//---
-
-	return new Widget(data[tag]["tag"], data[tag]["sprite"], Transform(position, dimension), toggle);
+	return new Widget(data.GetString("tag"), data.GetString("sprite"), Transform(position, dimension), toggle);
 }
 
 
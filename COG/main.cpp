@@ -1,4 +1,7 @@
+#include <string>
 #include "GameManager.h"
+#include "Benchmark.h"
+#include "PackFile.h"
 #if DEBUG_MODE == 1
 	#include <vld.h>
 #endif
@@ -13,6 +16,12 @@
 
 int main(int argc, char *argv[])
 {
+	//--- Run the loading benchmarks instead of the game (see Benchmark.h)
+	if (argc > 1 && std::string(argv[1]) == "-benchmark") { benchmark::Run(); return 0; }
+
+	//--- Pack every asset in to one archive instead of running the game (see PackFile.h)
+	if (argc > 1 && std::string(argv[1]) == "-pack") { return (PackFile::Build("Assets", "Assets.cogpak")) ? 0 : 1; }
+
 	//--- Full screen, core mode and Vsync bools can be adjusted below.
 	//--- Press ESC to exit full screen mode (full screen looks a bit streched right now - need to try and fix this!)
 	Game::Instance()->Initialize("Flashlight", false, true, true);